@@ -0,0 +1,144 @@
+// SPDX-FileCopyrightText: 2026 RizinOrg <info@rizin.re>
+// SPDX-License-Identifier: LGPL-3.0-only
+
+/**
+ * \file columns.c
+ *
+ * Columnar binary output, see include/rz_libdemangle_columns.h for the
+ * layout and the reader.
+ *
+ * The strings are streamed to the file right after a placeholder header as
+ * the batches complete, while the fixed size columns (8 to 18 bytes per
+ * record) are kept in memory; they are appended after the heap when the
+ * file is closed, then the header is written over the placeholder.
+ */
+
+#include "demangle.h"
+#include <rz_libdemangle_columns.h>
+
+#define COLUMNS_ALIGN(x) (((x) + 7) & ~(ut64)7)
+
+static void columns_write_le64(ut8 *p, ut64 value) {
+	cli_write_le32(p, (ut32)value);
+	cli_write_le32(p + 4, (ut32)(value >> 32));
+}
+
+/**
+ * \brief 64 bit FNV-1a hash of the input, as documented by the format.
+ */
+static ut64 columns_hash(const char *data, size_t length) {
+	ut64 hash = 0xcbf29ce484222325ull;
+	for (size_t i = 0; i < length; ++i) {
+		hash = (hash ^ (ut8)data[i]) * 0x100000001b3ull;
+	}
+	return hash;
+}
+
+static bool columns_append_le64(CliBuffer *buffer, ut64 value) {
+	ut8 bytes[8];
+	columns_write_le64(bytes, value);
+	return cli_buffer_append(buffer, (const char *)bytes, sizeof(bytes));
+}
+
+/**
+ * \brief Writes the data (unless NULL, i.e. already written) followed by the
+ * zero padding up to 8 bytes.
+ */
+static bool columns_write_section(FILE *fp, const void *data, size_t size) {
+	static const char zeros[8] = { 0 };
+	size_t padding = COLUMNS_ALIGN(size) - size;
+	return (!data || !size || fwrite(data, 1, size, fp) == size) && fwrite(zeros, 1, padding, fp) == padding;
+}
+
+/**
+ * \brief Creates the file at \p path; with \p hashes the input hashes are
+ * stored too.
+ */
+bool cli_columns_open(CliColumns *columns, const char *path, bool hashes) {
+	RzDemangleColumnsHeader placeholder = { 0 };
+	memset(columns, 0, sizeof(*columns));
+	columns->path = path;
+	columns->hashes = hashes;
+	if (!(columns->fp = fopen(path, "wb"))) {
+		return false;
+	} else if (fwrite(&placeholder, sizeof(placeholder), 1, columns->fp) != 1 || !columns_append_le64(&columns->offsets, 0)) {
+		cli_columns_close(columns, false);
+		return false;
+	}
+	return true;
+}
+
+/**
+ * \brief Appends a record; its string is the \p result or the input when
+ * the symbol cannot be demangled.
+ */
+bool cli_columns_add(CliColumns *columns, RzDemangleLang lang, const char *input, size_t input_length, const char *result) {
+	const char *string = result ? result : input;
+	size_t length = (result ? strlen(result) : input_length) + 1;
+	ut8 lang_byte = (ut8)lang;
+	ut8 status_byte = result ? RZ_DEMANGLE_COLUMNS_DEMANGLED : RZ_DEMANGLE_COLUMNS_FAILED;
+	if (fwrite(string, 1, length - 1, columns->fp) != length - 1 || fputc(0, columns->fp) == EOF) {
+		return false;
+	}
+	columns->heap_size += length;
+	columns->n_records++;
+	return columns_append_le64(&columns->offsets, columns->heap_size) &&
+		(!columns->hashes || columns_append_le64(&columns->hash_column, columns_hash(input, input_length))) &&
+		cli_buffer_append(&columns->langs, (const char *)&lang_byte, 1) &&
+		cli_buffer_append(&columns->status, (const char *)&status_byte, 1);
+}
+
+/**
+ * \brief Appends the heap padding, the columns and writes the header.
+ */
+static bool columns_finish(CliColumns *columns) {
+	ut8 header[sizeof(RzDemangleColumnsHeader)] = { 0 };
+	ut64 offset = sizeof(header);
+	memcpy(header, RZ_DEMANGLE_COLUMNS_MAGIC, 8);
+	cli_write_le32(header + offsetof(RzDemangleColumnsHeader, version), RZ_DEMANGLE_COLUMNS_VERSION);
+	cli_write_le32(header + offsetof(RzDemangleColumnsHeader, flags), columns->hashes ? RZ_DEMANGLE_COLUMNS_HASHES : 0);
+	columns_write_le64(header + offsetof(RzDemangleColumnsHeader, n_records), columns->n_records);
+	columns_write_le64(header + offsetof(RzDemangleColumnsHeader, heap_offset), offset);
+	columns_write_le64(header + offsetof(RzDemangleColumnsHeader, heap_size), columns->heap_size);
+	offset = COLUMNS_ALIGN(offset + columns->heap_size);
+	columns_write_le64(header + offsetof(RzDemangleColumnsHeader, offsets_offset), offset);
+	offset += columns->offsets.size;
+	if (columns->hashes) {
+		columns_write_le64(header + offsetof(RzDemangleColumnsHeader, hashes_offset), offset);
+		offset += columns->hash_column.size;
+	}
+	columns_write_le64(header + offsetof(RzDemangleColumnsHeader, langs_offset), offset);
+	offset = COLUMNS_ALIGN(offset + columns->langs.size);
+	columns_write_le64(header + offsetof(RzDemangleColumnsHeader, status_offset), offset);
+
+	// the heap is padded as any other section
+	return columns_write_section(columns->fp, NULL, columns->heap_size) &&
+		columns_write_section(columns->fp, columns->offsets.data, columns->offsets.size) &&
+		columns_write_section(columns->fp, columns->hash_column.data, columns->hash_column.size) &&
+		columns_write_section(columns->fp, columns->langs.data, columns->langs.size) &&
+		columns_write_section(columns->fp, columns->status.data, columns->status.size) &&
+		!fseek(columns->fp, 0, SEEK_SET) && fwrite(header, sizeof(header), 1, columns->fp) == 1;
+}
+
+/**
+ * \brief Completes the file with the columns and the header; without
+ * \p commit (or on failure) the file is removed.
+ */
+bool cli_columns_close(CliColumns *columns, bool commit) {
+	bool res = false;
+	if (columns->fp) {
+		res = commit && columns_finish(columns);
+		if (fclose(columns->fp)) {
+			res = false;
+		}
+		if (!res) {
+			remove(columns->path);
+		}
+		columns->fp = NULL;
+	}
+	cli_buffer_fini(&columns->offsets);
+	cli_buffer_fini(&columns->hash_column);
+	cli_buffer_fini(&columns->langs);
+	cli_buffer_fini(&columns->status);
+	return res;
+}
@@ -2,9 +2,7 @@
 // SPDX-FileCopyrightText: 2023 deroad <wargio@libero.it>
 // SPDX-License-Identifier: LGPL-3.0-only
 
-#include "demangler_util.h"
-#include "rz_libdemangle.h"
-#include "rz_libdemangle.h"
+#include "demangle.h"
 
 #if WITH_GPL
 #define CPP "c++ (incl. borland, gnu v3 & v2)"
@@ -20,68 +18,601 @@
 
 #define LANGUAGES "java, msvc, objc, " SWIFT "pascal, rust, " CPP
 
-typedef char *(*handler_t)(const char *symbol, RzDemangleOpts opts);
+/* max number of results kept in memory while demangling a stream */
+#define CLI_MEMO_SIZE (1 << 18)
 
-typedef struct {
-	const char *name;
-	handler_t demangle;
-} language_t;
+/* max number of threads accepted by -j */
+#define CLI_MAX_JOBS 1024
 
-static language_t languages[] = {
-	{ .name = "c++", .demangle = libdemangle_handler_cxx },
-	{ .name = "rust", .demangle = libdemangle_handler_rust },
-#if WITH_SWIFT_DEMANGLER
-	{ .name = "swift", .demangle = libdemangle_handler_swift },
-#endif
-	{ .name = "java", .demangle = libdemangle_handler_java },
-	{ .name = "msvc", .demangle = libdemangle_handler_msvc },
-	{ .name = "objc", .demangle = libdemangle_handler_objc },
-	{ .name = "pascal", .demangle = libdemangle_handler_pascal },
-};
+/* size of a new filter of the symbols known not to demangle */
+#define CLI_FILTER_CAPACITY (1 << 20)
+#define CLI_FILTER_FP_RATE  0.001
 
 static void usage(const char *prog) {
-	printf("usage: %s [option] <lang> <string to demangle>\n", prog);
-	printf("The program will attempt to demangle the string for the given language.\n"
+	printf("usage: %s [options] <lang> [<string to demangle>]\n", prog);
+	printf("       %s [options] -t\n", prog);
+	printf("The program will attempt to demangle the string for the given language;\n"
+	       "when no string is given, one symbol per line is read from stdin and\n"
+	       "the symbols which cannot be demangled are printed unchanged.\n"
 	       "Options:\n"
-	       "  -s    demangles the entry and simplifies the result\n"
+	       "  -s                  demangles the entry and simplifies the result\n"
+	       "  -t                  copies stdin to stdout, demangling the names found in the text\n"
+	       "  -m                  prints the candidate mangled names (c++ or msvc) of the declaration\n"
+	       "  -u                  prints the sorted unique names demangled from stdin, like sort -u\n"
+	       "  --json              prints a JSON record per symbol (NDJSON)\n"
+	       "  --json-ns           prints a JSON record per symbol, with the nanoseconds spent\n"
+	       "  --stats             prints the throughput and latency statistics at the end\n"
+	       "  --columns <file>    writes the symbols read from stdin to a columnar binary file\n"
+	       "  --columns-hash      stores the 64 bit FNV-1a hash of each input in the --columns file\n"
+#if WITH_CACHE
+	       "  -c <file>           uses (and updates) the given persistent demangle cache\n"
+#endif
+#if WITH_FILTER
+	       "  --filter <file>     skips (and records) the symbols known not to demangle\n"
+	       "  --filter-fp <rate>  false-positive rate of a new --filter file (default 0.001)\n"
+#endif
+#if WITH_THREADS
+	       "  -j <threads>        number of demangling threads; stdin is demangled\n"
+	       "                      by a reader, <threads> workers and a writer thread\n"
+#endif
+#if WITH_FILES
+	       "  -f <file>           demangles the symbols of the given ELF, PE/COFF, PDB or Mach-O file\n"
+	       "  -r <dir>            demangles the symbols of all the supported files in the tree\n"
+	       "  --diff <old> <new>  prints the symbols removed, added and changed between two files\n"
+	       "                      (or lists of symbols, one per line)\n"
+#endif
+#if WITH_CORPUS
+	       "  --capture <file>    appends every symbol demangled to the corpus file\n"
+	       "  --replay <file>     demangles the symbols of the corpus file as a benchmark, with\n"
+	       "                      -j threads, and prints the throughput and latency per language\n"
+#endif
+#if WITH_SERVER
+	       "  --listen <socket>   runs as daemon serving the clients on the unix socket\n"
+	       "  --connect <socket>  demangles stdin via the daemon listening on the socket\n"
+#endif
 	       "\nSupported languages: " LANGUAGES "\n");
 }
 
+/**
+ * \brief Reads at most \p max_lines lines (without the line terminator).
+ */
+size_t cli_read_lines(FILE *fp, char **lines, size_t max_lines) {
+	char chunk[1024];
+	size_t n_lines = 0;
+	char *line = NULL;
+	size_t length = 0;
+	while (n_lines < max_lines && fgets(chunk, sizeof(chunk), fp)) {
+		size_t size = strlen(chunk);
+		bool eol = size > 0 && chunk[size - 1] == '\n';
+		char *tmp = realloc(line, length + size + 1);
+		if (!tmp) {
+			break;
+		}
+		line = tmp;
+		memcpy(line + length, chunk, size + 1);
+		length += size;
+		if (!eol && !feof(fp)) {
+			continue;
+		}
+		length = strcspn(line, "\r\n");
+		line[length] = 0;
+		lines[n_lines++] = line;
+		line = NULL;
+		length = 0;
+	}
+	free(line);
+	return n_lines;
+}
+
+void cli_free_lines(char **lines, size_t n_lines) {
+	for (size_t i = 0; i < n_lines; ++i) {
+		free(lines[i]);
+	}
+}
+
+/**
+ * \brief Prints the demangled lines (or their records) and collects their
+ * \p stats; \p results and their times \p ns come from the batch, unless
+ * each line is demangled here on its own (\p serial).
+ */
+static bool stream_print(RzDemangleCtx *ctx, RzDemangleLang lang, RzDemangleOpts opts, CliOutput output, CliStats *stats, char **lines, char **results, const unsigned long long *ns, size_t n_lines, bool serial, FILE *out) {
+	CliBuffer buffer = { 0 };
+	bool res = true;
+	for (size_t i = 0; i < n_lines && res; ++i) {
+		CliRecord record = { 0 };
+		record.input = lines[i];
+		record.input_length = strlen(lines[i]);
+		record.lang = lang;
+		record.result = results[i];
+		record.ns = UT64_MAX;
+		record.bytes = UT64_MAX;
+		if (serial) {
+			cli_record_demangle(ctx, output, opts, stats, &record, lines[i]);
+			results[i] = record.result;
+		} else if (ns) {
+			record.ns = output == CLI_OUTPUT_JSON_TIMED ? ns[i] : UT64_MAX;
+			record.deduplicated = output == CLI_OUTPUT_JSON_TIMED && ns[i] == UT64_MAX;
+			if (stats) {
+				cli_stats_add(stats, lang, record.input_length, results[i] != NULL, ns[i]);
+			}
+		}
+		res = output == CLI_OUTPUT_TEXT ? fprintf(out, "%s\n", results[i] ? results[i] : lines[i]) >= 0 : cli_json_record(&buffer, &record);
+	}
+	if (res && buffer.size) {
+		fwrite(buffer.data, 1, buffer.size, out);
+	}
+	cli_buffer_fini(&buffer);
+	return res;
+}
+
+/**
+ * \brief Demangles the lines of \p in by batches, appending the results to
+ * the \p columns when given, otherwise printing them to \p out.
+ */
+static int demangle_stream(RzDemangleCtx *ctx, RzDemangleLang lang, RzDemangleOpts opts, CliOutput output, CliStats *stats, CliColumns *columns, FILE *in, FILE *out) {
+	char **lines = calloc(CLI_BATCH_SIZE, sizeof(char *));
+	char **results = calloc(CLI_BATCH_SIZE, sizeof(char *));
+	bool timed = output == CLI_OUTPUT_JSON_TIMED || stats;
+#if WITH_ALLOC_PROFILE
+	// the bytes are counted per thread, thus per symbol only when serial
+	bool serial = output == CLI_OUTPUT_JSON_TIMED;
+#else
+	bool serial = false;
+#endif
+	// the workers of the batch time each symbol
+	unsigned long long *ns = timed && !serial ? calloc(CLI_BATCH_SIZE, sizeof(unsigned long long)) : NULL;
+	int ret = 1;
+	if (!lines || !results || (timed && !serial && !ns)) {
+		goto end;
+	}
+	RzDemangleBatch batch = { 0 };
+	batch.lang = lang;
+	batch.opts = opts;
+	batch.symbols = (const char **)lines;
+	batch.results = results;
+	batch.ns = ns;
+	while ((batch.n_symbols = cli_read_lines(in, lines, CLI_BATCH_SIZE)) > 0) {
+		if (!serial && !libdemangle_batch_unique(ctx, &batch)) {
+			cli_free_lines(lines, batch.n_symbols);
+			goto end;
+		}
+		bool res = true;
+		if (columns) {
+			for (size_t i = 0; i < batch.n_symbols && res; ++i) {
+				res = cli_columns_add(columns, lang, lines[i], strlen(lines[i]), results[i]);
+			}
+		} else if (output != CLI_OUTPUT_TEXT || stats) {
+			res = stream_print(ctx, lang, opts, output, stats, lines, results, ns, batch.n_symbols, serial, out);
+		} else {
+			for (size_t i = 0; i < batch.n_symbols; ++i) {
+				fprintf(out, "%s\n", results[i] ? results[i] : lines[i]);
+			}
+		}
+		cli_free_lines(results, batch.n_symbols);
+		cli_free_lines(lines, batch.n_symbols);
+		memset(results, 0, batch.n_symbols * sizeof(char *));
+		if (!res) {
+			goto end;
+		}
+	}
+	ret = 0;
+
+end:
+	free(lines);
+	free(results);
+	free(ns);
+	return ret;
+}
+
+/**
+ * \brief Prints once each name demangled from \p in (or each input which
+ * cannot be demangled), in sorted order.
+ */
+static int demangle_sorted_unique(RzDemangleCtx *ctx, RzDemangleLang lang, RzDemangleOpts opts, FILE *in, FILE *out) {
+	char **lines = calloc(CLI_BATCH_SIZE, sizeof(char *));
+	RzDemangleSet *set = libdemangle_set_new(ctx, true);
+	size_t n_lines, n_names = 0;
+	int ret = 1;
+	if (!lines || !set) {
+		goto end;
+	}
+	while ((n_lines = cli_read_lines(in, lines, CLI_BATCH_SIZE)) > 0) {
+		bool res = libdemangle_set_add(set, lang, opts, (const char **)lines, n_lines);
+		cli_free_lines(lines, n_lines);
+		if (!res) {
+			goto end;
+		}
+	}
+	const char **names = libdemangle_set_sorted(set, &n_names);
+	if (!names) {
+		goto end;
+	}
+	for (size_t i = 0; i < n_names; ++i) {
+		fprintf(out, "%s\n", names[i]);
+	}
+	ret = 0;
+
+end:
+	free(lines);
+	libdemangle_set_free(set);
+	return ret;
+}
+
 int main(int argc, char const *argv[]) {
-	if (argc != 3 && argc != 4) {
+	RzDemangleOpts opts = RZ_DEMANGLE_OPT_BASE;
+#if WITH_CACHE
+	const char *cache_path = NULL;
+	RzDemangleCache *cache = NULL;
+#endif
+#if WITH_FILTER
+	const char *filter_path = NULL;
+	double filter_fp_rate = CLI_FILTER_FP_RATE;
+	RzDemangleFilter *filter = NULL;
+#endif
+#if WITH_FILES
+	const char *file_path = NULL;
+	const char *tree_path = NULL;
+	const char *diff_paths[2] = { NULL, NULL };
+#endif
+#if WITH_CORPUS
+	const char *capture_path = NULL;
+	const char *replay_path = NULL;
+	RzDemangleCapture *capture = NULL;
+#endif
+#if WITH_SERVER
+	const char *listen_path = NULL;
+	const char *connect_path = NULL;
+#endif
+	RzDemangleCtx *ctx = NULL;
+	char *result = NULL;
+	size_t n_jobs = 0;
+	bool text = false;
+	bool mangle = false;
+	bool sorted_unique = false;
+	CliOutput output = CLI_OUTPUT_TEXT;
+	CliStats *stats = NULL;
+	RzDemangleSampler *sampler = NULL;
+	bool print_stats = false;
+	const char *columns_path = NULL;
+	bool columns_hashes = false;
+	CliColumns columns = { 0 };
+	ut64 start = cli_time_ns();
+	int i, ret = 1;
+
+	for (i = 1; i < argc && argv[i][0] == '-' && argv[i][1]; ++i) {
+		if (!strcmp(argv[i], "-s")) {
+			opts |= RZ_DEMANGLE_OPT_SIMPLIFY;
+		} else if (!strcmp(argv[i], "-t")) {
+			text = true;
+		} else if (!strcmp(argv[i], "-m")) {
+			mangle = true;
+		} else if (!strcmp(argv[i], "-u")) {
+			sorted_unique = true;
+		} else if (!strcmp(argv[i], "--json")) {
+			output = CLI_OUTPUT_JSON;
+		} else if (!strcmp(argv[i], "--json-ns")) {
+			output = CLI_OUTPUT_JSON_TIMED;
+		} else if (!strcmp(argv[i], "--stats")) {
+			print_stats = true;
+		} else if (!strcmp(argv[i], "--columns") && (i + 1) < argc) {
+			columns_path = argv[++i];
+		} else if (!strcmp(argv[i], "--columns-hash")) {
+			columns_hashes = true;
+#if WITH_CACHE
+		} else if (!strcmp(argv[i], "-c") && (i + 1) < argc) {
+			cache_path = argv[++i];
+#endif
+#if WITH_FILTER
+		} else if (!strcmp(argv[i], "--filter") && (i + 1) < argc) {
+			filter_path = argv[++i];
+		} else if (!strcmp(argv[i], "--filter-fp") && (i + 1) < argc) {
+			char *end = NULL;
+			filter_fp_rate = strtod(argv[++i], &end);
+			if (!*argv[i] || *end || !(filter_fp_rate > 0.0 && filter_fp_rate < 1.0)) {
+				printf("error: invalid false-positive rate: '%s'\n", argv[i]);
+				usage(argv[0]);
+				return 1;
+			}
+#endif
+#if WITH_THREADS
+		} else if (!strcmp(argv[i], "-j") && (i + 1) < argc) {
+			char *end = NULL;
+			unsigned long value = strtoul(argv[++i], &end, 10);
+			if (!*argv[i] || *end || !value || value > CLI_MAX_JOBS) {
+				printf("error: invalid number of threads: '%s'\n", argv[i]);
+				usage(argv[0]);
+				return 1;
+			}
+			n_jobs = value;
+#endif
+#if WITH_FILES
+		} else if (!strcmp(argv[i], "-f") && (i + 1) < argc) {
+			file_path = argv[++i];
+		} else if (!strcmp(argv[i], "-r") && (i + 1) < argc) {
+			tree_path = argv[++i];
+		} else if (!strcmp(argv[i], "--diff") && (i + 2) < argc) {
+			diff_paths[0] = argv[++i];
+			diff_paths[1] = argv[++i];
+#endif
+#if WITH_CORPUS
+		} else if (!strcmp(argv[i], "--capture") && (i + 1) < argc) {
+			capture_path = argv[++i];
+		} else if (!strcmp(argv[i], "--replay") && (i + 1) < argc) {
+			replay_path = argv[++i];
+#endif
+#if WITH_SERVER
+		} else if (!strcmp(argv[i], "--listen") && (i + 1) < argc) {
+			listen_path = argv[++i];
+		} else if (!strcmp(argv[i], "--connect") && (i + 1) < argc) {
+			connect_path = argv[++i];
+#endif
+		} else {
+			printf("error: invalid option: '%s'\n", argv[i]);
+			usage(argv[0]);
+			return 1;
+		}
+	}
+
+	int n_args = argc - i;
+	bool valid_args = n_args == 1 || n_args == 2;
+	if (text) {
+		valid_args = !n_args && output == CLI_OUTPUT_TEXT && !print_stats;
+	} else if (mangle) {
+		valid_args = n_args == 2 && output == CLI_OUTPUT_TEXT && !print_stats;
+	}
+#if WITH_FILES
+	if (file_path || tree_path) {
+		valid_args = !n_args && !text && !mangle && !(file_path && tree_path);
+	}
+	if (diff_paths[0]) {
+		valid_args = !n_args && !text && !mangle && !file_path && !tree_path && output == CLI_OUTPUT_TEXT && !print_stats;
+	}
+#endif
+#if WITH_SERVER
+	if (listen_path) {
+		valid_args = !n_args && !connect_path && !text && !mangle && output == CLI_OUTPUT_TEXT && !print_stats;
+	} else if (connect_path) {
+		valid_args = n_args == 1 && !text && !mangle && output == CLI_OUTPUT_TEXT && !print_stats;
+	}
+#endif
+	if (columns_path) {
+		// only the symbols read from stdin are written to the columns
+		valid_args = valid_args && n_args == 1 && !text && !mangle && output == CLI_OUTPUT_TEXT && !print_stats;
+#if WITH_SERVER
+		valid_args = valid_args && !connect_path;
+#endif
+	} else if (columns_hashes) {
+		valid_args = false;
+	}
+	if (sorted_unique) {
+		valid_args = valid_args && n_args == 1 && !text && !mangle && !columns_path && output == CLI_OUTPUT_TEXT && !print_stats;
+#if WITH_SERVER
+		valid_args = valid_args && !connect_path;
+#endif
+	}
+#if WITH_CORPUS
+	if (replay_path) {
+		valid_args = !n_args && !text && !mangle && !sorted_unique && !columns_path && !capture_path && output == CLI_OUTPUT_TEXT && !print_stats;
+#if WITH_FILES
+		valid_args = valid_args && !file_path && !tree_path && !diff_paths[0];
+#endif
+#if WITH_SERVER
+		valid_args = valid_args && !listen_path && !connect_path;
+#endif
+	} else if (capture_path) {
+		valid_args = valid_args && !mangle;
+#if WITH_SERVER
+		valid_args = valid_args && !connect_path;
+#endif
+	}
+#endif
+	if (!valid_args) {
 		usage(argv[0]);
 		return 1;
 	}
 
-	RzDemangleOpts opts = RZ_DEMANGLE_OPT_BASE;
-	const char *lang = argv[1];
-	const char *symbol = argv[2];
-
-	if (argc == 4) {
-		if (strcmp(argv[1], "-s")) {
-			printf("error: invalid option: '%s'\n", argv[1]);
+	RzDemangleLang lang = RZ_DEMANGLE_LANG_MAX;
+	if (n_args > 0) {
+		lang = libdemangle_lang_from_name(argv[i]);
+		if (lang == RZ_DEMANGLE_LANG_MAX) {
+			printf("unknown lang: %s\n", argv[i]);
 			usage(argv[0]);
 			return 1;
 		}
-		opts |= RZ_DEMANGLE_OPT_SIMPLIFY;
-		lang = argv[2];
-		symbol = argv[3];
 	}
 
-	for (size_t i = 0; i < RZ_ARRAY_SIZE(languages); ++i) {
-		if (strcmp(languages[i].name, lang)) {
-			continue;
+	if (mangle) {
+		char **names = libdemangle_mangle(lang, argv[i + 1]);
+		if (!names) {
+			fprintf(stderr, "error: cannot mangle '%s'\n", argv[i + 1]);
+			return 1;
+		}
+		for (char **name = names; *name; ++name) {
+			printf("%s\n", *name);
+		}
+		libdemangle_mangle_free(names);
+		return 0;
+	}
+
+#if WITH_SERVER
+	if (connect_path) {
+		return cli_server_connect(connect_path, lang, opts, stdin, stdout);
+	}
+#endif
+#if WITH_CORPUS
+	if (replay_path) {
+		return cli_replay(replay_path, n_jobs, stdout);
+	}
+#endif
+
+#if WITH_CACHE
+	if (cache_path && !(cache = libdemangle_cache_open(cache_path, RZ_DEMANGLE_CACHE_READ_WRITE))) {
+		// a broken or unwritable cache never prevents demangling.
+		fprintf(stderr, "warning: cannot open cache file '%s'\n", cache_path);
+	}
+#endif
+#if WITH_FILTER
+	if (filter_path && !(filter = libdemangle_filter_load(filter_path)) &&
+		!(filter = libdemangle_filter_new(CLI_FILTER_CAPACITY, filter_fp_rate))) {
+		fprintf(stderr, "error: cannot allocate the filter\n");
+		goto end;
+	}
+#endif
+#if WITH_CORPUS
+	if (capture_path && !(capture = libdemangle_capture_open(capture_path))) {
+		fprintf(stderr, "error: cannot open the corpus '%s'\n", capture_path);
+		goto end;
+	}
+#endif
+	if (print_stats && (!(stats = RZ_NEW0(CliStats)) || !(sampler = libdemangle_sampler_new(CLI_STATS_TOP)))) {
+		fprintf(stderr, "error: cannot allocate the statistics\n");
+		goto end;
+	}
+
+	if (n_args == 2) {
+		bool known_failure = false;
+#if WITH_CORPUS
+		libdemangle_capture_add(capture, lang, argv[i + 1], opts);
+#endif
+		// only the lookup is timed, like in the other paths
+		ut64 bytes = output == CLI_OUTPUT_JSON_TIMED ? cli_alloc_bytes() : UT64_MAX;
+		ut64 begin = cli_time_ns();
+#if WITH_FILTER
+		known_failure = libdemangle_filter_contains(filter, lang, argv[i + 1]);
+#endif
+		if (!known_failure) {
+#if WITH_CACHE
+			result = cache ? libdemangle_cache_demangle(cache, lang, argv[i + 1], opts) : libdemangle_handler(lang, argv[i + 1], opts);
+#else
+			result = libdemangle_handler(lang, argv[i + 1], opts);
+#endif
+		}
+#if WITH_FILTER
+		if (!result) {
+			libdemangle_filter_add(filter, lang, argv[i + 1]);
+		}
+#endif
+		ut64 ns = cli_time_ns() - begin;
+		if (stats) {
+			cli_stats_add(stats, lang, strlen(argv[i + 1]), result != NULL, ns);
 		}
-		char *result = languages[i].demangle(symbol, opts);
-		if (result) {
+		if (output != CLI_OUTPUT_TEXT) {
+			CliRecord record = { 0 };
+			CliBuffer buffer = { 0 };
+			record.input = argv[i + 1];
+			record.input_length = strlen(argv[i + 1]);
+			record.lang = lang;
+			record.result = result;
+			record.ns = output == CLI_OUTPUT_JSON_TIMED ? ns : UT64_MAX;
+			record.bytes = bytes != UT64_MAX ? cli_alloc_bytes() - bytes : UT64_MAX;
+			if (cli_json_record(&buffer, &record)) {
+				fwrite(buffer.data, 1, buffer.size, stdout);
+			}
+			cli_buffer_fini(&buffer);
+		} else if (result) {
 			printf("%s\n", result);
-			free(result);
-			return 0;
 		}
-		return 1;
+		ret = result ? 0 : 1;
+		free(result);
+		goto end;
+	}
+
+#if WITH_THREADS
+	bool pipeline = n_jobs > 0 && !text && !columns_path && !sorted_unique;
+#if WITH_SERVER
+	pipeline = pipeline && !listen_path;
+#endif
+#if WITH_FILES
+	pipeline = pipeline && !file_path && !tree_path && !diff_paths[0];
+#endif
+	// the pipeline workers demangle the chunks, the context needs no worker
+	ctx = libdemangle_ctx_new(pipeline ? 1 : n_jobs);
+#else
+	ctx = libdemangle_ctx_new(n_jobs);
+#endif
+	if (!ctx || !libdemangle_ctx_set_memo(ctx, CLI_MEMO_SIZE)) {
+		fprintf(stderr, "error: cannot allocate the demangle context\n");
+		goto end;
+	}
+#if WITH_CACHE
+	libdemangle_ctx_set_cache(ctx, cache);
+#endif
+#if WITH_FILTER
+	libdemangle_ctx_set_filter(ctx, filter);
+#endif
+	libdemangle_ctx_set_sampler(ctx, sampler);
+#if WITH_CORPUS
+	if (capture) {
+		// otherwise RZ_DEMANGLE_CAPTURE may have opened one
+		libdemangle_ctx_set_capture(ctx, capture);
+	}
+#endif
+#if WITH_SERVER
+	if (listen_path) {
+		ret = cli_server_listen(listen_path, ctx);
+		goto end;
 	}
+#endif
+#if WITH_FILES
+	if (file_path) {
+		ret = cli_demangle_file(ctx, file_path, opts, output, stats, stdout);
+		goto end;
+	} else if (tree_path) {
+		ret = cli_demangle_tree(ctx, tree_path, opts, output, stats, stdout);
+		goto end;
+	} else if (diff_paths[0]) {
+		ret = cli_diff_demangle(ctx, diff_paths[0], diff_paths[1], opts, stdout);
+		goto end;
+	}
+#endif
+#if WITH_THREADS
+	if (pipeline) {
+		ret = cli_pipeline_demangle(ctx, lang, opts, output, stats, n_jobs, stdin, stdout);
+		goto end;
+	}
+#endif
+	if (text) {
+		ret = cli_filter_demangle(ctx, opts, stdin, stdout);
+		goto end;
+	}
+	if (sorted_unique) {
+		ret = demangle_sorted_unique(ctx, lang, opts, stdin, stdout);
+		goto end;
+	} else if (columns_path) {
+		if (!cli_columns_open(&columns, columns_path, columns_hashes)) {
+			fprintf(stderr, "error: cannot create '%s'\n", columns_path);
+			goto end;
+		}
+		ret = demangle_stream(ctx, lang, opts, output, stats, &columns, stdin, stdout);
+		if (!cli_columns_close(&columns, !ret) && !ret) {
+			fprintf(stderr, "error: cannot write '%s'\n", columns_path);
+			ret = 1;
+		}
+		goto end;
+	}
+	ret = demangle_stream(ctx, lang, opts, output, stats, NULL, stdin, stdout);
 
-	printf("unknown lang: %s\n", lang);
-	usage(argv[0]);
-	return 1;
-}
\ No newline at end of file
+end:
+	if (stats) {
+		fflush(stdout);
+		cli_stats_print(stats, sampler, cli_time_ns() - start, stderr);
+	}
+	free(stats);
+	libdemangle_ctx_free(ctx);
+	libdemangle_sampler_free(sampler);
+#if WITH_CORPUS
+	if (capture && !libdemangle_capture_close(capture)) {
+		fprintf(stderr, "warning: cannot write the corpus '%s'\n", capture_path);
+	}
+#endif
+#if WITH_CACHE
+	libdemangle_cache_close(cache);
+#endif
+#if WITH_FILTER
+	if (filter && !libdemangle_filter_save(filter, filter_path)) {
+		fprintf(stderr, "warning: cannot save filter file '%s'\n", filter_path);
+	}
+	libdemangle_filter_free(filter);
+#endif
+	return ret;
+}
@@ -0,0 +1,178 @@
+// SPDX-FileCopyrightText: 2026 RizinOrg <info@rizin.re>
+// SPDX-License-Identifier: LGPL-3.0-only
+
+#ifndef DEMANGLE_CLI_H
+#define DEMANGLE_CLI_H
+
+#include "demangler_util.h"
+#include "rz_libdemangle.h"
+
+/* symbols read from a stream are demangled in batches of this size */
+#define CLI_BATCH_SIZE 4096
+/* the JSON records are written once this many bytes are buffered */
+#define CLI_OUTPUT_FLUSH (64 * 1024)
+
+static inline ut16 cli_read_le16(const ut8 *p) {
+	return (ut16)(p[0] | (p[1] << 8));
+}
+
+static inline ut32 cli_read_le32(const ut8 *p) {
+	return (ut32)p[0] | ((ut32)p[1] << 8) | ((ut32)p[2] << 16) | ((ut32)p[3] << 24);
+}
+
+static inline ut64 cli_read_le64(const ut8 *p) {
+	return (ut64)cli_read_le32(p) | ((ut64)cli_read_le32(p + 4) << 32);
+}
+
+static inline void cli_write_le32(ut8 *p, ut32 value) {
+	p[0] = value & 0xff;
+	p[1] = (value >> 8) & 0xff;
+	p[2] = (value >> 16) & 0xff;
+	p[3] = (value >> 24) & 0xff;
+}
+
+/* output formats of the demangled symbols */
+typedef enum {
+	CLI_OUTPUT_TEXT = 0, ///< the result (or the input when it fails) per line
+	CLI_OUTPUT_JSON, ///< a JSON record per line (NDJSON)
+	CLI_OUTPUT_JSON_TIMED, ///< a JSON record per line, with the time spent
+} CliOutput;
+
+typedef struct {
+	char *data;
+	size_t size;
+	size_t capacity;
+} CliBuffer;
+
+typedef struct {
+	const char *file; ///< file containing the input, NULL when none
+	const char *input;
+	size_t input_length;
+	RzDemangleLang lang;
+	char *result; ///< NULL when the input cannot be demangled
+	ut64 ns; ///< UT64_MAX when not timed
+	bool deduplicated; ///< resolved by an earlier copy of the input, thus not timed
+	ut64 bytes; ///< allocated by the library, UT64_MAX when not counted
+} CliRecord;
+
+/* writer of the columnar binary output (see rz_libdemangle_columns.h) */
+typedef struct {
+	FILE *fp;
+	const char *path;
+	bool hashes; ///< stores the input hashes too
+	ut64 n_records;
+	ut64 heap_size;
+	CliBuffer offsets; ///< the fixed size columns, written on close
+	CliBuffer hash_column;
+	CliBuffer langs;
+	CliBuffer status;
+} CliColumns;
+
+#define CLI_STATS_BUCKETS 496 ///< latency buckets, enough for any ut64
+#define CLI_STATS_LENGTHS 10 ///< input length buckets: 0-15, 16-31, .., 4096+
+#define CLI_STATS_TOP     10 ///< slowest symbols kept by the sampler
+
+typedef struct {
+	ut64 demangled[RZ_DEMANGLE_LANG_MAX + 1];
+	ut64 failed[RZ_DEMANGLE_LANG_MAX + 1];
+	ut64 ns[RZ_DEMANGLE_LANG_MAX + 1]; ///< time spent per language
+	ut64 latency[CLI_STATS_BUCKETS];
+	ut64 max_ns;
+	ut64 lengths[CLI_STATS_LENGTHS];
+	ut64 deduplicated; ///< resolved by an earlier copy, out of the latencies
+} CliStats;
+
+void cli_stats_add(CliStats *stats, RzDemangleLang lang, size_t length, bool demangled, ut64 ns);
+void cli_stats_merge(CliStats *stats, const CliStats *other);
+ut64 cli_stats_percentile(const CliStats *stats, double quantile);
+void cli_stats_print(const CliStats *stats, RzDemangleSampler *sampler, ut64 wall_ns, FILE *out);
+ut64 cli_time_ns(void);
+ut64 cli_alloc_bytes(void);
+void cli_record_demangle(RzDemangleCtx *ctx, CliOutput output, RzDemangleOpts opts, CliStats *stats, CliRecord *record, const char *symbol);
+
+bool cli_buffer_reserve(CliBuffer *buffer, size_t size);
+bool cli_buffer_append(CliBuffer *buffer, const char *data, size_t length);
+void cli_buffer_fini(CliBuffer *buffer);
+bool cli_json_string(CliBuffer *buffer, const char *string, size_t length);
+bool cli_json_record(CliBuffer *buffer, const CliRecord *record);
+bool cli_columns_open(CliColumns *columns, const char *path, bool hashes);
+bool cli_columns_add(CliColumns *columns, RzDemangleLang lang, const char *input, size_t input_length, const char *result);
+bool cli_columns_close(CliColumns *columns, bool commit);
+
+size_t cli_read_lines(FILE *fp, char **lines, size_t max_lines);
+void cli_free_lines(char **lines, size_t n_lines);
+int cli_filter_demangle(RzDemangleCtx *ctx, RzDemangleOpts opts, FILE *in, FILE *out);
+
+#if WITH_FILES
+typedef struct {
+	const ut8 *data;
+	size_t size;
+} CliFile;
+
+typedef struct {
+	const char *name; ///< NUL terminated, points into the mapped file when possible
+	ut16 skip; ///< bytes skipped before demangling (i.e. "__imp_")
+	const char *tag; ///< printed before the demangled name (i.e. "__declspec(dllimport) "), NULL when none
+	RzDemangleLang lang;
+} CliSymbol;
+
+typedef struct {
+	CliSymbol *symbols;
+	size_t n_symbols;
+	size_t capacity;
+	char **copies; ///< names which are not NUL terminated within the file
+	size_t n_copies;
+	size_t copies_capacity;
+} CliSymbols;
+
+/* the DWARF sections, empty when missing */
+typedef struct {
+	CliFile info;
+	CliFile abbrev;
+	CliFile str;
+	CliFile line_str;
+	CliFile str_offsets;
+} CliDwarf;
+
+bool cli_file_map(CliFile *file, const char *path);
+void cli_file_unmap(CliFile *file);
+void cli_file_sequential(const CliFile *file);
+const char *cli_file_string(const CliFile *file, ut64 offset, size_t *max_length);
+
+bool cli_symbols_add(CliSymbols *symbols, const char *name, size_t max_length);
+char *cli_symbol_tagged(const CliSymbol *symbol, const char *result);
+void cli_symbols_fini(CliSymbols *symbols);
+int cli_symbols_demangle(RzDemangleCtx *ctx, const CliSymbols *symbols, RzDemangleOpts opts, CliOutput output, CliStats *stats, const char *path, FILE *out);
+bool cli_file_supported(const CliFile *file);
+bool cli_file_symbols(const CliFile *file, const char *path, CliSymbols *symbols);
+int cli_demangle_data(RzDemangleCtx *ctx, const CliFile *file, const char *path, bool print_path, RzDemangleOpts opts, CliOutput output, CliStats *stats, FILE *out);
+int cli_demangle_file(RzDemangleCtx *ctx, const char *path, RzDemangleOpts opts, CliOutput output, CliStats *stats, FILE *out);
+int cli_demangle_tree(RzDemangleCtx *ctx, const char *root, RzDemangleOpts opts, CliOutput output, CliStats *stats, FILE *out);
+int cli_diff_demangle(RzDemangleCtx *ctx, const char *old_path, const char *new_path, RzDemangleOpts opts, FILE *out);
+
+bool cli_dwarf_symbols(const CliDwarf *dwarf, CliSymbols *symbols);
+
+bool cli_elf_detect(const CliFile *file);
+bool cli_elf_symbols(const CliFile *file, CliSymbols *symbols);
+bool cli_pdb_detect(const CliFile *file);
+bool cli_pdb_symbols(const CliFile *file, CliSymbols *symbols);
+bool cli_pe_detect(const CliFile *file);
+bool cli_pe_symbols(const CliFile *file, CliSymbols *symbols);
+bool cli_macho_detect(const CliFile *file);
+bool cli_macho_symbols(const CliFile *file, CliSymbols *symbols);
+#endif
+
+#if WITH_THREADS
+int cli_pipeline_demangle(RzDemangleCtx *ctx, RzDemangleLang lang, RzDemangleOpts opts, CliOutput output, CliStats *stats, size_t n_workers, FILE *in, FILE *out);
+#endif
+
+#if WITH_CORPUS
+int cli_replay(const char *path, size_t n_threads, FILE *out);
+#endif
+
+#if WITH_SERVER
+int cli_server_listen(const char *path, RzDemangleCtx *ctx);
+int cli_server_connect(const char *path, RzDemangleLang lang, RzDemangleOpts opts, FILE *in, FILE *out);
+#endif
+
+#endif /* DEMANGLE_CLI_H */
@@ -0,0 +1,384 @@
+// SPDX-FileCopyrightText: 2026 RizinOrg <info@rizin.re>
+// SPDX-License-Identifier: LGPL-3.0-only
+
+/**
+ * \file diff.c
+ *
+ * Diff of the symbols of two builds, i.e. the added, removed and changed
+ * functions, with their demangled names.
+ *
+ * Each side is either a supported object file or a text list with one symbol
+ * per line. The two sets are joined by a hash table on the mangled names
+ * first: the symbols found on both sides are unchanged and never demangled,
+ * only the remainder is. A removed and an added symbol are then paired as
+ * changed when their names match once the template arguments, the parameters
+ * and the return type are erased (i.e. the signature or the template
+ * arguments changed), and the whole result is printed in sorted order:
+ *
+ *   - removed
+ *   + added
+ *   < changed, old name
+ *   > changed, new name
+ */
+
+#include "demangle.h"
+
+typedef struct {
+	CliFile file; ///< mapped object file
+	char *text; ///< text list, with the lines NUL terminated
+	CliSymbols symbols;
+} DiffSide;
+
+typedef struct {
+	ut64 hash;
+	const char *name; ///< NULL when free
+	size_t length;
+	bool sides[2]; ///< found on the old and on the new side
+	bool taken[2]; ///< collected as missing on the other side
+} DiffSlot;
+
+typedef struct {
+	const CliSymbol *symbol;
+	char *name; ///< demangled (or the mangled one when it cannot be)
+	char *key; ///< erased name, NULL when it cannot be paired
+} DiffName;
+
+typedef struct {
+	char kind; ///< '-', '+' or '<' (changed, followed by the new name)
+	const char *name;
+	const char *new_name;
+} DiffItem;
+
+typedef struct {
+	DiffName *names;
+	size_t n_names;
+} DiffNames;
+
+static bool diff_side_load(DiffSide *side, const char *path) {
+	if (!cli_file_map(&side->file, path)) {
+		fprintf(stderr, "error: cannot map '%s'\n", path);
+		return false;
+	} else if (cli_file_supported(&side->file)) {
+		return cli_file_symbols(&side->file, path, &side->symbols);
+	}
+
+	// a text list: the lines are NUL terminated in a copy of the file
+	size_t size = side->file.size;
+	side->text = malloc(size + 1);
+	if (!side->text) {
+		return false;
+	}
+	memcpy(side->text, side->file.data, size);
+	side->text[size] = 0;
+	cli_file_unmap(&side->file);
+	for (char *line = side->text; line < side->text + size;) {
+		char *end = memchr(line, '\n', side->text + size - line);
+		end = end ? end : side->text + size;
+		*end = 0;
+		if (end > line && end[-1] == '\r') {
+			end[-1] = 0;
+		}
+		if (!cli_symbols_add(&side->symbols, line, end + 1 - line)) {
+			return false;
+		}
+		line = end + 1;
+	}
+	return true;
+}
+
+static void diff_side_fini(DiffSide *side) {
+	cli_symbols_fini(&side->symbols);
+	cli_file_unmap(&side->file);
+	free(side->text);
+}
+
+static ut64 diff_hash(const char *data, size_t length) {
+	ut64 hash = 0xcbf29ce484222325ull;
+	for (size_t i = 0; i < length; ++i) {
+		hash = (hash ^ (ut8)data[i]) * 0x100000001b3ull;
+	}
+	return hash;
+}
+
+/**
+ * \brief Adds the name of the side to the table; a name present on both
+ * sides is found in a single slot.
+ */
+static void diff_table_add(DiffSlot *table, size_t mask, const char *name, size_t side) {
+	size_t length = strlen(name);
+	ut64 hash = diff_hash(name, length);
+	size_t i = hash & mask;
+	for (; table[i].name; i = (i + 1) & mask) {
+		DiffSlot *slot = &table[i];
+		if (slot->hash == hash && slot->length == length && !memcmp(slot->name, name, length)) {
+			slot->sides[side] = true;
+			return;
+		}
+	}
+	table[i].hash = hash;
+	table[i].name = name;
+	table[i].length = length;
+	table[i].sides[side] = true;
+}
+
+static DiffSlot *diff_table_find(DiffSlot *table, size_t mask, const char *name) {
+	size_t length = strlen(name);
+	ut64 hash = diff_hash(name, length);
+	for (size_t i = hash & mask; table[i].name; i = (i + 1) & mask) {
+		DiffSlot *slot = &table[i];
+		if (slot->hash == hash && slot->length == length && !memcmp(slot->name, name, length)) {
+			return slot;
+		}
+	}
+	return NULL;
+}
+
+static bool diff_ends_with_operator(const char *key, size_t length) {
+	return length >= 8 && !memcmp(key + length - 8, "operator", 8);
+}
+
+/**
+ * \brief Returns the name without the template arguments, the parameters
+ * and the return type, i.e. "ns::foo" for "int ns::foo<int>(int) const".
+ */
+static char *diff_erase(const char *name) {
+	size_t size = strlen(name);
+	char *key = malloc(size + 1);
+	if (!key) {
+		return NULL;
+	}
+	size_t length = 0;
+	size_t depth = 0;
+	bool function = false;
+	for (const char *p = name; *p;) {
+		if (!depth && diff_ends_with_operator(key, length)) {
+			// the operator characters are part of the name
+			size_t n = !strncmp(p, "()", 2) || !strncmp(p, "[]", 2) ? 2 : strspn(p, "<>=!+-*/%^&|~,");
+			n = n ? n : 1;
+			memcpy(key + length, p, n);
+			length += n;
+			p += n;
+			continue;
+		} else if (*p == '<') {
+			depth++;
+		} else if (*p == '>' && depth) {
+			depth--;
+		} else if (!depth && !strncmp(p, "(anonymous namespace)", 21)) {
+			memcpy(key + length, p, 21);
+			length += 21;
+			p += 21;
+			continue;
+		} else if (!depth && *p == '(') {
+			function = true;
+			break;
+		} else if (!depth) {
+			key[length++] = *p;
+		}
+		p++;
+	}
+	while (length && key[length - 1] == ' ') {
+		length--;
+	}
+	key[length] = 0;
+	if (!function) {
+		return key;
+	}
+	// the return type and the calling convention precede the last space
+	for (size_t i = length; i > 0; --i) {
+		if (key[i - 1] == ' ' && !diff_ends_with_operator(key, i - 1)) {
+			memmove(key, key + i, length - i + 1);
+			break;
+		}
+	}
+	return key;
+}
+
+/**
+ * \brief Demangles the symbols of the side which are missing on the other
+ * one (once per name), in one batch per language.
+ */
+static bool diff_demangle(RzDemangleCtx *ctx, const DiffSide *side, DiffSlot *table, size_t mask, size_t index, RzDemangleOpts opts, DiffNames *names) {
+	const CliSymbols *symbols = &side->symbols;
+	const char **batch_symbols = calloc(symbols->n_symbols + 1, sizeof(char *));
+	char **results = calloc(symbols->n_symbols + 1, sizeof(char *));
+	names->names = calloc(symbols->n_symbols + 1, sizeof(DiffName));
+	bool res = false;
+	if (!batch_symbols || !results || !names->names) {
+		goto end;
+	}
+	for (size_t i = 0; i < symbols->n_symbols; ++i) {
+		const CliSymbol *symbol = &symbols->symbols[i];
+		DiffSlot *slot = diff_table_find(table, mask, symbol->name);
+		if (slot && !slot->sides[!index] && !slot->taken[index]) {
+			slot->taken[index] = true;
+			names->names[names->n_names++].symbol = symbol;
+		}
+	}
+
+	for (int lang = 0; lang < RZ_DEMANGLE_LANG_MAX; ++lang) {
+		RzDemangleBatch batch = { 0 };
+		batch.lang = lang;
+		batch.opts = opts;
+		batch.symbols = batch_symbols;
+		batch.results = results;
+		for (size_t i = 0; i < names->n_names; ++i) {
+			const CliSymbol *symbol = names->names[i].symbol;
+			if (symbol->lang == lang) {
+				batch_symbols[batch.n_symbols++] = symbol->name + symbol->skip;
+			}
+		}
+		if (!batch.n_symbols) {
+			continue;
+		} else if (!libdemangle_batch_unique(ctx, &batch)) {
+			goto end;
+		}
+		size_t k = 0;
+		bool failed = false;
+		for (size_t i = 0; i < names->n_names; ++i) {
+			DiffName *name = &names->names[i];
+			if (name->symbol->lang != lang) {
+				continue;
+			}
+			char *result = results[k++];
+			if (!result) {
+				name->name = strdup(name->symbol->name);
+			} else if ((name->name = cli_symbol_tagged(name->symbol, result))) {
+				// the tag is part of the name too
+				name->key = diff_erase(result);
+			}
+			failed |= !name->name || (result && !name->key);
+			free(result);
+		}
+		if (failed) {
+			goto end;
+		}
+	}
+	res = true;
+
+end:
+	free(batch_symbols);
+	free(results);
+	return res;
+}
+
+static void diff_names_fini(DiffNames *names) {
+	for (size_t i = 0; names->names && i < names->n_names; ++i) {
+		free(names->names[i].name);
+		free(names->names[i].key);
+	}
+	free(names->names);
+}
+
+/* the names without key are sorted last */
+static int diff_compare_key(const void *a, const void *b) {
+	const DiffName *x = a, *y = b;
+	if (!x->key || !y->key) {
+		return !x->key - !y->key;
+	}
+	int cmp = strcmp(x->key, y->key);
+	return cmp ? cmp : strcmp(x->name, y->name);
+}
+
+static int diff_compare_item(const void *a, const void *b) {
+	const DiffItem *x = a, *y = b;
+	int cmp = strcmp(x->name, y->name);
+	return cmp ? cmp : x->kind - y->kind;
+}
+
+/**
+ * \brief Pairs the removed and the added names with the same key as changed;
+ * the \p items must hold all the names.
+ */
+static size_t diff_pair(DiffNames *removed, DiffNames *added, DiffItem *items) {
+	qsort(removed->names, removed->n_names, sizeof(DiffName), diff_compare_key);
+	qsort(added->names, added->n_names, sizeof(DiffName), diff_compare_key);
+	size_t n_items = 0;
+	size_t r = 0, a = 0;
+	while (r < removed->n_names || a < added->n_names) {
+		const DiffName *old = r < removed->n_names ? &removed->names[r] : NULL;
+		const DiffName *new = a < added->n_names ? &added->names[a] : NULL;
+		int cmp = 0;
+		if (!old || !new || !old->key || !new->key) {
+			cmp = !old ? 1 : !new ? -1 : !old->key ? 1 : -1;
+		} else {
+			cmp = strcmp(old->key, new->key);
+		}
+		DiffItem *item = &items[n_items++];
+		if (cmp < 0) {
+			item->kind = '-';
+			item->name = old->name;
+			r++;
+		} else if (cmp > 0) {
+			item->kind = '+';
+			item->name = new->name;
+			a++;
+		} else {
+			item->kind = '<';
+			item->name = old->name;
+			item->new_name = new->name;
+			r++;
+			a++;
+		}
+	}
+	return n_items;
+}
+
+/**
+ * \brief Prints the symbols removed, added and changed from the file (or
+ * list) at \p old_path to the one at \p new_path.
+ */
+int cli_diff_demangle(RzDemangleCtx *ctx, const char *old_path, const char *new_path, RzDemangleOpts opts, FILE *out) {
+	DiffSide sides[2] = { 0 };
+	DiffNames removed = { 0 }, added = { 0 };
+	DiffSlot *table = NULL;
+	DiffItem *items = NULL;
+	int ret = 1;
+	if (!diff_side_load(&sides[0], old_path) || !diff_side_load(&sides[1], new_path)) {
+		goto end;
+	}
+
+	// the load factor is kept at most 1/2
+	size_t n_slots = 64;
+	while (n_slots < 2 * (sides[0].symbols.n_symbols + sides[1].symbols.n_symbols)) {
+		n_slots *= 2;
+	}
+	if (!(table = calloc(n_slots, sizeof(DiffSlot)))) {
+		goto end;
+	}
+	for (size_t side = 0; side < 2; ++side) {
+		for (size_t i = 0; i < sides[side].symbols.n_symbols; ++i) {
+			diff_table_add(table, n_slots - 1, sides[side].symbols.symbols[i].name, side);
+		}
+	}
+	if (!diff_demangle(ctx, &sides[0], table, n_slots - 1, 0, opts, &removed) ||
+		!diff_demangle(ctx, &sides[1], table, n_slots - 1, 1, opts, &added)) {
+		goto end;
+	}
+	// the join is not needed anymore
+	free(table);
+	table = NULL;
+
+	if (!(items = calloc(removed.n_names + added.n_names + 1, sizeof(DiffItem)))) {
+		goto end;
+	}
+	size_t n_items = diff_pair(&removed, &added, items);
+	qsort(items, n_items, sizeof(DiffItem), diff_compare_item);
+	for (size_t i = 0; i < n_items; ++i) {
+		const DiffItem *item = &items[i];
+		if (item->kind == '<') {
+			fprintf(out, "< %s\n> %s\n", item->name, item->new_name);
+		} else {
+			fprintf(out, "%c %s\n", item->kind, item->name);
+		}
+	}
+	ret = 0;
+
+end:
+	free(items);
+	free(table);
+	diff_names_fini(&removed);
+	diff_names_fini(&added);
+	diff_side_fini(&sides[0]);
+	diff_side_fini(&sides[1]);
+	return ret;
+}
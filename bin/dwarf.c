@@ -0,0 +1,582 @@
+// SPDX-FileCopyrightText: 2026 RizinOrg <info@rizin.re>
+// SPDX-License-Identifier: LGPL-3.0-only
+
+/**
+ * \file dwarf.c
+ *
+ * DWARF (v2 to v5) linkage names: the units of .debug_info are walked one DIE
+ * at a time, without building any tree, decoding only the attributes needed
+ * to reach the DW_AT_linkage_name/DW_AT_MIPS_linkage_name ones. DIEs without
+ * such attributes and made only of fixed size forms are skipped at once.
+ *
+ * The same name is referenced by every unit including its declaration, so the
+ * names are deduplicated by their string section offset.
+ */
+
+#include "demangle.h"
+
+#define DW_AT_linkage_name      0x6e
+#define DW_AT_str_offsets_base  0x72
+#define DW_AT_MIPS_linkage_name 0x2007
+
+#define DW_FORM_addr           0x01
+#define DW_FORM_block2         0x03
+#define DW_FORM_block4         0x04
+#define DW_FORM_data2          0x05
+#define DW_FORM_data4          0x06
+#define DW_FORM_data8          0x07
+#define DW_FORM_string         0x08
+#define DW_FORM_block          0x09
+#define DW_FORM_block1         0x0a
+#define DW_FORM_data1          0x0b
+#define DW_FORM_flag           0x0c
+#define DW_FORM_sdata          0x0d
+#define DW_FORM_strp           0x0e
+#define DW_FORM_udata          0x0f
+#define DW_FORM_ref_addr       0x10
+#define DW_FORM_ref1           0x11
+#define DW_FORM_ref2           0x12
+#define DW_FORM_ref4           0x13
+#define DW_FORM_ref8           0x14
+#define DW_FORM_ref_udata      0x15
+#define DW_FORM_indirect       0x16
+#define DW_FORM_sec_offset     0x17
+#define DW_FORM_exprloc        0x18
+#define DW_FORM_flag_present   0x19
+#define DW_FORM_strx           0x1a
+#define DW_FORM_addrx          0x1b
+#define DW_FORM_ref_sup4       0x1c
+#define DW_FORM_strp_sup       0x1d
+#define DW_FORM_data16         0x1e
+#define DW_FORM_line_strp      0x1f
+#define DW_FORM_ref_sig8       0x20
+#define DW_FORM_implicit_const 0x21
+#define DW_FORM_loclistx       0x22
+#define DW_FORM_rnglistx       0x23
+#define DW_FORM_ref_sup8       0x24
+#define DW_FORM_strx1          0x25
+#define DW_FORM_strx2          0x26
+#define DW_FORM_strx3          0x27
+#define DW_FORM_strx4          0x28
+#define DW_FORM_addrx1         0x29
+#define DW_FORM_addrx2         0x2a
+#define DW_FORM_addrx3         0x2b
+#define DW_FORM_addrx4         0x2c
+#define DW_FORM_GNU_addr_index 0x1f01
+#define DW_FORM_GNU_str_index  0x1f02
+#define DW_FORM_GNU_ref_alt    0x1f20
+#define DW_FORM_GNU_strp_alt   0x1f21
+
+#define DW_UT_compile       0x01
+#define DW_UT_type          0x02
+#define DW_UT_partial       0x03
+#define DW_UT_skeleton      0x04
+#define DW_UT_split_compile 0x05
+#define DW_UT_split_type    0x06
+
+#define DWARF_VARIABLE_SIZE   UT32_MAX
+#define DWARF_MAX_ABBREV_CODE (1u << 20)
+#define DWARF_LINE_STR_KEY    (1ull << 63) ///< keeps .debug_line_str offsets apart from .debug_str ones
+
+typedef struct {
+	const ut8 *p;
+	const ut8 *end;
+} DwarfCursor;
+
+typedef struct {
+	ut8 version;
+	ut8 offset_size;
+	ut8 address_size;
+	ut64 str_offsets_base;
+} DwarfUnit;
+
+typedef struct {
+	ut32 attr;
+	ut32 form;
+} DwarfSpec;
+
+typedef struct {
+	ut32 first_spec;
+	ut32 n_specs;
+	ut32 fixed_size; ///< size of all the attributes, or DWARF_VARIABLE_SIZE
+	bool valid;
+	bool decode; ///< has attributes which must be decoded
+} DwarfAbbrev;
+
+/* the abbreviations of the current unit, reused while the next units share them */
+typedef struct {
+	ut64 offset;
+	ut8 offset_size;
+	ut8 address_size;
+	DwarfAbbrev *abbrevs; ///< indexed by code
+	size_t capacity;
+	DwarfSpec *specs;
+	size_t n_specs;
+	size_t specs_capacity;
+} DwarfAbbrevs;
+
+/* open addressing set of the string offsets already added (stored + 1) */
+typedef struct {
+	ut64 *keys;
+	size_t n_keys;
+	size_t capacity;
+} DwarfSet;
+
+typedef struct {
+	const CliDwarf *dwarf;
+	CliSymbols *symbols;
+	DwarfAbbrevs abbrevs;
+	DwarfSet seen;
+} DwarfReader;
+
+static bool dwarf_read(DwarfCursor *c, ut32 size, ut64 *value) {
+	if ((size_t)(c->end - c->p) < size) {
+		return false;
+	}
+	ut64 v = 0;
+	for (ut32 i = 0; i < size; ++i) {
+		v |= (ut64)c->p[i] << (i * 8);
+	}
+	c->p += size;
+	*value = v;
+	return true;
+}
+
+static bool dwarf_skip(DwarfCursor *c, ut64 size) {
+	if ((ut64)(c->end - c->p) < size) {
+		return false;
+	}
+	c->p += size;
+	return true;
+}
+
+static bool dwarf_uleb(DwarfCursor *c, ut64 *value) {
+	ut64 v = 0;
+	for (ut32 shift = 0; c->p < c->end; shift += 7) {
+		ut8 byte = *c->p++;
+		if (shift < 64) {
+			v |= (ut64)(byte & 0x7f) << shift;
+		}
+		if (!(byte & 0x80)) {
+			*value = v;
+			return true;
+		}
+	}
+	return false;
+}
+
+static bool dwarf_skip_leb(DwarfCursor *c) {
+	while (c->p < c->end) {
+		if (!(*c->p++ & 0x80)) {
+			return true;
+		}
+	}
+	return false;
+}
+
+/**
+ * \brief Returns the size of the forms which do not depend on the data,
+ * DWARF_VARIABLE_SIZE otherwise (including the unknown ones).
+ */
+static ut32 dwarf_form_size(ut32 form, ut8 offset_size, ut8 address_size) {
+	switch (form) {
+	case DW_FORM_flag_present:
+	case DW_FORM_implicit_const:
+		return 0;
+	case DW_FORM_data1:
+	case DW_FORM_flag:
+	case DW_FORM_ref1:
+	case DW_FORM_strx1:
+	case DW_FORM_addrx1:
+		return 1;
+	case DW_FORM_data2:
+	case DW_FORM_ref2:
+	case DW_FORM_strx2:
+	case DW_FORM_addrx2:
+		return 2;
+	case DW_FORM_strx3:
+	case DW_FORM_addrx3:
+		return 3;
+	case DW_FORM_data4:
+	case DW_FORM_ref4:
+	case DW_FORM_ref_sup4:
+	case DW_FORM_strx4:
+	case DW_FORM_addrx4:
+		return 4;
+	case DW_FORM_data8:
+	case DW_FORM_ref8:
+	case DW_FORM_ref_sig8:
+	case DW_FORM_ref_sup8:
+		return 8;
+	case DW_FORM_data16:
+		return 16;
+	case DW_FORM_addr:
+		return address_size;
+	case DW_FORM_strp:
+	case DW_FORM_ref_addr:
+	case DW_FORM_sec_offset:
+	case DW_FORM_strp_sup:
+	case DW_FORM_line_strp:
+	case DW_FORM_GNU_ref_alt:
+	case DW_FORM_GNU_strp_alt:
+		return offset_size;
+	default:
+		return DWARF_VARIABLE_SIZE;
+	}
+}
+
+static bool dwarf_skip_form(DwarfCursor *c, ut32 form, const DwarfUnit *unit) {
+	ut32 size = dwarf_form_size(form, unit->offset_size, unit->address_size);
+	if (size != DWARF_VARIABLE_SIZE) {
+		return dwarf_skip(c, size);
+	}
+	ut64 length;
+	switch (form) {
+	case DW_FORM_string: {
+		const ut8 *nul = memchr(c->p, 0, c->end - c->p);
+		if (!nul) {
+			return false;
+		}
+		c->p = nul + 1;
+		return true;
+	}
+	case DW_FORM_sdata:
+	case DW_FORM_udata:
+	case DW_FORM_ref_udata:
+	case DW_FORM_strx:
+	case DW_FORM_addrx:
+	case DW_FORM_loclistx:
+	case DW_FORM_rnglistx:
+	case DW_FORM_GNU_addr_index:
+	case DW_FORM_GNU_str_index:
+		return dwarf_skip_leb(c);
+	case DW_FORM_block1:
+		return dwarf_read(c, 1, &length) && dwarf_skip(c, length);
+	case DW_FORM_block2:
+		return dwarf_read(c, 2, &length) && dwarf_skip(c, length);
+	case DW_FORM_block4:
+		return dwarf_read(c, 4, &length) && dwarf_skip(c, length);
+	case DW_FORM_block:
+	case DW_FORM_exprloc:
+		return dwarf_uleb(c, &length) && dwarf_skip(c, length);
+	case DW_FORM_indirect:
+		return dwarf_uleb(c, &length) && length != DW_FORM_indirect && length <= UT32_MAX && dwarf_skip_form(c, (ut32)length, unit);
+	default:
+		return false;
+	}
+}
+
+static bool dwarf_set_grow(DwarfSet *set) {
+	size_t capacity = set->capacity ? set->capacity * 2 : 4096;
+	ut64 *keys = calloc(capacity, sizeof(ut64));
+	if (!keys) {
+		return false;
+	}
+	for (size_t i = 0; i < set->capacity; ++i) {
+		if (!set->keys[i]) {
+			continue;
+		}
+		size_t k = (set->keys[i] * 0x9e3779b97f4a7c15ull) >> 16 & (capacity - 1);
+		while (keys[k]) {
+			k = (k + 1) & (capacity - 1);
+		}
+		keys[k] = set->keys[i];
+	}
+	free(set->keys);
+	set->keys = keys;
+	set->capacity = capacity;
+	return true;
+}
+
+/**
+ * \brief Adds the key; returns 1 when added, 0 when already present and
+ * -1 on allocation failure.
+ */
+static int dwarf_set_add(DwarfSet *set, ut64 key) {
+	if (set->n_keys * 2 >= set->capacity && !dwarf_set_grow(set)) {
+		return -1;
+	}
+	key++;
+	size_t k = (key * 0x9e3779b97f4a7c15ull) >> 16 & (set->capacity - 1);
+	while (set->keys[k]) {
+		if (set->keys[k] == key) {
+			return 0;
+		}
+		k = (k + 1) & (set->capacity - 1);
+	}
+	set->keys[k] = key;
+	set->n_keys++;
+	return 1;
+}
+
+static bool dwarf_add_spec(DwarfAbbrevs *abbrevs, ut32 attr, ut32 form) {
+	if (abbrevs->n_specs >= abbrevs->specs_capacity) {
+		size_t capacity = abbrevs->specs_capacity ? abbrevs->specs_capacity * 2 : 256;
+		DwarfSpec *tmp = realloc(abbrevs->specs, capacity * sizeof(DwarfSpec));
+		if (!tmp) {
+			return false;
+		}
+		abbrevs->specs = tmp;
+		abbrevs->specs_capacity = capacity;
+	}
+	abbrevs->specs[abbrevs->n_specs].attr = attr;
+	abbrevs->specs[abbrevs->n_specs].form = form;
+	abbrevs->n_specs++;
+	return true;
+}
+
+static DwarfAbbrev *dwarf_add_abbrev(DwarfAbbrevs *abbrevs, ut64 code) {
+	if (code >= DWARF_MAX_ABBREV_CODE) {
+		return NULL;
+	} else if (code >= abbrevs->capacity) {
+		size_t capacity = abbrevs->capacity ? abbrevs->capacity : 64;
+		while (capacity <= code) {
+			capacity *= 2;
+		}
+		DwarfAbbrev *tmp = realloc(abbrevs->abbrevs, capacity * sizeof(DwarfAbbrev));
+		if (!tmp) {
+			return NULL;
+		}
+		memset(tmp + abbrevs->capacity, 0, (capacity - abbrevs->capacity) * sizeof(DwarfAbbrev));
+		abbrevs->abbrevs = tmp;
+		abbrevs->capacity = capacity;
+	}
+	return &abbrevs->abbrevs[code];
+}
+
+/**
+ * \brief Loads the abbreviation table at \p offset, unless already loaded
+ * for the same offset and sizes. Returns false on allocation failure;
+ * a malformed table leaves the abbreviations parsed till the error.
+ */
+static bool dwarf_load_abbrevs(DwarfReader *reader, ut64 offset, const DwarfUnit *unit) {
+	DwarfAbbrevs *abbrevs = &reader->abbrevs;
+	if (abbrevs->offset == offset && abbrevs->offset_size == unit->offset_size && abbrevs->address_size == unit->address_size) {
+		return true;
+	}
+	if (abbrevs->abbrevs) {
+		memset(abbrevs->abbrevs, 0, abbrevs->capacity * sizeof(DwarfAbbrev));
+	}
+	abbrevs->n_specs = 0;
+	abbrevs->offset = offset;
+	abbrevs->offset_size = unit->offset_size;
+	abbrevs->address_size = unit->address_size;
+
+	const CliFile *section = &reader->dwarf->abbrev;
+	if (offset >= section->size) {
+		return true;
+	}
+	DwarfCursor c = { section->data + offset, section->data + section->size };
+	ut64 code, tag;
+	while (dwarf_uleb(&c, &code) && code && dwarf_uleb(&c, &tag) && dwarf_skip(&c, 1)) {
+		DwarfAbbrev abbrev = { 0 };
+		abbrev.first_spec = (ut32)abbrevs->n_specs;
+		ut64 attr, form;
+		for (;;) {
+			if (!dwarf_uleb(&c, &attr) || !dwarf_uleb(&c, &form) ||
+				(form == DW_FORM_implicit_const && !dwarf_skip_leb(&c))) {
+				return true;
+			} else if (!attr && !form) {
+				break;
+			} else if (!dwarf_add_spec(abbrevs, (ut32)attr, (ut32)form)) {
+				return false;
+			}
+			abbrev.n_specs++;
+			ut32 size = dwarf_form_size((ut32)form, unit->offset_size, unit->address_size);
+			if (attr == DW_AT_linkage_name || attr == DW_AT_MIPS_linkage_name || attr == DW_AT_str_offsets_base) {
+				abbrev.decode = true;
+			} else if (size == DWARF_VARIABLE_SIZE || abbrev.fixed_size == DWARF_VARIABLE_SIZE) {
+				abbrev.fixed_size = DWARF_VARIABLE_SIZE;
+			} else {
+				abbrev.fixed_size += size;
+			}
+		}
+		DwarfAbbrev *slot = dwarf_add_abbrev(abbrevs, code);
+		if (!slot) {
+			return code >= DWARF_MAX_ABBREV_CODE;
+		}
+		abbrev.valid = true;
+		*slot = abbrev;
+	}
+	return true;
+}
+
+static bool dwarf_add_name(DwarfReader *reader, const CliFile *section, ut64 offset, ut64 key) {
+	if (offset >= section->size) {
+		return true;
+	}
+	int added = dwarf_set_add(&reader->seen, key);
+	if (added <= 0) {
+		return !added;
+	}
+	return cli_symbols_add(reader->symbols, (const char *)section->data + offset, section->size - offset);
+}
+
+static bool dwarf_add_indexed_name(DwarfReader *reader, const DwarfUnit *unit, ut64 index) {
+	const CliFile *offsets = &reader->dwarf->str_offsets;
+	ut64 entry = unit->str_offsets_base + index * unit->offset_size;
+	if (index >= offsets->size || entry >= offsets->size || offsets->size - entry < unit->offset_size) {
+		return true;
+	}
+	DwarfCursor c = { offsets->data + entry, offsets->data + offsets->size };
+	ut64 offset;
+	if (!dwarf_read(&c, unit->offset_size, &offset)) {
+		return true;
+	}
+	return dwarf_add_name(reader, &reader->dwarf->str, offset, offset);
+}
+
+/**
+ * \brief Decodes a linkage name attribute; malformed data is reported via
+ * \p valid, allocation failures via the return value.
+ */
+static bool dwarf_linkage_name(DwarfReader *reader, DwarfCursor *c, ut32 form, const DwarfUnit *unit, bool *valid) {
+	const CliDwarf *dwarf = reader->dwarf;
+	ut64 value;
+	*valid = true;
+	switch (form) {
+	case DW_FORM_strp:
+		*valid = dwarf_read(c, unit->offset_size, &value);
+		return !*valid || dwarf_add_name(reader, &dwarf->str, value, value);
+	case DW_FORM_line_strp:
+		*valid = dwarf_read(c, unit->offset_size, &value);
+		return !*valid || dwarf_add_name(reader, &dwarf->line_str, value, value | DWARF_LINE_STR_KEY);
+	case DW_FORM_strx:
+	case DW_FORM_GNU_str_index:
+		*valid = dwarf_uleb(c, &value);
+		return !*valid || dwarf_add_indexed_name(reader, unit, value);
+	case DW_FORM_strx1:
+	case DW_FORM_strx2:
+	case DW_FORM_strx3:
+	case DW_FORM_strx4:
+		*valid = dwarf_read(c, form - DW_FORM_strx1 + 1, &value);
+		return !*valid || dwarf_add_indexed_name(reader, unit, value);
+	case DW_FORM_string: {
+		// inlined within the DIE, thus not deduplicated
+		const char *name = (const char *)c->p;
+		*valid = dwarf_skip_form(c, form, unit);
+		return !*valid || cli_symbols_add(reader->symbols, name, (const char *)c->p - name);
+	}
+	default:
+		*valid = dwarf_skip_form(c, form, unit);
+		return true;
+	}
+}
+
+/**
+ * \brief Walks the DIEs of a unit; stops at the first malformed one.
+ */
+static bool dwarf_unit_dies(DwarfReader *reader, DwarfCursor *c, DwarfUnit *unit) {
+	const DwarfAbbrevs *abbrevs = &reader->abbrevs;
+	ut64 code;
+	while (dwarf_uleb(c, &code)) {
+		if (!code) {
+			// end of the children list
+			continue;
+		} else if (code >= abbrevs->capacity || !abbrevs->abbrevs[code].valid) {
+			return true;
+		}
+		const DwarfAbbrev *abbrev = &abbrevs->abbrevs[code];
+		if (!abbrev->decode && abbrev->fixed_size != DWARF_VARIABLE_SIZE) {
+			if (!dwarf_skip(c, abbrev->fixed_size)) {
+				return true;
+			}
+			continue;
+		}
+		const DwarfSpec *spec = abbrevs->specs + abbrev->first_spec;
+		for (ut32 i = 0; i < abbrev->n_specs; ++i, ++spec) {
+			bool valid = true;
+			if (spec->attr == DW_AT_linkage_name || spec->attr == DW_AT_MIPS_linkage_name) {
+				if (!dwarf_linkage_name(reader, c, spec->form, unit, &valid)) {
+					return false;
+				}
+			} else if (spec->attr == DW_AT_str_offsets_base && spec->form == DW_FORM_sec_offset) {
+				valid = dwarf_read(c, unit->offset_size, &unit->str_offsets_base);
+			} else {
+				valid = dwarf_skip_form(c, spec->form, unit);
+			}
+			if (!valid) {
+				return true;
+			}
+		}
+	}
+	return true;
+}
+
+/**
+ * \brief Parses the unit header at the cursor and walks its DIEs; the cursor
+ * is moved to the next unit. Returns false on allocation failure.
+ */
+static bool dwarf_unit(DwarfReader *reader, DwarfCursor *c) {
+	DwarfUnit unit = { 0 };
+	ut64 length, abbrev_offset, unit_type = DW_UT_compile, address_size, version;
+	unit.offset_size = 4;
+	if (!dwarf_read(c, 4, &length)) {
+		c->p = c->end;
+		return true;
+	} else if (length == UT32_MAX) {
+		unit.offset_size = 8;
+		if (!dwarf_read(c, 8, &length)) {
+			c->p = c->end;
+			return true;
+		}
+	} else if (length >= 0xfffffff0) {
+		// reserved values, the rest of the section cannot be walked
+		c->p = c->end;
+		return true;
+	}
+	DwarfCursor die = { c->p, c->p + RZ_MIN(length, (ut64)(c->end - c->p)) };
+	c->p = die.end;
+
+	if (!dwarf_read(&die, 2, &version) || version < 2 || version > 5) {
+		return true;
+	}
+	unit.version = (ut8)version;
+	if (version == 5) {
+		if (!dwarf_read(&die, 1, &unit_type) || !dwarf_read(&die, 1, &address_size) ||
+			!dwarf_read(&die, unit.offset_size, &abbrev_offset)) {
+			return true;
+		}
+		if (unit_type == DW_UT_skeleton || unit_type == DW_UT_split_compile) {
+			// dwo_id
+			dwarf_skip(&die, 8);
+		} else if (unit_type == DW_UT_type || unit_type == DW_UT_split_type) {
+			// type signature and offset
+			dwarf_skip(&die, 8 + unit.offset_size);
+		}
+		// right after the header of the string offsets table
+		unit.str_offsets_base = unit.offset_size == 8 ? 16 : 8;
+	} else if (!dwarf_read(&die, unit.offset_size, &abbrev_offset) || !dwarf_read(&die, 1, &address_size)) {
+		return true;
+	}
+	unit.address_size = (ut8)address_size;
+	if (!dwarf_load_abbrevs(reader, abbrev_offset, &unit)) {
+		return false;
+	}
+	return dwarf_unit_dies(reader, &die, &unit);
+}
+
+/**
+ * \brief Adds the linkage names of all the units of .debug_info (each name
+ * once); malformed units are skipped.
+ */
+bool cli_dwarf_symbols(const CliDwarf *dwarf, CliSymbols *symbols) {
+	if (!dwarf->info.size || !dwarf->abbrev.size) {
+		return true;
+	}
+	DwarfReader reader = { 0 };
+	reader.dwarf = dwarf;
+	reader.symbols = symbols;
+	reader.abbrevs.offset = UT64_MAX;
+	cli_file_sequential(&dwarf->info);
+
+	bool res = true;
+	DwarfCursor c = { dwarf->info.data, dwarf->info.data + dwarf->info.size };
+	while (c.p < c.end && res) {
+		res = dwarf_unit(&reader, &c);
+	}
+	free(reader.abbrevs.abbrevs);
+	free(reader.abbrevs.specs);
+	free(reader.seen.keys);
+	return res;
+}
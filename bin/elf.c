@@ -0,0 +1,212 @@
+// SPDX-FileCopyrightText: 2026 RizinOrg <info@rizin.re>
+// SPDX-License-Identifier: LGPL-3.0-only
+
+/**
+ * \file elf.c
+ *
+ * ELF files: walks the static and dynamic symbol tables and the DWARF linkage
+ * names (also of split .dwo files). Only little endian files are supported.
+ */
+
+#include "demangle.h"
+
+#define ELF_CLASS_32        1
+#define ELF_CLASS_64        2
+#define ELF_DATA_LSB        1
+#define ELF_TYPE_REL        1
+#define ELF_SHN_XINDEX      0xffff
+#define ELF_SHT_SYMTAB      2
+#define ELF_SHT_RELA        4
+#define ELF_SHT_NOBITS      8
+#define ELF_SHT_DYNSYM      11
+#define ELF_SHF_COMPRESSED  0x800
+#define ELF_STT_SECTION     3
+#define ELF_STT_FILE        4
+#define ELF_MAX_SECTIONS    0x100000
+
+typedef struct {
+	const CliFile *file;
+	bool is64;
+	ut16 type;
+	ut64 sections; ///< offset of the section headers
+	ut32 section_size;
+	ut32 n_sections;
+	ut32 names; ///< index of the section names section
+} ElfFile;
+
+typedef struct {
+	ut32 name;
+	ut32 type;
+	ut64 flags;
+	ut64 offset;
+	ut64 size;
+	ut32 link;
+	ut32 info;
+} ElfSection;
+
+static bool elf_in_file(const CliFile *file, ut64 offset, ut64 size) {
+	return offset <= file->size && size <= file->size - offset;
+}
+
+static void elf_section(const ElfFile *elf, ut32 index, ElfSection *section) {
+	const ut8 *p = elf->file->data + elf->sections + (ut64)index * elf->section_size;
+	section->name = cli_read_le32(p);
+	section->type = cli_read_le32(p + 4);
+	if (elf->is64) {
+		section->flags = cli_read_le64(p + 8);
+		section->offset = cli_read_le64(p + 24);
+		section->size = cli_read_le64(p + 32);
+		section->link = cli_read_le32(p + 40);
+		section->info = cli_read_le32(p + 44);
+	} else {
+		section->flags = cli_read_le32(p + 8);
+		section->offset = cli_read_le32(p + 16);
+		section->size = cli_read_le32(p + 20);
+		section->link = cli_read_le32(p + 24);
+		section->info = cli_read_le32(p + 28);
+	}
+}
+
+static bool elf_parse(const CliFile *file, ElfFile *elf) {
+	memset(elf, 0, sizeof(*elf));
+	elf->file = file;
+	if (file->size < 52 || memcmp(file->data, "\x7f" "ELF", 4) || file->data[5] != ELF_DATA_LSB) {
+		return false;
+	} else if (file->data[4] != ELF_CLASS_32 && (file->data[4] != ELF_CLASS_64 || file->size < 64)) {
+		return false;
+	}
+	const ut8 *header = file->data;
+	elf->is64 = header[4] == ELF_CLASS_64;
+	elf->type = cli_read_le16(header + 16);
+	elf->sections = elf->is64 ? cli_read_le64(header + 0x28) : cli_read_le32(header + 0x20);
+	elf->section_size = cli_read_le16(header + (elf->is64 ? 0x3a : 0x2e));
+	elf->n_sections = cli_read_le16(header + (elf->is64 ? 0x3c : 0x30));
+	elf->names = cli_read_le16(header + (elf->is64 ? 0x3e : 0x32));
+	if (!elf->sections) {
+		// stripped of the section headers
+		elf->n_sections = 0;
+		return true;
+	} else if (elf->section_size < (elf->is64 ? 64 : 40) || !elf_in_file(file, elf->sections, elf->section_size)) {
+		return false;
+	}
+	// the counts too big for the header are stored in the first section
+	ElfSection first;
+	elf_section(elf, 0, &first);
+	if (!elf->n_sections) {
+		elf->n_sections = first.size > ELF_MAX_SECTIONS ? ELF_MAX_SECTIONS + 1 : (ut32)first.size;
+	}
+	if (elf->names == ELF_SHN_XINDEX) {
+		elf->names = first.link;
+	}
+	return elf->n_sections <= ELF_MAX_SECTIONS &&
+		elf_in_file(file, elf->sections, (ut64)elf->n_sections * elf->section_size);
+}
+
+/**
+ * \brief Returns the section contents, or an empty file when the section
+ * has no data within the file or is compressed.
+ */
+static CliFile elf_section_data(const ElfFile *elf, const ElfSection *section) {
+	CliFile data = { 0 };
+	if (section->type != ELF_SHT_NOBITS && !(section->flags & ELF_SHF_COMPRESSED) &&
+		elf_in_file(elf->file, section->offset, section->size)) {
+		data.data = elf->file->data + section->offset;
+		data.size = section->size;
+	}
+	return data;
+}
+
+static bool elf_symbol_table(const ElfFile *elf, const ElfSection *section, CliSymbols *symbols) {
+	ut32 entry_size = elf->is64 ? 24 : 16;
+	CliFile table = elf_section_data(elf, section);
+	if (section->link >= elf->n_sections) {
+		return true;
+	}
+	ElfSection strtab_section;
+	elf_section(elf, section->link, &strtab_section);
+	CliFile strtab = elf_section_data(elf, &strtab_section);
+	// the first entry is always empty
+	for (ut64 offset = entry_size; offset + entry_size <= table.size; offset += entry_size) {
+		const ut8 *entry = table.data + offset;
+		ut32 name = cli_read_le32(entry);
+		ut8 type = entry[elf->is64 ? 4 : 12] & 0xf;
+		if (type == ELF_STT_SECTION || type == ELF_STT_FILE || !name || name >= strtab.size) {
+			continue;
+		}
+		if (!cli_symbols_add(symbols, (const char *)strtab.data + name, strtab.size - name)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+/**
+ * \brief Matches a debug section name, with or without the .dwo suffix.
+ */
+static bool elf_debug_section(const char *name, size_t max_length, const char *debug) {
+	size_t length = strlen(debug);
+	if (max_length <= length || strncmp(name, debug, length)) {
+		return false;
+	}
+	return !name[length] || (max_length > length + 4 && !strncmp(name + length, ".dwo", 5));
+}
+
+bool cli_elf_detect(const CliFile *file) {
+	ElfFile elf;
+	return elf_parse(file, &elf);
+}
+
+bool cli_elf_symbols(const CliFile *file, CliSymbols *symbols) {
+	ElfFile elf;
+	if (!elf_parse(file, &elf)) {
+		return false;
+	}
+	ElfSection names_section = { 0 };
+	if (elf.names < elf.n_sections) {
+		elf_section(&elf, elf.names, &names_section);
+	}
+	CliFile names = elf_section_data(&elf, &names_section);
+
+	CliDwarf dwarf = { 0 };
+	ut32 info_index = 0, str_offsets_index = 0;
+	for (ut32 i = 1; i < elf.n_sections; ++i) {
+		ElfSection section;
+		elf_section(&elf, i, &section);
+		if (section.type == ELF_SHT_SYMTAB || section.type == ELF_SHT_DYNSYM) {
+			if (!elf_symbol_table(&elf, &section, symbols)) {
+				return false;
+			}
+			continue;
+		} else if (section.name >= names.size) {
+			continue;
+		}
+		const char *name = (const char *)names.data + section.name;
+		size_t max_length = names.size - section.name;
+		if (elf_debug_section(name, max_length, ".debug_info")) {
+			dwarf.info = elf_section_data(&elf, &section);
+			info_index = i;
+		} else if (elf_debug_section(name, max_length, ".debug_abbrev")) {
+			dwarf.abbrev = elf_section_data(&elf, &section);
+		} else if (elf_debug_section(name, max_length, ".debug_str")) {
+			dwarf.str = elf_section_data(&elf, &section);
+		} else if (elf_debug_section(name, max_length, ".debug_line_str")) {
+			dwarf.line_str = elf_section_data(&elf, &section);
+		} else if (elf_debug_section(name, max_length, ".debug_str_offsets")) {
+			dwarf.str_offsets = elf_section_data(&elf, &section);
+			str_offsets_index = i;
+		}
+	}
+
+	if (elf.type == ELF_TYPE_REL) {
+		// the string offsets of relocatable objects are stored in the addends
+		for (ut32 i = 1; i < elf.n_sections; ++i) {
+			ElfSection section;
+			elf_section(&elf, i, &section);
+			if (section.type == ELF_SHT_RELA && section.size &&
+				((info_index && section.info == info_index) || (str_offsets_index && section.info == str_offsets_index))) {
+				return true;
+			}
+		}
+	}
+	return cli_dwarf_symbols(&dwarf, symbols);
+}
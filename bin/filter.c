@@ -0,0 +1,391 @@
+// SPDX-FileCopyrightText: 2026 RizinOrg <info@rizin.re>
+// SPDX-License-Identifier: LGPL-3.0-only
+
+/**
+ * \file filter.c
+ *
+ * Text filter (like c++filt): the mangled names found anywhere in the text,
+ * i.e. stack traces, perf maps or linker errors, are demangled in place and
+ * the rest of the text is copied unchanged.
+ *
+ * The input is read in chunks of whole lines; each chunk is scanned for the
+ * tokens starting at a word boundary with one of the decorations below, the
+ * ones not found in the run cache are demangled in one batch per language
+ * and the chunk is written back with the demangled names.
+ */
+
+#include "demangle.h"
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#define FILTER_CHUNK      (1 << 20)
+#define FILTER_CACHE_SIZE 4096 ///< entries of the run cache, power of 2
+#define FILTER_MAX_TOKEN  4096 ///< longer tokens are copied unchanged
+
+/* classes of the token characters */
+#define FILTER_WORD     (1 << 0) ///< alphanumeric and '_'
+#define FILTER_DOT      (1 << 1)
+#define FILTER_DOLLAR   (1 << 2)
+#define FILTER_AT       (1 << 3)
+#define FILTER_QUESTION (1 << 4)
+#define FILTER_PERCENT  (1 << 5)
+#define FILTER_START    (1 << 6) ///< first character of a decoration
+
+typedef struct {
+	const char *prefix;
+	ut8 length;
+	ut8 skip; ///< bytes not passed to the demangler
+	ut8 charset; ///< classes of the token characters
+	RzDemangleLang lang;
+} FilterDecoration;
+
+#define FILTER_ITANIUM (FILTER_WORD | FILTER_DOT | FILTER_DOLLAR)
+
+/* longer prefixes first */
+static const FilterDecoration decorations[] = {
+	{ "__Z", 3, 1, FILTER_ITANIUM, RZ_DEMANGLE_LANG_CXX }, // extra underscore of i386 and mach-o
+	{ "__R", 3, 1, FILTER_WORD | FILTER_DOT, RZ_DEMANGLE_LANG_RUST },
+	{ "_$s", 3, 1, FILTER_ITANIUM, RZ_DEMANGLE_LANG_SWIFT },
+	{ "_Z", 2, 0, FILTER_ITANIUM, RZ_DEMANGLE_LANG_CXX },
+	{ "_R", 2, 0, FILTER_WORD | FILTER_DOT, RZ_DEMANGLE_LANG_RUST },
+	{ "$s", 2, 0, FILTER_ITANIUM, RZ_DEMANGLE_LANG_SWIFT },
+	{ "?", 1, 0, FILTER_WORD | FILTER_DOLLAR | FILTER_AT | FILTER_QUESTION, RZ_DEMANGLE_LANG_MSVC },
+	{ "@", 1, 0, FILTER_WORD | FILTER_DOLLAR | FILTER_AT | FILTER_PERCENT, RZ_DEMANGLE_LANG_CXX }, // borland
+};
+
+typedef struct {
+	ut64 hash;
+	char *symbol; ///< the whole token, NUL terminated
+	size_t length;
+	char *result; ///< NULL when the token cannot be demangled
+	ut64 chunk; ///< last chunk using the entry, which cannot be replaced meanwhile
+} FilterEntry;
+
+typedef struct {
+	size_t offset; ///< within the chunk
+	size_t length;
+	const FilterDecoration *decoration;
+	FilterEntry *entry; ///< NULL when the token is not cached
+	char *copy; ///< NUL terminated copy of the token when not cached
+	char *result; ///< result of the token when not cached
+} FilterToken;
+
+typedef struct {
+	RzDemangleCtx *ctx;
+	RzDemangleOpts opts;
+	ut8 classes[256];
+	FilterEntry *cache;
+	ut64 chunk;
+	FilterToken *tokens;
+	size_t n_tokens;
+	size_t capacity;
+	const char **names;
+	char **results;
+	size_t *indexes;
+	size_t batch_capacity;
+} Filter;
+
+static void filter_init_classes(ut8 *classes) {
+	memset(classes, 0, 256);
+	for (int c = 0; c < 256; ++c) {
+		if ((c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_') {
+			classes[c] |= FILTER_WORD;
+		}
+	}
+	classes['.'] |= FILTER_DOT;
+	classes['$'] |= FILTER_DOLLAR;
+	classes['@'] |= FILTER_AT;
+	classes['?'] |= FILTER_QUESTION;
+	classes['%'] |= FILTER_PERCENT;
+	for (size_t i = 0; i < RZ_ARRAY_SIZE(decorations); ++i) {
+		classes[(ut8)decorations[i].prefix[0]] |= FILTER_START;
+	}
+}
+
+static ut64 filter_hash(const char *data, size_t length) {
+	ut64 hash = 0xcbf29ce484222325ull;
+	for (size_t i = 0; i < length; ++i) {
+		hash = (hash ^ (ut8)data[i]) * 0x100000001b3ull;
+	}
+	return hash;
+}
+
+/**
+ * \brief Returns the offset of the next character which can start a
+ * decoration ('_', '$', '?' or '@'), 16 bytes at a time when possible.
+ */
+static size_t filter_next_start(const Filter *filter, const char *text, size_t offset, size_t size) {
+#if defined(__SSE2__)
+	const __m128i underscore = _mm_set1_epi8('_');
+	const __m128i dollar = _mm_set1_epi8('$');
+	const __m128i question = _mm_set1_epi8('?');
+	const __m128i at = _mm_set1_epi8('@');
+	for (; offset + 16 <= size; offset += 16) {
+		__m128i v = _mm_loadu_si128((const __m128i *)(text + offset));
+		__m128i match = _mm_or_si128(
+			_mm_or_si128(_mm_cmpeq_epi8(v, underscore), _mm_cmpeq_epi8(v, dollar)),
+			_mm_or_si128(_mm_cmpeq_epi8(v, question), _mm_cmpeq_epi8(v, at)));
+		int mask = _mm_movemask_epi8(match);
+		if (mask) {
+			return offset + __builtin_ctz(mask);
+		}
+	}
+#endif
+	while (offset < size && !(filter->classes[(ut8)text[offset]] & FILTER_START)) {
+		offset++;
+	}
+	return offset;
+}
+
+static bool filter_add_token(Filter *filter, size_t offset, size_t length, const FilterDecoration *decoration) {
+	if (filter->n_tokens >= filter->capacity) {
+		size_t capacity = filter->capacity ? filter->capacity * 2 : 1024;
+		FilterToken *tmp = realloc(filter->tokens, capacity * sizeof(FilterToken));
+		if (!tmp) {
+			return false;
+		}
+		filter->tokens = tmp;
+		filter->capacity = capacity;
+	}
+	FilterToken *token = &filter->tokens[filter->n_tokens++];
+	memset(token, 0, sizeof(*token));
+	token->offset = offset;
+	token->length = length;
+	token->decoration = decoration;
+	return true;
+}
+
+/**
+ * \brief Collects the decorated tokens of the text.
+ */
+static bool filter_scan(Filter *filter, const char *text, size_t size) {
+	const ut8 *classes = filter->classes;
+	size_t offset = 0;
+	filter->n_tokens = 0;
+	while ((offset = filter_next_start(filter, text, offset, size)) < size) {
+		if (offset && (classes[(ut8)text[offset - 1]] & (FILTER_WORD | FILTER_DOLLAR | FILTER_AT | FILTER_QUESTION | FILTER_PERCENT))) {
+			// within a word
+			offset++;
+			continue;
+		}
+		const FilterDecoration *decoration = NULL;
+		for (size_t i = 0; i < RZ_ARRAY_SIZE(decorations) && !decoration; ++i) {
+			const FilterDecoration *d = &decorations[i];
+			if (size - offset > d->length && !memcmp(text + offset, d->prefix, d->length)) {
+				decoration = d;
+			}
+		}
+		if (!decoration) {
+			offset++;
+			continue;
+		}
+		size_t end = offset + decoration->length;
+		while (end < size && (classes[(ut8)text[end]] & decoration->charset)) {
+			end++;
+		}
+		// i.e. the full stop after the name
+		while (end > offset + decoration->length && text[end - 1] == '.') {
+			end--;
+		}
+		if (end > offset + decoration->length && end - offset <= FILTER_MAX_TOKEN &&
+			!filter_add_token(filter, offset, end - offset, decoration)) {
+			return false;
+		}
+		offset = end;
+	}
+	return true;
+}
+
+static char *filter_copy(const char *text, size_t length) {
+	char *copy = malloc(length + 1);
+	if (copy) {
+		memcpy(copy, text, length);
+		copy[length] = 0;
+	}
+	return copy;
+}
+
+/**
+ * \brief Looks the token up in the run cache; returns false when the token
+ * is not there and must be demangled, in which case it is added to the cache
+ * unless its slot is used by another token of the chunk.
+ */
+static bool filter_lookup(Filter *filter, const char *text, FilterToken *token, bool *failed) {
+	const char *symbol = text + token->offset;
+	ut64 hash = filter_hash(symbol, token->length);
+	FilterEntry *entry = &filter->cache[hash & (FILTER_CACHE_SIZE - 1)];
+	*failed = false;
+	if (entry->symbol && entry->hash == hash && entry->length == token->length && !memcmp(entry->symbol, symbol, token->length)) {
+		entry->chunk = filter->chunk;
+		token->entry = entry;
+		return true;
+	}
+	char *copy = filter_copy(symbol, token->length);
+	if (!copy) {
+		*failed = true;
+		return false;
+	} else if (entry->symbol && entry->chunk == filter->chunk) {
+		token->copy = copy;
+		return false;
+	}
+	free(entry->symbol);
+	free(entry->result);
+	entry->hash = hash;
+	entry->symbol = copy;
+	entry->length = token->length;
+	entry->result = NULL;
+	entry->chunk = filter->chunk;
+	token->entry = entry;
+	return false;
+}
+
+/**
+ * \brief Demangles the tokens missing from the cache, one batch per language.
+ */
+static bool filter_demangle(Filter *filter, const char *text) {
+	if (filter->n_tokens > filter->batch_capacity) {
+		size_t capacity = filter->capacity;
+		const char **names = realloc(filter->names, capacity * sizeof(char *));
+		filter->names = names ? names : filter->names;
+		char **results = realloc(filter->results, capacity * sizeof(char *));
+		filter->results = results ? results : filter->results;
+		size_t *indexes = realloc(filter->indexes, capacity * sizeof(size_t));
+		filter->indexes = indexes ? indexes : filter->indexes;
+		if (!names || !results || !indexes) {
+			return false;
+		}
+		filter->batch_capacity = capacity;
+	}
+
+	// the tokens to demangle are marked by their index
+	size_t n_missing = 0;
+	for (size_t i = 0; i < filter->n_tokens; ++i) {
+		bool failed;
+		if (filter_lookup(filter, text, &filter->tokens[i], &failed)) {
+			continue;
+		} else if (failed) {
+			return false;
+		}
+		filter->indexes[n_missing++] = i;
+	}
+
+	for (int lang = 0; lang < RZ_DEMANGLE_LANG_MAX; ++lang) {
+		RzDemangleBatch batch = { 0 };
+		batch.lang = lang;
+		batch.opts = filter->opts;
+		batch.symbols = filter->names;
+		batch.results = filter->results;
+		for (size_t i = 0; i < n_missing; ++i) {
+			const FilterToken *token = &filter->tokens[filter->indexes[i]];
+			if (token->decoration->lang == lang) {
+				const char *symbol = token->entry ? token->entry->symbol : token->copy;
+				filter->names[batch.n_symbols++] = symbol + token->decoration->skip;
+			}
+		}
+		if (!batch.n_symbols) {
+			continue;
+		} else if (!libdemangle_batch(filter->ctx, &batch)) {
+			return false;
+		}
+		size_t k = 0;
+		for (size_t i = 0; i < n_missing; ++i) {
+			FilterToken *token = &filter->tokens[filter->indexes[i]];
+			if (token->decoration->lang != lang) {
+				continue;
+			} else if (token->entry) {
+				token->entry->result = filter->results[k++];
+			} else {
+				token->result = filter->results[k++];
+			}
+		}
+	}
+	return true;
+}
+
+static bool filter_chunk(Filter *filter, const char *text, size_t size, FILE *out) {
+	filter->chunk++;
+	bool res = filter_scan(filter, text, size) && filter_demangle(filter, text);
+	size_t last = 0;
+	for (size_t i = 0; i < filter->n_tokens; ++i) {
+		FilterToken *token = &filter->tokens[i];
+		const char *result = token->entry ? token->entry->result : token->result;
+		if (res) {
+			fwrite(text + last, 1, token->offset - last, out);
+			if (result) {
+				fputs(result, out);
+			} else {
+				fwrite(text + token->offset, 1, token->length, out);
+			}
+			last = token->offset + token->length;
+		}
+		free(token->copy);
+		free(token->result);
+	}
+	if (res) {
+		fwrite(text + last, 1, size - last, out);
+	}
+	return res;
+}
+
+/**
+ * \brief Copies the text from \p in to \p out, demangling in place the
+ * decorated names found at the start of any word.
+ */
+int cli_filter_demangle(RzDemangleCtx *ctx, RzDemangleOpts opts, FILE *in, FILE *out) {
+	Filter filter = { 0 };
+	filter.ctx = ctx;
+	filter.opts = opts;
+	filter_init_classes(filter.classes);
+	filter.cache = calloc(FILTER_CACHE_SIZE, sizeof(FilterEntry));
+	size_t capacity = FILTER_CHUNK;
+	char *buffer = malloc(capacity);
+	size_t size = 0;
+	int ret = 1;
+	if (!filter.cache || !buffer) {
+		goto end;
+	}
+
+	for (bool eof = false; !eof;) {
+		if (size == capacity) {
+			// a line longer than the buffer
+			char *tmp = realloc(buffer, capacity * 2);
+			if (!tmp) {
+				goto end;
+			}
+			buffer = tmp;
+			capacity *= 2;
+		}
+		size_t n = fread(buffer + size, 1, capacity - size, in);
+		eof = n < capacity - size;
+		size += n;
+		// only whole lines, since the names never contain newlines
+		size_t end = size;
+		while (!eof && end > 0 && buffer[end - 1] != '\n') {
+			end--;
+		}
+		if (!end) {
+			continue;
+		} else if (!filter_chunk(&filter, buffer, end, out)) {
+			goto end;
+		}
+		memmove(buffer, buffer + end, size - end);
+		size -= end;
+	}
+	ret = 0;
+
+end:
+	if (filter.cache) {
+		for (size_t i = 0; i < FILTER_CACHE_SIZE; ++i) {
+			free(filter.cache[i].symbol);
+			free(filter.cache[i].result);
+		}
+	}
+	free(filter.cache);
+	free(filter.tokens);
+	free(filter.names);
+	free(filter.results);
+	free(filter.indexes);
+	free(buffer);
+	return ret;
+}
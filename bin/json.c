@@ -0,0 +1,195 @@
+// SPDX-FileCopyrightText: 2026 RizinOrg <info@rizin.re>
+// SPDX-License-Identifier: LGPL-3.0-only
+
+/**
+ * \file json.c
+ *
+ * Machine readable output: one JSON object per symbol and per line (NDJSON).
+ *
+ * The records are appended to a growable buffer by a hand-rolled encoder:
+ * the runs of characters which need no escaping are copied at once, invalid
+ * UTF-8 sequences are replaced by U+FFFD so the output is always valid JSON.
+ */
+
+#include "demangle.h"
+
+static const char hex_digits[] = "0123456789abcdef";
+
+bool cli_buffer_reserve(CliBuffer *buffer, size_t size) {
+	if (size <= buffer->capacity) {
+		return true;
+	}
+	size_t capacity = buffer->capacity ? buffer->capacity : 4096;
+	while (capacity < size) {
+		capacity *= 2;
+	}
+	char *tmp = realloc(buffer->data, capacity);
+	if (!tmp) {
+		return false;
+	}
+	buffer->data = tmp;
+	buffer->capacity = capacity;
+	return true;
+}
+
+bool cli_buffer_append(CliBuffer *buffer, const char *data, size_t length) {
+	if (!cli_buffer_reserve(buffer, buffer->size + length)) {
+		return false;
+	}
+	memcpy(buffer->data + buffer->size, data, length);
+	buffer->size += length;
+	return true;
+}
+
+void cli_buffer_fini(CliBuffer *buffer) {
+	free(buffer->data);
+	memset(buffer, 0, sizeof(*buffer));
+}
+
+/**
+ * \brief Returns the length of the valid UTF-8 sequence starting with a non
+ * ASCII character, or 0 when invalid (overlong, surrogate or truncated).
+ */
+static size_t json_utf8_length(const ut8 *p, size_t max_length) {
+	ut8 lead = p[0];
+	size_t length;
+	ut8 min = 0x80, max = 0xbf; ///< range of the second byte
+	if (lead >= 0xc2 && lead <= 0xdf) {
+		length = 2;
+	} else if (lead >= 0xe0 && lead <= 0xef) {
+		length = 3;
+		min = lead == 0xe0 ? 0xa0 : min;
+		max = lead == 0xed ? 0x9f : max;
+	} else if (lead >= 0xf0 && lead <= 0xf4) {
+		length = 4;
+		min = lead == 0xf0 ? 0x90 : min;
+		max = lead == 0xf4 ? 0x8f : max;
+	} else {
+		return 0;
+	}
+	if (length > max_length || p[1] < min || p[1] > max) {
+		return 0;
+	}
+	for (size_t i = 2; i < length; ++i) {
+		if ((p[i] & 0xc0) != 0x80) {
+			return 0;
+		}
+	}
+	return length;
+}
+
+/**
+ * \brief Appends the string as a quoted and escaped JSON string.
+ */
+bool cli_json_string(CliBuffer *buffer, const char *string, size_t length) {
+	// the worst case is 6 bytes per input byte plus the quotes
+	if (!cli_buffer_reserve(buffer, buffer->size + length * 6 + 2)) {
+		return false;
+	}
+	const ut8 *p = (const ut8 *)string;
+	const ut8 *end = p + length;
+	char *out = buffer->data + buffer->size;
+	*out++ = '"';
+	while (p < end) {
+		const ut8 *run = p;
+		while (p < end && *p >= 0x20 && *p < 0x80 && *p != '"' && *p != '\\') {
+			p++;
+		}
+		memcpy(out, run, p - run);
+		out += p - run;
+		if (p >= end) {
+			break;
+		}
+		ut8 c = *p;
+		if (c >= 0x80) {
+			size_t n = json_utf8_length(p, end - p);
+			if (n) {
+				memcpy(out, p, n);
+				out += n;
+				p += n;
+			} else {
+				memcpy(out, "\\ufffd", 6);
+				out += 6;
+				p++;
+			}
+			continue;
+		}
+		*out++ = '\\';
+		switch (c) {
+		case '"':
+		case '\\':
+			*out++ = c;
+			break;
+		case '\b': *out++ = 'b'; break;
+		case '\f': *out++ = 'f'; break;
+		case '\n': *out++ = 'n'; break;
+		case '\r': *out++ = 'r'; break;
+		case '\t': *out++ = 't'; break;
+		default:
+			memcpy(out, "u00", 3);
+			out[3] = hex_digits[c >> 4];
+			out[4] = hex_digits[c & 0xf];
+			out += 5;
+			break;
+		}
+		p++;
+	}
+	*out++ = '"';
+	buffer->size = out - buffer->data;
+	return true;
+}
+
+static bool json_number(CliBuffer *buffer, ut64 value) {
+	char digits[20];
+	size_t n = 0;
+	do {
+		digits[n++] = '0' + (value % 10);
+		value /= 10;
+	} while (value);
+	if (!cli_buffer_reserve(buffer, buffer->size + n)) {
+		return false;
+	}
+	while (n) {
+		buffer->data[buffer->size++] = digits[--n];
+	}
+	return true;
+}
+
+#define json_literal(buffer, text) cli_buffer_append(buffer, text, sizeof(text) - 1)
+
+/**
+ * \brief Appends the record as a JSON object followed by a newline:
+ * {["file":...,]"input":...,"lang":...,"result":...,"length":...[,"ns":...|,"deduplicated":true][,"bytes":...]},
+ * with a null "result" when the symbol cannot be demangled, whatever the
+ * reason, and "deduplicated" in place of the time of a repeated symbol.
+ */
+bool cli_json_record(CliBuffer *buffer, const CliRecord *record) {
+	const char *lang = libdemangle_lang_name(record->lang);
+	size_t length = record->result ? strlen(record->result) : 0;
+	if (record->file && (!json_literal(buffer, "{\"file\":") || !cli_json_string(buffer, record->file, strlen(record->file)))) {
+		return false;
+	}
+	if (!cli_buffer_append(buffer, record->file ? ",\"input\":" : "{\"input\":", 9) ||
+		!cli_json_string(buffer, record->input, record->input_length) ||
+		!json_literal(buffer, ",\"lang\":") ||
+		!cli_json_string(buffer, lang ? lang : "unknown", lang ? strlen(lang) : 7)) {
+		return false;
+	}
+	if (!json_literal(buffer, ",\"result\":")) {
+		return false;
+	} else if (record->result ? !cli_json_string(buffer, record->result, length) : !json_literal(buffer, "null")) {
+		return false;
+	}
+	if (!json_literal(buffer, ",\"length\":") || !json_number(buffer, length)) {
+		return false;
+	}
+	if (record->ns != UT64_MAX && (!json_literal(buffer, ",\"ns\":") || !json_number(buffer, record->ns))) {
+		return false;
+	} else if (record->deduplicated && !json_literal(buffer, ",\"deduplicated\":true")) {
+		return false;
+	}
+	if (record->bytes != UT64_MAX && (!json_literal(buffer, ",\"bytes\":") || !json_number(buffer, record->bytes))) {
+		return false;
+	}
+	return json_literal(buffer, "}\n");
+}
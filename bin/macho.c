@@ -0,0 +1,225 @@
+// SPDX-FileCopyrightText: 2026 RizinOrg <info@rizin.re>
+// SPDX-License-Identifier: LGPL-3.0-only
+
+/**
+ * \file macho.c
+ *
+ * Mach-O files (thin and fat): walks the LC_SYMTAB symbols, the C-strings
+ * of the __objc_classname section (i.e. the runtime names of the Swift
+ * classes) and the DWARF linkage names (i.e. of dSYM bundles) of every slice.
+ * The selectors of __objc_methname are plain strings, not decorated names,
+ * thus they are not walked.
+ * Only little endian slices are supported.
+ */
+
+#include "demangle.h"
+
+#define MACHO_MAGIC         0xfeedface
+#define MACHO_MAGIC_64      0xfeedfacf
+#define MACHO_FAT_MAGIC     0xcafebabe
+#define MACHO_FAT_MAGIC_64  0xcafebabf
+#define MACHO_FAT_MAX_ARCHS 64 ///< java classes share the magic, their version is bigger
+#define MACHO_LC_SEGMENT    0x1
+#define MACHO_LC_SYMTAB     0x2
+#define MACHO_LC_SEGMENT_64 0x19
+#define MACHO_N_STAB        0xe0
+
+typedef struct {
+	CliFile slice;
+	bool is64;
+	ut32 n_commands;
+	ut64 commands; ///< offset of the first load command
+	ut64 commands_end;
+} MachoFile;
+
+static const char *objc_sections[] = {
+	"__objc_classname",
+};
+
+/* section names are truncated to 16 bytes */
+static const struct {
+	const char *name;
+	size_t offset;
+} dwarf_sections[] = {
+	{ "__debug_info", offsetof(CliDwarf, info) },
+	{ "__debug_abbrev", offsetof(CliDwarf, abbrev) },
+	{ "__debug_str", offsetof(CliDwarf, str) },
+	{ "__debug_line_str", offsetof(CliDwarf, line_str) },
+	{ "__debug_str_offs", offsetof(CliDwarf, str_offsets) },
+};
+
+static ut32 macho_read_be32(const ut8 *p) {
+	return ((ut32)p[0] << 24) | ((ut32)p[1] << 16) | ((ut32)p[2] << 8) | (ut32)p[3];
+}
+
+static ut64 macho_read_be64(const ut8 *p) {
+	return ((ut64)macho_read_be32(p) << 32) | macho_read_be32(p + 4);
+}
+
+static bool macho_in_file(const CliFile *file, ut64 offset, ut64 size) {
+	return offset <= file->size && size <= file->size - offset;
+}
+
+static bool macho_parse(const CliFile *slice, MachoFile *macho) {
+	memset(macho, 0, sizeof(*macho));
+	if (slice->size < 28) {
+		return false;
+	}
+	ut32 magic = cli_read_le32(slice->data);
+	if (magic != MACHO_MAGIC && magic != MACHO_MAGIC_64) {
+		return false;
+	}
+	macho->slice = *slice;
+	macho->is64 = magic == MACHO_MAGIC_64;
+	macho->n_commands = cli_read_le32(slice->data + 16);
+	macho->commands = macho->is64 ? 32 : 28;
+	macho->commands_end = macho->commands + cli_read_le32(slice->data + 20);
+	return macho->commands_end <= slice->size;
+}
+
+static bool macho_fat_arch(const CliFile *file, ut32 index, CliFile *slice) {
+	bool is64 = macho_read_be32(file->data) == MACHO_FAT_MAGIC_64;
+	ut64 arch = 8 + (ut64)index * (is64 ? 32 : 20);
+	if (!macho_in_file(file, arch, is64 ? 32 : 20)) {
+		return false;
+	}
+	const ut8 *p = file->data + arch;
+	ut64 offset = is64 ? macho_read_be64(p + 8) : macho_read_be32(p + 8);
+	ut64 size = is64 ? macho_read_be64(p + 16) : macho_read_be32(p + 12);
+	if (!macho_in_file(file, offset, size)) {
+		return false;
+	}
+	slice->data = file->data + offset;
+	slice->size = size;
+	return true;
+}
+
+static bool macho_symtab(const MachoFile *macho, const ut8 *command, CliSymbols *symbols) {
+	const CliFile *slice = &macho->slice;
+	ut32 symoff = cli_read_le32(command + 8);
+	ut32 n_symbols = cli_read_le32(command + 12);
+	ut32 stroff = cli_read_le32(command + 16);
+	ut32 strsize = cli_read_le32(command + 20);
+	ut32 entry_size = macho->is64 ? 16 : 12;
+	if (!macho_in_file(slice, symoff, (ut64)n_symbols * entry_size) || !macho_in_file(slice, stroff, strsize)) {
+		return true;
+	}
+	for (ut32 i = 0; i < n_symbols; ++i) {
+		const ut8 *entry = slice->data + symoff + (ut64)i * entry_size;
+		ut32 strx = cli_read_le32(entry);
+		if ((entry[4] & MACHO_N_STAB) || !strx || strx >= strsize) {
+			// debugging entries hold file and function names, already in the table.
+			continue;
+		}
+		if (!cli_symbols_add(symbols, (const char *)slice->data + stroff + strx, strsize - strx)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+static bool macho_cstrings(const CliFile *slice, ut64 offset, ut64 size, CliSymbols *symbols) {
+	if (!macho_in_file(slice, offset, size)) {
+		return true;
+	}
+	const char *p = (const char *)slice->data + offset;
+	const char *end = p + size;
+	while (p < end) {
+		if (!cli_symbols_add(symbols, p, end - p)) {
+			return false;
+		}
+		const char *nul = memchr(p, 0, end - p);
+		p = nul ? nul + 1 : end;
+	}
+	return true;
+}
+
+static bool macho_segment(const MachoFile *macho, const ut8 *command, ut32 command_size, CliDwarf *dwarf, CliSymbols *symbols) {
+	ut32 header_size = macho->is64 ? 72 : 56;
+	ut32 section_size = macho->is64 ? 80 : 68;
+	ut32 n_sections = cli_read_le32(command + (macho->is64 ? 64 : 48));
+	if (command_size < header_size || n_sections > (command_size - header_size) / section_size) {
+		return true;
+	}
+	for (ut32 i = 0; i < n_sections; ++i) {
+		const ut8 *section = command + header_size + i * section_size;
+		ut64 size = macho->is64 ? cli_read_le64(section + 40) : cli_read_le32(section + 36);
+		ut32 offset = cli_read_le32(section + (macho->is64 ? 48 : 40));
+		for (size_t k = 0; k < RZ_ARRAY_SIZE(objc_sections); ++k) {
+			if (!strncmp((const char *)section, objc_sections[k], 16) &&
+				!macho_cstrings(&macho->slice, offset, size, symbols)) {
+				return false;
+			}
+		}
+		for (size_t k = 0; k < RZ_ARRAY_SIZE(dwarf_sections); ++k) {
+			if (!strncmp((const char *)section, dwarf_sections[k].name, 16) && macho_in_file(&macho->slice, offset, size)) {
+				CliFile *data = (CliFile *)((ut8 *)dwarf + dwarf_sections[k].offset);
+				data->data = macho->slice.data + offset;
+				data->size = size;
+			}
+		}
+	}
+	return true;
+}
+
+static bool macho_slice_symbols(const CliFile *slice, CliSymbols *symbols) {
+	MachoFile macho;
+	if (!macho_parse(slice, &macho)) {
+		return false;
+	}
+	CliDwarf dwarf = { 0 };
+	ut64 offset = macho.commands;
+	for (ut32 i = 0; i < macho.n_commands && offset + 8 <= macho.commands_end; ++i) {
+		const ut8 *command = slice->data + offset;
+		ut32 cmd = cli_read_le32(command);
+		ut32 command_size = cli_read_le32(command + 4);
+		if (command_size < 8 || command_size > macho.commands_end - offset) {
+			return false;
+		}
+		bool res = true;
+		if (cmd == MACHO_LC_SYMTAB && command_size >= 24) {
+			res = macho_symtab(&macho, command, symbols);
+		} else if (cmd == MACHO_LC_SEGMENT || cmd == MACHO_LC_SEGMENT_64) {
+			res = macho_segment(&macho, command, command_size, &dwarf, symbols);
+		}
+		if (!res) {
+			return false;
+		}
+		offset += command_size;
+	}
+	return cli_dwarf_symbols(&dwarf, symbols);
+}
+
+bool cli_macho_detect(const CliFile *file) {
+	MachoFile macho;
+	if (file->size < 8) {
+		return false;
+	} else if (macho_parse(file, &macho)) {
+		return true;
+	}
+	ut32 magic = macho_read_be32(file->data);
+	ut32 n_archs = macho_read_be32(file->data + 4);
+	return (magic == MACHO_FAT_MAGIC || magic == MACHO_FAT_MAGIC_64) && n_archs > 0 && n_archs <= MACHO_FAT_MAX_ARCHS;
+}
+
+bool cli_macho_symbols(const CliFile *file, CliSymbols *symbols) {
+	ut32 magic = macho_read_be32(file->data);
+	if (magic != MACHO_FAT_MAGIC && magic != MACHO_FAT_MAGIC_64) {
+		return macho_slice_symbols(file, symbols);
+	}
+	ut32 n_archs = macho_read_be32(file->data + 4);
+	for (ut32 i = 0; i < n_archs; ++i) {
+		CliFile slice;
+		if (!macho_fat_arch(file, i, &slice)) {
+			return false;
+		}
+		MachoFile macho;
+		if (!macho_parse(&slice, &macho)) {
+			// big endian slice
+			continue;
+		} else if (!macho_slice_symbols(&slice, symbols)) {
+			return false;
+		}
+	}
+	return true;
+}
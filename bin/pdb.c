@@ -0,0 +1,346 @@
+// SPDX-FileCopyrightText: 2026 RizinOrg <info@rizin.re>
+// SPDX-License-Identifier: LGPL-3.0-only
+
+/**
+ * \file pdb.c
+ *
+ * PDB files (MSF 7.0 container): walks the symbol records stream, shared by
+ * the publics and globals hash streams, and the procedures of the module
+ * streams listed in the DBI stream.
+ *
+ * Streams are not reassembled: records are read in place within the mapped
+ * file and copied to a scratch buffer only when they straddle two blocks
+ * which are not adjacent in the file.
+ */
+
+#include "demangle.h"
+
+#define PDB_MAGIC_SIZE       32
+#define PDB_SUPERBLOCK_SIZE  56
+#define PDB_NIL_STREAM       UT32_MAX
+#define PDB_STREAM_DBI       3
+#define PDB_DBI_HEADER_SIZE  64
+#define PDB_MODULE_INFO_SIZE 64
+#define PDB_MAX_RECORD       (0xffff + 2)
+
+#define CV_S_LDATA32     0x110c
+#define CV_S_GDATA32     0x110d
+#define CV_S_PUB32       0x110e
+#define CV_S_LPROC32     0x110f
+#define CV_S_GPROC32     0x1110
+#define CV_S_LTHREAD32   0x1112
+#define CV_S_GTHREAD32   0x1113
+#define CV_S_LPROC32_ID  0x1146
+#define CV_S_GPROC32_ID  0x1147
+
+typedef struct {
+	ut32 size;
+	const ut8 *blocks; ///< block indexes, little endian ut32
+	ut8 *blocks_copy; ///< set when the indexes straddle two directory blocks
+} PdbStream;
+
+typedef struct {
+	const CliFile *file;
+	ut32 block_size;
+	ut32 n_blocks;
+	PdbStream directory;
+	ut32 n_streams;
+	ut64 *block_lists; ///< directory offset of the block indexes of each stream
+	ut8 *scratch; ///< PDB_MAX_RECORD bytes
+} PdbFile;
+
+static const ut8 pdb_magic[PDB_MAGIC_SIZE] = "Microsoft C/C++ MSF 7.00\r\n\x1a" "DS\0\0\0";
+
+/**
+ * \brief Returns the file offset of the block holding the stream \p offset.
+ */
+static bool pdb_block_offset(const PdbFile *pdb, const PdbStream *stream, ut64 offset, ut64 *file_offset) {
+	ut32 block = cli_read_le32(stream->blocks + (offset / pdb->block_size) * 4);
+	if (block >= pdb->n_blocks) {
+		return false;
+	}
+	*file_offset = (ut64)block * pdb->block_size + offset % pdb->block_size;
+	return true;
+}
+
+/**
+ * \brief Returns \p size bytes of the stream at \p offset: a pointer within
+ * the mapped file when the bytes are contiguous in it, otherwise a copy in
+ * the scratch buffer. Returns NULL when the range is outside the stream.
+ */
+static const ut8 *pdb_stream_span(const PdbFile *pdb, const PdbStream *stream, ut64 offset, ut32 size) {
+	ut64 start;
+	if (offset > stream->size || size > stream->size - offset || size > PDB_MAX_RECORD) {
+		return NULL;
+	} else if (!size) {
+		return pdb->file->data;
+	} else if (!pdb_block_offset(pdb, stream, offset, &start)) {
+		return NULL;
+	}
+	ut64 contiguous = pdb->block_size - offset % pdb->block_size;
+	ut64 next = start + contiguous;
+	while (contiguous < size) {
+		ut64 block_start;
+		if (!pdb_block_offset(pdb, stream, offset + contiguous, &block_start)) {
+			return NULL;
+		} else if (block_start != next) {
+			break;
+		}
+		contiguous += pdb->block_size;
+		next += pdb->block_size;
+	}
+	if (contiguous >= size) {
+		return pdb->file->data + start;
+	}
+
+	// the range straddles blocks which are apart in the file
+	for (ut32 copied = 0; copied < size;) {
+		ut64 block_start;
+		if (!pdb_block_offset(pdb, stream, offset + copied, &block_start)) {
+			return NULL;
+		}
+		ut32 length = RZ_MIN(size - copied, pdb->block_size - (ut32)((offset + copied) % pdb->block_size));
+		memcpy(pdb->scratch + copied, pdb->file->data + block_start, length);
+		copied += length;
+	}
+	return pdb->scratch;
+}
+
+static bool pdb_stream_read32(const PdbFile *pdb, const PdbStream *stream, ut64 offset, ut32 *value) {
+	const ut8 *p = pdb_stream_span(pdb, stream, offset, 4);
+	if (!p) {
+		return false;
+	}
+	*value = cli_read_le32(p);
+	return true;
+}
+
+static bool pdb_parse(const CliFile *file, PdbFile *pdb) {
+	memset(pdb, 0, sizeof(*pdb));
+	pdb->file = file;
+	if (file->size < PDB_SUPERBLOCK_SIZE || memcmp(file->data, pdb_magic, PDB_MAGIC_SIZE)) {
+		return false;
+	}
+	pdb->block_size = cli_read_le32(file->data + 32);
+	ut32 directory_size = cli_read_le32(file->data + 44);
+	ut32 block_map = cli_read_le32(file->data + 52);
+	if (pdb->block_size < 512 || pdb->block_size > 32768 || (pdb->block_size & (pdb->block_size - 1))) {
+		return false;
+	}
+	// the blocks past the end of a truncated file are never read
+	pdb->n_blocks = RZ_MIN(cli_read_le32(file->data + 40), (ut32)(file->size / pdb->block_size));
+	ut64 n_directory_blocks = ((ut64)directory_size + pdb->block_size - 1) / pdb->block_size;
+	if (block_map >= pdb->n_blocks || n_directory_blocks * 4 > pdb->block_size || directory_size < 4) {
+		return false;
+	}
+	pdb->directory.size = directory_size;
+	pdb->directory.blocks = file->data + (ut64)block_map * pdb->block_size;
+	return true;
+}
+
+/**
+ * \brief Reads the directory: stream count, sizes, then the block indexes of
+ * each stream.
+ */
+static bool pdb_directory(PdbFile *pdb) {
+	if (!pdb_stream_read32(pdb, &pdb->directory, 0, &pdb->n_streams) ||
+		pdb->n_streams > (pdb->directory.size - 4) / 4) {
+		return false;
+	}
+	pdb->block_lists = calloc(pdb->n_streams + 1, sizeof(ut64));
+	if (!pdb->block_lists) {
+		return false;
+	}
+	ut64 offset = 4 + (ut64)pdb->n_streams * 4;
+	for (ut32 i = 0; i < pdb->n_streams; ++i) {
+		ut32 size;
+		if (!pdb_stream_read32(pdb, &pdb->directory, 4 + (ut64)i * 4, &size)) {
+			return false;
+		}
+		pdb->block_lists[i] = offset;
+		offset += size == PDB_NIL_STREAM ? 0 : ((ut64)size + pdb->block_size - 1) / pdb->block_size * 4;
+	}
+	return true;
+}
+
+/**
+ * \brief Looks up the size and the block indexes of the stream.
+ */
+static bool pdb_stream_open(PdbFile *pdb, ut32 index, PdbStream *stream) {
+	memset(stream, 0, sizeof(*stream));
+	if (index >= pdb->n_streams || !pdb_stream_read32(pdb, &pdb->directory, 4 + (ut64)index * 4, &stream->size)) {
+		return false;
+	} else if (stream->size == PDB_NIL_STREAM) {
+		stream->size = 0;
+		return true;
+	}
+	ut64 offset = pdb->block_lists[index];
+	ut64 n_blocks = ((ut64)stream->size + pdb->block_size - 1) / pdb->block_size;
+	if (offset > pdb->directory.size || n_blocks * 4 > pdb->directory.size - offset) {
+		return false;
+	}
+	const ut8 *blocks = n_blocks * 4 <= PDB_MAX_RECORD ? pdb_stream_span(pdb, &pdb->directory, offset, (ut32)n_blocks * 4) : NULL;
+	if (blocks && blocks != pdb->scratch) {
+		stream->blocks = blocks;
+		return true;
+	}
+	// the indexes straddle two directory blocks (or are too many for the scratch buffer)
+	stream->blocks_copy = malloc(n_blocks * 4 + 1);
+	if (!stream->blocks_copy) {
+		return false;
+	}
+	for (ut64 i = 0; i < n_blocks; ++i) {
+		ut32 block;
+		if (!pdb_stream_read32(pdb, &pdb->directory, offset + i * 4, &block)) {
+			free(stream->blocks_copy);
+			stream->blocks_copy = NULL;
+			return false;
+		}
+		cli_write_le32(stream->blocks_copy + i * 4, block);
+	}
+	stream->blocks = stream->blocks_copy;
+	return true;
+}
+
+static void pdb_stream_fini(PdbStream *stream) {
+	free(stream->blocks_copy);
+	memset(stream, 0, sizeof(*stream));
+}
+
+/**
+ * \brief Returns the offset of the name within the record (after the length
+ * and the kind), or 0 when the record has no interesting name.
+ */
+static ut32 pdb_record_name(ut16 kind, bool module) {
+	switch (kind) {
+	case CV_S_LPROC32:
+	case CV_S_GPROC32:
+	case CV_S_LPROC32_ID:
+	case CV_S_GPROC32_ID:
+		// parent, end, next, length, debug start and end, type, offset, segment, flags
+		return module ? 4 + 35 : 0;
+	case CV_S_PUB32:
+	case CV_S_LDATA32:
+	case CV_S_GDATA32:
+	case CV_S_LTHREAD32:
+	case CV_S_GTHREAD32:
+		// flags or type, offset, segment
+		return module ? 0 : 4 + 10;
+	default:
+		// i.e. the S_PROCREF of the globals refer to the module procedures
+		return 0;
+	}
+}
+
+/**
+ * \brief Walks the CodeView records of the stream in [offset, end).
+ */
+static bool pdb_records(PdbFile *pdb, const PdbStream *stream, ut64 offset, ut64 end, bool module, CliSymbols *symbols) {
+	end = RZ_MIN(end, (ut64)stream->size);
+	while (offset + 4 <= end) {
+		const ut8 *header = pdb_stream_span(pdb, stream, offset, 4);
+		if (!header) {
+			break;
+		}
+		ut32 length = cli_read_le16(header) + 2;
+		ut32 name_offset = pdb_record_name(cli_read_le16(header + 2), module);
+		if (length < 4 || offset + length > end) {
+			break;
+		} else if (!name_offset || name_offset >= length) {
+			offset += length;
+			continue;
+		}
+		const ut8 *record = pdb_stream_span(pdb, stream, offset, length);
+		if (!record) {
+			break;
+		}
+		const char *name = (const char *)record + name_offset;
+		size_t max_length = length - name_offset;
+		if (record == pdb->scratch) {
+			// the scratch buffer is reused, thus the name must be copied
+			max_length = strnlen(name, max_length);
+		}
+		if (!cli_symbols_add(symbols, name, max_length)) {
+			return false;
+		}
+		offset += length;
+	}
+	return true;
+}
+
+static bool pdb_modules(PdbFile *pdb, const PdbStream *dbi, CliSymbols *symbols) {
+	ut32 modules_size;
+	if (!pdb_stream_read32(pdb, dbi, 24, &modules_size)) {
+		return true;
+	}
+	ut64 offset = PDB_DBI_HEADER_SIZE;
+	ut64 end = offset + modules_size;
+	while (offset + PDB_MODULE_INFO_SIZE <= end) {
+		const ut8 *info = pdb_stream_span(pdb, dbi, offset, PDB_MODULE_INFO_SIZE);
+		if (!info) {
+			break;
+		}
+		ut16 stream_index = cli_read_le16(info + 34);
+		ut32 symbols_size = cli_read_le32(info + 36);
+
+		// skips the module and object file names, then aligns to 4 bytes
+		offset += PDB_MODULE_INFO_SIZE;
+		for (int i = 0; i < 2; ++i) {
+			const ut8 *c;
+			while ((c = pdb_stream_span(pdb, dbi, offset, 1)) && *c) {
+				offset++;
+			}
+			offset++;
+		}
+		offset = (offset + 3) & ~3ull;
+
+		PdbStream stream;
+		if (stream_index == UT16_MAX || !pdb_stream_open(pdb, stream_index, &stream)) {
+			continue;
+		}
+		// skips the signature of the symbols substream
+		bool res = pdb_records(pdb, &stream, 4, symbols_size, true, symbols);
+		pdb_stream_fini(&stream);
+		if (!res) {
+			return false;
+		}
+	}
+	return true;
+}
+
+bool cli_pdb_detect(const CliFile *file) {
+	PdbFile pdb;
+	return pdb_parse(file, &pdb);
+}
+
+bool cli_pdb_symbols(const CliFile *file, CliSymbols *symbols) {
+	PdbFile pdb;
+	if (!pdb_parse(file, &pdb)) {
+		return false;
+	}
+	PdbStream dbi = { 0 }, records;
+	bool res = false;
+	if (!(pdb.scratch = malloc(PDB_MAX_RECORD)) || !pdb_directory(&pdb) || !pdb_stream_open(&pdb, PDB_STREAM_DBI, &dbi)) {
+		goto end;
+	} else if (dbi.size < PDB_DBI_HEADER_SIZE) {
+		// without debug info
+		res = true;
+		goto end;
+	}
+	const ut8 *header = pdb_stream_span(&pdb, &dbi, 0, PDB_DBI_HEADER_SIZE);
+	ut16 records_index = header ? cli_read_le16(header + 20) : UT16_MAX;
+	if (records_index != UT16_MAX && pdb_stream_open(&pdb, records_index, &records)) {
+		res = pdb_records(&pdb, &records, 0, records.size, false, symbols);
+		pdb_stream_fini(&records);
+		if (!res) {
+			goto end;
+		}
+	}
+	res = pdb_modules(&pdb, &dbi, symbols);
+
+end:
+	pdb_stream_fini(&dbi);
+	free(pdb.block_lists);
+	free(pdb.scratch);
+	return res;
+}
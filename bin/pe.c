@@ -0,0 +1,273 @@
+// SPDX-FileCopyrightText: 2026 RizinOrg <info@rizin.re>
+// SPDX-License-Identifier: LGPL-3.0-only
+
+/**
+ * \file pe.c
+ *
+ * PE images and COFF objects: walks the COFF symbol table, the export
+ * directory and the (delay) import name tables.
+ */
+
+#include "demangle.h"
+
+#define COFF_HEADER_SIZE     20
+#define COFF_SECTION_SIZE    40
+#define COFF_SYMBOL_SIZE     18
+#define COFF_STORAGE_FILE    103
+#define COFF_MAX_SECTIONS    0xff00
+#define PE_MAGIC_PE32        0x10b
+#define PE_MAGIC_PE32_PLUS   0x20b
+#define PE_DIR_EXPORT        0
+#define PE_DIR_IMPORT        1
+#define PE_DIR_DELAY_IMPORT  13
+#define PE_IMPORT_SIZE       20
+#define PE_DELAY_IMPORT_SIZE 32
+
+typedef struct {
+	const CliFile *file;
+	ut64 coff; ///< offset of the COFF file header
+	ut64 optional; ///< offset of the optional header
+	ut32 optional_size;
+	ut64 sections; ///< offset of the section table
+	ut32 n_sections;
+	bool pe64;
+} PeFile;
+
+static const ut16 coff_machines[] = {
+	0x014c, // i386
+	0x0200, // ia64
+	0x01c0, // arm
+	0x01c2, // thumb
+	0x01c4, // armnt
+	0x8664, // amd64
+	0xa641, // arm64ec
+	0xaa64, // arm64
+};
+
+static bool pe_in_file(const CliFile *file, ut64 offset, ut64 size) {
+	return offset <= file->size && size <= file->size - offset;
+}
+
+static bool pe_parse(const CliFile *file, PeFile *pe) {
+	memset(pe, 0, sizeof(*pe));
+	pe->file = file;
+	if (file->size >= 0x40 && !memcmp(file->data, "MZ", 2)) {
+		ut32 lfanew = cli_read_le32(file->data + 0x3c);
+		if (!pe_in_file(file, lfanew, 4 + COFF_HEADER_SIZE) || memcmp(file->data + lfanew, "PE\0\0", 4)) {
+			return false;
+		}
+		pe->coff = lfanew + 4;
+	} else {
+		// a plain COFF object has no optional header
+		if (file->size < COFF_HEADER_SIZE || cli_read_le16(file->data + 16)) {
+			return false;
+		}
+		ut16 machine = cli_read_le16(file->data);
+		size_t i;
+		for (i = 0; i < RZ_ARRAY_SIZE(coff_machines) && coff_machines[i] != machine; ++i) {
+		}
+		if (i == RZ_ARRAY_SIZE(coff_machines)) {
+			return false;
+		}
+	}
+	const ut8 *header = file->data + pe->coff;
+	pe->n_sections = cli_read_le16(header + 2);
+	pe->optional = pe->coff + COFF_HEADER_SIZE;
+	pe->optional_size = cli_read_le16(header + 16);
+	pe->sections = pe->optional + pe->optional_size;
+	if (pe->n_sections > COFF_MAX_SECTIONS || !pe_in_file(file, pe->sections, (ut64)pe->n_sections * COFF_SECTION_SIZE)) {
+		return false;
+	}
+	ut32 symtab = cli_read_le32(header + 8);
+	ut32 n_symbols = cli_read_le32(header + 12);
+	if (symtab && !pe_in_file(file, symtab, (ut64)n_symbols * COFF_SYMBOL_SIZE)) {
+		return false;
+	}
+	if (pe->optional_size >= 2) {
+		ut16 magic = cli_read_le16(file->data + pe->optional);
+		if (magic != PE_MAGIC_PE32 && magic != PE_MAGIC_PE32_PLUS) {
+			return false;
+		}
+		pe->pe64 = magic == PE_MAGIC_PE32_PLUS;
+	}
+	return true;
+}
+
+static bool pe_rva_to_offset(const PeFile *pe, ut32 rva, ut64 *offset) {
+	const ut8 *section = pe->file->data + pe->sections;
+	for (ut32 i = 0; i < pe->n_sections; ++i, section += COFF_SECTION_SIZE) {
+		ut32 va = cli_read_le32(section + 12);
+		ut32 raw_size = cli_read_le32(section + 16);
+		ut32 raw_offset = cli_read_le32(section + 20);
+		if (rva >= va && rva - va < raw_size) {
+			*offset = (ut64)raw_offset + (rva - va);
+			return *offset < pe->file->size;
+		}
+	}
+	return false;
+}
+
+static bool pe_data_directory(const PeFile *pe, ut32 index, ut32 *rva, ut32 *size) {
+	ut32 count_offset = pe->pe64 ? 108 : 92;
+	ut32 entry = (pe->pe64 ? 112 : 96) + index * 8;
+	if (pe->optional_size < entry + 8 || index >= cli_read_le32(pe->file->data + pe->optional + count_offset)) {
+		return false;
+	}
+	*rva = cli_read_le32(pe->file->data + pe->optional + entry);
+	*size = cli_read_le32(pe->file->data + pe->optional + entry + 4);
+	return *rva && *size;
+}
+
+static bool pe_add_rva_name(const PeFile *pe, CliSymbols *symbols, ut32 rva) {
+	ut64 offset;
+	size_t max_length;
+	const char *name;
+	if (!pe_rva_to_offset(pe, rva, &offset) || !(name = cli_file_string(pe->file, offset, &max_length))) {
+		// broken entries are skipped
+		return true;
+	}
+	return cli_symbols_add(symbols, name, max_length);
+}
+
+static bool pe_symbol_table(const PeFile *pe, CliSymbols *symbols) {
+	const CliFile *file = pe->file;
+	ut32 symtab = cli_read_le32(file->data + pe->coff + 8);
+	ut32 n_symbols = cli_read_le32(file->data + pe->coff + 12);
+	if (!symtab || !n_symbols) {
+		return true;
+	}
+	ut64 strtab = symtab + (ut64)n_symbols * COFF_SYMBOL_SIZE;
+	ut32 strtab_size = pe_in_file(file, strtab, 4) ? cli_read_le32(file->data + strtab) : 0;
+	if (!pe_in_file(file, strtab, strtab_size)) {
+		strtab_size = file->size - strtab;
+	}
+
+	for (ut32 i = 0; i < n_symbols; ++i) {
+		const ut8 *symbol = file->data + symtab + (ut64)i * COFF_SYMBOL_SIZE;
+		// skips the auxiliary records (i.e. the file name of C_FILE)
+		ut8 storage = symbol[16];
+		i += symbol[17];
+		if (storage == COFF_STORAGE_FILE) {
+			continue;
+		}
+		const char *name = (const char *)symbol;
+		size_t max_length = 8;
+		if (!cli_read_le32(symbol)) {
+			ut32 offset = cli_read_le32(symbol + 4);
+			if (offset < 4 || offset >= strtab_size) {
+				continue;
+			}
+			name = (const char *)file->data + strtab + offset;
+			max_length = strtab_size - offset;
+		}
+		if (!cli_symbols_add(symbols, name, max_length)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+static bool pe_exports(const PeFile *pe, CliSymbols *symbols) {
+	ut32 rva, size;
+	ut64 offset;
+	if (!pe_data_directory(pe, PE_DIR_EXPORT, &rva, &size) || !pe_rva_to_offset(pe, rva, &offset) || !pe_in_file(pe->file, offset, 40)) {
+		return true;
+	}
+	const ut8 *directory = pe->file->data + offset;
+	ut32 n_names = cli_read_le32(directory + 24);
+	ut64 names;
+	if (!pe_rva_to_offset(pe, cli_read_le32(directory + 32), &names) || !pe_in_file(pe->file, names, (ut64)n_names * 4)) {
+		return true;
+	}
+	for (ut32 i = 0; i < n_names; ++i) {
+		if (!pe_add_rva_name(pe, symbols, cli_read_le32(pe->file->data + names + i * 4))) {
+			return false;
+		}
+	}
+	return true;
+}
+
+/**
+ * \brief Walks an import name table: a list of hint/name RVAs or ordinals
+ * terminated by zero.
+ */
+static bool pe_import_names(const PeFile *pe, CliSymbols *symbols, ut32 table_rva) {
+	ut32 entry_size = pe->pe64 ? 8 : 4;
+	ut64 table;
+	if (!pe_rva_to_offset(pe, table_rva, &table)) {
+		return true;
+	}
+	for (; pe_in_file(pe->file, table, entry_size); table += entry_size) {
+		ut64 entry = pe->pe64 ? cli_read_le64(pe->file->data + table) : cli_read_le32(pe->file->data + table);
+		ut64 ordinal_flag = pe->pe64 ? (1ull << 63) : (1ull << 31);
+		if (!entry) {
+			break;
+		} else if (entry & ordinal_flag) {
+			continue;
+		}
+		// skips the 2 bytes hint
+		if (!pe_add_rva_name(pe, symbols, (ut32)(entry & 0x7fffffff) + 2)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+static bool pe_imports(const PeFile *pe, CliSymbols *symbols) {
+	ut32 rva, size;
+	ut64 offset;
+	if (!pe_data_directory(pe, PE_DIR_IMPORT, &rva, &size) || !pe_rva_to_offset(pe, rva, &offset)) {
+		return true;
+	}
+	for (; pe_in_file(pe->file, offset, PE_IMPORT_SIZE); offset += PE_IMPORT_SIZE) {
+		const ut8 *descriptor = pe->file->data + offset;
+		ut32 lookup = cli_read_le32(descriptor);
+		ut32 thunks = cli_read_le32(descriptor + 16);
+		if (!lookup && !thunks) {
+			break;
+		} else if (!pe_import_names(pe, symbols, lookup ? lookup : thunks)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+static bool pe_delay_imports(const PeFile *pe, CliSymbols *symbols) {
+	ut32 rva, size;
+	ut64 offset;
+	if (!pe_data_directory(pe, PE_DIR_DELAY_IMPORT, &rva, &size) || !pe_rva_to_offset(pe, rva, &offset)) {
+		return true;
+	}
+	for (; pe_in_file(pe->file, offset, PE_DELAY_IMPORT_SIZE); offset += PE_DELAY_IMPORT_SIZE) {
+		const ut8 *descriptor = pe->file->data + offset;
+		ut32 attributes = cli_read_le32(descriptor);
+		ut32 names = cli_read_le32(descriptor + 16);
+		if (!cli_read_le32(descriptor + 4)) {
+			break;
+		} else if (!(attributes & 1)) {
+			// the old format uses virtual addresses, which are not supported.
+			continue;
+		} else if (!pe_import_names(pe, symbols, names)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+bool cli_pe_detect(const CliFile *file) {
+	PeFile pe;
+	return pe_parse(file, &pe);
+}
+
+bool cli_pe_symbols(const CliFile *file, CliSymbols *symbols) {
+	PeFile pe;
+	if (!pe_parse(file, &pe) || !pe_symbol_table(&pe, symbols)) {
+		return false;
+	} else if (!pe.optional_size) {
+		// object file
+		return true;
+	}
+	return pe_exports(&pe, symbols) &&
+		pe_imports(&pe, symbols) &&
+		pe_delay_imports(&pe, symbols);
+}
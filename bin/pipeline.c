@@ -0,0 +1,494 @@
+// SPDX-FileCopyrightText: 2026 RizinOrg <info@rizin.re>
+// SPDX-License-Identifier: LGPL-3.0-only
+
+/**
+ * \file pipeline.c
+ *
+ * Pipelined demangling of a symbol per line stream.
+ *
+ * A reader thread splits the input in chunks of whole lines, the workers
+ * demangle the chunks and the writer thread prints them back in the input
+ * order. The chunks are allocated once and recycled: the reader takes them
+ * from the free queue, so at most a fixed number of chunks is in flight and
+ * their input and output buffers are reused.
+ *
+ * The queues are bounded lock-free rings; a thread finding its queue empty
+ * (or full) backs off by yielding and then sleeping.
+ *
+ * A regular file is mapped in memory and the chunks point into the mapping,
+ * any other input is read into the chunk buffers.
+ */
+
+#include "demangle.h"
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#define PIPELINE_CHUNK_SIZE (256 * 1024)
+#define PIPELINE_CACHE_LINE 64
+
+typedef struct {
+	size_t seq;
+	const char *input; ///< whole lines, in the buffer or in the mapped file
+	size_t input_size;
+	char *buffer;
+	size_t buffer_capacity;
+	CliBuffer output;
+} CliChunk;
+
+typedef struct {
+	size_t sequence; ///< (atomic)
+	CliChunk *chunk;
+} CliQueueCell;
+
+/* bounded multi producer, multi consumer queue */
+typedef struct {
+	CliQueueCell *cells;
+	size_t mask;
+	char pad0[PIPELINE_CACHE_LINE];
+	size_t head; ///< next cell to push (atomic)
+	char pad1[PIPELINE_CACHE_LINE];
+	size_t tail; ///< next cell to pop (atomic)
+	char pad2[PIPELINE_CACHE_LINE];
+} CliQueue;
+
+typedef struct {
+	RzDemangleCtx *ctx;
+	RzDemangleLang lang;
+	RzDemangleOpts opts;
+	CliOutput output;
+	CliStats *stats; ///< NULL when not collected
+	CliStats *worker_stats; ///< one per worker
+	size_t n_workers; ///< workers started (atomic)
+	FILE *in;
+	FILE *out;
+	const char *map; ///< the input file when mapped
+	size_t map_size;
+	size_t map_offset;
+	CliChunk *chunks;
+	size_t n_chunks;
+	CliQueue free_chunks;
+	CliQueue todo;
+	CliQueue done;
+	size_t n_read; ///< chunks produced by the reader (atomic)
+	bool eof; ///< set once n_read is final (atomic)
+	bool error; ///< (atomic)
+} CliPipeline;
+
+static bool queue_init(CliQueue *queue, size_t min_capacity) {
+	size_t capacity = 2;
+	while (capacity < min_capacity) {
+		capacity *= 2;
+	}
+	memset(queue, 0, sizeof(*queue));
+	queue->cells = calloc(capacity, sizeof(CliQueueCell));
+	if (!queue->cells) {
+		return false;
+	}
+	for (size_t i = 0; i < capacity; ++i) {
+		queue->cells[i].sequence = i;
+	}
+	queue->mask = capacity - 1;
+	return true;
+}
+
+/**
+ * \brief Pushes the chunk; returns false when the queue is full.
+ *
+ * Each cell sequence tells whose turn it is: a producer owns the cell when
+ * the sequence equals its position, a consumer when it equals position + 1.
+ */
+static bool queue_push(CliQueue *queue, CliChunk *chunk) {
+	size_t pos = __atomic_load_n(&queue->head, __ATOMIC_RELAXED);
+	CliQueueCell *cell;
+	for (;;) {
+		cell = &queue->cells[pos & queue->mask];
+		size_t sequence = __atomic_load_n(&cell->sequence, __ATOMIC_ACQUIRE);
+		intptr_t diff = (intptr_t)sequence - (intptr_t)pos;
+		if (!diff) {
+			if (__atomic_compare_exchange_n(&queue->head, &pos, pos + 1, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+				break;
+			}
+		} else if (diff < 0) {
+			return false;
+		} else {
+			pos = __atomic_load_n(&queue->head, __ATOMIC_RELAXED);
+		}
+	}
+	cell->chunk = chunk;
+	__atomic_store_n(&cell->sequence, pos + 1, __ATOMIC_RELEASE);
+	return true;
+}
+
+/**
+ * \brief Pops a chunk; returns NULL when the queue is empty.
+ */
+static CliChunk *queue_pop(CliQueue *queue) {
+	size_t pos = __atomic_load_n(&queue->tail, __ATOMIC_RELAXED);
+	CliQueueCell *cell;
+	for (;;) {
+		cell = &queue->cells[pos & queue->mask];
+		size_t sequence = __atomic_load_n(&cell->sequence, __ATOMIC_ACQUIRE);
+		intptr_t diff = (intptr_t)sequence - (intptr_t)(pos + 1);
+		if (!diff) {
+			if (__atomic_compare_exchange_n(&queue->tail, &pos, pos + 1, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+				break;
+			}
+		} else if (diff < 0) {
+			return NULL;
+		} else {
+			pos = __atomic_load_n(&queue->tail, __ATOMIC_RELAXED);
+		}
+	}
+	CliChunk *chunk = cell->chunk;
+	__atomic_store_n(&cell->sequence, pos + queue->mask + 1, __ATOMIC_RELEASE);
+	return chunk;
+}
+
+static void backoff(unsigned *attempts) {
+	if (++*attempts < 64) {
+		sched_yield();
+		return;
+	}
+	struct timespec ts = { 0, 50 * 1000 };
+	nanosleep(&ts, NULL);
+}
+
+static bool pipeline_failed(CliPipeline *pipeline) {
+	return __atomic_load_n(&pipeline->error, __ATOMIC_ACQUIRE);
+}
+
+static void pipeline_fail(CliPipeline *pipeline) {
+	__atomic_store_n(&pipeline->error, true, __ATOMIC_RELEASE);
+}
+
+/**
+ * \brief Returns a free chunk, or NULL when the pipeline failed.
+ */
+static CliChunk *pipeline_free_chunk(CliPipeline *pipeline) {
+	CliChunk *chunk;
+	unsigned attempts = 0;
+	while (!(chunk = queue_pop(&pipeline->free_chunks))) {
+		if (pipeline_failed(pipeline)) {
+			return NULL;
+		}
+		backoff(&attempts);
+	}
+	return chunk;
+}
+
+static bool buffer_reserve(char **buffer, size_t *capacity, size_t size) {
+	if (size <= *capacity) {
+		return true;
+	}
+	size_t new_capacity = *capacity ? *capacity : PIPELINE_CHUNK_SIZE;
+	while (new_capacity < size) {
+		new_capacity *= 2;
+	}
+	char *tmp = realloc(*buffer, new_capacity);
+	if (!tmp) {
+		return false;
+	}
+	*buffer = tmp;
+	*capacity = new_capacity;
+	return true;
+}
+
+/**
+ * \brief Fills the chunk with the whole lines read from the stream; the
+ * partial line at the end is kept in \p carry for the next chunk.
+ */
+static bool reader_fill(CliPipeline *pipeline, CliChunk *chunk, char **carry, size_t *carry_size, size_t *carry_capacity, bool *eof) {
+	// room for the carried partial line and for reading at least as much
+	if (!buffer_reserve(&chunk->buffer, &chunk->buffer_capacity, *carry_size * 2 + 1)) {
+		return false;
+	}
+	if (*carry_size) {
+		memcpy(chunk->buffer, *carry, *carry_size);
+	}
+	size_t size = *carry_size;
+	size_t scanned = 0;
+	*carry_size = 0;
+	for (;;) {
+		size += fread(chunk->buffer + size, 1, chunk->buffer_capacity - size, pipeline->in);
+		const char *last = NULL;
+		for (const char *p = chunk->buffer + scanned; (p = memchr(p, '\n', chunk->buffer + size - p)); ++p) {
+			last = p;
+		}
+		if (ferror(pipeline->in)) {
+			return false;
+		} else if (feof(pipeline->in)) {
+			*eof = true;
+			break;
+		} else if (last) {
+			*carry_size = chunk->buffer + size - (last + 1);
+			if (!buffer_reserve(carry, carry_capacity, *carry_size)) {
+				return false;
+			}
+			memcpy(*carry, last + 1, *carry_size);
+			size = last + 1 - chunk->buffer;
+			break;
+		}
+		// a line longer than the buffer
+		scanned = size;
+		if (size == chunk->buffer_capacity && !buffer_reserve(&chunk->buffer, &chunk->buffer_capacity, size * 2)) {
+			return false;
+		}
+	}
+	chunk->input = chunk->buffer;
+	chunk->input_size = size;
+	return true;
+}
+
+/**
+ * \brief Points the chunk to the next lines of the mapped file.
+ */
+static void reader_map(CliPipeline *pipeline, CliChunk *chunk, bool *eof) {
+	const char *start = pipeline->map + pipeline->map_offset;
+	size_t left = pipeline->map_size - pipeline->map_offset;
+	size_t size = RZ_MIN(left, (size_t)PIPELINE_CHUNK_SIZE);
+	const char *nl = memchr(start + size, '\n', left - size);
+	size = nl ? (size_t)(nl + 1 - start) : left;
+	chunk->input = start;
+	chunk->input_size = size;
+	pipeline->map_offset += size;
+	*eof = pipeline->map_offset >= pipeline->map_size;
+}
+
+static void *reader_main(void *user) {
+	CliPipeline *pipeline = user;
+	char *carry = NULL;
+	size_t carry_size = 0, carry_capacity = 0;
+	size_t seq = 0;
+	bool eof = pipeline->map && pipeline->map_offset >= pipeline->map_size;
+	while (!eof) {
+		CliChunk *chunk = pipeline_free_chunk(pipeline);
+		if (!chunk) {
+			break;
+		}
+		if (pipeline->map) {
+			reader_map(pipeline, chunk, &eof);
+		} else if (!reader_fill(pipeline, chunk, &carry, &carry_size, &carry_capacity, &eof)) {
+			pipeline_fail(pipeline);
+			break;
+		}
+		if (!chunk->input_size) {
+			queue_push(&pipeline->free_chunks, chunk);
+			continue;
+		}
+		chunk->seq = seq++;
+		// never full: the queues can hold all the chunks
+		queue_push(&pipeline->todo, chunk);
+		__atomic_store_n(&pipeline->n_read, seq, __ATOMIC_RELEASE);
+	}
+	free(carry);
+	__atomic_store_n(&pipeline->eof, true, __ATOMIC_RELEASE);
+	return NULL;
+}
+
+static bool worker_append(CliChunk *chunk, const char *text, size_t length) {
+	return cli_buffer_append(&chunk->output, text, length) && cli_buffer_append(&chunk->output, "\n", 1);
+}
+
+/**
+ * \brief Demangles the lines of the chunk into its output buffer; the lines
+ * are copied (NUL terminated) in \p line, the input may be read-only.
+ */
+static bool worker_demangle(CliPipeline *pipeline, CliChunk *chunk, CliStats *stats, char **line, size_t *line_capacity) {
+	chunk->output.size = 0;
+	const char *p = chunk->input;
+	const char *end = chunk->input + chunk->input_size;
+	while (p < end) {
+		const char *nl = memchr(p, '\n', end - p);
+		const char *next = nl ? nl + 1 : end;
+		size_t length = (nl ? nl : end) - p;
+		const char *cr = memchr(p, '\r', length);
+		length = cr ? (size_t)(cr - p) : length;
+		if (!buffer_reserve(line, line_capacity, length + 1)) {
+			return false;
+		}
+		memcpy(*line, p, length);
+		(*line)[length] = 0;
+		CliRecord record = { 0 };
+		record.input = *line;
+		record.input_length = length;
+		record.lang = pipeline->lang;
+		cli_record_demangle(pipeline->ctx, pipeline->output, pipeline->opts, stats, &record, *line);
+		bool res;
+		if (pipeline->output != CLI_OUTPUT_TEXT) {
+			res = cli_json_record(&chunk->output, &record);
+		} else if (record.result) {
+			res = worker_append(chunk, record.result, strlen(record.result));
+		} else {
+			res = worker_append(chunk, *line, length);
+		}
+		free(record.result);
+		if (!res) {
+			return false;
+		}
+		p = next;
+	}
+	return true;
+}
+
+static void *worker_main(void *user) {
+	CliPipeline *pipeline = user;
+	size_t index = __atomic_fetch_add(&pipeline->n_workers, 1, __ATOMIC_RELAXED);
+	CliStats *stats = pipeline->stats ? &pipeline->worker_stats[index] : NULL;
+	char *line = NULL;
+	size_t line_capacity = 0;
+	unsigned attempts = 0;
+	while (!pipeline_failed(pipeline)) {
+		bool eof = __atomic_load_n(&pipeline->eof, __ATOMIC_ACQUIRE);
+		CliChunk *chunk = queue_pop(&pipeline->todo);
+		if (!chunk) {
+			if (eof) {
+				break;
+			}
+			backoff(&attempts);
+			continue;
+		}
+		attempts = 0;
+		if (!worker_demangle(pipeline, chunk, stats, &line, &line_capacity)) {
+			pipeline_fail(pipeline);
+			break;
+		}
+		queue_push(&pipeline->done, chunk);
+	}
+	free(line);
+	return NULL;
+}
+
+/**
+ * \brief Prints the chunks in the input order, reordering them via a window
+ * indexed by their sequence number (at most n_chunks are in flight).
+ */
+static void writer_run(CliPipeline *pipeline) {
+	CliChunk **window = calloc(pipeline->n_chunks, sizeof(CliChunk *));
+	if (!window) {
+		pipeline_fail(pipeline);
+		return;
+	}
+	size_t next = 0;
+	unsigned attempts = 0;
+	while (!pipeline_failed(pipeline)) {
+		bool eof = __atomic_load_n(&pipeline->eof, __ATOMIC_ACQUIRE);
+		if (eof && next == __atomic_load_n(&pipeline->n_read, __ATOMIC_ACQUIRE)) {
+			break;
+		}
+		CliChunk *chunk = queue_pop(&pipeline->done);
+		if (!chunk) {
+			backoff(&attempts);
+			continue;
+		}
+		attempts = 0;
+		window[chunk->seq % pipeline->n_chunks] = chunk;
+		while ((chunk = window[next % pipeline->n_chunks]) && chunk->seq == next) {
+			window[next % pipeline->n_chunks] = NULL;
+			if (fwrite(chunk->output.data, 1, chunk->output.size, pipeline->out) != chunk->output.size) {
+				pipeline_fail(pipeline);
+				break;
+			}
+			queue_push(&pipeline->free_chunks, chunk);
+			next++;
+		}
+	}
+	free(window);
+}
+
+static void pipeline_map_input(CliPipeline *pipeline) {
+	int fd = fileno(pipeline->in);
+	struct stat st;
+	off_t offset = lseek(fd, 0, SEEK_CUR);
+	if (fd < 0 || fstat(fd, &st) || !S_ISREG(st.st_mode) || offset < 0 || offset >= st.st_size) {
+		return;
+	}
+	void *map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	if (map == MAP_FAILED) {
+		return;
+	}
+	posix_madvise(map, st.st_size, POSIX_MADV_SEQUENTIAL);
+	pipeline->map = map;
+	pipeline->map_size = st.st_size;
+	pipeline->map_offset = offset;
+}
+
+/**
+ * \brief Demangles one symbol per line from \p in to \p out, in order, via
+ * a reader, \p n_workers workers and a writer thread (the calling one).
+ */
+int cli_pipeline_demangle(RzDemangleCtx *ctx, RzDemangleLang lang, RzDemangleOpts opts, CliOutput output, CliStats *stats, size_t n_workers, FILE *in, FILE *out) {
+	CliPipeline pipeline = { 0 };
+	pipeline.ctx = ctx;
+	pipeline.lang = lang;
+	pipeline.opts = opts;
+	pipeline.output = output;
+	pipeline.stats = stats;
+	pipeline.in = in;
+	pipeline.out = out;
+	// enough chunks to keep every stage busy
+	pipeline.n_chunks = 2 * n_workers + 2;
+	pthread_t *workers = calloc(n_workers, sizeof(pthread_t));
+	pipeline.chunks = calloc(pipeline.n_chunks, sizeof(CliChunk));
+	pthread_t reader;
+	size_t n_started = 0;
+	bool reader_started = false;
+	int ret = 1;
+	pipeline.worker_stats = stats ? calloc(n_workers, sizeof(CliStats)) : NULL;
+	if (!workers || !pipeline.chunks || (stats && !pipeline.worker_stats) || !queue_init(&pipeline.free_chunks, pipeline.n_chunks) ||
+		!queue_init(&pipeline.todo, pipeline.n_chunks) || !queue_init(&pipeline.done, pipeline.n_chunks)) {
+		fprintf(stderr, "error: cannot allocate the pipeline\n");
+		goto end;
+	}
+	for (size_t i = 0; i < pipeline.n_chunks; ++i) {
+		queue_push(&pipeline.free_chunks, &pipeline.chunks[i]);
+	}
+	pipeline_map_input(&pipeline);
+
+	if (pthread_create(&reader, NULL, reader_main, &pipeline)) {
+		fprintf(stderr, "error: cannot start the pipeline\n");
+		goto end;
+	}
+	reader_started = true;
+	for (; n_started < n_workers; ++n_started) {
+		if (pthread_create(&workers[n_started], NULL, worker_main, &pipeline)) {
+			pipeline_fail(&pipeline);
+			break;
+		}
+	}
+	if (n_started) {
+		writer_run(&pipeline);
+	}
+	ret = pipeline_failed(&pipeline) || fflush(out) ? 1 : 0;
+
+end:
+	if (ret) {
+		pipeline_fail(&pipeline);
+	}
+	if (reader_started) {
+		pthread_join(reader, NULL);
+	}
+	for (size_t i = 0; i < n_started; ++i) {
+		pthread_join(workers[i], NULL);
+		if (stats) {
+			cli_stats_merge(stats, &pipeline.worker_stats[i]);
+		}
+	}
+	if (pipeline.map) {
+		munmap((void *)pipeline.map, pipeline.map_size);
+	}
+	for (size_t i = 0; pipeline.chunks && i < pipeline.n_chunks; ++i) {
+		free(pipeline.chunks[i].buffer);
+		cli_buffer_fini(&pipeline.chunks[i].output);
+	}
+	free(pipeline.chunks);
+	free(pipeline.free_chunks.cells);
+	free(pipeline.todo.cells);
+	free(pipeline.done.cells);
+	free(pipeline.worker_stats);
+	free(workers);
+	return ret;
+}
@@ -0,0 +1,134 @@
+// SPDX-FileCopyrightText: 2026 RizinOrg <info@rizin.re>
+// SPDX-License-Identifier: LGPL-3.0-only
+
+/**
+ * \file replay.c
+ *
+ * Replay benchmark of a corpus captured in production (see --capture).
+ *
+ * The corpus is mapped by the library and its symbols are demangled straight
+ * by the language handlers, bypassing the caches of a context, so that the
+ * numbers measure the engines. With -j the threads grab chunks of records
+ * via an atomic cursor; every call is timed and each thread collects the
+ * stats of each language, merged at the end.
+ */
+
+#include "demangle.h"
+#include <pthread.h>
+
+#define REPLAY_CHUNK_SIZE 256
+
+typedef struct {
+	const RzDemangleCorpusEntry *entries;
+	size_t n_entries;
+	size_t cursor; ///< (atomic) next record to grab
+} CliReplay;
+
+typedef struct {
+	CliReplay *replay;
+	pthread_t thread;
+	CliStats stats[RZ_DEMANGLE_LANG_MAX + 1];
+} CliReplayWorker;
+
+static void *replay_worker(void *user) {
+	CliReplayWorker *worker = user;
+	CliReplay *replay = worker->replay;
+	for (;;) {
+		size_t start = __atomic_fetch_add(&replay->cursor, REPLAY_CHUNK_SIZE, __ATOMIC_RELAXED);
+		if (start >= replay->n_entries) {
+			break;
+		}
+		size_t end = RZ_MIN(start + REPLAY_CHUNK_SIZE, replay->n_entries);
+		for (size_t i = start; i < end; ++i) {
+			const RzDemangleCorpusEntry *entry = &replay->entries[i];
+			ut64 begin = cli_time_ns();
+			char *result = libdemangle_handler(entry->lang, entry->symbol, entry->opts);
+			ut64 ns = cli_time_ns() - begin;
+			cli_stats_add(&worker->stats[entry->lang], entry->lang, entry->length, result != NULL, ns);
+			free(result);
+		}
+	}
+	return NULL;
+}
+
+static void replay_print(const CliStats *langs, size_t n_threads, ut64 input_size, ut64 wall_ns, FILE *out) {
+	CliStats *total = RZ_NEW0(CliStats);
+	if (!total) {
+		return;
+	}
+	for (size_t i = 0; i <= RZ_DEMANGLE_LANG_MAX; ++i) {
+		cli_stats_merge(total, &langs[i]);
+	}
+	fprintf(out, "threads: %" PFMTSZu ", input: %.1f MB, %.1f MB/s\n", n_threads, input_size / 1e6,
+		wall_ns ? (double)input_size * 1e3 / (double)wall_ns : 0.0);
+	cli_stats_print(total, NULL, wall_ns, out);
+	free(total);
+
+	fprintf(out, "%-10s %12s %12s %12s %12s %12s\n", "lang", "mean ns", "p50 ns", "p99 ns", "p99.9 ns", "max ns");
+	for (size_t i = 0; i <= RZ_DEMANGLE_LANG_MAX; ++i) {
+		const CliStats *stats = &langs[i];
+		ut64 n = stats->demangled[i] + stats->failed[i];
+		if (!n) {
+			continue;
+		}
+		const char *name = i < RZ_DEMANGLE_LANG_MAX ? libdemangle_lang_name(i) : NULL;
+		fprintf(out, "%-10s %12llu %12llu %12llu %12llu %12llu\n", name ? name : "unknown",
+			(unsigned long long)(stats->ns[i] / n), (unsigned long long)cli_stats_percentile(stats, 0.5),
+			(unsigned long long)cli_stats_percentile(stats, 0.99), (unsigned long long)cli_stats_percentile(stats, 0.999),
+			(unsigned long long)stats->max_ns);
+	}
+}
+
+/**
+ * \brief Demangles every symbol of the corpus file with \p n_threads threads
+ * (the caller included) and prints the throughput and the latency per
+ * language.
+ */
+int cli_replay(const char *path, size_t n_threads, FILE *out) {
+	CliReplay replay = { 0 };
+	CliReplayWorker *workers = NULL;
+	int ret = 1;
+	RzDemangleCorpus *corpus = libdemangle_corpus_open(path);
+	if (!corpus) {
+		fprintf(stderr, "error: cannot open the corpus '%s'\n", path);
+		return 1;
+	}
+	replay.entries = libdemangle_corpus_entries(corpus, &replay.n_entries);
+	n_threads = n_threads ? n_threads : 1;
+	if (!(workers = calloc(n_threads, sizeof(CliReplayWorker)))) {
+		fprintf(stderr, "error: cannot allocate the replay\n");
+		goto end;
+	}
+	ut64 input_size = 0;
+	for (size_t i = 0; i < replay.n_entries; ++i) {
+		input_size += replay.entries[i].length;
+	}
+
+	ut64 start = cli_time_ns();
+	size_t n_started = 1;
+	for (; n_started < n_threads; ++n_started) {
+		workers[n_started].replay = &replay;
+		if (pthread_create(&workers[n_started].thread, NULL, replay_worker, &workers[n_started])) {
+			break;
+		}
+	}
+	workers[0].replay = &replay;
+	replay_worker(&workers[0]);
+	for (size_t i = 1; i < n_started; ++i) {
+		pthread_join(workers[i].thread, NULL);
+	}
+	ut64 wall_ns = cli_time_ns() - start;
+
+	for (size_t i = 1; i < n_started; ++i) {
+		for (size_t l = 0; l <= RZ_DEMANGLE_LANG_MAX; ++l) {
+			cli_stats_merge(&workers[0].stats[l], &workers[i].stats[l]);
+		}
+	}
+	replay_print(workers[0].stats, n_started, input_size, wall_ns, out);
+	ret = 0;
+
+end:
+	free(workers);
+	libdemangle_corpus_close(corpus);
+	return ret;
+}
@@ -0,0 +1,561 @@
+// SPDX-FileCopyrightText: 2026 RizinOrg <info@rizin.re>
+// SPDX-License-Identifier: LGPL-3.0-only
+
+/**
+ * \file server.c
+ *
+ * Demangle daemon (--listen) and its client (--connect).
+ *
+ * The daemon keeps a single demangle context (worker pool, in-memory and
+ * optional persistent caches) alive across all the clients, thus repeated
+ * invocations do not pay the start-up cost and share every result.
+ *
+ * Each client sends batches of symbols and can pipeline up to
+ * CLIENT_WINDOW requests before waiting for the replies, which are sent
+ * back in the same order. All the integers are little endian u32.
+ *
+ * request:  frame_size, id, lang (u8), reserved (u8), opts (u16), n_symbols,
+ *           n_symbols * { length, bytes }
+ * response: frame_size, id, n_symbols,
+ *           n_symbols * { length, bytes } (length UT32_MAX on failure)
+ *
+ * frame_size is the number of bytes which follow the field itself.
+ */
+
+#include "demangle.h"
+#include <errno.h>
+#include <pthread.h>
+#include <signal.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#define SERVER_MAX_FRAME   (64u << 20)
+#define SERVER_MAX_SYMBOLS (1u << 16)
+#define REQUEST_HEADER     12
+#define RESPONSE_HEADER    8
+#define CLIENT_WINDOW      4
+
+typedef struct server_client_t {
+	int fd;
+	RzDemangleCtx *ctx;
+	struct server_client_t *next;
+} ServerClient;
+
+typedef struct {
+	pthread_mutex_t lock;
+	pthread_cond_t gone;
+	ServerClient *clients;
+} Server;
+
+typedef struct {
+	char **lines;
+	size_t n_lines;
+	ut32 id;
+} ClientRequest;
+
+typedef struct {
+	int fd;
+	RzDemangleLang lang;
+	RzDemangleOpts opts;
+	FILE *in;
+	pthread_mutex_t lock;
+	pthread_cond_t cond;
+	ClientRequest window[CLIENT_WINDOW];
+	size_t head;
+	size_t count;
+	bool eof;
+	bool error;
+} Client;
+
+static volatile sig_atomic_t server_stop = 0;
+static int server_fd = -1;
+
+static bool io_read(int fd, void *buffer, size_t size) {
+	ut8 *p = buffer;
+	while (size > 0) {
+		ssize_t n = read(fd, p, size);
+		if (n < 0 && errno == EINTR) {
+			continue;
+		} else if (n <= 0) {
+			return false;
+		}
+		p += n;
+		size -= n;
+	}
+	return true;
+}
+
+static bool io_write(int fd, const void *buffer, size_t size) {
+	const ut8 *p = buffer;
+	while (size > 0) {
+		ssize_t n = send(fd, p, size, MSG_NOSIGNAL);
+		if (n < 0 && errno == EINTR) {
+			continue;
+		} else if (n <= 0) {
+			return false;
+		}
+		p += n;
+		size -= n;
+	}
+	return true;
+}
+
+/**
+ * \brief Reads a whole frame; \p frame is grown when needed.
+ */
+static bool io_read_frame(int fd, ut8 **frame, size_t *capacity, ut32 *frame_size) {
+	ut8 size[4];
+	if (!io_read(fd, size, sizeof(size))) {
+		return false;
+	}
+	*frame_size = cli_read_le32(size);
+	if (*frame_size > SERVER_MAX_FRAME) {
+		return false;
+	} else if (*frame_size > *capacity) {
+		ut8 *tmp = realloc(*frame, *frame_size);
+		if (!tmp) {
+			return false;
+		}
+		*frame = tmp;
+		*capacity = *frame_size;
+	}
+	return io_read(fd, *frame, *frame_size);
+}
+
+static void server_signal(int sig) {
+	server_stop = 1;
+	// any thread may receive the signal, this wakes up accept() anyway.
+	shutdown(server_fd, SHUT_RDWR);
+}
+
+/**
+ * \brief Parses the request, demangles it and sends back the response.
+ */
+static bool server_serve(ServerClient *client, const ut8 *frame, ut32 frame_size) {
+	if (frame_size < REQUEST_HEADER) {
+		return false;
+	}
+	ut32 id = cli_read_le32(frame);
+	RzDemangleLang lang = frame[4];
+	RzDemangleOpts opts = frame[6] | (frame[7] << 8);
+	ut32 n_symbols = cli_read_le32(frame + 8);
+	if (n_symbols > SERVER_MAX_SYMBOLS) {
+		return false;
+	}
+
+	RzDemangleBatch batch = { 0 };
+	batch.lang = lang;
+	batch.opts = opts;
+	batch.n_symbols = n_symbols;
+	const char **symbols = calloc(n_symbols + 1, sizeof(char *));
+	char **results = calloc(n_symbols + 1, sizeof(char *));
+	// each symbol is preceded by 4 bytes of length, thus fits with its terminator.
+	char *pool = malloc(frame_size);
+	ut8 *response = NULL;
+	bool res = false;
+	if (!symbols || !results || !pool) {
+		goto end;
+	}
+
+	const ut8 *p = frame + REQUEST_HEADER;
+	const ut8 *frame_end = frame + frame_size;
+	char *pool_p = pool;
+	for (ut32 i = 0; i < n_symbols; ++i) {
+		if (frame_end - p < 4) {
+			goto end;
+		}
+		ut32 length = cli_read_le32(p);
+		p += 4;
+		if ((size_t)(frame_end - p) < length) {
+			goto end;
+		}
+		memcpy(pool_p, p, length);
+		pool_p[length] = 0;
+		symbols[i] = pool_p;
+		pool_p += length + 1;
+		p += length;
+	}
+
+	batch.symbols = symbols;
+	batch.results = results;
+	if (lang < RZ_DEMANGLE_LANG_MAX && !libdemangle_batch_unique(client->ctx, &batch)) {
+		goto end;
+	}
+
+	size_t size = 4 + RESPONSE_HEADER;
+	for (ut32 i = 0; i < n_symbols; ++i) {
+		size += 4 + (results[i] ? strlen(results[i]) : 0);
+	}
+	if (size - 4 > UT32_MAX || !(response = malloc(size))) {
+		goto end;
+	}
+	cli_write_le32(response, (ut32)(size - 4));
+	cli_write_le32(response + 4, id);
+	cli_write_le32(response + 8, n_symbols);
+	ut8 *r = response + 4 + RESPONSE_HEADER;
+	for (ut32 i = 0; i < n_symbols; ++i) {
+		if (!results[i]) {
+			cli_write_le32(r, UT32_MAX);
+			r += 4;
+			continue;
+		}
+		size_t length = strlen(results[i]);
+		cli_write_le32(r, (ut32)length);
+		memcpy(r + 4, results[i], length);
+		r += 4 + length;
+	}
+	res = io_write(client->fd, response, size);
+
+end:
+	if (results) {
+		cli_free_lines(results, n_symbols);
+	}
+	free(response);
+	free(results);
+	free(symbols);
+	free(pool);
+	return res;
+}
+
+typedef struct {
+	Server *server;
+	ServerClient *client;
+} ServerThread;
+
+static void *server_client_main(void *user) {
+	ServerThread *thread = user;
+	Server *server = thread->server;
+	ServerClient *client = thread->client;
+	free(thread);
+
+	ut8 *frame = NULL;
+	size_t capacity = 0;
+	ut32 frame_size = 0;
+	while (io_read_frame(client->fd, &frame, &capacity, &frame_size) &&
+		server_serve(client, frame, frame_size)) {
+	}
+	free(frame);
+
+	pthread_mutex_lock(&server->lock);
+	ServerClient **p = &server->clients;
+	while (*p != client) {
+		p = &(*p)->next;
+	}
+	*p = client->next;
+	pthread_cond_broadcast(&server->gone);
+	pthread_mutex_unlock(&server->lock);
+	close(client->fd);
+	free(client);
+	return NULL;
+}
+
+static bool server_add_client(Server *server, int fd, RzDemangleCtx *ctx) {
+	ServerClient *client = RZ_NEW0(ServerClient);
+	ServerThread *thread = RZ_NEW0(ServerThread);
+	if (!client || !thread) {
+		goto fail;
+	}
+	client->fd = fd;
+	client->ctx = ctx;
+	thread->server = server;
+	thread->client = client;
+
+	pthread_mutex_lock(&server->lock);
+	client->next = server->clients;
+	server->clients = client;
+	pthread_mutex_unlock(&server->lock);
+
+	pthread_t tid;
+	if (!pthread_create(&tid, NULL, server_client_main, thread)) {
+		pthread_detach(tid);
+		return true;
+	}
+
+	pthread_mutex_lock(&server->lock);
+	server->clients = client->next;
+	pthread_mutex_unlock(&server->lock);
+
+fail:
+	free(client);
+	free(thread);
+	close(fd);
+	return false;
+}
+
+static bool socket_address(const char *path, struct sockaddr_un *addr) {
+	memset(addr, 0, sizeof(*addr));
+	addr->sun_family = AF_UNIX;
+	if (strlen(path) >= sizeof(addr->sun_path)) {
+		fprintf(stderr, "error: socket path '%s' is too long\n", path);
+		return false;
+	}
+	strcpy(addr->sun_path, path);
+	return true;
+}
+
+/**
+ * \brief Serves the clients connecting to \p path until SIGINT or SIGTERM.
+ */
+int cli_server_listen(const char *path, RzDemangleCtx *ctx) {
+	struct sockaddr_un addr;
+	if (!socket_address(path, &addr)) {
+		return 1;
+	}
+	int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (fd < 0) {
+		fprintf(stderr, "error: cannot create socket: %s\n", strerror(errno));
+		return 1;
+	}
+
+	struct stat st;
+	if (!stat(path, &st) && S_ISSOCK(st.st_mode)) {
+		if (!connect(fd, (struct sockaddr *)&addr, sizeof(addr))) {
+			fprintf(stderr, "error: a daemon is already listening on '%s'\n", path);
+			close(fd);
+			return 1;
+		}
+		// stale socket left by a daemon which did not exit cleanly.
+		unlink(path);
+	}
+	if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) || listen(fd, 64)) {
+		fprintf(stderr, "error: cannot listen on '%s': %s\n", path, strerror(errno));
+		close(fd);
+		return 1;
+	}
+
+	server_fd = fd;
+	struct sigaction sa = { 0 };
+	sa.sa_handler = server_signal;
+	sigaction(SIGINT, &sa, NULL);
+	sigaction(SIGTERM, &sa, NULL);
+
+	Server server = { 0 };
+	pthread_mutex_init(&server.lock, NULL);
+	pthread_cond_init(&server.gone, NULL);
+	while (!server_stop) {
+		int client_fd = accept(fd, NULL, NULL);
+		if (client_fd < 0) {
+			if (server_stop) {
+				break;
+			} else if (errno == EINTR || errno == ECONNABORTED) {
+				continue;
+			}
+			fprintf(stderr, "error: accept failed: %s\n", strerror(errno));
+			break;
+		}
+		server_add_client(&server, client_fd, ctx);
+	}
+	server_fd = -1;
+	close(fd);
+	unlink(path);
+
+	// the context is freed by the caller, thus waits for all the clients.
+	pthread_mutex_lock(&server.lock);
+	for (ServerClient *c = server.clients; c; c = c->next) {
+		shutdown(c->fd, SHUT_RDWR);
+	}
+	while (server.clients) {
+		pthread_cond_wait(&server.gone, &server.lock);
+	}
+	pthread_mutex_unlock(&server.lock);
+	pthread_cond_destroy(&server.gone);
+	pthread_mutex_destroy(&server.lock);
+	return 0;
+}
+
+static bool client_send(Client *client, const ClientRequest *request) {
+	size_t size = 4 + REQUEST_HEADER;
+	for (size_t i = 0; i < request->n_lines; ++i) {
+		size += 4 + strlen(request->lines[i]);
+	}
+	if (size - 4 > SERVER_MAX_FRAME) {
+		fprintf(stderr, "error: the symbols are too long\n");
+		return false;
+	}
+	ut8 *frame = malloc(size);
+	if (!frame) {
+		return false;
+	}
+	cli_write_le32(frame, (ut32)(size - 4));
+	cli_write_le32(frame + 4, request->id);
+	frame[8] = (ut8)client->lang;
+	frame[9] = 0;
+	frame[10] = client->opts & 0xff;
+	frame[11] = (client->opts >> 8) & 0xff;
+	cli_write_le32(frame + 12, (ut32)request->n_lines);
+	ut8 *p = frame + 4 + REQUEST_HEADER;
+	for (size_t i = 0; i < request->n_lines; ++i) {
+		size_t length = strlen(request->lines[i]);
+		cli_write_le32(p, (ut32)length);
+		memcpy(p + 4, request->lines[i], length);
+		p += 4 + length;
+	}
+	bool res = io_write(client->fd, frame, size);
+	free(frame);
+	return res;
+}
+
+/**
+ * \brief Reads stdin and sends the requests while the main thread
+ * receives the responses.
+ */
+static void *client_sender_main(void *user) {
+	Client *client = user;
+	for (ut32 id = 0;; ++id) {
+		pthread_mutex_lock(&client->lock);
+		while (client->count >= CLIENT_WINDOW && !client->error) {
+			pthread_cond_wait(&client->cond, &client->lock);
+		}
+		bool error = client->error;
+		pthread_mutex_unlock(&client->lock);
+		if (error) {
+			break;
+		}
+
+		ClientRequest request = { 0 };
+		request.id = id;
+		request.lines = calloc(CLI_BATCH_SIZE, sizeof(char *));
+		if (request.lines) {
+			request.n_lines = cli_read_lines(client->in, request.lines, CLI_BATCH_SIZE);
+		}
+		if (!request.n_lines) {
+			free(request.lines);
+			pthread_mutex_lock(&client->lock);
+			client->eof = true;
+			client->error = !request.lines || ferror(client->in);
+			pthread_cond_broadcast(&client->cond);
+			pthread_mutex_unlock(&client->lock);
+			break;
+		}
+
+		// queued before sending, the response may arrive immediately.
+		pthread_mutex_lock(&client->lock);
+		client->window[(client->head + client->count) % CLIENT_WINDOW] = request;
+		client->count++;
+		pthread_cond_broadcast(&client->cond);
+		pthread_mutex_unlock(&client->lock);
+
+		if (!client_send(client, &request)) {
+			pthread_mutex_lock(&client->lock);
+			client->error = true;
+			pthread_cond_broadcast(&client->cond);
+			pthread_mutex_unlock(&client->lock);
+			break;
+		}
+	}
+	shutdown(client->fd, SHUT_WR);
+	return NULL;
+}
+
+static bool client_receive(Client *client, const ClientRequest *request, FILE *out, ut8 **frame, size_t *capacity) {
+	ut32 frame_size = 0;
+	if (!io_read_frame(client->fd, frame, capacity, &frame_size) || frame_size < RESPONSE_HEADER) {
+		return false;
+	}
+	const ut8 *p = *frame;
+	const ut8 *frame_end = p + frame_size;
+	if (cli_read_le32(p) != request->id || cli_read_le32(p + 4) != request->n_lines) {
+		return false;
+	}
+	p += RESPONSE_HEADER;
+	for (size_t i = 0; i < request->n_lines; ++i) {
+		if (frame_end - p < 4) {
+			return false;
+		}
+		ut32 length = cli_read_le32(p);
+		p += 4;
+		if (length == UT32_MAX) {
+			fprintf(out, "%s\n", request->lines[i]);
+			continue;
+		} else if ((size_t)(frame_end - p) < length) {
+			return false;
+		}
+		fwrite(p, 1, length, out);
+		fputc('\n', out);
+		p += length;
+	}
+	return true;
+}
+
+/**
+ * \brief Demangles the symbols read from \p in via the daemon on \p path.
+ */
+int cli_server_connect(const char *path, RzDemangleLang lang, RzDemangleOpts opts, FILE *in, FILE *out) {
+	struct sockaddr_un addr;
+	if (!socket_address(path, &addr)) {
+		return 1;
+	}
+	// heap allocated, a sender blocked on the input may outlive this function.
+	Client *client = RZ_NEW0(Client);
+	if (!client) {
+		return 1;
+	}
+	client->lang = lang;
+	client->opts = opts;
+	client->in = in;
+	client->fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (client->fd < 0 || connect(client->fd, (struct sockaddr *)&addr, sizeof(addr))) {
+		fprintf(stderr, "error: cannot connect to '%s': %s\n", path, strerror(errno));
+		if (client->fd >= 0) {
+			close(client->fd);
+		}
+		free(client);
+		return 1;
+	}
+	pthread_mutex_init(&client->lock, NULL);
+	pthread_cond_init(&client->cond, NULL);
+
+	pthread_t sender;
+	if (pthread_create(&sender, NULL, client_sender_main, client)) {
+		close(client->fd);
+		free(client);
+		return 1;
+	}
+
+	ut8 *frame = NULL;
+	size_t capacity = 0;
+	bool received = true;
+	int ret = 0;
+	while (received) {
+		pthread_mutex_lock(&client->lock);
+		while (!client->count && !client->eof && !client->error) {
+			pthread_cond_wait(&client->cond, &client->lock);
+		}
+		if (!client->count) {
+			// the sender is done.
+			ret = client->error ? 1 : 0;
+			pthread_mutex_unlock(&client->lock);
+			break;
+		}
+		ClientRequest request = client->window[client->head];
+		pthread_mutex_unlock(&client->lock);
+
+		received = client_receive(client, &request, out, &frame, &capacity);
+		cli_free_lines(request.lines, request.n_lines);
+		free(request.lines);
+
+		pthread_mutex_lock(&client->lock);
+		client->head = (client->head + 1) % CLIENT_WINDOW;
+		client->count--;
+		client->error |= !received;
+		pthread_cond_broadcast(&client->cond);
+		pthread_mutex_unlock(&client->lock);
+	}
+	free(frame);
+
+	if (!received) {
+		fprintf(stderr, "error: invalid response from '%s'\n", path);
+		// the sender may be blocked on the input, thus it is left to the exit.
+		shutdown(client->fd, SHUT_RDWR);
+		pthread_detach(sender);
+		return 1;
+	}
+	pthread_join(sender, NULL);
+	close(client->fd);
+	pthread_cond_destroy(&client->cond);
+	pthread_mutex_destroy(&client->lock);
+	free(client);
+	return ret;
+}
@@ -0,0 +1,259 @@
+// SPDX-FileCopyrightText: 2026 RizinOrg <info@rizin.re>
+// SPDX-License-Identifier: LGPL-3.0-only
+
+/**
+ * \file stats.c
+ *
+ * Throughput and latency statistics of a run, printed as a summary at exit.
+ *
+ * Collecting is cheap enough to be always on: each symbol costs a couple of
+ * counters and a log-linear latency bucket (8 sub-buckets per power of two,
+ * so the percentiles are accurate within 12.5%). Every thread collects its
+ * own stats, which are merged at the end. The slowest symbols are kept by
+ * the sampler of the library attached to the context. The timing of each
+ * symbol, also reported by the timed JSON output, lives here too. The
+ * repeated symbols resolved by the deduplicated batches are not timed, they
+ * are counted apart and left out of the latencies.
+ */
+
+#include "demangle.h"
+#if __WINDOWS__
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+static size_t stats_latency_bucket(ut64 ns) {
+	if (ns < 8) {
+		return (size_t)ns;
+	}
+#if defined(__GNUC__)
+	size_t msb = 63 - __builtin_clzll(ns);
+#else
+	size_t msb = 0;
+	for (ut64 v = ns; v >>= 1;) {
+		msb++;
+	}
+#endif
+	return (msb - 2) * 8 + ((ns >> (msb - 3)) & 7);
+}
+
+/**
+ * \brief Returns the biggest latency falling in the bucket.
+ */
+static ut64 stats_latency_max(size_t bucket) {
+	if (bucket < 8) {
+		return bucket;
+	}
+	size_t shift = bucket / 8 - 1;
+	ut64 lower = (ut64)(8 + bucket % 8) << shift;
+	return lower + ((ut64)1 << shift) - 1;
+}
+
+static size_t stats_length_bucket(size_t length) {
+	size_t bucket = 0;
+	for (length >>= 4; length && bucket < CLI_STATS_LENGTHS - 1; length >>= 1) {
+		bucket++;
+	}
+	return bucket;
+}
+
+/**
+ * \brief Adds a symbol which took \p ns, UT64_MAX when it was resolved by an
+ * earlier copy of it (see libdemangle_batch_unique()).
+ */
+void cli_stats_add(CliStats *stats, RzDemangleLang lang, size_t length, bool demangled, ut64 ns) {
+	size_t l = lang < RZ_DEMANGLE_LANG_MAX ? lang : RZ_DEMANGLE_LANG_MAX;
+	if (demangled) {
+		stats->demangled[l]++;
+	} else {
+		stats->failed[l]++;
+	}
+	stats->lengths[stats_length_bucket(length)]++;
+	if (ns == UT64_MAX) {
+		stats->deduplicated++;
+		return;
+	}
+	stats->ns[l] += ns;
+	stats->latency[stats_latency_bucket(ns)]++;
+	stats->max_ns = ns > stats->max_ns ? ns : stats->max_ns;
+}
+
+void cli_stats_merge(CliStats *stats, const CliStats *other) {
+	for (size_t i = 0; i <= RZ_DEMANGLE_LANG_MAX; ++i) {
+		stats->demangled[i] += other->demangled[i];
+		stats->failed[i] += other->failed[i];
+		stats->ns[i] += other->ns[i];
+	}
+	for (size_t i = 0; i < CLI_STATS_BUCKETS; ++i) {
+		stats->latency[i] += other->latency[i];
+	}
+	for (size_t i = 0; i < CLI_STATS_LENGTHS; ++i) {
+		stats->lengths[i] += other->lengths[i];
+	}
+	stats->max_ns = other->max_ns > stats->max_ns ? other->max_ns : stats->max_ns;
+	stats->deduplicated += other->deduplicated;
+}
+
+/**
+ * \brief Returns the latency below which the \p quantile of the timed
+ * symbols fall.
+ */
+ut64 cli_stats_percentile(const CliStats *stats, double quantile) {
+	ut64 total = 0;
+	for (size_t i = 0; i <= RZ_DEMANGLE_LANG_MAX; ++i) {
+		total += stats->demangled[i] + stats->failed[i];
+	}
+	total -= stats->deduplicated;
+	ut64 rank = (ut64)(quantile * (double)total);
+	rank = rank < total ? rank + 1 : total;
+	ut64 seen = 0;
+	for (size_t i = 0; i < CLI_STATS_BUCKETS; ++i) {
+		seen += stats->latency[i];
+		if (seen >= rank) {
+			ut64 max = stats_latency_max(i);
+			return max < stats->max_ns ? max : stats->max_ns;
+		}
+	}
+	return stats->max_ns;
+}
+
+static void stats_print_ns(FILE *out, const char *label, ut64 ns) {
+	if (ns < 10000) {
+		fprintf(out, "%s %llu ns", label, (unsigned long long)ns);
+	} else if (ns < 10000000) {
+		fprintf(out, "%s %.1f us", label, ns / 1e3);
+	} else {
+		fprintf(out, "%s %.1f ms", label, ns / 1e6);
+	}
+}
+
+static double stats_rate(ut64 n, ut64 ns) {
+	return ns ? (double)n * 1e9 / (double)ns : 0.0;
+}
+
+/**
+ * \brief Prints the summary of the run, which took \p wall_ns, and the
+ * slowest symbols found by the \p sampler; the rate per language is the one
+ * of a single thread, i.e. over the time spent on it.
+ */
+void cli_stats_print(const CliStats *stats, RzDemangleSampler *sampler, ut64 wall_ns, FILE *out) {
+	ut64 demangled = 0, failed = 0;
+	for (size_t i = 0; i <= RZ_DEMANGLE_LANG_MAX; ++i) {
+		demangled += stats->demangled[i];
+		failed += stats->failed[i];
+	}
+	ut64 total = demangled + failed;
+	fprintf(out, "symbols: %llu (%llu demangled, %llu failed", (unsigned long long)total,
+		(unsigned long long)demangled, (unsigned long long)failed);
+	if (stats->deduplicated) {
+		fprintf(out, ", %llu deduplicated", (unsigned long long)stats->deduplicated);
+	}
+	fprintf(out, ")\n");
+	fprintf(out, "time: %.3f s, %.0f symbols/s\n", wall_ns / 1e9, stats_rate(total, wall_ns));
+	if (!total) {
+		return;
+	}
+
+	fprintf(out, "%-10s %12s %12s %12s %14s\n", "lang", "symbols", "demangled", "failed", "symbols/s");
+	for (size_t i = 0; i <= RZ_DEMANGLE_LANG_MAX; ++i) {
+		ut64 n = stats->demangled[i] + stats->failed[i];
+		if (!n) {
+			continue;
+		}
+		const char *name = i < RZ_DEMANGLE_LANG_MAX ? libdemangle_lang_name(i) : NULL;
+		fprintf(out, "%-10s %12llu %12llu %12llu %14.0f\n", name ? name : "unknown", (unsigned long long)n,
+			(unsigned long long)stats->demangled[i], (unsigned long long)stats->failed[i], stats_rate(n, stats->ns[i]));
+	}
+
+	fprintf(out, "latency:");
+	stats_print_ns(out, " p50", cli_stats_percentile(stats, 0.5));
+	stats_print_ns(out, ", p99", cli_stats_percentile(stats, 0.99));
+	stats_print_ns(out, ", p99.9", cli_stats_percentile(stats, 0.999));
+	stats_print_ns(out, ", max", stats->max_ns);
+	fprintf(out, "\n");
+
+	fprintf(out, "length:\n");
+	for (size_t i = 0; i < CLI_STATS_LENGTHS; ++i) {
+		if (!stats->lengths[i]) {
+			continue;
+		}
+		size_t min = i ? (size_t)16 << (i - 1) : 0;
+		char range[32];
+		if (i == CLI_STATS_LENGTHS - 1) {
+			snprintf(range, sizeof(range), "%" PFMTSZu "+", min);
+		} else {
+			snprintf(range, sizeof(range), "%" PFMTSZu "-%" PFMTSZu, min, ((size_t)16 << i) - 1);
+		}
+		fprintf(out, "  %-12s %12llu\n", range, (unsigned long long)stats->lengths[i]);
+	}
+
+#if WITH_ALLOC_PROFILE
+	fprintf(out, "allocations:\n");
+	libdemangle_alloc_report(out, CLI_STATS_TOP, total);
+#endif
+
+	RzDemangleSample slowest[CLI_STATS_TOP];
+	size_t n_slowest = libdemangle_sampler_query(sampler, slowest, CLI_STATS_TOP);
+	if (!n_slowest) {
+		return;
+	}
+	fprintf(out, "slowest:\n");
+	for (size_t i = 0; i < n_slowest; ++i) {
+		const RzDemangleSample *slow = &slowest[i];
+		const char *name = libdemangle_lang_name(slow->lang);
+		stats_print_ns(out, " ", slow->ns);
+		fprintf(out, "  %s  %s%s", name ? name : "unknown", slow->symbol, slow->symbol_length >= sizeof(slow->symbol) ? "..." : "");
+		if (slow->output_length) {
+			fprintf(out, "  (%" PFMTSZu " chars)\n", slow->output_length);
+		} else {
+			fprintf(out, "  (failed)\n");
+		}
+	}
+}
+
+/**
+ * \brief Monotonic time in nanoseconds, to time each symbol.
+ */
+ut64 cli_time_ns(void) {
+#if __WINDOWS__
+	LARGE_INTEGER counter, frequency;
+	QueryPerformanceCounter(&counter);
+	QueryPerformanceFrequency(&frequency);
+	return (ut64)((double)counter.QuadPart * 1e9 / (double)frequency.QuadPart);
+#else
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (ut64)ts.tv_sec * 1000000000ull + (ut64)ts.tv_nsec;
+#endif
+}
+
+/**
+ * \brief Bytes allocated so far by the library on the calling thread, or
+ * UT64_MAX when it is not built with use_alloc_profile.
+ */
+ut64 cli_alloc_bytes(void) {
+#if WITH_ALLOC_PROFILE
+	return libdemangle_alloc_thread_bytes();
+#else
+	return UT64_MAX;
+#endif
+}
+
+/**
+ * \brief Demangles the symbol timing it when \p output is CLI_OUTPUT_JSON_TIMED
+ * or when collecting the \p stats; the result is stored in the record, with
+ * the bytes allocated for it in the timed output.
+ */
+void cli_record_demangle(RzDemangleCtx *ctx, CliOutput output, RzDemangleOpts opts, CliStats *stats, CliRecord *record, const char *symbol) {
+	bool timed = output == CLI_OUTPUT_JSON_TIMED || stats;
+	ut64 bytes = output == CLI_OUTPUT_JSON_TIMED ? cli_alloc_bytes() : UT64_MAX;
+	ut64 start = timed ? cli_time_ns() : 0;
+	record->result = libdemangle_ctx_demangle(ctx, record->lang, symbol, opts);
+	ut64 ns = timed ? cli_time_ns() - start : 0;
+	record->ns = output == CLI_OUTPUT_JSON_TIMED ? ns : UT64_MAX;
+	record->bytes = bytes != UT64_MAX ? cli_alloc_bytes() - bytes : UT64_MAX;
+	if (stats) {
+		cli_stats_add(stats, record->lang, record->input_length, record->result != NULL, ns);
+	}
+}
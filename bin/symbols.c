@@ -0,0 +1,401 @@
+// SPDX-FileCopyrightText: 2026 RizinOrg <info@rizin.re>
+// SPDX-License-Identifier: LGPL-3.0-only
+
+/**
+ * \file symbols.c
+ *
+ * Bulk demangling of the symbols found in executables and object files.
+ *
+ * The file is mapped in memory and each format reader collects the decorated
+ * names as pointers into the mapping (names are copied only when they are not
+ * NUL terminated, like the 8 bytes COFF short names), which are then routed to
+ * the right language by their prefix and demangled in batches.
+ */
+
+#include "demangle.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+typedef struct {
+	const char *name;
+	bool (*detect)(const CliFile *file);
+	bool (*symbols)(const CliFile *file, CliSymbols *symbols);
+} CliFormat;
+
+static const CliFormat formats[] = {
+	{ "elf", cli_elf_detect, cli_elf_symbols },
+	{ "pdb", cli_pdb_detect, cli_pdb_symbols },
+	{ "pe", cli_pe_detect, cli_pe_symbols },
+	{ "mach-o", cli_macho_detect, cli_macho_symbols },
+};
+
+typedef struct {
+	const char *prefix;
+	ut16 length;
+	ut16 skip; ///< bytes not passed to the demangler
+	RzDemangleLang lang;
+} CliDecoration;
+
+#define DECORATION(p, s, l) \
+	{ p, sizeof(p) - 1, s, l }
+
+static const CliDecoration decorations[] = {
+	DECORATION("?", 0, RZ_DEMANGLE_LANG_MSVC),
+	DECORATION("@", 0, RZ_DEMANGLE_LANG_CXX), // borland
+	DECORATION("_Z", 0, RZ_DEMANGLE_LANG_CXX),
+	DECORATION("__Z", 1, RZ_DEMANGLE_LANG_CXX), // extra underscore of i386 and mach-o
+	DECORATION("_R", 0, RZ_DEMANGLE_LANG_RUST),
+	DECORATION("__R", 1, RZ_DEMANGLE_LANG_RUST),
+	DECORATION("$s", 0, RZ_DEMANGLE_LANG_SWIFT),
+	DECORATION("_$s", 1, RZ_DEMANGLE_LANG_SWIFT),
+	DECORATION("_T0", 0, RZ_DEMANGLE_LANG_SWIFT),
+	DECORATION("__T0", 0, RZ_DEMANGLE_LANG_SWIFT),
+	DECORATION("_Tt", 1, RZ_DEMANGLE_LANG_SWIFT), // objc runtime names of swift classes
+	DECORATION("_OBJC_", 0, RZ_DEMANGLE_LANG_OBJC),
+	DECORATION("-[", 0, RZ_DEMANGLE_LANG_OBJC),
+	DECORATION("+[", 0, RZ_DEMANGLE_LANG_OBJC),
+};
+
+/* prefixes which are skipped when demangling and rendered as a tag of the demangled name */
+typedef struct {
+	const char *prefix;
+	const char *tag;
+} CliSymbolPrefix;
+
+static const CliSymbolPrefix symbol_prefixes[] = {
+	{ "__imp_", "__declspec(dllimport) " },
+};
+
+/**
+ * \brief Maps the whole file in memory (read-only).
+ */
+bool cli_file_map(CliFile *file, const char *path) {
+	memset(file, 0, sizeof(*file));
+	int fd = open(path, O_RDONLY);
+	if (fd < 0) {
+		return false;
+	}
+	struct stat st;
+	if (fstat(fd, &st) || !S_ISREG(st.st_mode) || st.st_size < 1) {
+		close(fd);
+		return false;
+	}
+	void *data = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (data == MAP_FAILED) {
+		return false;
+	}
+	file->data = data;
+	file->size = st.st_size;
+	return true;
+}
+
+/**
+ * \brief Hints the kernel that (a part of) the mapping is read once from the
+ * start to the end, i.e. to read ahead the huge debug sections.
+ */
+void cli_file_sequential(const CliFile *file) {
+	uintptr_t page = (uintptr_t)sysconf(_SC_PAGESIZE);
+	uintptr_t start = (uintptr_t)file->data & ~(page - 1);
+	if (file->size) {
+		posix_madvise((void *)start, (uintptr_t)file->data + file->size - start, POSIX_MADV_SEQUENTIAL);
+	}
+}
+
+void cli_file_unmap(CliFile *file) {
+	if (file->data) {
+		munmap((void *)file->data, file->size);
+	}
+	memset(file, 0, sizeof(*file));
+}
+
+/**
+ * \brief Returns the string at \p offset and the bytes left till the end
+ * of the file, or NULL when the offset is outside the file.
+ */
+const char *cli_file_string(const CliFile *file, ut64 offset, size_t *max_length) {
+	if (offset >= file->size) {
+		return NULL;
+	}
+	*max_length = file->size - offset;
+	return (const char *)file->data + offset;
+}
+
+static bool symbols_copy(CliSymbols *symbols, const char **name, size_t length) {
+	if (symbols->n_copies >= symbols->copies_capacity) {
+		size_t capacity = symbols->copies_capacity ? symbols->copies_capacity * 2 : 64;
+		char **tmp = realloc(symbols->copies, capacity * sizeof(char *));
+		if (!tmp) {
+			return false;
+		}
+		symbols->copies = tmp;
+		symbols->copies_capacity = capacity;
+	}
+	char *copy = malloc(length + 1);
+	if (!copy) {
+		return false;
+	}
+	memcpy(copy, *name, length);
+	copy[length] = 0;
+	symbols->copies[symbols->n_copies++] = copy;
+	*name = copy;
+	return true;
+}
+
+/**
+ * \brief Adds the name when decorated; \p max_length bounds the name when it
+ * is not NUL terminated (i.e. the end of the file or of the field).
+ */
+bool cli_symbols_add(CliSymbols *symbols, const char *name, size_t max_length) {
+	size_t length = 0;
+	while (length < max_length && name[length]) {
+		length++;
+	}
+	ut16 prefix = 0;
+	const char *tag = NULL;
+	for (size_t i = 0; i < RZ_ARRAY_SIZE(symbol_prefixes); ++i) {
+		size_t size = strlen(symbol_prefixes[i].prefix);
+		if (length > size && !strncmp(name, symbol_prefixes[i].prefix, size)) {
+			prefix = (ut16)size;
+			tag = symbol_prefixes[i].tag;
+			break;
+		}
+	}
+	const CliDecoration *decoration = NULL;
+	for (size_t i = 0; i < RZ_ARRAY_SIZE(decorations); ++i) {
+		const CliDecoration *d = &decorations[i];
+		if (length - prefix > d->length && !strncmp(name + prefix, d->prefix, d->length)) {
+			decoration = d;
+		}
+	}
+	if (!decoration) {
+		// not a decorated name.
+		return true;
+	}
+	if (length == max_length && !symbols_copy(symbols, &name, length)) {
+		return false;
+	}
+
+	if (symbols->n_symbols >= symbols->capacity) {
+		size_t capacity = symbols->capacity ? symbols->capacity * 2 : 1024;
+		CliSymbol *tmp = realloc(symbols->symbols, capacity * sizeof(CliSymbol));
+		if (!tmp) {
+			return false;
+		}
+		symbols->symbols = tmp;
+		symbols->capacity = capacity;
+	}
+	CliSymbol *symbol = &symbols->symbols[symbols->n_symbols++];
+	symbol->name = name;
+	symbol->skip = prefix + decoration->skip;
+	symbol->tag = tag;
+	symbol->lang = decoration->lang;
+	return true;
+}
+
+/**
+ * \brief Returns a new string made of the tag of the symbol followed by its
+ * demangled \p result.
+ */
+char *cli_symbol_tagged(const CliSymbol *symbol, const char *result) {
+	size_t tag_length = symbol->tag ? strlen(symbol->tag) : 0;
+	size_t length = strlen(result);
+	char *tagged = malloc(tag_length + length + 1);
+	if (tagged) {
+		memcpy(tagged, symbol->tag ? symbol->tag : "", tag_length);
+		memcpy(tagged + tag_length, result, length + 1);
+	}
+	return tagged;
+}
+
+void cli_symbols_fini(CliSymbols *symbols) {
+	cli_free_lines(symbols->copies, symbols->n_copies);
+	free(symbols->copies);
+	free(symbols->symbols);
+	memset(symbols, 0, sizeof(*symbols));
+}
+
+/**
+ * \brief Demangles the symbols, one batch per language (the workers time each
+ * symbol for the \p stats), and prints them in their original order; failures are printed
+ * unchanged. With \p path, the path is printed before them (or is part of
+ * the JSON records).
+ */
+int cli_symbols_demangle(RzDemangleCtx *ctx, const CliSymbols *symbols, RzDemangleOpts opts, CliOutput output, CliStats *stats, const char *path, FILE *out) {
+	size_t n_symbols = symbols->n_symbols;
+	char **results = calloc(n_symbols + 1, sizeof(char *));
+	char **batch_results = calloc(n_symbols + 1, sizeof(char *));
+	const char **names = calloc(n_symbols + 1, sizeof(char *));
+	size_t *indexes = calloc(n_symbols + 1, sizeof(size_t));
+	bool timed = output == CLI_OUTPUT_JSON_TIMED || stats;
+#if WITH_ALLOC_PROFILE
+	// the bytes are counted per thread, thus per symbol only when serial
+	bool serial = output == CLI_OUTPUT_JSON_TIMED;
+#else
+	bool serial = false;
+#endif
+	ut64 *times = timed ? calloc(n_symbols + 1, sizeof(ut64)) : NULL;
+	ut64 *bytes = serial ? calloc(n_symbols + 1, sizeof(ut64)) : NULL;
+	unsigned long long *batch_ns = timed && !serial ? calloc(n_symbols + 1, sizeof(unsigned long long)) : NULL;
+	CliBuffer buffer = { 0 };
+	int ret = 1;
+	if (!results || !batch_results || !names || !indexes || (timed && !times) || (serial && !bytes) || (timed && !serial && !batch_ns)) {
+		goto end;
+	}
+
+	for (size_t i = 0; serial && i < n_symbols; ++i) {
+		const CliSymbol *symbol = &symbols->symbols[i];
+		CliRecord record = { 0 };
+		record.input = symbol->name;
+		record.input_length = strlen(symbol->name);
+		record.lang = symbol->lang;
+		cli_record_demangle(ctx, output, opts, stats, &record, symbol->name + symbol->skip);
+		results[i] = record.result;
+		times[i] = record.ns;
+		bytes[i] = record.bytes;
+	}
+	for (int lang = 0; !serial && lang < RZ_DEMANGLE_LANG_MAX; ++lang) {
+		RzDemangleBatch batch = { 0 };
+		batch.lang = lang;
+		batch.opts = opts;
+		batch.symbols = names;
+		batch.results = batch_results;
+		batch.ns = batch_ns;
+		for (size_t i = 0; i < n_symbols; ++i) {
+			const CliSymbol *symbol = &symbols->symbols[i];
+			if (symbol->lang == lang) {
+				indexes[batch.n_symbols] = i;
+				names[batch.n_symbols++] = symbol->name + symbol->skip;
+			}
+		}
+		if (!batch.n_symbols) {
+			continue;
+		} else if (!libdemangle_batch_unique(ctx, &batch)) {
+			goto end;
+		}
+		for (size_t i = 0; i < batch.n_symbols; ++i) {
+			results[indexes[i]] = batch_results[i];
+			if (batch_ns) {
+				times[indexes[i]] = batch_ns[i];
+			}
+		}
+	}
+	for (size_t i = 0; stats && !serial && i < n_symbols; ++i) {
+		const CliSymbol *symbol = &symbols->symbols[i];
+		cli_stats_add(stats, symbol->lang, strlen(symbol->name), results[i] != NULL, times[i]);
+	}
+
+	if (output == CLI_OUTPUT_TEXT && path && n_symbols) {
+		fprintf(out, "%s:\n", path);
+	}
+	for (size_t i = 0; i < n_symbols; ++i) {
+		const CliSymbol *symbol = &symbols->symbols[i];
+		if (output != CLI_OUTPUT_TEXT) {
+			CliRecord record = { 0 };
+			record.file = path;
+			record.input = symbol->name;
+			record.input_length = strlen(symbol->name);
+			record.lang = symbol->lang;
+			record.result = results[i];
+			record.ns = output == CLI_OUTPUT_JSON_TIMED ? times[i] : UT64_MAX;
+			record.deduplicated = output == CLI_OUTPUT_JSON_TIMED && times[i] == UT64_MAX;
+			record.bytes = bytes ? bytes[i] : UT64_MAX;
+			// the tag is part of the result too
+			char *tagged = NULL;
+			if (results[i] && symbol->tag) {
+				if (!(tagged = cli_symbol_tagged(symbol, results[i]))) {
+					goto end;
+				}
+				record.result = tagged;
+			}
+			bool res = cli_json_record(&buffer, &record);
+			free(tagged);
+			if (!res) {
+				goto end;
+			} else if (buffer.size >= CLI_OUTPUT_FLUSH) {
+				fwrite(buffer.data, 1, buffer.size, out);
+				buffer.size = 0;
+			}
+		} else if (results[i]) {
+			fprintf(out, "%s%s\n", symbol->tag ? symbol->tag : "", results[i]);
+		} else {
+			fprintf(out, "%s\n", symbol->name);
+		}
+	}
+	if (buffer.size) {
+		fwrite(buffer.data, 1, buffer.size, out);
+	}
+	ret = 0;
+
+end:
+	if (results) {
+		cli_free_lines(results, n_symbols);
+	}
+	cli_buffer_fini(&buffer);
+	free(results);
+	free(batch_results);
+	free(names);
+	free(indexes);
+	free(times);
+	free(bytes);
+	free(batch_ns);
+	return ret;
+}
+
+static const CliFormat *file_format(const CliFile *file) {
+	for (size_t i = 0; i < RZ_ARRAY_SIZE(formats); ++i) {
+		if (formats[i].detect(file)) {
+			return &formats[i];
+		}
+	}
+	return NULL;
+}
+
+bool cli_file_supported(const CliFile *file) {
+	return file_format(file) != NULL;
+}
+
+/**
+ * \brief Collects the decorated names found in the (supported) file data.
+ */
+bool cli_file_symbols(const CliFile *file, const char *path, CliSymbols *symbols) {
+	const CliFormat *format = file_format(file);
+	if (!format) {
+		fprintf(stderr, "error: unsupported file format '%s'\n", path);
+		return false;
+	} else if (!format->symbols(file, symbols)) {
+		fprintf(stderr, "error: invalid or truncated %s file '%s'\n", format->name, path);
+		return false;
+	}
+	return true;
+}
+
+/**
+ * \brief Demangles all the decorated names found in the (supported) file
+ * data; with \p print_path the path is printed before the names, if any.
+ */
+int cli_demangle_data(RzDemangleCtx *ctx, const CliFile *file, const char *path, bool print_path, RzDemangleOpts opts, CliOutput output, CliStats *stats, FILE *out) {
+	CliSymbols symbols = { 0 };
+	int ret = 1;
+	if (cli_file_symbols(file, path, &symbols)) {
+		ret = cli_symbols_demangle(ctx, &symbols, opts, output, stats, print_path ? path : NULL, out);
+	}
+	cli_symbols_fini(&symbols);
+	return ret;
+}
+
+/**
+ * \brief Demangles all the decorated names found in the file.
+ */
+int cli_demangle_file(RzDemangleCtx *ctx, const char *path, RzDemangleOpts opts, CliOutput output, CliStats *stats, FILE *out) {
+	CliFile file;
+	if (!cli_file_map(&file, path)) {
+		fprintf(stderr, "error: cannot map '%s'\n", path);
+		return 1;
+	}
+	int ret = cli_demangle_data(ctx, &file, path, false, opts, output, stats, out);
+	cli_file_unmap(&file);
+	return ret;
+}
@@ -0,0 +1,508 @@
+// SPDX-FileCopyrightText: 2026 RizinOrg <info@rizin.re>
+// SPDX-License-Identifier: LGPL-3.0-only
+
+/**
+ * \file tree.c
+ *
+ * Bulk demangling of all the supported files found in a directory tree.
+ *
+ * The tree is walked first (in sorted order, without following symlinks),
+ * then the files are read ahead asynchronously while the ones already read
+ * are demangled and printed in the walk order: at most TREE_MAX_FILES files,
+ * for a total of TREE_MAX_BYTES, are being read or waiting to be demangled.
+ *
+ * The files are read via io_uring when available, otherwise by a pool of
+ * threads using pread.
+ */
+
+#include "demangle.h"
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#if WITH_IO_URING
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#endif
+
+#define TREE_MAX_FILES   64
+#define TREE_MAX_BYTES   (256ull << 20)
+#define TREE_MAX_READ    (1u << 30) ///< bytes per read request
+#define TREE_IO_THREADS  4
+
+typedef enum {
+	TREE_FILE_PENDING = 0,
+	TREE_FILE_READ,
+	TREE_FILE_FAILED,
+} TreeFileStatus;
+
+typedef struct {
+	char *path;
+	ut8 *data;
+	size_t size; ///< from the walk, then from the opened file
+	size_t done; ///< bytes read
+	int fd;
+	TreeFileStatus status;
+	struct iovec iov;
+} TreeFile;
+
+#if WITH_IO_URING
+typedef struct {
+	int fd;
+	unsigned *sq_tail;
+	unsigned *sq_mask;
+	unsigned *sq_array;
+	unsigned *cq_head;
+	unsigned *cq_tail;
+	unsigned *cq_mask;
+	struct io_uring_sqe *sqes;
+	struct io_uring_cqe *cqes;
+	void *sq_ring;
+	size_t sq_ring_size;
+	void *cq_ring;
+	size_t cq_ring_size;
+	size_t sqes_size;
+	unsigned to_submit;
+} TreeRing;
+#endif
+
+typedef struct {
+	TreeFile *files;
+	size_t n_files;
+	size_t capacity;
+	size_t next_start; ///< next file to read
+	size_t bytes; ///< being read or waiting to be demangled
+#if WITH_IO_URING
+	bool use_ring;
+	TreeRing ring;
+#endif
+	pthread_t threads[TREE_IO_THREADS];
+	size_t n_threads;
+	pthread_mutex_t lock;
+	pthread_cond_t cond;
+	size_t next_read; ///< next file to read by the pool
+	bool stop;
+} Tree;
+
+static bool tree_add(Tree *tree, char *path, size_t size) {
+	if (tree->n_files >= tree->capacity) {
+		size_t capacity = tree->capacity ? tree->capacity * 2 : 256;
+		TreeFile *tmp = realloc(tree->files, capacity * sizeof(TreeFile));
+		if (!tmp) {
+			return false;
+		}
+		tree->files = tmp;
+		tree->capacity = capacity;
+	}
+	TreeFile *file = &tree->files[tree->n_files++];
+	memset(file, 0, sizeof(*file));
+	file->path = path;
+	file->size = size;
+	file->fd = -1;
+	return true;
+}
+
+static int tree_compare_names(const void *a, const void *b) {
+	return strcmp(*(char *const *)a, *(char *const *)b);
+}
+
+static char *tree_join(const char *dir, const char *name) {
+	size_t dir_length = strlen(dir);
+	size_t name_length = strlen(name);
+	bool slash = dir_length && dir[dir_length - 1] != '/';
+	char *path = malloc(dir_length + slash + name_length + 1);
+	if (path) {
+		memcpy(path, dir, dir_length);
+		path[dir_length] = '/';
+		memcpy(path + dir_length + slash, name, name_length + 1);
+	}
+	return path;
+}
+
+/**
+ * \brief Adds the regular files of the directory, recursively and sorted by
+ * name; unreadable directories are reported and skipped.
+ */
+static bool tree_walk(Tree *tree, const char *dir) {
+	DIR *d = opendir(dir);
+	if (!d) {
+		fprintf(stderr, "warning: cannot open directory '%s'\n", dir);
+		return true;
+	}
+	char **names = NULL;
+	size_t n_names = 0, capacity = 0;
+	bool res = false;
+	struct dirent *entry;
+	while ((entry = readdir(d))) {
+		if (!strcmp(entry->d_name, ".") || !strcmp(entry->d_name, "..")) {
+			continue;
+		} else if (n_names >= capacity) {
+			capacity = capacity ? capacity * 2 : 64;
+			char **tmp = realloc(names, capacity * sizeof(char *));
+			if (!tmp) {
+				goto end;
+			}
+			names = tmp;
+		}
+		if (!(names[n_names] = tree_join(dir, entry->d_name))) {
+			goto end;
+		}
+		n_names++;
+	}
+	qsort(names, n_names, sizeof(char *), tree_compare_names);
+
+	for (size_t i = 0; i < n_names; ++i) {
+		struct stat st;
+		if (lstat(names[i], &st)) {
+			continue;
+		} else if (S_ISDIR(st.st_mode)) {
+			if (!tree_walk(tree, names[i])) {
+				goto end;
+			}
+		} else if (S_ISREG(st.st_mode) && st.st_size > 0) {
+			if (!tree_add(tree, names[i], st.st_size)) {
+				goto end;
+			}
+			// owned by the tree
+			names[i] = NULL;
+		}
+	}
+	res = true;
+
+end:
+	for (size_t i = 0; i < n_names; ++i) {
+		free(names[i]);
+	}
+	free(names);
+	closedir(d);
+	return res;
+}
+
+/**
+ * \brief Opens the file and allocates its buffer; the size is updated to
+ * the one of the opened file.
+ */
+static bool tree_file_open(TreeFile *file) {
+	struct stat st;
+	file->fd = open(file->path, O_RDONLY | O_CLOEXEC);
+	if (file->fd < 0 || fstat(file->fd, &st) || !S_ISREG(st.st_mode)) {
+		return false;
+	}
+	file->size = st.st_size;
+	file->data = malloc(file->size + 1);
+	return file->data != NULL;
+}
+
+static void tree_file_close(TreeFile *file, TreeFileStatus status) {
+	if (file->fd >= 0) {
+		close(file->fd);
+		file->fd = -1;
+	}
+	if (status == TREE_FILE_FAILED) {
+		free(file->data);
+		file->data = NULL;
+	}
+	file->status = status;
+}
+
+static void *tree_io_main(void *user) {
+	Tree *tree = user;
+	pthread_mutex_lock(&tree->lock);
+	for (;;) {
+		while (!tree->stop && tree->next_read >= tree->next_start) {
+			pthread_cond_wait(&tree->cond, &tree->lock);
+		}
+		if (tree->stop) {
+			break;
+		}
+		TreeFile *file = &tree->files[tree->next_read++];
+		pthread_mutex_unlock(&tree->lock);
+
+		TreeFileStatus status = tree_file_open(file) ? TREE_FILE_READ : TREE_FILE_FAILED;
+		while (status == TREE_FILE_READ && file->done < file->size) {
+			ssize_t n = pread(file->fd, file->data + file->done, RZ_MIN(file->size - file->done, (size_t)TREE_MAX_READ), file->done);
+			if (n < 0 && errno == EINTR) {
+				continue;
+			} else if (n < 0) {
+				status = TREE_FILE_FAILED;
+			} else if (!n) {
+				// truncated meanwhile
+				file->size = file->done;
+			}
+			file->done += n > 0 ? n : 0;
+		}
+
+		pthread_mutex_lock(&tree->lock);
+		tree_file_close(file, status);
+		pthread_cond_broadcast(&tree->cond);
+	}
+	pthread_mutex_unlock(&tree->lock);
+	return NULL;
+}
+
+#if WITH_IO_URING
+static bool ring_init(TreeRing *ring, unsigned entries) {
+	struct io_uring_params params = { 0 };
+	memset(ring, 0, sizeof(*ring));
+	ring->fd = (int)syscall(__NR_io_uring_setup, entries, &params);
+	if (ring->fd < 0) {
+		// i.e. old kernel or disabled by seccomp or sysctl
+		return false;
+	}
+	ring->sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+	ring->cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+	if (params.features & IORING_FEAT_SINGLE_MMAP) {
+		if (ring->cq_ring_size > ring->sq_ring_size) {
+			ring->sq_ring_size = ring->cq_ring_size;
+		}
+		ring->cq_ring_size = ring->sq_ring_size;
+	}
+	ring->sq_ring = mmap(NULL, ring->sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQ_RING);
+	ring->cq_ring = ring->sq_ring;
+	if (ring->sq_ring != MAP_FAILED && !(params.features & IORING_FEAT_SINGLE_MMAP)) {
+		ring->cq_ring = mmap(NULL, ring->cq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_CQ_RING);
+	}
+	ring->sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+	ring->sqes = mmap(NULL, ring->sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring->fd, IORING_OFF_SQES);
+	if (ring->sq_ring == MAP_FAILED || ring->cq_ring == MAP_FAILED || ring->sqes == MAP_FAILED) {
+		return false;
+	}
+	ut8 *sq = ring->sq_ring;
+	ut8 *cq = ring->cq_ring;
+	ring->sq_tail = (unsigned *)(sq + params.sq_off.tail);
+	ring->sq_mask = (unsigned *)(sq + params.sq_off.ring_mask);
+	ring->sq_array = (unsigned *)(sq + params.sq_off.array);
+	ring->cq_head = (unsigned *)(cq + params.cq_off.head);
+	ring->cq_tail = (unsigned *)(cq + params.cq_off.tail);
+	ring->cq_mask = (unsigned *)(cq + params.cq_off.ring_mask);
+	ring->cqes = (struct io_uring_cqe *)(cq + params.cq_off.cqes);
+	return true;
+}
+
+static void ring_fini(TreeRing *ring) {
+	if (ring->sqes && ring->sqes != MAP_FAILED) {
+		munmap(ring->sqes, ring->sqes_size);
+	}
+	if (ring->cq_ring && ring->cq_ring != MAP_FAILED && ring->cq_ring != ring->sq_ring) {
+		munmap(ring->cq_ring, ring->cq_ring_size);
+	}
+	if (ring->sq_ring && ring->sq_ring != MAP_FAILED) {
+		munmap(ring->sq_ring, ring->sq_ring_size);
+	}
+	if (ring->fd >= 0) {
+		close(ring->fd);
+	}
+	memset(ring, 0, sizeof(*ring));
+	ring->fd = -1;
+}
+
+/**
+ * \brief Queues the read of the rest of the file; there are never more
+ * reads than the ring entries, since each file has at most one.
+ */
+static void ring_read(TreeRing *ring, TreeFile *file, size_t index) {
+	unsigned tail = *ring->sq_tail;
+	unsigned slot = tail & *ring->sq_mask;
+	struct io_uring_sqe *sqe = &ring->sqes[slot];
+	file->iov.iov_base = file->data + file->done;
+	file->iov.iov_len = RZ_MIN(file->size - file->done, (size_t)TREE_MAX_READ);
+	memset(sqe, 0, sizeof(*sqe));
+	sqe->opcode = IORING_OP_READV;
+	sqe->fd = file->fd;
+	sqe->addr = (ut64)(uintptr_t)&file->iov;
+	sqe->len = 1;
+	sqe->off = file->done;
+	sqe->user_data = index;
+	ring->sq_array[slot] = slot;
+	__atomic_store_n(ring->sq_tail, tail + 1, __ATOMIC_RELEASE);
+	ring->to_submit++;
+}
+
+/**
+ * \brief Submits the queued reads and handles the completed ones, waiting
+ * for at least one when \p wait is set. Returns false when the ring fails.
+ */
+static bool ring_run(Tree *tree, bool wait) {
+	TreeRing *ring = &tree->ring;
+	int n = (int)syscall(__NR_io_uring_enter, ring->fd, ring->to_submit, wait ? 1 : 0, wait ? IORING_ENTER_GETEVENTS : 0, NULL, 0);
+	if (n < 0) {
+		return errno == EINTR || errno == EAGAIN || errno == EBUSY;
+	}
+	ring->to_submit -= RZ_MIN((unsigned)n, ring->to_submit);
+
+	unsigned head = *ring->cq_head;
+	unsigned tail = __atomic_load_n(ring->cq_tail, __ATOMIC_ACQUIRE);
+	for (; head != tail; ++head) {
+		const struct io_uring_cqe *cqe = &ring->cqes[head & *ring->cq_mask];
+		size_t index = (size_t)cqe->user_data;
+		TreeFile *file = &tree->files[index];
+		if (cqe->res == -EINTR || cqe->res == -EAGAIN) {
+			ring_read(ring, file, index);
+			continue;
+		} else if (cqe->res < 0) {
+			tree_file_close(file, TREE_FILE_FAILED);
+			continue;
+		} else if (!cqe->res) {
+			// truncated meanwhile
+			file->size = file->done;
+		}
+		file->done += cqe->res;
+		if (file->done < file->size) {
+			ring_read(ring, file, index);
+		} else {
+			tree_file_close(file, TREE_FILE_READ);
+		}
+	}
+	__atomic_store_n(ring->cq_head, head, __ATOMIC_RELEASE);
+	return true;
+}
+#endif
+
+/**
+ * \brief Starts reading the next files, within the limits.
+ */
+static void tree_read_ahead(Tree *tree, size_t next_process) {
+	while (tree->next_start < tree->n_files && tree->next_start - next_process < TREE_MAX_FILES) {
+		TreeFile *file = &tree->files[tree->next_start];
+		if (tree->bytes && tree->bytes + file->size > TREE_MAX_BYTES) {
+			break;
+		}
+		tree->bytes += file->size;
+#if WITH_IO_URING
+		if (tree->use_ring) {
+			if (!tree_file_open(file)) {
+				tree_file_close(file, TREE_FILE_FAILED);
+			} else if (!file->size) {
+				tree_file_close(file, TREE_FILE_READ);
+			} else {
+				ring_read(&tree->ring, file, tree->next_start);
+			}
+			tree->next_start++;
+			continue;
+		}
+#endif
+		pthread_mutex_lock(&tree->lock);
+		tree->next_start++;
+		pthread_cond_broadcast(&tree->cond);
+		pthread_mutex_unlock(&tree->lock);
+	}
+#if WITH_IO_URING
+	if (tree->use_ring && tree->ring.to_submit && !ring_run(tree, false)) {
+		tree->use_ring = false;
+	}
+#endif
+}
+
+/**
+ * \brief Waits for the file to be read (or to fail).
+ */
+static TreeFileStatus tree_wait(Tree *tree, TreeFile *file) {
+#if WITH_IO_URING
+	if (tree->use_ring) {
+		while (file->status == TREE_FILE_PENDING) {
+			if (!ring_run(tree, true)) {
+				return TREE_FILE_FAILED;
+			}
+		}
+		return file->status;
+	}
+#endif
+	pthread_mutex_lock(&tree->lock);
+	while (file->status == TREE_FILE_PENDING) {
+		pthread_cond_wait(&tree->cond, &tree->lock);
+	}
+	TreeFileStatus status = file->status;
+	pthread_mutex_unlock(&tree->lock);
+	return status;
+}
+
+static bool tree_start(Tree *tree) {
+#if WITH_IO_URING
+	if ((tree->use_ring = ring_init(&tree->ring, TREE_MAX_FILES))) {
+		return true;
+	}
+	ring_fini(&tree->ring);
+#endif
+	pthread_mutex_init(&tree->lock, NULL);
+	pthread_cond_init(&tree->cond, NULL);
+	for (; tree->n_threads < TREE_IO_THREADS; tree->n_threads++) {
+		if (pthread_create(&tree->threads[tree->n_threads], NULL, tree_io_main, tree)) {
+			break;
+		}
+	}
+	return tree->n_threads > 0;
+}
+
+static void tree_stop(Tree *tree) {
+#if WITH_IO_URING
+	if (tree->use_ring) {
+		// waits for the reads still in flight, their buffers are freed below
+		for (size_t i = 0; i < tree->next_start; ++i) {
+			tree_wait(tree, &tree->files[i]);
+		}
+		ring_fini(&tree->ring);
+		return;
+	}
+#endif
+	pthread_mutex_lock(&tree->lock);
+	tree->stop = true;
+	pthread_cond_broadcast(&tree->cond);
+	pthread_mutex_unlock(&tree->lock);
+	for (size_t i = 0; i < tree->n_threads; ++i) {
+		pthread_join(tree->threads[i], NULL);
+	}
+	pthread_mutex_destroy(&tree->lock);
+	pthread_cond_destroy(&tree->cond);
+}
+
+/**
+ * \brief Demangles the decorated names of all the supported files found in
+ * the tree; each file with any is printed as its path followed by the names.
+ * Unreadable or malformed files are reported without stopping the walk.
+ */
+int cli_demangle_tree(RzDemangleCtx *ctx, const char *root, RzDemangleOpts opts, CliOutput output, CliStats *stats, FILE *out) {
+	Tree tree = { 0 };
+	int ret = 1;
+	struct stat st;
+	if (stat(root, &st)) {
+		fprintf(stderr, "error: cannot open '%s'\n", root);
+		return 1;
+	} else if (S_ISDIR(st.st_mode) ? !tree_walk(&tree, root) : !tree_add(&tree, strdup(root), st.st_size)) {
+		fprintf(stderr, "error: cannot allocate the file list\n");
+		goto end;
+	} else if (!tree_start(&tree)) {
+		fprintf(stderr, "error: cannot start the reader threads\n");
+		goto end;
+	}
+
+	ret = 0;
+	for (size_t i = 0; i < tree.n_files; ++i) {
+		TreeFile *file = &tree.files[i];
+		tree_read_ahead(&tree, i);
+		if (tree_wait(&tree, file) != TREE_FILE_READ) {
+			fprintf(stderr, "warning: cannot read '%s'\n", file->path);
+			ret = 1;
+		} else {
+			CliFile data = { file->data, file->size };
+			if (data.size && cli_file_supported(&data) && cli_demangle_data(ctx, &data, file->path, true, opts, output, stats, out)) {
+				ret = 1;
+			}
+		}
+		tree.bytes -= file->size;
+		free(file->data);
+		file->data = NULL;
+	}
+	tree_stop(&tree);
+
+end:
+	for (size_t i = 0; i < tree.n_files; ++i) {
+		free(tree.files[i].path);
+		free(tree.files[i].data);
+	}
+	free(tree.files);
+	return ret;
+}
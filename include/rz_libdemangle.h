@@ -5,6 +5,8 @@
 #ifndef RZ_LIBDEMANGLE_H
 #define RZ_LIBDEMANGLE_H
 
+#include <stddef.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -17,12 +19,30 @@ extern "C" {
 #define DEM_LIB_EXPORT
 #endif
 
+/**
+ * \brief Version of the library, bumped whenever the output of a demangler
+ * changes; files storing demangling outcomes are discarded on a mismatch of
+ * the version or of the demanglers built in.
+ */
+#define RZ_LIBDEMANGLE_VERSION "0.1.0"
+
 typedef enum {
 	RZ_DEMANGLE_OPT_BASE = 0,
 	RZ_DEMANGLE_OPT_SIMPLIFY = (1 << 0),
 	RZ_DEMANGLE_OPT_ENABLE_ALL = 0xFFFF,
 } RzDemangleOpts;
 
+typedef enum {
+	RZ_DEMANGLE_LANG_CXX = 0,
+	RZ_DEMANGLE_LANG_RUST,
+	RZ_DEMANGLE_LANG_SWIFT,
+	RZ_DEMANGLE_LANG_JAVA,
+	RZ_DEMANGLE_LANG_MSVC,
+	RZ_DEMANGLE_LANG_OBJC,
+	RZ_DEMANGLE_LANG_PASCAL,
+	RZ_DEMANGLE_LANG_MAX, ///< unknown or unsupported language
+} RzDemangleLang;
+
 DEM_LIB_EXPORT char *libdemangle_handler_cxx(const char *symbol, RzDemangleOpts opts);
 DEM_LIB_EXPORT char *libdemangle_handler_rust(const char *symbol, RzDemangleOpts opts);
 
@@ -35,6 +55,156 @@ DEM_LIB_EXPORT char *libdemangle_handler_msvc(const char *symbol, RzDemangleOpts
 DEM_LIB_EXPORT char *libdemangle_handler_objc(const char *symbol, RzDemangleOpts opts);
 DEM_LIB_EXPORT char *libdemangle_handler_pascal(const char *symbol, RzDemangleOpts opts);
 
+DEM_LIB_EXPORT RzDemangleLang libdemangle_lang_from_name(const char *name);
+DEM_LIB_EXPORT const char *libdemangle_lang_name(RzDemangleLang lang);
+DEM_LIB_EXPORT char *libdemangle_handler(RzDemangleLang lang, const char *symbol, RzDemangleOpts opts);
+DEM_LIB_EXPORT const char *libdemangle_precomputed(RzDemangleLang lang, const char *symbol, RzDemangleOpts opts);
+DEM_LIB_EXPORT char **libdemangle_mangle(RzDemangleLang lang, const char *declaration);
+DEM_LIB_EXPORT void libdemangle_mangle_free(char **names);
+
+typedef struct {
+	RzDemangleLang lang;
+	RzDemangleOpts opts;
+	const char **symbols;
+	char **results; ///< filled by libdemangle_batch, each result must be freed
+	size_t n_symbols;
+	unsigned long long *ns; ///< optional, filled with the nanoseconds spent on each symbol (see libdemangle_batch_unique())
+} RzDemangleBatch;
+
+typedef struct rz_demangle_ctx_t RzDemangleCtx;
+
+DEM_LIB_EXPORT RzDemangleCtx *libdemangle_ctx_new(size_t n_threads);
+DEM_LIB_EXPORT void libdemangle_ctx_free(RzDemangleCtx *ctx);
+DEM_LIB_EXPORT int libdemangle_ctx_set_memo(RzDemangleCtx *ctx, size_t max_entries);
+DEM_LIB_EXPORT char *libdemangle_ctx_demangle(RzDemangleCtx *ctx, RzDemangleLang lang, const char *symbol, RzDemangleOpts opts);
+DEM_LIB_EXPORT int libdemangle_batch(RzDemangleCtx *ctx, RzDemangleBatch *batch);
+DEM_LIB_EXPORT int libdemangle_batch_unique(RzDemangleCtx *ctx, RzDemangleBatch *batch);
+
+/**
+ * \brief Asynchronous batch submitted via libdemangle_submit().
+ *
+ * A request is always owned by the caller, who frees it via
+ * libdemangle_request_free() once completed, either from its callback or
+ * after polling it; libdemangle_ctx_free() never frees the requests and only
+ * detaches those which were not polled yet. The callbacks of a context
+ * without worker threads are deferred to libdemangle_complete(), thus they
+ * may free the request even though libdemangle_submit() returns it.
+ * libdemangle_cancel() and libdemangle_request_status() read the request
+ * before taking any lock: it must not be freed while they may run, i.e. a
+ * callback freeing it must not race with another thread cancelling it.
+ */
+typedef struct rz_demangle_request_t RzDemangleRequest;
+
+typedef enum {
+	RZ_DEMANGLE_REQUEST_PENDING = 0,
+	RZ_DEMANGLE_REQUEST_DONE,
+	RZ_DEMANGLE_REQUEST_CANCELLED,
+} RzDemangleRequestStatus;
+
+typedef void (*RzDemangleCompletion)(RzDemangleRequest *request, void *user);
+
+DEM_LIB_EXPORT void libdemangle_ctx_set_max_pending(RzDemangleCtx *ctx, size_t max_pending);
+DEM_LIB_EXPORT RzDemangleRequest *libdemangle_submit(RzDemangleCtx *ctx, RzDemangleBatch *batch, RzDemangleCompletion callback, void *user);
+DEM_LIB_EXPORT int libdemangle_cancel(RzDemangleRequest *request);
+DEM_LIB_EXPORT int libdemangle_completion_fd(RzDemangleCtx *ctx);
+DEM_LIB_EXPORT RzDemangleRequest *libdemangle_complete(RzDemangleCtx *ctx);
+DEM_LIB_EXPORT RzDemangleBatch *libdemangle_request_batch(RzDemangleRequest *request);
+DEM_LIB_EXPORT void *libdemangle_request_user(RzDemangleRequest *request);
+DEM_LIB_EXPORT RzDemangleRequestStatus libdemangle_request_status(RzDemangleRequest *request);
+DEM_LIB_EXPORT void libdemangle_request_free(RzDemangleRequest *request);
+
+typedef struct rz_demangle_set_t RzDemangleSet;
+
+DEM_LIB_EXPORT RzDemangleSet *libdemangle_set_new(RzDemangleCtx *ctx, int keep_failures);
+DEM_LIB_EXPORT void libdemangle_set_free(RzDemangleSet *set);
+DEM_LIB_EXPORT int libdemangle_set_add(RzDemangleSet *set, RzDemangleLang lang, RzDemangleOpts opts, const char **symbols, size_t n_symbols);
+DEM_LIB_EXPORT size_t libdemangle_set_size(RzDemangleSet *set);
+DEM_LIB_EXPORT const char **libdemangle_set_sorted(RzDemangleSet *set, size_t *n_names);
+
+#define RZ_DEMANGLE_SAMPLE_SYMBOL 128
+
+typedef struct rz_demangle_sampler_t RzDemangleSampler;
+
+typedef struct {
+	RzDemangleLang lang;
+	unsigned long long ns;
+	size_t symbol_length; ///< the symbol below is truncated to RZ_DEMANGLE_SAMPLE_SYMBOL - 1
+	size_t output_length; ///< 0 when the symbol cannot be demangled
+	char symbol[RZ_DEMANGLE_SAMPLE_SYMBOL];
+} RzDemangleSample;
+
+DEM_LIB_EXPORT RzDemangleSampler *libdemangle_sampler_new(size_t top_k);
+DEM_LIB_EXPORT void libdemangle_sampler_free(RzDemangleSampler *sampler);
+DEM_LIB_EXPORT size_t libdemangle_sampler_query(RzDemangleSampler *sampler, RzDemangleSample *samples, size_t max_samples);
+DEM_LIB_EXPORT void libdemangle_ctx_set_sampler(RzDemangleCtx *ctx, RzDemangleSampler *sampler);
+
+#if WITH_CACHE
+typedef struct rz_demangle_cache_t RzDemangleCache;
+
+typedef enum {
+	RZ_DEMANGLE_CACHE_READ_WRITE = 0,
+	RZ_DEMANGLE_CACHE_READ_ONLY = (1 << 0),
+} RzDemangleCacheMode;
+
+DEM_LIB_EXPORT RzDemangleCache *libdemangle_cache_open(const char *path, RzDemangleCacheMode mode);
+DEM_LIB_EXPORT void libdemangle_cache_close(RzDemangleCache *cache);
+DEM_LIB_EXPORT char *libdemangle_cache_get(RzDemangleCache *cache, RzDemangleLang lang, const char *symbol, RzDemangleOpts opts);
+DEM_LIB_EXPORT int libdemangle_cache_set(RzDemangleCache *cache, RzDemangleLang lang, const char *symbol, RzDemangleOpts opts, const char *demangled);
+DEM_LIB_EXPORT int libdemangle_cache_compact(RzDemangleCache *cache);
+DEM_LIB_EXPORT char *libdemangle_cache_demangle(RzDemangleCache *cache, RzDemangleLang lang, const char *symbol, RzDemangleOpts opts);
+DEM_LIB_EXPORT void libdemangle_ctx_set_cache(RzDemangleCtx *ctx, RzDemangleCache *cache);
+#endif
+
+#if WITH_FILTER
+typedef struct rz_demangle_filter_t RzDemangleFilter;
+
+DEM_LIB_EXPORT RzDemangleFilter *libdemangle_filter_new(size_t capacity, double fp_rate);
+DEM_LIB_EXPORT RzDemangleFilter *libdemangle_filter_load(const char *path);
+DEM_LIB_EXPORT int libdemangle_filter_save(RzDemangleFilter *filter, const char *path);
+DEM_LIB_EXPORT void libdemangle_filter_free(RzDemangleFilter *filter);
+DEM_LIB_EXPORT int libdemangle_filter_contains(RzDemangleFilter *filter, RzDemangleLang lang, const char *symbol);
+DEM_LIB_EXPORT int libdemangle_filter_add(RzDemangleFilter *filter, RzDemangleLang lang, const char *symbol);
+DEM_LIB_EXPORT char *libdemangle_filter_demangle(RzDemangleFilter *filter, RzDemangleLang lang, const char *symbol, RzDemangleOpts opts);
+DEM_LIB_EXPORT void libdemangle_ctx_set_filter(RzDemangleCtx *ctx, RzDemangleFilter *filter);
+#endif
+
+#if WITH_CORPUS
+typedef struct rz_demangle_capture_t RzDemangleCapture;
+typedef struct rz_demangle_corpus_t RzDemangleCorpus;
+
+typedef struct {
+	RzDemangleLang lang;
+	RzDemangleOpts opts;
+	const char *symbol; ///< NUL terminated, points into the mapped corpus
+	size_t length;
+} RzDemangleCorpusEntry;
+
+DEM_LIB_EXPORT RzDemangleCapture *libdemangle_capture_open(const char *path);
+DEM_LIB_EXPORT int libdemangle_capture_add(RzDemangleCapture *capture, RzDemangleLang lang, const char *symbol, RzDemangleOpts opts);
+DEM_LIB_EXPORT int libdemangle_capture_flush(RzDemangleCapture *capture);
+DEM_LIB_EXPORT int libdemangle_capture_close(RzDemangleCapture *capture);
+DEM_LIB_EXPORT void libdemangle_ctx_set_capture(RzDemangleCtx *ctx, RzDemangleCapture *capture);
+DEM_LIB_EXPORT RzDemangleCorpus *libdemangle_corpus_open(const char *path);
+DEM_LIB_EXPORT void libdemangle_corpus_close(RzDemangleCorpus *corpus);
+DEM_LIB_EXPORT const RzDemangleCorpusEntry *libdemangle_corpus_entries(RzDemangleCorpus *corpus, size_t *n_entries);
+#endif
+
+#if WITH_ALLOC_PROFILE
+#include <stdio.h>
+
+typedef struct {
+	const char *file;
+	unsigned int line;
+	unsigned long long count;
+	unsigned long long bytes;
+} RzDemangleAllocSite;
+
+DEM_LIB_EXPORT size_t libdemangle_alloc_sites(RzDemangleAllocSite *sites, size_t max_sites);
+DEM_LIB_EXPORT void libdemangle_alloc_report(FILE *out, size_t max_sites, size_t n_symbols);
+DEM_LIB_EXPORT void libdemangle_alloc_reset(void);
+DEM_LIB_EXPORT unsigned long long libdemangle_alloc_thread_bytes(void);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,319 @@
+// SPDX-FileCopyrightText: 2026 RizinOrg <info@rizin.re>
+// SPDX-License-Identifier: LGPL-3.0-only
+
+/**
+ * \file rz_libdemangle.hpp
+ *
+ * Header-only C++17 layer over the C API.
+ *
+ * - the inputs are std::string_view; the handlers read NUL terminated
+ *   strings, thus views are copied to a stack buffer (or to the heap when
+ *   longer than RZ_DEMANGLE_HPP_STACK bytes), while std::string and C strings
+ *   are passed through as they are.
+ * - the results are RAII handles to the strings returned by the library
+ *   (rz::demangle::Result), or are copied into a caller's buffer or into a
+ *   std::pmr::memory_resource.
+ * - rz::demangle::Context owns a demangle context; its batch() accepts any
+ *   range of strings and returns the results as a range.
+ *
+ * Everything is inline and only calls the C functions.
+ */
+
+#ifndef RZ_LIBDEMANGLE_HPP
+#define RZ_LIBDEMANGLE_HPP
+
+#include "rz_libdemangle.h"
+#include <cstdlib>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <memory_resource>
+#include <new>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#ifndef RZ_DEMANGLE_HPP_STACK
+#define RZ_DEMANGLE_HPP_STACK 256
+#endif
+
+namespace rz::demangle {
+
+using Lang = RzDemangleLang;
+using Opts = RzDemangleOpts;
+
+struct FreeDeleter {
+	void operator()(char *string) const noexcept {
+		std::free(string);
+	}
+};
+
+/**
+ * \brief A string returned by the library, empty when demangling failed.
+ */
+class Result {
+public:
+	Result() noexcept = default;
+	explicit Result(char *string) noexcept :
+		string_(string) {}
+
+	explicit operator bool() const noexcept {
+		return string_ != nullptr;
+	}
+	const char *c_str() const noexcept {
+		return string_.get();
+	}
+	std::string_view view() const &noexcept {
+		return string_ ? std::string_view(string_.get()) : std::string_view();
+	}
+	// the view of a temporary would dangle
+	std::string_view view() const && = delete;
+	char *release() noexcept {
+		return string_.release();
+	}
+
+private:
+	std::unique_ptr<char, FreeDeleter> string_;
+};
+
+namespace detail {
+
+/**
+ * \brief NUL terminated copy of a string view, on the stack when short.
+ */
+class CString {
+public:
+	explicit CString(std::string_view view) {
+		char *data = view.size() < sizeof(stack_) ? stack_ : (heap_ = std::make_unique<char[]>(view.size() + 1)).get();
+		std::memcpy(data, view.data(), view.size());
+		data[view.size()] = 0;
+		data_ = data;
+	}
+	CString(const CString &) = delete;
+	CString &operator=(const CString &) = delete;
+
+	const char *c_str() const noexcept {
+		return data_;
+	}
+
+private:
+	char stack_[RZ_DEMANGLE_HPP_STACK];
+	std::unique_ptr<char[]> heap_;
+	const char *data_;
+};
+
+/**
+ * \brief Copies the result into the buffer (keeping its capacity); returns
+ * false and clears the buffer when the symbol cannot be demangled.
+ */
+template <typename String>
+inline bool assign(String &buffer, Result result) {
+	if (!result) {
+		buffer.clear();
+		return false;
+	}
+	buffer.assign(result.view());
+	return true;
+}
+
+} // namespace detail
+
+inline Result demangle(Lang lang, const char *symbol, Opts opts = RZ_DEMANGLE_OPT_BASE) {
+	return Result(libdemangle_handler(lang, symbol, opts));
+}
+
+inline Result demangle(Lang lang, const std::string &symbol, Opts opts = RZ_DEMANGLE_OPT_BASE) {
+	return demangle(lang, symbol.c_str(), opts);
+}
+
+inline Result demangle(Lang lang, std::string_view symbol, Opts opts = RZ_DEMANGLE_OPT_BASE) {
+	detail::CString copy(symbol);
+	return demangle(lang, copy.c_str(), opts);
+}
+
+/**
+ * \brief Demangles into a reusable buffer, see detail::assign().
+ */
+template <typename String>
+inline bool demangle_into(String &buffer, Lang lang, std::string_view symbol, Opts opts = RZ_DEMANGLE_OPT_BASE) {
+	return detail::assign(buffer, demangle(lang, symbol, opts));
+}
+
+/**
+ * \brief Demangles into a string allocated from the memory resource.
+ */
+inline std::optional<std::pmr::string> demangle(Lang lang, std::string_view symbol, Opts opts, std::pmr::memory_resource *resource) {
+	std::pmr::string buffer(resource);
+	if (!demangle_into(buffer, lang, symbol, opts)) {
+		return std::nullopt;
+	}
+	return buffer;
+}
+
+inline std::optional<Lang> lang_from_name(const char *name) {
+	Lang lang = libdemangle_lang_from_name(name);
+	return lang == RZ_DEMANGLE_LANG_MAX ? std::nullopt : std::optional<Lang>(lang);
+}
+
+/**
+ * \brief The results of a batch, in the order of the symbols; each one is a
+ * C string, nullptr when the symbol cannot be demangled.
+ */
+class BatchResults {
+public:
+	using value_type = const char *;
+	using const_iterator = const char *const *;
+	using iterator = const_iterator;
+
+	BatchResults() noexcept = default;
+	explicit BatchResults(size_t size) :
+		results_(size, nullptr) {}
+	BatchResults(BatchResults &&other) noexcept :
+		results_(std::move(other.results_)) {
+		other.results_.clear();
+	}
+	BatchResults &operator=(BatchResults &&other) noexcept {
+		if (this != &other) {
+			clear();
+			results_ = std::move(other.results_);
+			other.results_.clear();
+		}
+		return *this;
+	}
+	~BatchResults() {
+		clear();
+	}
+
+	size_t size() const noexcept {
+		return results_.size();
+	}
+	const char *operator[](size_t i) const noexcept {
+		return results_[i];
+	}
+	const_iterator begin() const noexcept {
+		return results_.data();
+	}
+	const_iterator end() const noexcept {
+		return results_.data() + results_.size();
+	}
+	/** \brief Takes the ownership of the i-th result. */
+	Result take(size_t i) noexcept {
+		return Result(std::exchange(results_[i], nullptr));
+	}
+	char **data() noexcept {
+		return results_.data();
+	}
+	void clear() noexcept {
+		for (char *result : results_) {
+			std::free(result);
+		}
+		results_.clear();
+	}
+
+private:
+	std::vector<char *> results_;
+};
+
+/**
+ * \brief Owns a demangle context (see libdemangle_ctx_new()).
+ */
+class Context {
+public:
+	explicit Context(size_t n_threads = 0) :
+		ctx_(libdemangle_ctx_new(n_threads)) {
+		if (!ctx_) {
+			throw std::bad_alloc();
+		}
+	}
+	Context(Context &&other) noexcept :
+		ctx_(std::exchange(other.ctx_, nullptr)) {}
+	Context &operator=(Context &&other) noexcept {
+		if (this != &other) {
+			libdemangle_ctx_free(ctx_);
+			ctx_ = std::exchange(other.ctx_, nullptr);
+		}
+		return *this;
+	}
+	Context(const Context &) = delete;
+	Context &operator=(const Context &) = delete;
+	~Context() {
+		libdemangle_ctx_free(ctx_);
+	}
+
+	RzDemangleCtx *get() const noexcept {
+		return ctx_;
+	}
+	bool set_memo(size_t max_entries) noexcept {
+		return libdemangle_ctx_set_memo(ctx_, max_entries);
+	}
+#if WITH_CACHE
+	void set_cache(RzDemangleCache *cache) noexcept {
+		libdemangle_ctx_set_cache(ctx_, cache);
+	}
+#endif
+#if WITH_FILTER
+	void set_filter(RzDemangleFilter *filter) noexcept {
+		libdemangle_ctx_set_filter(ctx_, filter);
+	}
+#endif
+
+	Result demangle(Lang lang, const char *symbol, Opts opts = RZ_DEMANGLE_OPT_BASE) const {
+		return Result(libdemangle_ctx_demangle(ctx_, lang, symbol, opts));
+	}
+	Result demangle(Lang lang, const std::string &symbol, Opts opts = RZ_DEMANGLE_OPT_BASE) const {
+		return demangle(lang, symbol.c_str(), opts);
+	}
+	Result demangle(Lang lang, std::string_view symbol, Opts opts = RZ_DEMANGLE_OPT_BASE) const {
+		detail::CString copy(symbol);
+		return demangle(lang, copy.c_str(), opts);
+	}
+	template <typename String>
+	bool demangle_into(String &buffer, Lang lang, std::string_view symbol, Opts opts = RZ_DEMANGLE_OPT_BASE) const {
+		return detail::assign(buffer, demangle(lang, symbol, opts));
+	}
+
+	/**
+	 * \brief Demangles in parallel any range of C strings, std::string or
+	 * std::string_view (the views are copied); with \p unique each distinct
+	 * symbol is demangled once (see libdemangle_batch_unique()).
+	 */
+	template <typename Range>
+	BatchResults batch(Lang lang, const Range &symbols, Opts opts = RZ_DEMANGLE_OPT_BASE, bool unique = false) const {
+		using Element = std::decay_t<decltype(*std::begin(symbols))>;
+		std::vector<const char *> pointers;
+		std::vector<std::string> copies; ///< NUL terminated copies of the views
+		for (const auto &symbol : symbols) {
+			if constexpr (std::is_convertible_v<const Element &, const char *>) {
+				pointers.push_back(symbol);
+			} else if constexpr (std::is_same_v<Element, std::string>) {
+				pointers.push_back(symbol.c_str());
+			} else {
+				copies.emplace_back(std::string_view(symbol));
+			}
+		}
+		for (const std::string &copy : copies) {
+			pointers.push_back(copy.c_str());
+		}
+		BatchResults results(pointers.size());
+		RzDemangleBatch batch = {};
+		batch.lang = lang;
+		batch.opts = opts;
+		batch.symbols = pointers.data();
+		batch.results = results.data();
+		batch.n_symbols = pointers.size();
+		if (!(unique ? libdemangle_batch_unique(ctx_, &batch) : libdemangle_batch(ctx_, &batch))) {
+			throw std::bad_alloc();
+		}
+		return results;
+	}
+
+private:
+	RzDemangleCtx *ctx_;
+};
+
+} // namespace rz::demangle
+
+#endif /* RZ_LIBDEMANGLE_HPP */
@@ -0,0 +1,143 @@
+// SPDX-FileCopyrightText: 2026 RizinOrg <info@rizin.re>
+// SPDX-License-Identifier: LGPL-3.0-only
+
+/**
+ * \file rz_libdemangle_columns.h
+ *
+ * Reader of the columnar files written by `demangle --columns <file>`.
+ *
+ * The file is meant to be mapped in memory and indexed without parsing;
+ * every integer is little endian and every section is 8 bytes aligned:
+ *
+ *   [ RzDemangleColumnsHeader ]
+ *   [ heap: the NUL terminated UTF-8 strings, one per record ]
+ *   [ offsets: ut64 * (n_records + 1), string i is heap[offsets[i]..offsets[i + 1]) ]
+ *   [ hashes: ut64 * n_records, only with RZ_DEMANGLE_COLUMNS_HASHES ]
+ *   [ langs: ut8 * n_records, the RzDemangleLang values ]
+ *   [ status: ut8 * n_records, the RzDemangleColumnsStatus values ]
+ *
+ * The string of a record is the demangled symbol, or the input itself when
+ * it cannot be demangled. The optional hash is the 64 bit FNV-1a hash of the
+ * input, see rz_demangle_columns_hash().
+ *
+ * This header has no dependency on the library and only reads the file on
+ * little endian hosts.
+ */
+
+#ifndef RZ_LIBDEMANGLE_COLUMNS_H
+#define RZ_LIBDEMANGLE_COLUMNS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define RZ_DEMANGLE_COLUMNS_MAGIC   "RZDMCOLS"
+#define RZ_DEMANGLE_COLUMNS_VERSION 1
+
+typedef enum {
+	RZ_DEMANGLE_COLUMNS_HASHES = (1 << 0), ///< the file has the hashes column
+} RzDemangleColumnsFlags;
+
+typedef enum {
+	RZ_DEMANGLE_COLUMNS_DEMANGLED = 0,
+	RZ_DEMANGLE_COLUMNS_FAILED, ///< the string is the input
+} RzDemangleColumnsStatus;
+
+typedef struct {
+	char magic[8];
+	uint32_t version;
+	uint32_t flags;
+	uint64_t n_records;
+	uint64_t heap_offset;
+	uint64_t heap_size;
+	uint64_t offsets_offset;
+	uint64_t hashes_offset; ///< 0 without RZ_DEMANGLE_COLUMNS_HASHES
+	uint64_t langs_offset;
+	uint64_t status_offset;
+} RzDemangleColumnsHeader;
+
+typedef struct {
+	const RzDemangleColumnsHeader *header;
+	uint64_t n_records;
+	const char *heap;
+	const uint64_t *offsets;
+	const uint64_t *hashes; ///< NULL when missing
+	const uint8_t *langs;
+	const uint8_t *status;
+} RzDemangleColumns;
+
+static inline int rz_demangle_columns_section_is_valid(uint64_t offset, uint64_t size, size_t file_size) {
+	return !(offset & 7) && offset <= file_size && size <= file_size - offset;
+}
+
+/**
+ * \brief Validates the mapped file and sets up the columns pointing into it;
+ * returns 0 when the data is not a valid columnar file.
+ */
+static inline int rz_demangle_columns_init(RzDemangleColumns *columns, const void *data, size_t size) {
+	const RzDemangleColumnsHeader *hdr = (const RzDemangleColumnsHeader *)data;
+	const uint8_t *base = (const uint8_t *)data;
+	if (!columns || !data || ((uintptr_t)data & 7) || size < sizeof(*hdr) ||
+		memcmp(hdr->magic, RZ_DEMANGLE_COLUMNS_MAGIC, sizeof(hdr->magic)) ||
+		hdr->version != RZ_DEMANGLE_COLUMNS_VERSION || hdr->n_records >= size) {
+		return 0;
+	}
+	uint64_t n = hdr->n_records;
+	int has_hashes = !!(hdr->flags & RZ_DEMANGLE_COLUMNS_HASHES);
+	if (!rz_demangle_columns_section_is_valid(hdr->heap_offset, hdr->heap_size, size) ||
+		!rz_demangle_columns_section_is_valid(hdr->offsets_offset, (n + 1) * 8, size) ||
+		(has_hashes && !rz_demangle_columns_section_is_valid(hdr->hashes_offset, n * 8, size)) ||
+		!rz_demangle_columns_section_is_valid(hdr->langs_offset, n, size) ||
+		!rz_demangle_columns_section_is_valid(hdr->status_offset, n, size)) {
+		return 0;
+	}
+	columns->header = hdr;
+	columns->n_records = n;
+	columns->heap = (const char *)(base + hdr->heap_offset);
+	columns->offsets = (const uint64_t *)(base + hdr->offsets_offset);
+	columns->hashes = has_hashes ? (const uint64_t *)(base + hdr->hashes_offset) : NULL;
+	columns->langs = base + hdr->langs_offset;
+	columns->status = base + hdr->status_offset;
+	return 1;
+}
+
+/**
+ * \brief Returns the NUL terminated string of the record (and its length),
+ * or NULL when out of bounds.
+ */
+static inline const char *rz_demangle_columns_string(const RzDemangleColumns *columns, uint64_t index, size_t *length) {
+	if (index >= columns->n_records) {
+		return NULL;
+	}
+	uint64_t start = columns->offsets[index];
+	uint64_t end = columns->offsets[index + 1];
+	if (start >= end || end > columns->header->heap_size || columns->heap[end - 1]) {
+		return NULL;
+	}
+	if (length) {
+		*length = (size_t)(end - start - 1);
+	}
+	return columns->heap + start;
+}
+
+/**
+ * \brief 64 bit FNV-1a hash of the input, as stored in the hashes column.
+ */
+static inline uint64_t rz_demangle_columns_hash(const char *input, size_t length) {
+	uint64_t hash = 0xcbf29ce484222325ull;
+	for (size_t i = 0; i < length; ++i) {
+		hash ^= (uint8_t)input[i];
+		hash *= 0x100000001b3ull;
+	}
+	return hash;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* RZ_LIBDEMANGLE_COLUMNS_H */
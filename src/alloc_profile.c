@@ -0,0 +1,132 @@
+// SPDX-FileCopyrightText: 2026 RizinOrg <info@rizin.re>
+// SPDX-License-Identifier: LGPL-3.0-only
+
+#include "alloc_profile.h"
+#include "demangler_util.h"
+#include <rz_libdemangle.h>
+
+// the report allocates with the plain functions
+#undef malloc
+#undef calloc
+#undef realloc
+#undef strdup
+
+__thread uint64_t dem_alloc_thread_bytes;
+
+static DemAllocSite *alloc_sites; ///< (atomic) head of the list
+
+void dem_alloc_register(DemAllocSite *site) {
+	int registered = 0;
+	if (!__atomic_compare_exchange_n(&site->registered, &registered, 1, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+		return;
+	}
+	DemAllocSite *head = __atomic_load_n(&alloc_sites, __ATOMIC_ACQUIRE);
+	do {
+		site->next = head;
+	} while (!__atomic_compare_exchange_n(&alloc_sites, &head, site, true, __ATOMIC_RELEASE, __ATOMIC_ACQUIRE));
+}
+
+static int alloc_site_cmp_location(const void *a, const void *b) {
+	const RzDemangleAllocSite *x = a, *y = b;
+	int cmp = strcmp(x->file, y->file);
+	return cmp ? cmp : x->line < y->line ? -1 : x->line > y->line;
+}
+
+static int alloc_site_cmp_bytes(const void *a, const void *b) {
+	const RzDemangleAllocSite *x = a, *y = b;
+	if (x->bytes != y->bytes) {
+		return x->bytes < y->bytes ? 1 : -1;
+	}
+	return alloc_site_cmp_location(a, b);
+}
+
+/**
+ * \brief Copies the counters of the allocation sites which allocated since
+ * the last reset, the biggest first.
+ *
+ * A function inlined from a header has a call site per source file which
+ * includes it, these are merged.
+ *
+ * \return the number of sites, which can exceed \p max_sites (\p sites can
+ * be NULL to count them).
+ */
+DEM_LIB_EXPORT size_t libdemangle_alloc_sites(RzDemangleAllocSite *sites, size_t max_sites) {
+	// the list only grows at its head, its tail from this head is stable
+	DemAllocSite *head = __atomic_load_n(&alloc_sites, __ATOMIC_ACQUIRE);
+	size_t n_sites = 0;
+	for (DemAllocSite *site = head; site; site = site->next) {
+		n_sites++;
+	}
+	RzDemangleAllocSite *all = malloc((n_sites + 1) * sizeof(RzDemangleAllocSite));
+	if (!all) {
+		return 0;
+	}
+	DemAllocSite *site = head;
+	for (size_t i = 0; i < n_sites; ++i, site = site->next) {
+		all[i].file = site->file;
+		all[i].line = site->line;
+		all[i].count = __atomic_load_n(&site->count, __ATOMIC_RELAXED);
+		all[i].bytes = __atomic_load_n(&site->bytes, __ATOMIC_RELAXED);
+	}
+	qsort(all, n_sites, sizeof(RzDemangleAllocSite), alloc_site_cmp_location);
+	size_t n_merged = 0;
+	for (size_t i = 0; i < n_sites; ++i) {
+		if (!all[i].count) {
+			continue;
+		} else if (n_merged && !alloc_site_cmp_location(&all[n_merged - 1], &all[i])) {
+			all[n_merged - 1].count += all[i].count;
+			all[n_merged - 1].bytes += all[i].bytes;
+		} else {
+			all[n_merged++] = all[i];
+		}
+	}
+	qsort(all, n_merged, sizeof(RzDemangleAllocSite), alloc_site_cmp_bytes);
+	if (sites) {
+		memcpy(sites, all, RZ_MIN(n_merged, max_sites) * sizeof(RzDemangleAllocSite));
+	}
+	free(all);
+	return n_merged;
+}
+
+/**
+ * \brief Prints the \p max_sites sites which allocated the most bytes; with
+ * \p n_symbols (those demangled since the last reset) the averages per
+ * symbol are printed too.
+ */
+DEM_LIB_EXPORT void libdemangle_alloc_report(FILE *out, size_t max_sites, size_t n_symbols) {
+	RzDemangleAllocSite *sites = malloc((max_sites + 1) * sizeof(RzDemangleAllocSite));
+	if (!sites) {
+		return;
+	}
+	size_t n_sites = RZ_MIN(libdemangle_alloc_sites(sites, max_sites), max_sites);
+	fprintf(out, "%-40s %12s %14s", "site", "allocations", "bytes");
+	fprintf(out, n_symbols ? " %12s %12s\n" : "\n", "allocs/sym", "bytes/sym");
+	for (size_t i = 0; i < n_sites; ++i) {
+		char location[256];
+		snprintf(location, sizeof(location), "%s:%u", sites[i].file, sites[i].line);
+		fprintf(out, "%-40s %12llu %14llu", location, sites[i].count, sites[i].bytes);
+		if (n_symbols) {
+			fprintf(out, " %12.2f %12.1f", (double)sites[i].count / n_symbols, (double)sites[i].bytes / n_symbols);
+		}
+		fprintf(out, "\n");
+	}
+	free(sites);
+}
+
+/**
+ * \brief Zeroes the counters of all the sites, e.g. after a warm up.
+ */
+DEM_LIB_EXPORT void libdemangle_alloc_reset(void) {
+	for (DemAllocSite *site = __atomic_load_n(&alloc_sites, __ATOMIC_ACQUIRE); site; site = site->next) {
+		__atomic_store_n(&site->count, 0, __ATOMIC_RELAXED);
+		__atomic_store_n(&site->bytes, 0, __ATOMIC_RELAXED);
+	}
+}
+
+/**
+ * \brief Returns the bytes requested so far by the library on the calling
+ * thread; the difference around a call gives its allocations.
+ */
+DEM_LIB_EXPORT unsigned long long libdemangle_alloc_thread_bytes(void) {
+	return dem_alloc_thread_bytes;
+}
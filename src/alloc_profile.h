@@ -0,0 +1,79 @@
+// SPDX-FileCopyrightText: 2026 RizinOrg <info@rizin.re>
+// SPDX-License-Identifier: LGPL-3.0-only
+
+/**
+ * \file alloc_profile.h
+ *
+ * Allocation-site profiling, built with the alloc_profile meson option.
+ *
+ * This header is force-included (-include) in every source file of the
+ * library, the vendored ones too, and turns malloc(), calloc(), realloc()
+ * and strdup() into wrappers which count the calls and the bytes requested
+ * at each call site. Every call site gets its own static counters, which
+ * are linked in a global list on their first use, so counting costs two
+ * atomic additions and no lookup. See libdemangle_alloc_sites() for the
+ * report.
+ */
+
+#ifndef RZ_LIBDEMANGLE_ALLOC_PROFILE_H
+#define RZ_LIBDEMANGLE_ALLOC_PROFILE_H
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct dem_alloc_site_t {
+	const char *file;
+	unsigned int line;
+	int registered; ///< (atomic) linked in the list of the sites
+	uint64_t count; ///< (atomic)
+	uint64_t bytes; ///< (atomic) requested, the reallocations count the new size
+	struct dem_alloc_site_t *next;
+} DemAllocSite;
+
+extern __thread uint64_t dem_alloc_thread_bytes;
+
+void dem_alloc_register(DemAllocSite *site);
+
+static inline void dem_alloc_count(DemAllocSite *site, size_t size) {
+	if (!__atomic_load_n(&site->registered, __ATOMIC_ACQUIRE)) {
+		dem_alloc_register(site);
+	}
+	__atomic_fetch_add(&site->count, 1, __ATOMIC_RELAXED);
+	__atomic_fetch_add(&site->bytes, size, __ATOMIC_RELAXED);
+	dem_alloc_thread_bytes += size;
+}
+
+static inline void *dem_alloc_malloc(size_t size, DemAllocSite *site) {
+	dem_alloc_count(site, size);
+	return malloc(size);
+}
+
+static inline void *dem_alloc_calloc(size_t n, size_t size, DemAllocSite *site) {
+	dem_alloc_count(site, n * size);
+	return calloc(n, size);
+}
+
+static inline void *dem_alloc_realloc(void *ptr, size_t size, DemAllocSite *site) {
+	dem_alloc_count(site, size);
+	return realloc(ptr, size);
+}
+
+static inline char *dem_alloc_strdup(const char *string, DemAllocSite *site) {
+	dem_alloc_count(site, strlen(string) + 1);
+	return strdup(string);
+}
+
+/* the counters of the call site where the macro is expanded */
+#define DEM_ALLOC_SITE \
+	({ \
+		static DemAllocSite dem_alloc_site = { __FILE__, __LINE__ }; \
+		&dem_alloc_site; \
+	})
+
+#define malloc(size)       dem_alloc_malloc((size), DEM_ALLOC_SITE)
+#define calloc(n, size)    dem_alloc_calloc((n), (size), DEM_ALLOC_SITE)
+#define realloc(ptr, size) dem_alloc_realloc((ptr), (size), DEM_ALLOC_SITE)
+#define strdup(string)     dem_alloc_strdup((string), DEM_ALLOC_SITE)
+
+#endif /* RZ_LIBDEMANGLE_ALLOC_PROFILE_H */
@@ -0,0 +1,963 @@
+// SPDX-FileCopyrightText: 2026 RizinOrg <info@rizin.re>
+// SPDX-License-Identifier: LGPL-3.0-only
+
+/**
+ * \file batch.c
+ *
+ * Demangle context and parallel batch engine.
+ *
+ * A context owns a pool of worker threads which is shared by every batch
+ * submitted to it, also from different threads at the same time.
+ * Each batch becomes a job in the pool queue; workers (and the thread which
+ * submitted the batch) grab chunks of symbols from the job via an atomic
+ * cursor, thus big batches are spread over all the threads while many small
+ * batches are served concurrently.
+ *
+ * Batches can also be submitted asynchronously: the submitting thread returns
+ * immediately and only the workers run the job; its completion is delivered
+ * via a callback or via a queue which can be polled through a file descriptor,
+ * to integrate with event loops.
+ *
+ * Batches with repeated symbols can be deduplicated first, so that each
+ * distinct symbol is demangled once and its result copied to the others.
+ *
+ * Besides batches, the pool runs generic jobs split in chunks of items
+ * (see dem_ctx_parallel()), e.g. the sort of the demangled names sets.
+ *
+ * A single symbol goes through the in-memory memo, the negative-result
+ * filter (symbols known not to demangle), the persistent cache and finally
+ * the language handler; the whole lookup is timed when a sampler of the
+ * slowest symbols is attached. Every symbol can also be appended to a corpus
+ * file, to replay the production mix later: the capture is attached by the
+ * caller or opened by every new context when RZ_DEMANGLE_CAPTURE names the
+ * file.
+ */
+
+#include "batch.h"
+#include "memo.h"
+#include "sampler.h"
+#if WITH_THREADS
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <unistd.h>
+#if __linux__
+#include <sys/eventfd.h>
+#endif
+#endif
+
+#define BATCH_CHUNK_SIZE  64
+#define BATCH_MAX_PENDING 1024
+
+typedef struct dem_job_t {
+	RzDemangleCtx *ctx;
+	RzDemangleBatch *batch; ///< demangled when there is no run callback
+	DemParallelRun run; ///< runs a chunk of a generic job
+	void *user;
+	size_t n_items; ///< symbols of the batch or items of the generic job
+	size_t chunk_size;
+	size_t cursor; ///< next item to grab (atomic)
+	size_t n_done; ///< items done
+	size_t n_users; ///< workers currently running the job
+	bool queued;
+	bool cancelled; ///< (atomic)
+	RzDemangleRequest *request; ///< NULL when the submitter waits for the job
+	struct dem_job_t *next;
+} DemJob;
+
+struct rz_demangle_request_t {
+	DemJob job;
+	RzDemangleCtx *ctx; ///< (atomic) NULL once handed to the caller
+	RzDemangleRequestStatus status;
+	RzDemangleCompletion callback;
+	void *user;
+	struct rz_demangle_request_t *next; ///< completion queue
+};
+
+struct rz_demangle_ctx_t {
+	DemMemo *memo;
+#if WITH_CACHE
+	RzDemangleCache *cache;
+#endif
+#if WITH_FILTER
+	RzDemangleFilter *filter;
+#endif
+	RzDemangleSampler *sampler;
+#if WITH_CORPUS
+	RzDemangleCapture *capture;
+	bool capture_owned; ///< opened via RZ_DEMANGLE_CAPTURE
+#endif
+#if WITH_THREADS
+	pthread_t *threads;
+	size_t n_threads;
+	pthread_mutex_t lock;
+	pthread_cond_t wake; ///< signals new jobs to the workers
+	pthread_cond_t done; ///< signals completed jobs to the submitters
+	DemJob *head;
+	DemJob *tail;
+	bool stop;
+	int completion_fd[2]; ///< eventfd (or pipe) signaled on completion
+#endif
+	size_t n_pending; ///< asynchronous requests not yet completed or polled
+	size_t max_pending;
+	RzDemangleRequest *completed_head;
+	RzDemangleRequest *completed_tail;
+};
+
+static char *ctx_demangle(RzDemangleCtx *ctx, RzDemangleLang lang, const char *symbol, RzDemangleOpts opts) {
+	char *result = NULL;
+	if (ctx->memo && dem_memo_get(ctx->memo, lang, opts, symbol, &result)) {
+		return result;
+	}
+#if WITH_FILTER
+	if (libdemangle_filter_contains(ctx->filter, lang, symbol)) {
+		return NULL;
+	}
+#endif
+#if WITH_CACHE
+	result = ctx->cache ? libdemangle_cache_demangle(ctx->cache, lang, symbol, opts) : libdemangle_handler(lang, symbol, opts);
+#else
+	result = libdemangle_handler(lang, symbol, opts);
+#endif
+#if WITH_FILTER
+	if (!result) {
+		libdemangle_filter_add(ctx->filter, lang, symbol);
+	}
+#endif
+	if (ctx->memo) {
+		dem_memo_set(ctx->memo, lang, opts, symbol, result);
+	}
+	return result;
+}
+
+/**
+ * \brief Demangles a single symbol via the context caches.
+ */
+DEM_LIB_EXPORT char *libdemangle_ctx_demangle(RzDemangleCtx *ctx, RzDemangleLang lang, const char *symbol, RzDemangleOpts opts) {
+	if (!ctx || !symbol) {
+		return NULL;
+	}
+#if WITH_CORPUS
+	if (ctx->capture) {
+		libdemangle_capture_add(ctx->capture, lang, symbol, opts);
+	}
+#endif
+	if (!ctx->sampler) {
+		return ctx_demangle(ctx, lang, symbol, opts);
+	}
+	ut64 start = dem_sampler_ticks();
+	char *result = ctx_demangle(ctx, lang, symbol, opts);
+	dem_sampler_add(ctx->sampler, lang, symbol, result, dem_sampler_ticks() - start);
+	return result;
+}
+
+static void job_init(DemJob *job, RzDemangleCtx *ctx, RzDemangleBatch *batch) {
+	job->ctx = ctx;
+	job->batch = batch;
+	job->n_items = batch->n_symbols;
+	job->chunk_size = BATCH_CHUNK_SIZE;
+}
+
+/**
+ * \brief Runs chunks of the job until no item is left; returns the
+ * number of items done by the caller.
+ */
+static size_t job_run(DemJob *job) {
+	RzDemangleBatch *batch = job->batch;
+	size_t count = 0;
+	while (!__atomic_load_n(&job->cancelled, __ATOMIC_RELAXED)) {
+		size_t start = __atomic_fetch_add(&job->cursor, job->chunk_size, __ATOMIC_RELAXED);
+		if (start >= job->n_items) {
+			break;
+		}
+		size_t end = RZ_MIN(start + job->chunk_size, job->n_items);
+		if (job->run) {
+			job->run(job->user, start, end);
+		}
+		for (size_t i = start; !job->run && i < end; ++i) {
+			ut64 begin = batch->ns ? dem_sampler_now_ns() : 0;
+			batch->results[i] = libdemangle_ctx_demangle(job->ctx, batch->lang, batch->symbols[i], batch->opts);
+			if (batch->ns) {
+				batch->ns[i] = dem_sampler_now_ns() - begin;
+			}
+		}
+		count += end - start;
+	}
+	return count;
+}
+
+static void ctx_lock(RzDemangleCtx *ctx) {
+#if WITH_THREADS
+	pthread_mutex_lock(&ctx->lock);
+#endif
+}
+
+static void ctx_unlock(RzDemangleCtx *ctx) {
+#if WITH_THREADS
+	pthread_mutex_unlock(&ctx->lock);
+#endif
+}
+
+#if WITH_THREADS
+static void completion_signal(RzDemangleCtx *ctx) {
+	if (ctx->completion_fd[1] < 0) {
+		return;
+	}
+	ut64 one = 1;
+	// a full pipe is already readable, the error is fine.
+	ssize_t written = write(ctx->completion_fd[1], &one, ctx->completion_fd[0] == ctx->completion_fd[1] ? sizeof(one) : 1);
+	(void)written;
+}
+
+static void completion_drain(RzDemangleCtx *ctx) {
+	ut8 buffer[64];
+	if (ctx->completion_fd[0] < 0) {
+		return;
+	}
+	while (read(ctx->completion_fd[0], buffer, sizeof(buffer)) > 0) {
+	}
+}
+
+static bool completion_fd_open(RzDemangleCtx *ctx) {
+#if __linux__
+	int fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+	if (fd >= 0) {
+		ctx->completion_fd[0] = ctx->completion_fd[1] = fd;
+		return true;
+	}
+#endif
+	int fds[2];
+	if (pipe(fds)) {
+		return false;
+	}
+	for (int i = 0; i < 2; ++i) {
+		fcntl(fds[i], F_SETFL, fcntl(fds[i], F_GETFL) | O_NONBLOCK);
+		fcntl(fds[i], F_SETFD, FD_CLOEXEC);
+	}
+	ctx->completion_fd[0] = fds[0];
+	ctx->completion_fd[1] = fds[1];
+	return true;
+}
+#endif
+
+static void completion_push(RzDemangleCtx *ctx, RzDemangleRequest *request) {
+	if (ctx->completed_tail) {
+		ctx->completed_tail->next = request;
+	} else {
+		ctx->completed_head = request;
+#if WITH_THREADS
+		completion_signal(ctx);
+#endif
+	}
+	ctx->completed_tail = request;
+}
+
+/**
+ * \brief Removes the first request of the completion queue, which is no
+ * longer pending; must be called with the context locked.
+ */
+static RzDemangleRequest *completion_pop(RzDemangleCtx *ctx) {
+	RzDemangleRequest *request = ctx->completed_head;
+	if (!request) {
+		return NULL;
+	}
+	ctx->completed_head = request->next;
+	if (!ctx->completed_head) {
+		ctx->completed_tail = NULL;
+#if WITH_THREADS
+		completion_drain(ctx);
+#endif
+	}
+	request->next = NULL;
+	ctx->n_pending--;
+	__atomic_store_n(&request->ctx, NULL, __ATOMIC_RELEASE);
+	return request;
+}
+
+/**
+ * \brief Delivers the completion of the request; must be called with the
+ * context locked, which is temporarily released to run the callback.
+ */
+static void request_complete(RzDemangleCtx *ctx, RzDemangleRequest *request) {
+	request->status = request->job.cancelled ? RZ_DEMANGLE_REQUEST_CANCELLED : RZ_DEMANGLE_REQUEST_DONE;
+	if (request->callback) {
+		ctx->n_pending--;
+		__atomic_store_n(&request->ctx, NULL, __ATOMIC_RELEASE);
+		ctx_unlock(ctx);
+		// the callback may free the request, it must not be used anymore.
+		request->callback(request, request->user);
+		ctx_lock(ctx);
+		return;
+	}
+	completion_push(ctx, request);
+}
+
+#if WITH_THREADS
+static void job_dequeue(RzDemangleCtx *ctx, DemJob *job) {
+	if (!job->queued) {
+		return;
+	}
+	DemJob **p = &ctx->head;
+	DemJob *prev = NULL;
+	while (*p && *p != job) {
+		prev = *p;
+		p = &(*p)->next;
+	}
+	*p = job->next;
+	if (ctx->tail == job) {
+		ctx->tail = prev;
+	}
+	job->queued = false;
+}
+
+static void *worker_main(void *user) {
+	RzDemangleCtx *ctx = user;
+	pthread_mutex_lock(&ctx->lock);
+	// the queued jobs are cancelled on stop, but still need to be completed.
+	while (!ctx->stop || ctx->head) {
+		DemJob *job = ctx->head;
+		if (!job) {
+			pthread_cond_wait(&ctx->wake, &ctx->lock);
+			continue;
+		}
+		job->n_users++;
+		pthread_mutex_unlock(&ctx->lock);
+		size_t count = job_run(job);
+		pthread_mutex_lock(&ctx->lock);
+		// the job cursor is exhausted, nobody else must pick it.
+		job_dequeue(ctx, job);
+		job->n_done += count;
+		job->n_users--;
+		if (job->n_users) {
+			continue;
+		} else if (job->request) {
+			request_complete(ctx, job->request);
+		} else if (job->n_done == job->n_items) {
+			pthread_cond_broadcast(&ctx->done);
+		}
+	}
+	pthread_mutex_unlock(&ctx->lock);
+	return NULL;
+}
+
+static size_t ctx_default_threads(void) {
+	long n = sysconf(_SC_NPROCESSORS_ONLN);
+	return n > 0 ? (size_t)n : 1;
+}
+#endif
+
+/**
+ * \brief Creates a demangle context.
+ *
+ * \param n_threads  Number of threads used by the batches (0 means one per
+ *                   online cpu); the thread submitting a batch counts as one.
+ */
+DEM_LIB_EXPORT RzDemangleCtx *libdemangle_ctx_new(size_t n_threads) {
+	RzDemangleCtx *ctx = RZ_NEW0(RzDemangleCtx);
+	if (!ctx) {
+		return NULL;
+	}
+	ctx->max_pending = BATCH_MAX_PENDING;
+#if WITH_CORPUS
+	const char *capture_path = getenv("RZ_DEMANGLE_CAPTURE");
+	if (capture_path && *capture_path) {
+		// a corpus which cannot be opened never prevents demangling
+		ctx->capture = libdemangle_capture_open(capture_path);
+		ctx->capture_owned = true;
+	}
+#endif
+#if WITH_THREADS
+	ctx->completion_fd[0] = ctx->completion_fd[1] = -1;
+	if (!n_threads) {
+		n_threads = ctx_default_threads();
+	}
+	pthread_mutex_init(&ctx->lock, NULL);
+	pthread_cond_init(&ctx->wake, NULL);
+	pthread_cond_init(&ctx->done, NULL);
+	if (n_threads > 1) {
+		ctx->threads = calloc(n_threads - 1, sizeof(pthread_t));
+		if (!ctx->threads) {
+			libdemangle_ctx_free(ctx);
+			return NULL;
+		}
+		for (; ctx->n_threads < n_threads - 1; ctx->n_threads++) {
+			if (pthread_create(&ctx->threads[ctx->n_threads], NULL, worker_main, ctx)) {
+				break;
+			}
+		}
+	}
+#endif
+	return ctx;
+}
+
+DEM_LIB_EXPORT void libdemangle_ctx_free(RzDemangleCtx *ctx) {
+	if (!ctx) {
+		return;
+	}
+#if WITH_THREADS
+	pthread_mutex_lock(&ctx->lock);
+	ctx->stop = true;
+	for (DemJob *job = ctx->head; job; job = job->next) {
+		__atomic_store_n(&job->cancelled, true, __ATOMIC_RELAXED);
+	}
+	pthread_cond_broadcast(&ctx->wake);
+	pthread_mutex_unlock(&ctx->lock);
+	for (size_t i = 0; i < ctx->n_threads; ++i) {
+		pthread_join(ctx->threads[i], NULL);
+	}
+	free(ctx->threads);
+#endif
+	// the requests are owned by the caller: the deferred callbacks are run,
+	// the other requests are detached and must still be freed
+	RzDemangleRequest *request;
+	while ((request = completion_pop(ctx))) {
+		if (request->callback) {
+			request->callback(request, request->user);
+		}
+	}
+#if WITH_THREADS
+	if (ctx->completion_fd[0] >= 0) {
+		close(ctx->completion_fd[0]);
+	}
+	if (ctx->completion_fd[1] >= 0 && ctx->completion_fd[1] != ctx->completion_fd[0]) {
+		close(ctx->completion_fd[1]);
+	}
+	pthread_cond_destroy(&ctx->done);
+	pthread_cond_destroy(&ctx->wake);
+	pthread_mutex_destroy(&ctx->lock);
+#endif
+	dem_memo_free(ctx->memo);
+#if WITH_CORPUS
+	if (ctx->capture_owned) {
+		libdemangle_capture_close(ctx->capture);
+	}
+#endif
+	free(ctx);
+}
+
+/**
+ * \brief Enables a shared in-memory cache of at most \p max_entries results;
+ * must be called before the context is used.
+ */
+DEM_LIB_EXPORT int libdemangle_ctx_set_memo(RzDemangleCtx *ctx, size_t max_entries) {
+	if (!ctx) {
+		return false;
+	}
+	dem_memo_free(ctx->memo);
+	ctx->memo = max_entries ? dem_memo_new(max_entries) : NULL;
+	return !max_entries || ctx->memo;
+}
+
+/**
+ * \brief Sets the sampler of the slowest symbols, which times every symbol
+ * demangled via the context; the sampler is owned by the caller and must
+ * outlive the context.
+ */
+DEM_LIB_EXPORT void libdemangle_ctx_set_sampler(RzDemangleCtx *ctx, RzDemangleSampler *sampler) {
+	if (ctx) {
+		ctx->sampler = sampler;
+	}
+}
+
+#if WITH_CACHE
+/**
+ * \brief Sets the persistent cache used by the context; the cache is owned
+ * by the caller and must outlive the context.
+ */
+DEM_LIB_EXPORT void libdemangle_ctx_set_cache(RzDemangleCtx *ctx, RzDemangleCache *cache) {
+	if (ctx) {
+		ctx->cache = cache;
+	}
+}
+#endif
+
+#if WITH_CORPUS
+/**
+ * \brief Sets the capture which records every symbol demangled via the
+ * context, replacing the one opened via RZ_DEMANGLE_CAPTURE; the capture is
+ * owned by the caller and must outlive the context.
+ */
+DEM_LIB_EXPORT void libdemangle_ctx_set_capture(RzDemangleCtx *ctx, RzDemangleCapture *capture) {
+	if (!ctx) {
+		return;
+	}
+	if (ctx->capture_owned) {
+		libdemangle_capture_close(ctx->capture);
+		ctx->capture_owned = false;
+	}
+	ctx->capture = capture;
+}
+#endif
+
+#if WITH_FILTER
+/**
+ * \brief Sets the filter of the symbols known not to demangle, which is
+ * consulted before demangling and updated on failure; the filter is owned
+ * by the caller and must outlive the context.
+ */
+DEM_LIB_EXPORT void libdemangle_ctx_set_filter(RzDemangleCtx *ctx, RzDemangleFilter *filter) {
+	if (ctx) {
+		ctx->filter = filter;
+	}
+}
+#endif
+
+/**
+ * \brief Runs the job on the worker pool, with the calling thread helping,
+ * and waits for its completion; small jobs are run by the caller alone.
+ */
+static void ctx_run(RzDemangleCtx *ctx, DemJob *job) {
+#if WITH_THREADS
+	if (ctx->n_threads > 0 && job->n_items > job->chunk_size) {
+		pthread_mutex_lock(&ctx->lock);
+		job->queued = true;
+		if (ctx->tail) {
+			ctx->tail->next = job;
+		} else {
+			ctx->head = job;
+		}
+		ctx->tail = job;
+		pthread_cond_broadcast(&ctx->wake);
+		pthread_mutex_unlock(&ctx->lock);
+
+		size_t count = job_run(job);
+
+		pthread_mutex_lock(&ctx->lock);
+		job_dequeue(ctx, job);
+		job->n_done += count;
+		while (job->n_done < job->n_items || job->n_users) {
+			pthread_cond_wait(&ctx->done, &ctx->lock);
+		}
+		pthread_mutex_unlock(&ctx->lock);
+		return;
+	}
+#endif
+	job_run(job);
+}
+
+/**
+ * \brief Demangles all the symbols of the batch in parallel.
+ *
+ * Each results[i] is set to the demangled symbols[i] or NULL on failure and
+ * must be freed by the caller; when the batch has an ns array, ns[i] is set
+ * to the time the worker spent on symbols[i]. Safe to call from multiple
+ * threads.
+ */
+DEM_LIB_EXPORT int libdemangle_batch(RzDemangleCtx *ctx, RzDemangleBatch *batch) {
+	if (!ctx || !batch || (batch->n_symbols && (!batch->symbols || !batch->results))) {
+		return false;
+	}
+	DemJob job = { 0 };
+	job_init(&job, ctx, batch);
+	ctx_run(ctx, &job);
+	return true;
+}
+
+/**
+ * \brief Runs \p run over the chunks of \p n_items items in parallel on the
+ * worker pool and returns once every chunk is done.
+ */
+void dem_ctx_parallel(RzDemangleCtx *ctx, size_t n_items, size_t chunk_size, DemParallelRun run, void *user) {
+	DemJob job = { 0 };
+	job.ctx = ctx;
+	job.run = run;
+	job.user = user;
+	job.n_items = n_items;
+	job.chunk_size = chunk_size ? chunk_size : 1;
+	ctx_run(ctx, &job);
+}
+
+/**
+ * \brief Returns the number of threads running the jobs, the caller included.
+ */
+size_t dem_ctx_n_threads(RzDemangleCtx *ctx) {
+#if WITH_THREADS
+	return ctx->n_threads + 1;
+#else
+	return 1;
+#endif
+}
+
+typedef struct {
+	ut64 hash;
+	size_t length;
+	size_t id; ///< index of the unique symbol plus one, 0 when free
+} DemUniqueSlot;
+
+typedef struct {
+	DemUniqueSlot *slots;
+	size_t mask;
+	const char **symbols;
+	char **results;
+	size_t *first; ///< index of the first occurrence of each unique symbol
+	unsigned long long *ns; ///< time of each unique symbol, when asked by the batch
+	size_t n_unique;
+	size_t capacity;
+} DemUnique;
+
+/**
+ * \brief Hashes the symbol 8 bytes at a time and returns its length.
+ */
+static ut64 unique_hash(const char *symbol, size_t *length) {
+	size_t size = strlen(symbol);
+	ut64 hash = size * 0x9e3779b97f4a7c15ull;
+	const char *p = symbol;
+	for (; size - (p - symbol) >= 8; p += 8) {
+		ut64 word;
+		memcpy(&word, p, sizeof(word));
+		hash = (hash ^ word) * 0xff51afd7ed558ccdull;
+		hash ^= hash >> 32;
+	}
+	ut64 tail = 0;
+	memcpy(&tail, p, size - (p - symbol));
+	hash = (hash ^ tail) * 0xc4ceb9fe1a85ec53ull;
+	*length = size;
+	return hash ^ (hash >> 29);
+}
+
+static bool unique_grow(DemUnique *unique) {
+	size_t capacity = unique->capacity ? unique->capacity * 2 : 64;
+	const char **symbols = realloc(unique->symbols, capacity * sizeof(char *));
+	unique->symbols = symbols ? symbols : unique->symbols;
+	char **results = realloc(unique->results, capacity * sizeof(char *));
+	unique->results = results ? results : unique->results;
+	size_t *first = realloc(unique->first, capacity * sizeof(size_t));
+	unique->first = first ? first : unique->first;
+	// the load factor is kept at most 1/2
+	DemUniqueSlot *slots = calloc(capacity * 2, sizeof(DemUniqueSlot));
+	if (!symbols || !results || !first || !slots) {
+		free(slots);
+		return false;
+	}
+	size_t mask = capacity * 2 - 1;
+	for (size_t i = 0; unique->slots && i <= unique->mask; ++i) {
+		DemUniqueSlot *slot = &unique->slots[i];
+		if (!slot->id) {
+			continue;
+		}
+		size_t k = slot->hash & mask;
+		while (slots[k].id) {
+			k = (k + 1) & mask;
+		}
+		slots[k] = *slot;
+	}
+	free(unique->slots);
+	unique->slots = slots;
+	unique->mask = mask;
+	unique->capacity = capacity;
+	return true;
+}
+
+/**
+ * \brief Returns the id of the symbol, adding it when seen for the first
+ * time at index \p i, or SIZE_MAX on allocation failure.
+ */
+static size_t unique_add(DemUnique *unique, const char *symbol, size_t i) {
+	if (unique->n_unique == unique->capacity && !unique_grow(unique)) {
+		return SIZE_MAX;
+	}
+	size_t length;
+	ut64 hash = unique_hash(symbol, &length);
+	size_t k = hash & unique->mask;
+	for (; unique->slots[k].id; k = (k + 1) & unique->mask) {
+		DemUniqueSlot *slot = &unique->slots[k];
+		if (slot->hash == hash && slot->length == length && !memcmp(unique->symbols[slot->id - 1], symbol, length)) {
+			return slot->id - 1;
+		}
+	}
+	size_t id = unique->n_unique++;
+	unique->slots[k].hash = hash;
+	unique->slots[k].length = length;
+	unique->slots[k].id = id + 1;
+	unique->symbols[id] = symbol;
+	unique->results[id] = NULL;
+	unique->first[id] = i;
+	return id;
+}
+
+/**
+ * \brief Demangles the symbols of the batch like libdemangle_batch(), but
+ * each distinct symbol only once.
+ *
+ * The symbols are deduplicated via a hash set, the unique ones are demangled
+ * in parallel and their results are copied back to every occurrence, in the
+ * original order. Besides the batch, the memory used is proportional to the
+ * number of unique symbols, thus it pays off when the symbols repeat.
+ * When the time of each symbol is asked, the repeated ones, which are not
+ * demangled again, get ULLONG_MAX in place of a time.
+ */
+DEM_LIB_EXPORT int libdemangle_batch_unique(RzDemangleCtx *ctx, RzDemangleBatch *batch) {
+	if (!ctx || !batch || (batch->n_symbols && (!batch->symbols || !batch->results))) {
+		return false;
+	}
+	DemUnique unique = { 0 };
+	int ret = false;
+	// the results hold the ids of the unique symbols until fanned out
+	// from the index owned on, the results are owned
+	size_t owned = batch->n_symbols;
+	for (size_t i = 0; i < batch->n_symbols; ++i) {
+		size_t id = unique_add(&unique, batch->symbols[i], i);
+		if (id == SIZE_MAX) {
+			goto end;
+		}
+		batch->results[i] = (char *)(uintptr_t)id;
+	}
+
+	RzDemangleBatch unique_batch = *batch;
+	unique_batch.symbols = unique.symbols;
+	unique_batch.results = unique.results;
+	unique_batch.n_symbols = unique.n_unique;
+	if (batch->ns && !(unique.ns = malloc((unique.n_unique + 1) * sizeof(unsigned long long)))) {
+		goto end;
+	}
+	unique_batch.ns = unique.ns;
+	if (!libdemangle_batch(ctx, &unique_batch)) {
+		goto end;
+	}
+	// backwards, so the first occurrence takes the result after the copies
+	for (; owned > 0; --owned) {
+		size_t i = owned - 1;
+		size_t id = (size_t)(uintptr_t)batch->results[i];
+		char *result = unique.results[id];
+		if (batch->ns) {
+			// the copies are not timed
+			batch->ns[i] = unique.first[id] == i ? unique.ns[id] : ~0ull;
+		}
+		if (unique.first[id] == i || !result) {
+			batch->results[i] = result;
+			unique.results[id] = NULL;
+		} else if (!(batch->results[i] = strdup(result))) {
+			goto end;
+		}
+	}
+	ret = true;
+
+end:
+	if (!ret) {
+		for (size_t k = 0; k < batch->n_symbols; ++k) {
+			if (k >= owned) {
+				free(batch->results[k]);
+			}
+			batch->results[k] = NULL;
+		}
+		for (size_t k = 0; k < unique.n_unique; ++k) {
+			free(unique.results[k]);
+		}
+	}
+	free(unique.slots);
+	free(unique.symbols);
+	free(unique.results);
+	free(unique.first);
+	free(unique.ns);
+	return ret;
+}
+
+/**
+ * \brief Limits the asynchronous requests which are either running or
+ * waiting to be polled; libdemangle_submit() fails beyond this limit.
+ */
+DEM_LIB_EXPORT void libdemangle_ctx_set_max_pending(RzDemangleCtx *ctx, size_t max_pending) {
+	if (!ctx) {
+		return;
+	}
+	ctx_lock(ctx);
+	ctx->max_pending = max_pending;
+	ctx_unlock(ctx);
+}
+
+/**
+ * \brief Submits the batch to the worker pool and returns immediately.
+ *
+ * When the batch is done (or cancelled) the \p callback is invoked from a
+ * worker thread; without callback the request is added to the completion
+ * queue, see libdemangle_completion_fd() and libdemangle_complete().
+ * The batch must stay valid until the completion. A context without worker
+ * threads runs the batch before returning and queues the request in any
+ * case: its callback is run by the next libdemangle_complete().
+ *
+ * \return the request, owned by the caller, or NULL on error or when too
+ * many requests are pending, in which case the results are left untouched.
+ */
+DEM_LIB_EXPORT RzDemangleRequest *libdemangle_submit(RzDemangleCtx *ctx, RzDemangleBatch *batch, RzDemangleCompletion callback, void *user) {
+	if (!ctx || !batch || (batch->n_symbols && (!batch->symbols || !batch->results))) {
+		return NULL;
+	}
+	RzDemangleRequest *request = RZ_NEW0(RzDemangleRequest);
+	if (!request) {
+		return NULL;
+	}
+	job_init(&request->job, ctx, batch);
+	request->job.request = request;
+	request->ctx = ctx;
+	request->callback = callback;
+	request->user = user;
+
+	ctx_lock(ctx);
+	if (ctx->n_pending >= ctx->max_pending) {
+		// rejected before touching the results of the caller
+		ctx_unlock(ctx);
+		free(request);
+		return NULL;
+	}
+	ctx->n_pending++;
+	// cancelled requests leave the results which were not computed to NULL.
+	memset(batch->results, 0, batch->n_symbols * sizeof(char *));
+#if WITH_THREADS
+	if (ctx->n_threads > 0) {
+		request->job.queued = true;
+		if (ctx->tail) {
+			ctx->tail->next = &request->job;
+		} else {
+			ctx->head = &request->job;
+		}
+		ctx->tail = &request->job;
+		pthread_cond_broadcast(&ctx->wake);
+		ctx_unlock(ctx);
+		return request;
+	}
+#endif
+	ctx_unlock(ctx);
+	job_run(&request->job);
+	ctx_lock(ctx);
+	// the callback is deferred to libdemangle_complete(), so that it may free
+	// the request which is returned here
+	request->status = request->job.cancelled ? RZ_DEMANGLE_REQUEST_CANCELLED : RZ_DEMANGLE_REQUEST_DONE;
+	completion_push(ctx, request);
+	ctx_unlock(ctx);
+	return request;
+}
+
+/**
+ * \brief Cancels the request; the symbols which are already being
+ * demangled are completed, the others are left to NULL. The request must
+ * not be freed meanwhile (e.g. by its callback on a worker).
+ *
+ * \return false when the request was already completed.
+ */
+DEM_LIB_EXPORT int libdemangle_cancel(RzDemangleRequest *request) {
+	if (!request) {
+		return false;
+	}
+	RzDemangleCtx *ctx = __atomic_load_n(&request->ctx, __ATOMIC_ACQUIRE);
+	if (!ctx) {
+		// already handed to the caller, thus completed
+		return false;
+	}
+	ctx_lock(ctx);
+	if (request->status != RZ_DEMANGLE_REQUEST_PENDING) {
+		ctx_unlock(ctx);
+		return false;
+	}
+	__atomic_store_n(&request->job.cancelled, true, __ATOMIC_RELAXED);
+#if WITH_THREADS
+	if (request->job.queued && !request->job.n_users) {
+		// not yet picked by any worker
+		job_dequeue(ctx, &request->job);
+		request_complete(ctx, request);
+	}
+#endif
+	ctx_unlock(ctx);
+	return true;
+}
+
+/**
+ * \brief Returns a file descriptor which becomes readable when the
+ * completion queue is not empty, or -1 when not supported.
+ */
+DEM_LIB_EXPORT int libdemangle_completion_fd(RzDemangleCtx *ctx) {
+	if (!ctx) {
+		return -1;
+	}
+#if WITH_THREADS
+	ctx_lock(ctx);
+	if (ctx->completion_fd[0] < 0 && completion_fd_open(ctx) && ctx->completed_head) {
+		completion_signal(ctx);
+	}
+	int fd = ctx->completion_fd[0];
+	ctx_unlock(ctx);
+	return fd;
+#else
+	return -1;
+#endif
+}
+
+/**
+ * \brief Pops a completed request (without callback) from the completion
+ * queue; returns NULL when the queue is empty.
+ *
+ * The callbacks of the requests completed by a context without worker
+ * threads are run here, from the calling thread.
+ */
+DEM_LIB_EXPORT RzDemangleRequest *libdemangle_complete(RzDemangleCtx *ctx) {
+	if (!ctx) {
+		return NULL;
+	}
+	ctx_lock(ctx);
+	RzDemangleRequest *request;
+	while ((request = completion_pop(ctx)) && request->callback) {
+		ctx_unlock(ctx);
+		// the callback may free the request, it must not be used anymore.
+		request->callback(request, request->user);
+		ctx_lock(ctx);
+	}
+	ctx_unlock(ctx);
+	return request;
+}
+
+DEM_LIB_EXPORT RzDemangleBatch *libdemangle_request_batch(RzDemangleRequest *request) {
+	return request ? request->job.batch : NULL;
+}
+
+DEM_LIB_EXPORT void *libdemangle_request_user(RzDemangleRequest *request) {
+	return request ? request->user : NULL;
+}
+
+/**
+ * \brief Returns the status of the request, which must not be freed
+ * meanwhile (e.g. by its callback on a worker).
+ */
+DEM_LIB_EXPORT RzDemangleRequestStatus libdemangle_request_status(RzDemangleRequest *request) {
+	if (!request) {
+		return RZ_DEMANGLE_REQUEST_CANCELLED;
+	}
+	RzDemangleCtx *ctx = __atomic_load_n(&request->ctx, __ATOMIC_ACQUIRE);
+	if (!ctx) {
+		return request->status;
+	}
+	ctx_lock(ctx);
+	RzDemangleRequestStatus status = request->status;
+	ctx_unlock(ctx);
+	return status;
+}
+
+/**
+ * \brief Frees a completed request, polled or not; the batch results are
+ * owned by the caller and are not freed.
+ */
+DEM_LIB_EXPORT void libdemangle_request_free(RzDemangleRequest *request) {
+	if (!request) {
+		return;
+	}
+	RzDemangleCtx *ctx = __atomic_load_n(&request->ctx, __ATOMIC_ACQUIRE);
+	if (ctx) {
+		// not yet polled: drops it from the completion queue
+		ctx_lock(ctx);
+		RzDemangleRequest *prev = NULL;
+		RzDemangleRequest *it = ctx->completed_head;
+		while (it && it != request) {
+			prev = it;
+			it = it->next;
+		}
+		if (it == request && !prev) {
+			completion_pop(ctx);
+		} else if (it == request) {
+			prev->next = request->next;
+			if (ctx->completed_tail == request) {
+				ctx->completed_tail = prev;
+			}
+			ctx->n_pending--;
+		}
+		ctx_unlock(ctx);
+	}
+	free(request);
+}
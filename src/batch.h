@@ -0,0 +1,16 @@
+// SPDX-FileCopyrightText: 2026 RizinOrg <info@rizin.re>
+// SPDX-License-Identifier: LGPL-3.0-only
+
+#ifndef BATCH_H
+#define BATCH_H
+
+#include "demangler_util.h"
+#include <rz_libdemangle.h>
+
+/* runs the items [start, end) of a generic job */
+typedef void (*DemParallelRun)(void *user, size_t start, size_t end);
+
+void dem_ctx_parallel(RzDemangleCtx *ctx, size_t n_items, size_t chunk_size, DemParallelRun run, void *user);
+size_t dem_ctx_n_threads(RzDemangleCtx *ctx);
+
+#endif /* BATCH_H */
@@ -0,0 +1,587 @@
+// SPDX-FileCopyrightText: 2026 RizinOrg <info@rizin.re>
+// SPDX-License-Identifier: LGPL-3.0-only
+
+/**
+ * \file cache.c
+ *
+ * Persistent on-disk demangle cache.
+ *
+ * The file is made of a fixed header, an open-addressed bucket table and
+ * an append-only heap of records (key + demangled string):
+ *
+ *   [ CacheHeader ][ CacheBucket * n_buckets ][ heap ... heap_capacity ]
+ *
+ * The file is created sparse with its final size, thus every process maps
+ * it once and the mapping never moves; readers never take any lock.
+ *
+ * Writers serialize through flock() (and a mutex for threads of the same
+ * process), append the record to the heap, publish the new heap size and
+ * finally publish the bucket by storing its hash with release semantics:
+ * a reader that observes a non zero hash always observes a complete record.
+ *
+ * When the table or the heap is full, the writer compacts the cache into a
+ * bigger file which atomically replaces the old one via rename(); the old
+ * file is then marked as retired, so every reader/writer still using it
+ * switches to the new file at the next access.
+ *
+ * The header is stamped with the library version and the demanglers built
+ * in: a cache written by another version or build holds outcomes which may
+ * differ, thus a writer replaces it with an empty one.
+ */
+
+#include "demangler_util.h"
+#include <rz_libdemangle.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define CACHE_MAGIC            "RZDMCACH"
+#define CACHE_VERSION          2
+#define CACHE_DEFAULT_BUCKETS  (1u << 14)
+#define CACHE_LIB_VERSION_SIZE 16
+#define CACHE_DEFAULT_HEAP     (16ull << 20)
+#define CACHE_MAX_LOAD(n)      (((n) / 4) * 3)
+#define CACHE_ALIGN(x)         (((x) + 7) & ~(ut64)7)
+#define CACHE_RECORD_SIZE(s, o) CACHE_ALIGN(sizeof(CacheRecord) + (s) + 1 + (o) + 1)
+
+#define atomic_load_acq(p)     __atomic_load_n(p, __ATOMIC_ACQUIRE)
+#define atomic_store_rel(p, v) __atomic_store_n(p, v, __ATOMIC_RELEASE)
+
+typedef struct {
+	char magic[8];
+	ut32 version;
+	ut32 n_buckets; ///< always a power of 2
+	ut64 heap_offset; ///< file offset of the heap
+	ut64 heap_capacity; ///< bytes reserved for the heap
+	ut64 heap_size; ///< bytes used within the heap (published by writers)
+	ut32 n_entries;
+	ut32 retired; ///< set when the file has been replaced by a compacted one
+	char lib_version[CACHE_LIB_VERSION_SIZE]; ///< RZ_LIBDEMANGLE_VERSION of the writer
+	ut32 lib_features; ///< DEM_LIB_FEATURES of the writer
+	ut32 reserved;
+} CacheHeader;
+
+typedef struct {
+	ut64 hash; ///< 0 means empty; stored last by writers
+	ut64 offset; ///< record offset within the heap
+} CacheBucket;
+
+typedef struct {
+	ut64 hash;
+	ut32 lang;
+	ut32 opts;
+	ut32 symbol_len;
+	ut32 output_len;
+	// followed by symbol\0 and output\0
+} CacheRecord;
+
+typedef struct cache_map_t {
+	int fd;
+	ut8 *base;
+	size_t size;
+	CacheHeader *header;
+	CacheBucket *buckets;
+	ut8 *heap;
+	ut64 heap_capacity; ///< copied at open, the header can be rewritten
+	struct cache_map_t *prev; ///< retired maps, freed on close
+} CacheMap;
+
+struct rz_demangle_cache_t {
+	char *path;
+	bool read_only;
+	CacheMap *map;
+	pthread_mutex_t lock;
+};
+
+static ut64 cache_key_hash(RzDemangleLang lang, RzDemangleOpts opts, const char *symbol, size_t length) {
+	ut64 hash = dem_hash(symbol, length);
+	hash ^= ((ut64)lang << 56) ^ ((ut64)opts << 32);
+	hash *= 0x9e3779b97f4a7c15ull;
+	return hash ? hash : 1;
+}
+
+static void cache_map_free(CacheMap *map) {
+	while (map) {
+		CacheMap *prev = map->prev;
+		munmap(map->base, map->size);
+		close(map->fd);
+		free(map);
+		map = prev;
+	}
+}
+
+static void cache_lib_version(char *lib_version) {
+	memset(lib_version, 0, CACHE_LIB_VERSION_SIZE);
+	strncpy(lib_version, RZ_LIBDEMANGLE_VERSION, CACHE_LIB_VERSION_SIZE - 1);
+}
+
+/**
+ * \brief Returns true when the cache was written by another version or
+ * build of the library (or in another format), thus must be reset.
+ */
+static bool cache_header_is_stale(const CacheHeader *hdr) {
+	char lib_version[CACHE_LIB_VERSION_SIZE];
+	cache_lib_version(lib_version);
+	return hdr->version != CACHE_VERSION || memcmp(hdr->lib_version, lib_version, sizeof(lib_version)) ||
+		hdr->lib_features != DEM_LIB_FEATURES;
+}
+
+static bool cache_header_is_valid(const CacheHeader *hdr, size_t size) {
+	if (!hdr->n_buckets || (hdr->n_buckets & (hdr->n_buckets - 1)) || hdr->n_entries > CACHE_MAX_LOAD(hdr->n_buckets) ||
+		!hdr->heap_capacity || hdr->heap_offset != CACHE_ALIGN(hdr->heap_offset)) {
+		return false;
+	}
+	// the file may be truncated, corrupt or foreign: nothing may point past its end
+	ut64 table_end = sizeof(CacheHeader) + (ut64)hdr->n_buckets * sizeof(CacheBucket);
+	return hdr->heap_offset >= table_end && hdr->heap_capacity <= size && hdr->heap_offset <= size - hdr->heap_capacity &&
+		hdr->heap_size <= hdr->heap_capacity;
+}
+
+static CacheMap *cache_map_open(const char *path, bool read_only) {
+	int fd = open(path, read_only ? O_RDONLY : O_RDWR);
+	if (fd < 0) {
+		return NULL;
+	}
+	struct stat st;
+	if (fstat(fd, &st) || st.st_size < (off_t)sizeof(CacheHeader)) {
+		close(fd);
+		return NULL;
+	}
+	size_t size = (size_t)st.st_size;
+	int prot = read_only ? PROT_READ : PROT_READ | PROT_WRITE;
+	ut8 *base = mmap(NULL, size, prot, MAP_SHARED, fd, 0);
+	if (base == MAP_FAILED) {
+		close(fd);
+		return NULL;
+	}
+	// a stale cache is reset by the writers, any other invalid file is never replaced
+	const CacheHeader *hdr = (const CacheHeader *)base;
+	int err = 0;
+	if (memcmp(hdr->magic, CACHE_MAGIC, sizeof(hdr->magic))) {
+		err = EINVAL;
+	} else if (cache_header_is_stale(hdr)) {
+		err = ESTALE;
+	} else if (!cache_header_is_valid(hdr, size)) {
+		err = EINVAL;
+	}
+	CacheMap *map = err ? NULL : RZ_NEW0(CacheMap);
+	if (!map) {
+		munmap(base, size);
+		close(fd);
+		errno = err ? err : ENOMEM;
+		return NULL;
+	}
+	map->fd = fd;
+	map->base = base;
+	map->size = size;
+	map->header = (CacheHeader *)base;
+	map->buckets = (CacheBucket *)(base + sizeof(CacheHeader));
+	map->heap = base + map->header->heap_offset;
+	map->heap_capacity = map->header->heap_capacity;
+	return map;
+}
+
+/**
+ * \brief Creates a new empty cache file in a temporary file next to \p path;
+ * the returned path must be renamed/linked to its final destination.
+ */
+static char *cache_file_create(const char *path, ut32 n_buckets, ut64 heap_capacity) {
+	char *tmp = dem_str_newf("%s.XXXXXX", path);
+	if (!tmp) {
+		return NULL;
+	}
+	int fd = mkstemp(tmp);
+	if (fd < 0) {
+		free(tmp);
+		return NULL;
+	}
+	CacheHeader hdr = { 0 };
+	memcpy(hdr.magic, CACHE_MAGIC, sizeof(hdr.magic));
+	hdr.version = CACHE_VERSION;
+	cache_lib_version(hdr.lib_version);
+	hdr.lib_features = DEM_LIB_FEATURES;
+	hdr.n_buckets = n_buckets;
+	hdr.heap_offset = CACHE_ALIGN(sizeof(CacheHeader) + (ut64)n_buckets * sizeof(CacheBucket));
+	hdr.heap_capacity = heap_capacity;
+	// the file is sparse, thus the empty heap does not use any disk space.
+	if (ftruncate(fd, (off_t)(hdr.heap_offset + hdr.heap_capacity)) ||
+		pwrite(fd, &hdr, sizeof(hdr), 0) != (ssize_t)sizeof(hdr) ||
+		fchmod(fd, 0644)) {
+		close(fd);
+		unlink(tmp);
+		free(tmp);
+		return NULL;
+	}
+	close(fd);
+	return tmp;
+}
+
+/**
+ * \brief Returns the record at \p offset when it lies within the published
+ * heap and the mapping; the offset and the sizes come from the file.
+ */
+static const CacheRecord *cache_record_at(const CacheMap *map, ut64 offset, ut64 heap_size) {
+	ut64 limit = RZ_MIN(heap_size, map->heap_capacity);
+	if (offset > limit || limit - offset < sizeof(CacheRecord)) {
+		return NULL;
+	}
+	const CacheRecord *rec = (const CacheRecord *)(map->heap + offset);
+	if (CACHE_RECORD_SIZE((ut64)rec->symbol_len, (ut64)rec->output_len) > limit - offset) {
+		return NULL;
+	}
+	return rec;
+}
+
+/**
+ * \brief Lock-free lookup; returns the record or NULL and stores in \p slot
+ * the bucket where the key would be inserted (NULL when the table is full).
+ */
+static const CacheRecord *cache_map_find(const CacheMap *map, ut64 hash, RzDemangleLang lang, RzDemangleOpts opts, const char *symbol, size_t length, CacheBucket **slot) {
+	ut32 mask = map->header->n_buckets - 1;
+	ut64 heap_size = atomic_load_acq(&map->header->heap_size);
+	if (slot) {
+		*slot = NULL;
+	}
+	for (ut32 i = 0, idx = (ut32)hash & mask; i <= mask; ++i, idx = (idx + 1) & mask) {
+		CacheBucket *bucket = &map->buckets[idx];
+		ut64 bhash = atomic_load_acq(&bucket->hash);
+		if (!bhash) {
+			if (slot) {
+				*slot = bucket;
+			}
+			return NULL;
+		} else if (bhash != hash) {
+			continue;
+		}
+		const CacheRecord *rec = cache_record_at(map, bucket->offset, heap_size);
+		if (rec && rec->lang == (ut32)lang && rec->opts == (ut32)opts &&
+			rec->symbol_len == length && !memcmp(rec + 1, symbol, length)) {
+			return rec;
+		}
+	}
+	return NULL;
+}
+
+static void cache_map_append(CacheMap *map, CacheBucket *slot, ut64 hash, ut32 lang, ut32 opts, const char *symbol, size_t symbol_len, const char *output, size_t output_len) {
+	CacheHeader *hdr = map->header;
+	ut64 offset = hdr->heap_size;
+	CacheRecord *rec = (CacheRecord *)(map->heap + offset);
+	rec->hash = hash;
+	rec->lang = lang;
+	rec->opts = opts;
+	rec->symbol_len = (ut32)symbol_len;
+	rec->output_len = (ut32)output_len;
+	char *data = (char *)(rec + 1);
+	memcpy(data, symbol, symbol_len);
+	data[symbol_len] = 0;
+	memcpy(data + symbol_len + 1, output, output_len);
+	data[symbol_len + 1 + output_len] = 0;
+
+	atomic_store_rel(&hdr->heap_size, offset + CACHE_RECORD_SIZE(symbol_len, output_len));
+	slot->offset = offset;
+	atomic_store_rel(&slot->hash, hash);
+	hdr->n_entries++;
+}
+
+static bool cache_map_has_room(const CacheMap *map, size_t symbol_len, size_t output_len) {
+	const CacheHeader *hdr = map->header;
+	ut64 heap_size = hdr->heap_size;
+	return hdr->n_entries + 1 <= CACHE_MAX_LOAD(hdr->n_buckets) && heap_size <= map->heap_capacity &&
+		CACHE_RECORD_SIZE(symbol_len, output_len) <= map->heap_capacity - heap_size;
+}
+
+/**
+ * \brief Replaces the current map (locked by the caller) with a newly
+ * compacted file which can hold at least \p extra more heap bytes.
+ */
+static bool cache_map_compact(RzDemangleCache *cache, ut64 extra) {
+	CacheMap *old = cache->map;
+	CacheHeader *ohdr = old->header;
+
+	// the sizes come from the file: the growth fails rather than overflows
+	ut32 n_buckets = ohdr->n_buckets;
+	while (CACHE_MAX_LOAD(n_buckets) < (ut64)ohdr->n_entries * 2 + 1) {
+		if (n_buckets > UT32_MAX / 2) {
+			return false;
+		}
+		n_buckets <<= 1;
+	}
+	ut64 heap_capacity = ohdr->heap_capacity;
+	if (extra > UT64_MAX / 4 - ohdr->heap_size) {
+		return false;
+	}
+	while (heap_capacity < (ohdr->heap_size + extra) * 2) {
+		if (heap_capacity > UT64_MAX / 2) {
+			return false;
+		}
+		heap_capacity <<= 1;
+	}
+
+	char *tmp = cache_file_create(cache->path, n_buckets, heap_capacity);
+	if (!tmp) {
+		return false;
+	}
+	CacheMap *map = cache_map_open(tmp, false);
+	if (!map) {
+		unlink(tmp);
+		free(tmp);
+		return false;
+	}
+
+	// copy only the published records; torn appends of crashed writers are dropped.
+	ut64 heap_size = ohdr->heap_size;
+	for (ut32 i = 0; i < ohdr->n_buckets; ++i) {
+		const CacheBucket *bucket = &old->buckets[i];
+		if (!bucket->hash) {
+			continue;
+		}
+		const CacheRecord *rec = cache_record_at(old, bucket->offset, heap_size);
+		if (!rec) {
+			continue;
+		}
+		const char *symbol = (const char *)(rec + 1);
+		CacheBucket *slot = NULL;
+		cache_map_find(map, bucket->hash, rec->lang, rec->opts, symbol, rec->symbol_len, &slot);
+		if (slot) {
+			cache_map_append(map, slot, bucket->hash, rec->lang, rec->opts, symbol, rec->symbol_len, symbol + rec->symbol_len + 1, rec->output_len);
+		}
+	}
+
+	if (flock(map->fd, LOCK_EX) || rename(tmp, cache->path)) {
+		cache_map_free(map);
+		unlink(tmp);
+		free(tmp);
+		return false;
+	}
+	free(tmp);
+
+	// every other user of the old file will move to the new one.
+	atomic_store_rel(&ohdr->retired, 1);
+	msync(old->base, sizeof(CacheHeader), MS_ASYNC);
+	flock(old->fd, LOCK_UN);
+
+	map->prev = old;
+	atomic_store_rel(&cache->map, map);
+	return true;
+}
+
+/**
+ * \brief Returns the current map, switching to the new file when the
+ * current one has been retired by a compaction.
+ */
+static CacheMap *cache_current_map(RzDemangleCache *cache) {
+	CacheMap *map = atomic_load_acq(&cache->map);
+	if (!atomic_load_acq(&map->header->retired)) {
+		return map;
+	}
+	pthread_mutex_lock(&cache->lock);
+	map = cache->map;
+	while (atomic_load_acq(&map->header->retired)) {
+		CacheMap *next = cache_map_open(cache->path, cache->read_only);
+		if (!next) {
+			break;
+		}
+		next->prev = map;
+		map = next;
+		atomic_store_rel(&cache->map, map);
+	}
+	pthread_mutex_unlock(&cache->lock);
+	return map;
+}
+
+/**
+ * \brief Takes the writer lock on the current file, following the
+ * compactions made by other processes while waiting for it.
+ */
+static CacheMap *cache_lock_writer(RzDemangleCache *cache) {
+	pthread_mutex_lock(&cache->lock);
+	for (;;) {
+		CacheMap *map = cache->map;
+		if (flock(map->fd, LOCK_EX)) {
+			break;
+		} else if (!atomic_load_acq(&map->header->retired)) {
+			return map;
+		}
+		flock(map->fd, LOCK_UN);
+		CacheMap *next = cache_map_open(cache->path, false);
+		if (!next) {
+			break;
+		}
+		next->prev = map;
+		atomic_store_rel(&cache->map, next);
+	}
+	pthread_mutex_unlock(&cache->lock);
+	return NULL;
+}
+
+static void cache_unlock_writer(RzDemangleCache *cache) {
+	flock(cache->map->fd, LOCK_UN);
+	pthread_mutex_unlock(&cache->lock);
+}
+
+/**
+ * \brief Opens (and when writable, creates) a persistent demangle cache.
+ *
+ * The same file can be shared by any number of processes and threads.
+ *
+ * \param path  The cache file path
+ * \param mode  RZ_DEMANGLE_CACHE_READ_ONLY to never modify the file
+ *
+ * \return On success a valid pointer is returned, otherwise NULL.
+ */
+DEM_LIB_EXPORT RzDemangleCache *libdemangle_cache_open(const char *path, RzDemangleCacheMode mode) {
+	if (RZ_STR_ISEMPTY(path)) {
+		return NULL;
+	}
+	bool read_only = mode & RZ_DEMANGLE_CACHE_READ_ONLY;
+	CacheMap *map = cache_map_open(path, read_only);
+	if (!map && !read_only && errno == ENOENT) {
+		char *tmp = cache_file_create(path, CACHE_DEFAULT_BUCKETS, CACHE_DEFAULT_HEAP);
+		if (tmp) {
+			// link() fails when another process created the file first; use that one.
+			if (link(tmp, path) && errno != EEXIST) {
+				unlink(tmp);
+				free(tmp);
+				return NULL;
+			}
+			unlink(tmp);
+			free(tmp);
+			map = cache_map_open(path, read_only);
+		}
+	} else if (!map && !read_only && errno == ESTALE) {
+		// written by another version or build of the library: starts over
+		char *tmp = cache_file_create(path, CACHE_DEFAULT_BUCKETS, CACHE_DEFAULT_HEAP);
+		if (tmp) {
+			if (rename(tmp, path)) {
+				unlink(tmp);
+				free(tmp);
+				return NULL;
+			}
+			free(tmp);
+			map = cache_map_open(path, read_only);
+		}
+	}
+	if (!map) {
+		return NULL;
+	}
+
+	RzDemangleCache *cache = RZ_NEW0(RzDemangleCache);
+	if (!cache || !(cache->path = strdup(path)) || pthread_mutex_init(&cache->lock, NULL)) {
+		if (cache) {
+			free(cache->path);
+		}
+		free(cache);
+		cache_map_free(map);
+		return NULL;
+	}
+	cache->read_only = read_only;
+	cache->map = map;
+	return cache;
+}
+
+DEM_LIB_EXPORT void libdemangle_cache_close(RzDemangleCache *cache) {
+	if (!cache) {
+		return;
+	}
+	cache_map_free(cache->map);
+	pthread_mutex_destroy(&cache->lock);
+	free(cache->path);
+	free(cache);
+}
+
+/**
+ * \brief Returns a copy of the cached demangled string or NULL on cache miss.
+ */
+DEM_LIB_EXPORT char *libdemangle_cache_get(RzDemangleCache *cache, RzDemangleLang lang, const char *symbol, RzDemangleOpts opts) {
+	if (!cache || !symbol || lang >= RZ_DEMANGLE_LANG_MAX) {
+		return NULL;
+	}
+	size_t length = strlen(symbol);
+	ut64 hash = cache_key_hash(lang, opts, symbol, length);
+	CacheMap *map = cache_current_map(cache);
+	const CacheRecord *rec = cache_map_find(map, hash, lang, opts, symbol, length, NULL);
+	if (!rec) {
+		return NULL;
+	}
+	return dem_str_ndup((const char *)(rec + 1) + rec->symbol_len + 1, rec->output_len);
+}
+
+/**
+ * \brief Stores the demangled string of the given symbol into the cache.
+ *
+ * \return 1 when the entry is stored (or already present), 0 on failure.
+ */
+DEM_LIB_EXPORT int libdemangle_cache_set(RzDemangleCache *cache, RzDemangleLang lang, const char *symbol, RzDemangleOpts opts, const char *demangled) {
+	if (!cache || cache->read_only || !symbol || !demangled || lang >= RZ_DEMANGLE_LANG_MAX) {
+		return false;
+	}
+	size_t symbol_len = strlen(symbol);
+	size_t output_len = strlen(demangled);
+	if (symbol_len >= UT32_MAX || output_len >= UT32_MAX) {
+		return false;
+	}
+	ut64 hash = cache_key_hash(lang, opts, symbol, symbol_len);
+
+	CacheMap *map = cache_lock_writer(cache);
+	if (!map) {
+		return false;
+	}
+	bool res = true;
+	CacheBucket *slot = NULL;
+	if (cache_map_find(map, hash, lang, opts, symbol, symbol_len, &slot)) {
+		goto end;
+	}
+	if (!slot || !cache_map_has_room(map, symbol_len, output_len)) {
+		if (!cache_map_compact(cache, CACHE_RECORD_SIZE(symbol_len, output_len))) {
+			res = false;
+			goto end;
+		}
+		map = cache->map;
+		cache_map_find(map, hash, lang, opts, symbol, symbol_len, &slot);
+		if (!slot) {
+			res = false;
+			goto end;
+		}
+	}
+	cache_map_append(map, slot, hash, lang, opts, symbol, symbol_len, demangled, output_len);
+
+end:
+	cache_unlock_writer(cache);
+	return res;
+}
+
+/**
+ * \brief Rewrites the cache into a new file, dropping any torn record and
+ * growing the table when it is more than half full.
+ */
+DEM_LIB_EXPORT int libdemangle_cache_compact(RzDemangleCache *cache) {
+	if (!cache || cache->read_only) {
+		return false;
+	}
+	if (!cache_lock_writer(cache)) {
+		return false;
+	}
+	bool res = cache_map_compact(cache, 0);
+	cache_unlock_writer(cache);
+	return res;
+}
+
+/**
+ * \brief Demangles the symbol via the cache; on cache miss the handler of the
+ * given language is invoked and its result is stored into the cache.
+ */
+DEM_LIB_EXPORT char *libdemangle_cache_demangle(RzDemangleCache *cache, RzDemangleLang lang, const char *symbol, RzDemangleOpts opts) {
+	char *output = libdemangle_cache_get(cache, lang, symbol, opts);
+	if (output) {
+		return output;
+	}
+	output = libdemangle_handler(lang, symbol, opts);
+	if (output) {
+		libdemangle_cache_set(cache, lang, symbol, opts, output);
+	}
+	return output;
+}
@@ -0,0 +1,299 @@
+// SPDX-FileCopyrightText: 2026 RizinOrg <info@rizin.re>
+// SPDX-License-Identifier: LGPL-3.0-only
+
+/**
+ * \file corpus.c
+ *
+ * Capture of the symbols demangled in production into a corpus file, and
+ * reader of such files to replay them.
+ *
+ * The file is a fixed header followed by length-prefixed records:
+ *
+ *   [ "RZDMCORP" ][ version: le32 ]
+ *   [ lang: u8 ][ opts: uleb128 ][ length: uleb128 ][ symbol ][ \0 ] ...
+ *
+ * Usual symbols cost 4 bytes besides their own; the terminator lets the
+ * reader hand out symbols pointing straight into the mapped file.
+ *
+ * The records are buffered by the capture and appended with a single write()
+ * of whole records to a file opened with O_APPEND, so any number of threads
+ * and processes can capture into the same file. A process that dies loses
+ * its buffered records, and at worst leaves a truncated record at the end,
+ * which the reader ignores.
+ */
+
+#include "demangler_util.h"
+#include <rz_libdemangle.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define CORPUS_MAGIC       "RZDMCORP"
+#define CORPUS_VERSION     1
+#define CORPUS_HEADER_SIZE 12
+#define CORPUS_BUFFER_SIZE (64 * 1024)
+#define CORPUS_MAX_PREFIX  (1 + 5 + 10) ///< lang, opts and length
+
+struct rz_demangle_capture_t {
+	int fd;
+	bool failed; ///< a write failed, the records are dropped since then
+	ut8 *buffer;
+	size_t size;
+	size_t capacity;
+	pthread_mutex_t lock;
+};
+
+struct rz_demangle_corpus_t {
+	ut8 *base;
+	size_t size;
+	RzDemangleCorpusEntry *entries;
+	size_t n_entries;
+};
+
+static size_t corpus_write_uleb128(ut8 *p, ut64 value) {
+	size_t n = 0;
+	do {
+		ut8 byte = value & 0x7f;
+		value >>= 7;
+		p[n++] = byte | (value ? 0x80 : 0);
+	} while (value);
+	return n;
+}
+
+/**
+ * \brief Reads an unsigned LEB128 within [*p, end), returns false when
+ * truncated or overlong.
+ */
+static bool corpus_read_uleb128(const ut8 **p, const ut8 *end, ut64 *value) {
+	ut64 result = 0;
+	for (size_t shift = 0; *p < end && shift < 64; shift += 7) {
+		ut8 byte = *(*p)++;
+		result |= (ut64)(byte & 0x7f) << shift;
+		if (!(byte & 0x80)) {
+			*value = result;
+			return true;
+		}
+	}
+	return false;
+}
+
+static bool corpus_write_all(int fd, const ut8 *data, size_t size) {
+	while (size) {
+		ssize_t written = write(fd, data, size);
+		if (written < 0 && errno == EINTR) {
+			continue;
+		} else if (written <= 0) {
+			return false;
+		}
+		data += written;
+		size -= (size_t)written;
+	}
+	return true;
+}
+
+static void corpus_header(ut8 *header) {
+	memcpy(header, CORPUS_MAGIC, 8);
+	header[8] = CORPUS_VERSION;
+	header[9] = header[10] = header[11] = 0;
+}
+
+/**
+ * \brief Opens the corpus file for appending the captured symbols, creating
+ * it when missing; returns NULL when it exists but is not a corpus.
+ */
+DEM_LIB_EXPORT RzDemangleCapture *libdemangle_capture_open(const char *path) {
+	if (!path) {
+		return NULL;
+	}
+	ut8 header[CORPUS_HEADER_SIZE], expected[CORPUS_HEADER_SIZE];
+	corpus_header(expected);
+	// only the process creating the file writes the header
+	int fd = open(path, O_WRONLY | O_APPEND | O_CREAT | O_EXCL, 0644);
+	if (fd >= 0) {
+		if (!corpus_write_all(fd, expected, sizeof(expected))) {
+			close(fd);
+			unlink(path);
+			return NULL;
+		}
+	} else if (errno != EEXIST || (fd = open(path, O_RDWR | O_APPEND)) < 0) {
+		return NULL;
+	} else if (pread(fd, header, sizeof(header), 0) != sizeof(header) || memcmp(header, expected, sizeof(header))) {
+		close(fd);
+		return NULL;
+	}
+	RzDemangleCapture *capture = RZ_NEW0(RzDemangleCapture);
+	if (!capture || !(capture->buffer = malloc(CORPUS_BUFFER_SIZE))) {
+		free(capture);
+		close(fd);
+		return NULL;
+	}
+	capture->fd = fd;
+	capture->capacity = CORPUS_BUFFER_SIZE;
+	pthread_mutex_init(&capture->lock, NULL);
+	return capture;
+}
+
+static bool capture_flush(RzDemangleCapture *capture) {
+	if (capture->size && !capture->failed) {
+		capture->failed = !corpus_write_all(capture->fd, capture->buffer, capture->size);
+	}
+	capture->size = 0;
+	return !capture->failed;
+}
+
+/**
+ * \brief Appends the symbol to the corpus; safe to call from multiple threads.
+ */
+DEM_LIB_EXPORT int libdemangle_capture_add(RzDemangleCapture *capture, RzDemangleLang lang, const char *symbol, RzDemangleOpts opts) {
+	if (!capture || !symbol || lang >= RZ_DEMANGLE_LANG_MAX) {
+		return false;
+	}
+	size_t length = strlen(symbol);
+	size_t record_size = CORPUS_MAX_PREFIX + length + 1;
+	int ret = false;
+	pthread_mutex_lock(&capture->lock);
+	if (capture->failed) {
+		goto end;
+	} else if (capture->size + record_size > capture->capacity && !capture_flush(capture)) {
+		goto end;
+	} else if (record_size > capture->capacity) {
+		// a huge symbol gets a buffer of its own, a record is never split
+		ut8 *buffer = realloc(capture->buffer, record_size);
+		if (!buffer) {
+			goto end;
+		}
+		capture->buffer = buffer;
+		capture->capacity = record_size;
+	}
+	ut8 *p = capture->buffer + capture->size;
+	*p++ = (ut8)lang;
+	p += corpus_write_uleb128(p, (ut64)opts);
+	p += corpus_write_uleb128(p, length);
+	memcpy(p, symbol, length + 1);
+	capture->size = (size_t)(p + length + 1 - capture->buffer);
+	ret = true;
+
+end:
+	pthread_mutex_unlock(&capture->lock);
+	return ret;
+}
+
+/**
+ * \brief Writes the buffered records to the file.
+ */
+DEM_LIB_EXPORT int libdemangle_capture_flush(RzDemangleCapture *capture) {
+	if (!capture) {
+		return false;
+	}
+	pthread_mutex_lock(&capture->lock);
+	bool ret = capture_flush(capture);
+	pthread_mutex_unlock(&capture->lock);
+	return ret;
+}
+
+/**
+ * \brief Flushes and closes the capture; returns false when some records
+ * could not be written.
+ */
+DEM_LIB_EXPORT int libdemangle_capture_close(RzDemangleCapture *capture) {
+	if (!capture) {
+		return false;
+	}
+	bool ret = capture_flush(capture);
+	ret = !close(capture->fd) && ret;
+	pthread_mutex_destroy(&capture->lock);
+	free(capture->buffer);
+	free(capture);
+	return ret;
+}
+
+/**
+ * \brief Maps the corpus file and indexes its records; a truncated record
+ * at the end (e.g. of a crashed capture) is ignored.
+ */
+DEM_LIB_EXPORT RzDemangleCorpus *libdemangle_corpus_open(const char *path) {
+	if (!path) {
+		return NULL;
+	}
+	RzDemangleCorpus *corpus = NULL;
+	ut8 expected[CORPUS_HEADER_SIZE];
+	corpus_header(expected);
+	int fd = open(path, O_RDONLY);
+	if (fd < 0) {
+		return NULL;
+	}
+	struct stat st;
+	if (fstat(fd, &st) || st.st_size < CORPUS_HEADER_SIZE || !(corpus = RZ_NEW0(RzDemangleCorpus))) {
+		goto end;
+	}
+	corpus->size = (size_t)st.st_size;
+	corpus->base = mmap(NULL, corpus->size, PROT_READ, MAP_PRIVATE, fd, 0);
+	if (corpus->base == MAP_FAILED) {
+		corpus->base = NULL;
+		goto end;
+	} else if (memcmp(corpus->base, expected, sizeof(expected))) {
+		goto end;
+	}
+#if defined(MADV_SEQUENTIAL)
+	madvise(corpus->base, corpus->size, MADV_SEQUENTIAL);
+#endif
+
+	size_t capacity = 0;
+	const ut8 *p = corpus->base + CORPUS_HEADER_SIZE;
+	const ut8 *end = corpus->base + corpus->size;
+	while (p < end) {
+		RzDemangleLang lang = (RzDemangleLang)*p++;
+		ut64 opts, length;
+		if (!corpus_read_uleb128(&p, end, &opts) || !corpus_read_uleb128(&p, end, &length) ||
+			length >= (ut64)(end - p) || p[length]) {
+			break;
+		}
+		if (corpus->n_entries == capacity) {
+			capacity = capacity ? capacity * 2 : 1024;
+			RzDemangleCorpusEntry *entries = realloc(corpus->entries, capacity * sizeof(RzDemangleCorpusEntry));
+			if (!entries) {
+				goto end;
+			}
+			corpus->entries = entries;
+		}
+		RzDemangleCorpusEntry *entry = &corpus->entries[corpus->n_entries++];
+		entry->lang = lang < RZ_DEMANGLE_LANG_MAX ? lang : RZ_DEMANGLE_LANG_MAX;
+		entry->opts = (RzDemangleOpts)opts;
+		entry->symbol = (const char *)p;
+		entry->length = (size_t)length;
+		p += length + 1;
+	}
+	close(fd);
+	return corpus;
+
+end:
+	close(fd);
+	libdemangle_corpus_close(corpus);
+	return NULL;
+}
+
+DEM_LIB_EXPORT void libdemangle_corpus_close(RzDemangleCorpus *corpus) {
+	if (!corpus) {
+		return;
+	}
+	if (corpus->base) {
+		munmap(corpus->base, corpus->size);
+	}
+	free(corpus->entries);
+	free(corpus);
+}
+
+/**
+ * \brief Returns the records of the corpus, in capture order; the symbols
+ * are valid until the corpus is closed.
+ */
+DEM_LIB_EXPORT const RzDemangleCorpusEntry *libdemangle_corpus_entries(RzDemangleCorpus *corpus, size_t *n_entries) {
+	if (!corpus || !n_entries) {
+		return NULL;
+	}
+	*n_entries = corpus->n_entries;
+	return corpus->entries;
+}
@@ -5,6 +5,8 @@
 #include "demangler_util.h"
 #include "borland.h"
 #include "cxx.h"
+#include "precomputed.h"
+#include "probes.h"
 #include <rz_libdemangle.h>
 
 #if WITH_GPL
@@ -424,7 +426,7 @@ char *demangle_gpl_cxx(const char *str, bool simplify) {
 	char *tmpstr = strdup(str);
 	char *p = tmpstr;
 
-	while (p[0] == p[1] && *p == '_') {
+	while (*p == '_' && p[1] == '_') {
 		p++;
 	}
 	for (i = 0; i < RZ_ARRAY_SIZE(prefixes); i++) {
@@ -486,7 +488,9 @@ char *demangle_gpl_cxx(const char *str, bool simplify) {
 	}
 
 	if (simplify) {
+		DEM_PROBE1(cxx_simplify_entry, out);
 		out = cplus_replace_std_typedefs(out);
+		DEM_PROBE1(cxx_simplify_return, out != NULL);
 	}
 	if (block_invoke) {
 		DemString *ds = dem_string_new();
@@ -512,14 +516,18 @@ char *find_block_invoke(char *p) {
 	return last;
 }
 
-DEM_LIB_EXPORT char *libdemangle_handler_cxx(const char *symbol, RzDemangleOpts opts) {
+static char *cxx_handler(const char *symbol, RzDemangleOpts opts) {
+	dem_precomputed_return(RZ_DEMANGLE_LANG_CXX, symbol, opts);
+
 	char *result = demangle_borland_delphi(symbol);
 	if (result) {
 		return result;
 	}
 
 #if WITH_GPL
+	DEM_PROBE1(cxx_v2_entry, symbol);
 	result = cplus_demangle_v2(symbol, DMGL_PARAMS);
+	DEM_PROBE1(cxx_v2_return, result != NULL);
 	if (result) {
 		return result;
 	}
@@ -528,3 +536,7 @@ DEM_LIB_EXPORT char *libdemangle_handler_cxx(const char *symbol, RzDemangleOpts
 	return NULL;
 #endif
 }
+
+DEM_LIB_EXPORT char *libdemangle_handler_cxx(const char *symbol, RzDemangleOpts opts) {
+	return dem_probe_handler(RZ_DEMANGLE_LANG_CXX, cxx_handler, symbol, opts);
+}
@@ -135,6 +135,7 @@ extern char *alloca();
 #include "libiberty.h"
 #include "demangle.h"
 #include "cp-demangle.h"
+#include "../probes.h"
 
 /* If IN_GLIBCPP_V3 is defined, some functions are made static.  We
    also rename them via #define to avoid compiler errors when the
@@ -215,28 +216,6 @@ static void d_init_info(const char *, int, size_t, struct d_info *);
 #define ANONYMOUS_NAMESPACE_PREFIX_LEN \
 	(sizeof(ANONYMOUS_NAMESPACE_PREFIX) - 1)
 
-/* Information we keep for the standard substitutions.  */
-
-struct d_standard_sub_info {
-	/* The code for this substitution.  */
-	char code;
-	/* The simple string it expands to.  */
-	const char *simple_expansion;
-	/* The length of the simple expansion.  */
-	int simple_len;
-	/* The results of a full, verbose, expansion.  This is used when
-	   qualifying a constructor/destructor, or when in verbose mode.  */
-	const char *full_expansion;
-	/* The length of the full expansion.  */
-	int full_len;
-	/* What to set the last_name field of d_info to; NULL if we should
-	   not set it.  This is only relevant when qualifying a
-	   constructor/destructor.  */
-	const char *set_last_name;
-	/* The length of set_last_name.  */
-	int set_last_name_len;
-};
-
 /* Accessors for subtrees of struct demangle_component.  */
 
 #define d_left(dc)  ((dc)->u.s_binary.left)
@@ -309,6 +288,44 @@ struct d_info_checkpoint {
 	int expansion;
 };
 
+/* Number of sub-results remembered by a parse; one per bit of the
+   valid mask of struct d_memo.  */
+#define D_MEMO_SIZE 64
+
+/* The productions whose sub-results are remembered.  */
+
+enum d_memo_production {
+	D_MEMO_TYPE,
+	D_MEMO_TEMPLATE_ARGS
+};
+
+/* A production parsed before the first ambiguous unresolved-name.  The
+   parse with the old unresolved-name grammar is identical up to that
+   point, so it can skip the production by restoring the state after it:
+   its components and substitutions are still in place.  */
+
+struct d_memo_entry {
+	enum d_memo_production production;
+	/* The state of d_info before and after the production.  */
+	struct d_info_checkpoint start;
+	struct d_info_checkpoint end;
+	struct demangle_component *start_last_name;
+	struct demangle_component *end_last_name;
+	/* The grammar mode of the production.  */
+	int is_expression;
+	int is_conversion;
+	/* The result.  */
+	struct demangle_component *dc;
+};
+
+/* The sub-results remembered by a parse, indexed by position and
+   production; the entries are valid only when their bit is set.  */
+
+struct d_memo {
+	unsigned long long valid;
+	struct d_memo_entry entries[D_MEMO_SIZE];
+};
+
 /* Maximum number of times d_print_comp may be called recursively.  */
 #define MAX_RECURSION_COUNT 1024
 
@@ -467,6 +484,7 @@ static struct demangle_component *
 d_template_param(struct d_info *);
 
 static struct demangle_component *d_template_args(struct d_info *);
+static struct demangle_component *d_template_args_open(struct d_info *);
 static struct demangle_component *d_template_args_1(struct d_info *);
 
 static struct demangle_component *
@@ -496,6 +514,12 @@ static void d_checkpoint(struct d_info *, struct d_info_checkpoint *);
 
 static void d_backtrack(struct d_info *, struct d_info_checkpoint *);
 
+static struct demangle_component *
+d_memo_parse(struct d_info *, enum d_memo_production,
+	struct demangle_component *(*)(struct d_info *));
+
+static struct demangle_component *d_type(struct d_info *);
+
 static void d_growable_string_init(struct d_growable_string *, size_t);
 
 static inline void
@@ -2295,6 +2319,11 @@ const struct demangle_builtin_type_info
 CP_STATIC_IF_GLIBCPP_V3
 struct demangle_component *
 cplus_demangle_type(struct d_info *di) {
+	return d_memo_parse(di, D_MEMO_TYPE, d_type);
+}
+
+static struct demangle_component *
+d_type(struct d_info *di) {
 	char peek;
 	struct demangle_component *ret;
 	int can_subst;
@@ -2965,6 +2994,12 @@ static struct demangle_component *
 d_template_args(struct d_info *di) {
 	if (d_peek_char(di) != 'I' && d_peek_char(di) != 'J')
 		return NULL;
+
+	return d_memo_parse(di, D_MEMO_TEMPLATE_ARGS, d_template_args_open);
+}
+
+static struct demangle_component *
+d_template_args_open(struct d_info *di) {
 	d_advance(di, 1);
 
 	return d_template_args_1(di);
@@ -3104,6 +3139,9 @@ d_unresolved_name(struct d_info *di) {
 	d_advance(di, 2);
 
 	peek = d_peek_char(di);
+	if (di->unresolved_name_state == 0 && (IS_DIGIT(peek) || IS_LOWER(peek) || peek == 'C' || peek == 'U' || peek == 'L'))
+		/* The two grammars differ from here, see d_memo_parse.  */
+		di->memo = NULL;
 	if (di->unresolved_name_state && (IS_DIGIT(peek) || IS_LOWER(peek) || peek == 'C' || peek == 'U' || peek == 'L')) {
 		/* The third production is ambiguous with the old unresolved-name syntax
 		   of <type> <base-unresolved-name>; in the old mangling, A::x was mangled
@@ -3643,7 +3681,8 @@ d_add_substitution(struct d_info *di, struct demangle_component *dc) {
    actually appears in the source.
 */
 
-static const struct d_standard_sub_info standard_subs[] = {
+CP_STATIC_IF_GLIBCPP_V3
+const struct d_standard_sub_info cplus_demangle_standard_subs[D_STANDARD_SUB_COUNT] = {
 	{ 't', NL("std"),
 		NL("std"),
 		NULL, 0 },
@@ -3716,8 +3755,8 @@ d_substitution(struct d_info *di, int prefix) {
 				verbose = 1;
 		}
 
-		pend = (&standard_subs[0] + sizeof standard_subs / sizeof standard_subs[0]);
-		for (p = &standard_subs[0]; p < pend; ++p) {
+		pend = &cplus_demangle_standard_subs[D_STANDARD_SUB_COUNT];
+		for (p = &cplus_demangle_standard_subs[0]; p < pend; ++p) {
 			if (c == p->code) {
 				const char *s;
 				int len;
@@ -3764,6 +3803,67 @@ d_backtrack(struct d_info *di, struct d_info_checkpoint *checkpoint) {
 	di->next_comp = checkpoint->next_comp;
 	di->next_sub = checkpoint->next_sub;
 	di->expansion = checkpoint->expansion;
+
+	/* The components and substitutions of the productions parsed since
+	   the checkpoint are going to be overwritten.  */
+	if (di->memo != NULL) {
+		int i;
+
+		for (i = 0; i < D_MEMO_SIZE; ++i) {
+			struct d_memo_entry *m = &di->memo->entries[i];
+
+			if ((di->memo->valid & (1ULL << i)) != 0 && (m->end.next_comp > checkpoint->next_comp || m->end.next_sub > checkpoint->next_sub))
+				di->memo->valid &= ~(1ULL << i);
+		}
+	}
+}
+
+/* Parses the production via PARSE.  When parsing with the new
+   unresolved-name grammar, the result is remembered until the first
+   ambiguous unresolved-name is found; the parse with the old grammar
+   reuses it instead of parsing the same span again, up to the same
+   point.  */
+
+static struct demangle_component *
+d_memo_parse(struct d_info *di, enum d_memo_production production,
+	struct demangle_component *(*parse)(struct d_info *)) {
+	struct d_info_checkpoint start;
+	struct demangle_component *start_last_name;
+	struct demangle_component *dc;
+	struct d_memo_entry *m;
+	int i;
+
+	if (di->memo == NULL)
+		return parse(di);
+
+	i = ((di->n - di->s) * 2 + production) & (D_MEMO_SIZE - 1);
+	m = &di->memo->entries[i];
+	if (di->unresolved_name_state == 0 && (di->memo->valid & (1ULL << i)) != 0 && m->production == production && m->start.n == di->n && m->start.next_comp == di->next_comp && m->start.next_sub == di->next_sub && m->start.expansion == di->expansion && m->start_last_name == di->last_name && m->is_expression == di->is_expression && m->is_conversion == di->is_conversion) {
+		di->n = m->end.n;
+		di->next_comp = m->end.next_comp;
+		di->next_sub = m->end.next_sub;
+		di->expansion = m->end.expansion;
+		di->last_name = m->end_last_name;
+		return m->dc;
+	}
+
+	d_checkpoint(di, &start);
+	start_last_name = di->last_name;
+	dc = parse(di);
+	/* Nothing is remembered past the first ambiguous unresolved-name.  */
+	if (dc == NULL || di->unresolved_name_state != 1)
+		return dc;
+
+	m->production = production;
+	m->start = start;
+	d_checkpoint(di, &m->end);
+	m->start_last_name = start_last_name;
+	m->end_last_name = di->last_name;
+	m->is_expression = di->is_expression;
+	m->is_conversion = di->is_conversion;
+	m->dc = dc;
+	di->memo->valid |= 1ULL << i;
+	return dc;
 }
 
 /* Initialize a growable string.  */
@@ -5927,6 +6027,8 @@ void cplus_demangle_init_info(const char *mangled, int options, size_t len,
 	di->is_expression = 0;
 	di->is_conversion = 0;
 	di->recursion_level = 0;
+
+	di->memo = NULL;
 }
 
 /* Internal implementation for the demangler.  If MANGLED is a g++ v3 ABI
@@ -5944,6 +6046,8 @@ d_demangle_callback(const char *mangled, int options,
 		DCT_GLOBAL_DTORS
 	} type;
 	struct d_info di;
+	struct d_memo memo;
+	int memoize;
 	struct demangle_component *dc;
 	int status;
 
@@ -5957,9 +6061,9 @@ d_demangle_callback(const char *mangled, int options,
 		type = DCT_TYPE;
 	}
 
+	/* Only an unresolved-name can need a second parse.  */
+	memoize = strstr(mangled, "sr") != NULL;
 	di.unresolved_name_state = 1;
-
-again:
 	cplus_demangle_init_info(mangled, options, strlen(mangled), &di);
 
 	/* PR 87675 - Check for a mangled string that is so long
@@ -5987,6 +6091,13 @@ again:
 		di.subs = alloca(di.num_subs * sizeof(*di.subs));
 #endif
 
+		if (memoize) {
+			memo.valid = 0;
+			di.memo = &memo;
+		}
+
+		DEM_PROBE1(cxx_v3_parse_entry, mangled);
+again:
 		switch (type) {
 		case DCT_TYPE:
 			dc = cplus_demangle_type(&di);
@@ -6016,19 +6127,27 @@ again:
 		if (((options & DMGL_PARAMS) != 0) && d_peek_char(&di) != '\0')
 			dc = NULL;
 
-		/* See discussion in d_unresolved_name.  */
+		/* See discussion in d_unresolved_name.  The arrays are kept, the
+		   parse reuses the sub-results found in the memo.  */
 		if (dc == NULL && di.unresolved_name_state == -1) {
 			di.unresolved_name_state = 0;
+			cplus_demangle_init_info(mangled, options, strlen(mangled), &di);
+			di.memo = memoize ? &memo : NULL;
 			goto again;
 		}
 
+		DEM_PROBE1(cxx_v3_parse_return, dc != NULL);
+
 #ifdef CP_DEMANGLE_DEBUG
 		d_dump(dc, 0);
 #endif
 
-		status = (dc != NULL)
-			? cplus_demangle_print_callback(options, dc, callback, opaque)
-			: 0;
+		status = 0;
+		if (dc != NULL) {
+			DEM_PROBE1(cxx_v3_print_entry, mangled);
+			status = cplus_demangle_print_callback(options, dc, callback, opaque);
+			DEM_PROBE1(cxx_v3_print_return, status);
+		}
 	}
 
 	return status;
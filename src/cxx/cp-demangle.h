@@ -125,6 +125,9 @@ struct d_info {
 	   -1: using new unresolved-name grammar and saw an unresolved-name.
 	    0: using old unresolved-name grammar.  */
 	int unresolved_name_state;
+	/* Sub-results of the parse with the new unresolved-name grammar,
+	   reused when parsing again with the old one; NULL when unused.  */
+	struct d_memo *memo;
 	/* If DMGL_NO_RECURSE_LIMIT is not active then this is set to
 	   the current recursion level.  */
 	unsigned int recursion_level;
@@ -182,6 +185,34 @@ CP_STATIC_IF_GLIBCPP_V3
 const struct demangle_builtin_type_info
 	cplus_demangle_builtin_types[D_BUILTIN_TYPE_COUNT];
 
+/* Information we keep for the standard substitutions.  */
+
+struct d_standard_sub_info {
+	/* The code for this substitution.  */
+	char code;
+	/* The simple string it expands to.  */
+	const char *simple_expansion;
+	/* The length of the simple expansion.  */
+	int simple_len;
+	/* The results of a full, verbose, expansion.  This is used when
+	   qualifying a constructor/destructor, or when in verbose mode.  */
+	const char *full_expansion;
+	/* The length of the full expansion.  */
+	int full_len;
+	/* What to set the last_name field of d_info to; NULL if we should
+	   not set it.  This is only relevant when qualifying a
+	   constructor/destructor.  */
+	const char *set_last_name;
+	/* The length of set_last_name.  */
+	int set_last_name_len;
+};
+
+#define D_STANDARD_SUB_COUNT (7)
+
+CP_STATIC_IF_GLIBCPP_V3
+const struct d_standard_sub_info
+	cplus_demangle_standard_subs[D_STANDARD_SUB_COUNT];
+
 CP_STATIC_IF_GLIBCPP_V3
 struct demangle_component *
 cplus_demangle_mangled_name(struct d_info *, int);
@@ -0,0 +1,550 @@
+// SPDX-FileCopyrightText: 2026 RizinOrg <info@rizin.re>
+// SPDX-License-Identifier: LGPL-3.0-only
+
+/**
+ * \file cp-mangle.c
+ *
+ * Mangling of a parsed declaration with the Itanium C++ ABI scheme, the
+ * reverse of cp-demangle.c whose builtin type, operator and standard
+ * substitution tables are shared.
+ *
+ * Every prefix of a name and every type which is not builtin is a
+ * substitution candidate, referenced as S_, S0_, S1_, ... when repeated;
+ * the candidates are keyed by their canonical printing.
+ */
+
+#include "demangle.h"
+#include "cp-demangle.h"
+#include "../mangle.h"
+
+typedef struct {
+	MangleChoices *choices;
+	char **subs;
+	size_t n_subs;
+	const MangleComponent *targs; ///< template arguments of the function template, referred to as T_, T0_, ...
+} CpMangler;
+
+/**
+ * \brief Builtin types printed differently by the demangler.
+ */
+static const struct {
+	const char *builtin;
+	const char *name;
+} cp_builtin_aliases[] = {
+	{ "long long", "int64_t" },
+	{ "unsigned long long", "uint64_t" },
+	{ "__int128", "int128_t" },
+	{ "unsigned __int128", "uint128_t" },
+	{ "__int8", "signed char" },
+	{ "unsigned __int8", "unsigned char" },
+	{ "__int16", "short" },
+	{ "unsigned __int16", "unsigned short" },
+	{ "__int32", "int" },
+	{ "unsigned __int32", "unsigned int" },
+	{ "__int64", "int64_t" },
+	{ "unsigned __int64", "uint64_t" },
+};
+
+/**
+ * \brief Codes of the builtin types past 'z' in cplus_demangle_builtin_types.
+ */
+static const char *const cp_builtin_codes_ex[D_BUILTIN_TYPE_COUNT - 26] = {
+	"Df", "Dd", "De", "Dh", "Du", "Ds", "Di", "Dn"
+};
+
+static bool cp_type(CpMangler *m, DemString *out, const MangleType *type);
+
+static bool cp_builtin(DemString *out, const char *builtin) {
+	for (size_t i = 0; i < RZ_ARRAY_SIZE(cp_builtin_aliases); ++i) {
+		if (!strcmp(cp_builtin_aliases[i].builtin, builtin)) {
+			builtin = cp_builtin_aliases[i].name;
+			break;
+		}
+	}
+	for (size_t i = 0; i < D_BUILTIN_TYPE_COUNT; ++i) {
+		const char *name = cplus_demangle_builtin_types[i].name;
+		if (name && !strcmp(name, builtin)) {
+			if (i < 26) {
+				return dem_string_append_char(out, 'a' + i);
+			}
+			return dem_string_append(out, cp_builtin_codes_ex[i - 26]);
+		}
+	}
+	return false;
+}
+
+static bool cp_seq_id(DemString *out, size_t index) {
+	dem_string_append_char(out, 'S');
+	if (index) {
+		char digits[16];
+		size_t n = sizeof(digits) - 1;
+		digits[n] = 0;
+		index--;
+		do {
+			digits[--n] = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ"[index % 36];
+			index /= 36;
+		} while (index);
+		dem_string_append(out, digits + n);
+	}
+	return dem_string_append_char(out, '_');
+}
+
+/**
+ * \brief Appends the back reference to the candidate \p key, when known.
+ */
+static bool cp_sub_find(CpMangler *m, DemString *out, const char *key) {
+	for (size_t i = 0; i < m->n_subs; ++i) {
+		if (!strcmp(m->subs[i], key)) {
+			return cp_seq_id(out, i);
+		}
+	}
+	return false;
+}
+
+static bool cp_sub_add(CpMangler *m, const char *key) {
+	if (!(m->n_subs & (m->n_subs - 1))) {
+		char **tmp = realloc(m->subs, (m->n_subs ? m->n_subs * 2 : 8) * sizeof(char *));
+		if (!tmp) {
+			return false;
+		}
+		m->subs = tmp;
+	}
+	return (m->subs[m->n_subs++] = strdup(key)) != NULL;
+}
+
+static bool equal_ignoring_spaces(const char *a, const char *b) {
+	for (;; a++, b++) {
+		while (*a == ' ') {
+			a++;
+		}
+		while (*b == ' ') {
+			b++;
+		}
+		if (*a != *b) {
+			return false;
+		} else if (!*a) {
+			return true;
+		}
+	}
+}
+
+/**
+ * \brief Appends the standard abbreviation (e.g. Sa for std::allocator) of
+ * \p key, when it has one.
+ */
+static bool cp_standard_sub(DemString *out, const char *key) {
+	for (size_t i = 0; i < D_STANDARD_SUB_COUNT; ++i) {
+		const struct d_standard_sub_info *sub = &cplus_demangle_standard_subs[i];
+		if (!strcmp(sub->simple_expansion, key) || equal_ignoring_spaces(sub->full_expansion, key)) {
+			dem_string_append_char(out, 'S');
+			return dem_string_append_char(out, sub->code);
+		}
+	}
+	return false;
+}
+
+static bool cp_source_name(DemString *out, const char *name, size_t length) {
+	dem_string_appendf(out, "%" PFMTSZu, length);
+	return dem_string_append_n(out, name, length);
+}
+
+/**
+ * \brief Returns the code of the operator, choosing between the unary and the
+ * binary one when the number of parameters does not tell (a member function
+ * has the object as implicit first argument).
+ */
+static const char *cp_operator_code(CpMangler *m, const MangleComponent *c, size_t n_params) {
+	const struct demangle_operator_info *matches[4];
+	size_t n = 0;
+	for (const struct demangle_operator_info *op = cplus_demangle_operators; op->code && n < RZ_ARRAY_SIZE(matches); ++op) {
+		size_t length = op->len;
+		while (length && op->name[length - 1] == ' ') {
+			length--;
+		}
+		if (length != c->length || memcmp(op->name, c->name, length)) {
+			continue;
+		}
+		bool same_arity = false;
+		for (size_t i = 0; i < n; ++i) {
+			same_arity |= matches[i]->args == op->args;
+		}
+		// new, delete and co_await take any parameters
+		if (!same_arity && (IS_ALPHA(*c->name) || op->args == n_params || op->args == n_params + 1)) {
+			matches[n++] = op;
+		}
+	}
+	return n ? matches[mangle_choose(m->choices, n)]->code : NULL;
+}
+
+static bool cp_unqualified(CpMangler *m, DemString *out, const MangleComponent *c, size_t n_params) {
+	static const char *const ctors[] = { "C1", "C2" };
+	static const char *const dtors[] = { "D1", "D2", "D0" };
+	const char *code;
+	bool ok;
+	switch (c->kind) {
+	case MANGLE_COMPONENT_NAME:
+		ok = cp_source_name(out, c->name, c->length);
+		break;
+	case MANGLE_COMPONENT_OPERATOR:
+		if (!(code = cp_operator_code(m, c, n_params))) {
+			return false;
+		}
+		ok = dem_string_append(out, code);
+		break;
+	case MANGLE_COMPONENT_CONVERSION:
+		ok = dem_string_append(out, "cv") && cp_type(m, out, c->conversion);
+		break;
+	case MANGLE_COMPONENT_CTOR:
+		ok = dem_string_append(out, ctors[mangle_choose(m->choices, RZ_ARRAY_SIZE(ctors))]);
+		break;
+	case MANGLE_COMPONENT_DTOR:
+		ok = dem_string_append(out, dtors[mangle_choose(m->choices, RZ_ARRAY_SIZE(dtors))]);
+		break;
+	default:
+		ok = dem_string_append(out, "12_GLOBAL__N_1");
+		break;
+	}
+	for (const char *tag = c->abi_tags; ok && tag && tag < c->abi_tags + c->abi_tags_length;) {
+		// [abi:name]
+		const char *end = memchr(tag, ']', c->abi_tags + c->abi_tags_length - tag);
+		if (!end) {
+			return false;
+		}
+		dem_string_append_char(out, 'B');
+		ok = cp_source_name(out, tag + 5, end - tag - 5);
+		tag = end + 1;
+	}
+	return ok;
+}
+
+static bool cp_literal(DemString *out, const MangleTemplateArg *arg) {
+	dem_string_append_char(out, 'L');
+	if (!cp_builtin(out, arg->literal_type)) {
+		return false;
+	}
+	if (arg->literal_length == 4 && !memcmp(arg->literal, "true", 4)) {
+		dem_string_append_char(out, '1');
+	} else if (arg->literal_length == 5 && !memcmp(arg->literal, "false", 5)) {
+		dem_string_append_char(out, '0');
+	} else if (*arg->literal == '-') {
+		dem_string_append_char(out, 'n');
+		dem_string_append_n(out, arg->literal + 1, arg->literal_length - 1);
+	} else {
+		dem_string_append_n(out, arg->literal, arg->literal_length);
+	}
+	return dem_string_append_char(out, 'E');
+}
+
+static bool cp_template_args(CpMangler *m, DemString *out, const MangleComponent *c) {
+	dem_string_append_char(out, 'I');
+	for (size_t i = 0; i < c->n_args; ++i) {
+		const MangleTemplateArg *arg = &c->args[i];
+		if (arg->type ? !cp_type(m, out, arg->type) : !cp_literal(out, arg)) {
+			return false;
+		}
+	}
+	return dem_string_append_char(out, 'E');
+}
+
+/**
+ * \brief Finds the component of the \p element of the name, made of elements:
+ * each component and, when it has template arguments, the component with them.
+ */
+static void cp_element(const MangleName *name, size_t element, size_t *component, bool *args) {
+	for (size_t i = 0;; ++i) {
+		size_t n = name->components[i].has_args ? 2 : 1;
+		if (element < n) {
+			*component = i + 1;
+			*args = n == 1 || element == 1;
+			return;
+		}
+		element -= n;
+	}
+}
+
+/**
+ * \brief Appends the name, back referencing its longest prefix which is
+ * already a candidate and adding the following ones.
+ *
+ * \param prefix Appended after the N of a nested name (e.g. the qualifiers of
+ * a method); the unscoped names do not have it
+ * \param type The name is the one of a type, so the complete name is a
+ * candidate too
+ * \param n_params Number of parameters of the function, used for operators
+ */
+static bool cp_name(CpMangler *m, DemString *out, const MangleName *name, const char *prefix, bool type, size_t n_params) {
+	size_t n_elements = 0;
+	for (size_t i = 0; i < name->n_components; ++i) {
+		n_elements += name->components[i].has_args ? 2 : 1;
+	}
+	DemString *key = dem_string_new();
+	DemString *found = dem_string_new();
+	size_t start = n_elements, component;
+	bool args, ok = false;
+	if (!key || !found) {
+		goto end;
+	}
+	for (; start > 0; --start) {
+		cp_element(name, start - 1, &component, &args);
+		dem_string_reset(key);
+		if (!mangle_print_name(key, name, component, args)) {
+			goto end;
+		}
+		if (cp_sub_find(m, found, dem_string_buffer(key)) || cp_standard_sub(found, dem_string_buffer(key))) {
+			break;
+		}
+	}
+
+	const MangleComponent *first = &name->components[0];
+	bool std = first->kind == MANGLE_COMPONENT_NAME && !first->has_args && first->length == 3 && !memcmp(first->name, "std", 3);
+	bool nested = start < n_elements && name->n_components > (std ? 2 : 1);
+	if (nested) {
+		dem_string_append_char(out, 'N');
+		dem_string_append(out, prefix);
+	}
+	dem_string_append_n(out, dem_string_buffer(found), dem_string_length(found));
+	for (size_t element = start; element < n_elements; ++element) {
+		cp_element(name, element, &component, &args);
+		const MangleComponent *c = &name->components[component - 1];
+		if (args && c->has_args ? !cp_template_args(m, out, c) : !cp_unqualified(m, out, c, n_params)) {
+			goto end;
+		}
+		if (element + 1 == n_elements && !type) {
+			break;
+		}
+		dem_string_reset(key);
+		if (!mangle_print_name(key, name, component, args) || !cp_sub_add(m, dem_string_buffer(key))) {
+			goto end;
+		}
+	}
+	ok = !nested || dem_string_append_char(out, 'E');
+
+end:
+	dem_string_free(key);
+	dem_string_free(found);
+	return ok;
+}
+
+/**
+ * \brief Returns 1 + the index of the template argument of the function
+ * template which \p type may refer to, otherwise 0.
+ */
+static int cp_template_param(CpMangler *m, const MangleType *type) {
+	for (size_t i = 0; i < m->targs->n_args; ++i) {
+		const MangleType *arg = m->targs->args[i].type;
+		if (!arg || arg->cv || !mangle_type_equal(arg, type, true)) {
+			continue;
+		}
+		char key[48];
+		snprintf(key, sizeof(key), "template-param:%" PFMTSZu, i);
+		return mangle_choose_keyed(m->choices, key, 2) ? 0 : (int)i + 1;
+	}
+	return 0;
+}
+
+/**
+ * \brief Marks the parts of the type which refer to a template argument of
+ * the function template, so that they are keyed and mangled as such.
+ */
+static void cp_mark_template_params(CpMangler *m, MangleType *type) {
+	if ((type->template_param = cp_template_param(m, type))) {
+		return;
+	}
+	switch (type->kind) {
+	case MANGLE_TYPE_NAMED:
+		for (size_t i = 0; i < type->name.n_components; ++i) {
+			const MangleComponent *c = &type->name.components[i];
+			for (size_t j = 0; j < c->n_args; ++j) {
+				if (c->args[j].type) {
+					cp_mark_template_params(m, c->args[j].type);
+				}
+			}
+		}
+		break;
+	case MANGLE_TYPE_POINTER:
+	case MANGLE_TYPE_LVALUE_REF:
+	case MANGLE_TYPE_RVALUE_REF:
+		cp_mark_template_params(m, type->pointee);
+		break;
+	case MANGLE_TYPE_FUNCTION:
+		cp_mark_template_params(m, type->function.ret);
+		for (size_t i = 0; i < type->function.n_params; ++i) {
+			cp_mark_template_params(m, type->function.params[i]);
+		}
+		break;
+	default:
+		break;
+	}
+}
+
+static bool cp_params(CpMangler *m, DemString *out, const MangleFunction *function) {
+	if (!function->n_params && !function->varargs) {
+		return dem_string_append_char(out, 'v');
+	}
+	for (size_t i = 0; i < function->n_params; ++i) {
+		if (!cp_type(m, out, function->params[i])) {
+			return false;
+		}
+	}
+	return !function->varargs || dem_string_append_char(out, 'z');
+}
+
+/**
+ * \brief Appends the type, whose typedefs and template parameters are already
+ * resolved.
+ */
+static bool cp_resolved_type(CpMangler *m, DemString *out, const MangleType *type) {
+	if (type->kind == MANGLE_TYPE_BUILTIN && !type->cv && !type->template_param) {
+		return cp_builtin(out, type->builtin);
+	}
+	DemString *key = dem_string_new();
+	bool ok = false;
+	if (!key || !mangle_print_type(key, type)) {
+		goto end;
+	}
+	if (cp_sub_find(m, out, dem_string_buffer(key))) {
+		ok = true;
+		goto end;
+	}
+	if (type->cv) {
+		MangleType unqualified = *type;
+		unqualified.cv = 0;
+		if (type->cv & MANGLE_CV_VOLATILE) {
+			dem_string_append_char(out, 'V');
+		}
+		if (type->cv & MANGLE_CV_CONST) {
+			dem_string_append_char(out, 'K');
+		}
+		ok = cp_resolved_type(m, out, &unqualified);
+	} else if (type->template_param) {
+		dem_string_append_char(out, 'T');
+		if (type->template_param > 1) {
+			dem_string_appendf(out, "%d", type->template_param - 2);
+		}
+		ok = dem_string_append_char(out, '_');
+	} else {
+		switch (type->kind) {
+		case MANGLE_TYPE_NAMED:
+			// the name adds itself as candidate
+			ok = cp_name(m, out, &type->name, "", true, 0);
+			goto end;
+		case MANGLE_TYPE_POINTER:
+		case MANGLE_TYPE_LVALUE_REF:
+		case MANGLE_TYPE_RVALUE_REF:
+			dem_string_append_char(out, type->kind == MANGLE_TYPE_POINTER ? 'P' : type->kind == MANGLE_TYPE_LVALUE_REF ? 'R'
+																    : 'O');
+			ok = cp_type(m, out, type->pointee);
+			break;
+		case MANGLE_TYPE_FUNCTION:
+			ok = dem_string_append_char(out, 'F') &&
+				cp_type(m, out, type->function.ret) &&
+				cp_params(m, out, &type->function) &&
+				dem_string_append_char(out, 'E');
+			break;
+		default:
+			break;
+		}
+	}
+	ok = ok && cp_sub_add(m, dem_string_buffer(key));
+
+end:
+	dem_string_free(key);
+	return ok;
+}
+
+static bool cp_type(CpMangler *m, DemString *out, const MangleType *type) {
+	MangleType resolved = *type;
+	const char *builtin = type->kind == MANGLE_TYPE_BUILTIN ? NULL : mangle_typedef(m->choices, type);
+	if (builtin) {
+		resolved.kind = MANGLE_TYPE_BUILTIN;
+		resolved.builtin = builtin;
+	}
+	return cp_resolved_type(m, out, &resolved);
+}
+
+static bool cp_function(CpMangler *m, DemString *out, MangleDecl *decl) {
+	char prefix[4] = { 0 };
+	size_t n = 0;
+	if (decl->method_cv & MANGLE_CV_VOLATILE) {
+		prefix[n++] = 'V';
+	}
+	if (decl->method_cv & MANGLE_CV_CONST) {
+		prefix[n++] = 'K';
+	}
+	if (decl->ref_qualifier) {
+		prefix[n++] = decl->ref_qualifier == 1 ? 'R' : 'O';
+	}
+	if (!cp_name(m, out, &decl->name, prefix, false, decl->function.n_params)) {
+		return false;
+	}
+	if (mangle_is_template(decl)) {
+		// the return type of a function template is part of its signature
+		m->targs = &decl->name.components[decl->name.n_components - 1];
+		if (!decl->type) {
+			return false;
+		}
+		cp_mark_template_params(m, decl->type);
+		for (size_t i = 0; i < decl->function.n_params; ++i) {
+			cp_mark_template_params(m, decl->function.params[i]);
+		}
+		if (!cp_type(m, out, decl->type)) {
+			return false;
+		}
+	}
+	return cp_params(m, out, &decl->function);
+}
+
+/**
+ * \brief Mangles the variant of the declaration selected by \p choices.
+ */
+char *cplus_mangle(MangleDecl *decl, MangleChoices *choices) {
+	CpMangler m = { .choices = choices };
+	DemString *out = dem_string_new();
+	bool ok = false;
+	if (!out) {
+		return NULL;
+	}
+	const MangleComponent *last = decl->name.n_components ? &decl->name.components[decl->name.n_components - 1] : NULL;
+	bool plain = last && decl->name.n_components == 1 && last->kind == MANGLE_COMPONENT_NAME && !last->has_args;
+	switch (decl->kind) {
+	case MANGLE_DECL_FUNCTION:
+		if (plain && mangle_choose(choices, 2)) {
+			// extern "C"
+			ok = dem_string_append_n(out, last->name, last->length);
+			break;
+		}
+		ok = dem_string_append(out, "_Z") && cp_function(&m, out, decl);
+		break;
+	case MANGLE_DECL_VARIABLE:
+		if (plain) {
+			ok = dem_string_append_n(out, last->name, last->length);
+			break;
+		}
+		ok = dem_string_append(out, "_Z") && cp_name(&m, out, &decl->name, "", false, 0);
+		break;
+	case MANGLE_DECL_GUARD:
+		ok = dem_string_append(out, "_ZGV") && cp_name(&m, out, &decl->name, "", false, 0);
+		break;
+	case MANGLE_DECL_VTABLE:
+		ok = dem_string_append(out, "_ZTV") && cp_type(&m, out, decl->type);
+		break;
+	case MANGLE_DECL_VTT:
+		ok = dem_string_append(out, "_ZTT") && cp_type(&m, out, decl->type);
+		break;
+	case MANGLE_DECL_TYPEINFO:
+		ok = dem_string_append(out, "_ZTI") && cp_type(&m, out, decl->type);
+		break;
+	case MANGLE_DECL_TYPEINFO_NAME:
+		ok = dem_string_append(out, "_ZTS") && cp_type(&m, out, decl->type);
+		break;
+	}
+	for (size_t i = 0; i < m.n_subs; ++i) {
+		free(m.subs[i]);
+	}
+	free(m.subs);
+	if (!ok) {
+		dem_string_free(out);
+		return NULL;
+	}
+	return dem_string_drain(out);
+}
@@ -22,6 +22,19 @@
 		} \
 	} while (0)
 
+/**
+ * \brief FNV-1a 64 bit hash; the value is stable across runs and hosts
+ * since it is also stored on disk.
+ */
+ut64 dem_hash(const char *data, size_t size) {
+	ut64 hash = 0xcbf29ce484222325ull;
+	for (size_t i = 0; i < size; ++i) {
+		hash ^= (ut8)data[i];
+		hash *= 0x100000001b3ull;
+	}
+	return hash;
+}
+
 void dem_str_replace_char(char *string, size_t size, char ch, char rp) {
 	for (size_t i = 0; i < size; ++i) {
 		if (string[i] == ch) {
@@ -57,6 +57,21 @@ typedef uint64_t ut64;
 #define PFMTSZu "zu"
 #endif
 
+/* demanglers built in, stored with RZ_LIBDEMANGLE_VERSION by the files of outcomes */
+#if WITH_GPL
+#define DEM_LIB_FEATURE_GPL (1u << 0)
+#else
+#define DEM_LIB_FEATURE_GPL 0
+#endif
+#if WITH_SWIFT_DEMANGLER
+#define DEM_LIB_FEATURE_SWIFT (1u << 1)
+#else
+#define DEM_LIB_FEATURE_SWIFT 0
+#endif
+#define DEM_LIB_FEATURES (DEM_LIB_FEATURE_GPL | DEM_LIB_FEATURE_SWIFT)
+
+ut64 dem_hash(const char *data, size_t size);
+
 char *dem_str_ndup(const char *ptr, int len);
 char *dem_str_newf(const char *fmt, ...);
 char *dem_str_append(char *ptr, const char *string);
@@ -81,6 +96,7 @@ bool dem_string_append_char(DemString *ds, const char ch);
 bool dem_string_concat(DemString *dst, DemString *src);
 #define dem_string_buffer(d)            (d->buf)
 #define dem_string_length(d)            (d->len)
+#define dem_string_reset(d)             (d->len = 0, d->buf[0] = 0)
 #define dem_string_appends(d, s)        dem_string_append_n(d, s, strlen(s))
 #define dem_string_appends_prefix(d, s) dem_string_append_prefix_n(d, s, strlen(s))
 
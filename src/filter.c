@@ -0,0 +1,282 @@
+// SPDX-FileCopyrightText: 2026 RizinOrg <info@rizin.re>
+// SPDX-License-Identifier: LGPL-3.0-only
+
+/**
+ * \file filter.c
+ *
+ * Negative-result filter: a Bloom filter of the (language, symbol) pairs
+ * which are known not to demangle, e.g. C symbols, local labels or
+ * compiler generated names.
+ *
+ * The filter is sized for a number of entries and a false-positive rate;
+ * once it holds that many entries it stops growing, thus the rate is never
+ * exceeded (a false positive makes a valid symbol look undemanglable).
+ * The bit positions are derived by double hashing from a single hash of
+ * the key, and bits are only ever set, so concurrent lookups and insertions
+ * need no lock.
+ *
+ * The filter can be saved to and loaded from a file, made of a fixed header
+ * followed by the bit array:
+ *
+ *   [ FilterHeader ][ ut64 * (n_bits / 64) ]
+ *
+ * The header is stamped with the library version and the demanglers built
+ * in: a symbol which failed may demangle with another version or build, so
+ * the filter is discarded on a mismatch. The file is written to a unique temporary file which then
+ * replaces the old one via rename(), thus readers never observe a partial
+ * file, even when several processes save at once.
+ */
+
+#include "demangler_util.h"
+#include <rz_libdemangle.h>
+#include <math.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define FILTER_MAGIC            "RZDMBLOM"
+#define FILTER_VERSION          2
+#define FILTER_MAX_HASHES       32
+#define FILTER_MAX_BITS         (1ull << 36)
+#define FILTER_LIB_VERSION_SIZE 16
+
+#define FILTER_LN2              0.69314718055994530942
+
+#if WITH_THREADS
+#define atomic_load(p) __atomic_load_n(p, __ATOMIC_RELAXED)
+#define atomic_inc(p)  __atomic_add_fetch(p, 1, __ATOMIC_RELAXED)
+#else
+#define atomic_load(p) (*(p))
+#define atomic_inc(p)  (++*(p))
+#endif
+
+typedef struct {
+	char magic[8];
+	ut32 version;
+	ut32 n_hashes;
+	ut64 n_bits; ///< always a multiple of 64
+	ut64 capacity; ///< entries after which the filter stops growing
+	ut64 n_entries;
+	char lib_version[FILTER_LIB_VERSION_SIZE]; ///< RZ_LIBDEMANGLE_VERSION of the writer
+	ut32 lib_features; ///< DEM_LIB_FEATURES of the writer
+	ut32 reserved;
+} FilterHeader;
+
+struct rz_demangle_filter_t {
+	ut32 n_hashes;
+	ut64 n_bits;
+	ut64 capacity;
+	ut64 n_entries; ///< (atomic)
+	ut64 *bits; ///< (atomic)
+};
+
+/**
+ * \brief Sets the bits of \p mask in \p word and returns the previous value.
+ */
+static ut64 filter_set_bits(ut64 *word, ut64 mask) {
+#if WITH_THREADS
+	return __atomic_fetch_or(word, mask, __ATOMIC_RELAXED);
+#else
+	ut64 old = *word;
+	*word |= mask;
+	return old;
+#endif
+}
+
+static RzDemangleFilter *filter_alloc(ut64 n_bits, ut32 n_hashes, ut64 capacity) {
+	RzDemangleFilter *filter = RZ_NEW0(RzDemangleFilter);
+	if (!filter) {
+		return NULL;
+	}
+	filter->bits = calloc(n_bits / 64, sizeof(ut64));
+	if (!filter->bits) {
+		free(filter);
+		return NULL;
+	}
+	filter->n_bits = n_bits;
+	filter->n_hashes = n_hashes;
+	filter->capacity = capacity;
+	return filter;
+}
+
+/**
+ * \brief Creates an empty filter which holds up to \p capacity failing
+ * symbols with at most the given false-positive rate (e.g. 0.001).
+ */
+DEM_LIB_EXPORT RzDemangleFilter *libdemangle_filter_new(size_t capacity, double fp_rate) {
+	if (!capacity || !(fp_rate > 0.0 && fp_rate < 1.0)) {
+		return NULL;
+	}
+	// optimal size: m = -n ln(p) / ln(2)^2 bits and k = m / n ln(2) hashes
+	double bits = -(double)capacity * log(fp_rate) / (FILTER_LN2 * FILTER_LN2);
+	if (bits > (double)FILTER_MAX_BITS) {
+		return NULL;
+	}
+	ut64 n_bits = ((ut64)bits + 63) & ~(ut64)63;
+	double hashes = round((double)n_bits / (double)capacity * FILTER_LN2);
+	ut32 n_hashes = hashes < 1.0 ? 1 : (hashes > FILTER_MAX_HASHES ? FILTER_MAX_HASHES : (ut32)hashes);
+	return filter_alloc(n_bits, n_hashes, capacity);
+}
+
+DEM_LIB_EXPORT void libdemangle_filter_free(RzDemangleFilter *filter) {
+	if (!filter) {
+		return;
+	}
+	free(filter->bits);
+	free(filter);
+}
+
+static void filter_lib_version(char *lib_version) {
+	memset(lib_version, 0, FILTER_LIB_VERSION_SIZE);
+	strncpy(lib_version, RZ_LIBDEMANGLE_VERSION, FILTER_LIB_VERSION_SIZE - 1);
+}
+
+/**
+ * \brief Loads a filter saved via libdemangle_filter_save; returns NULL when
+ * the file is missing, is not a valid filter or was saved by another version
+ * of the library.
+ */
+DEM_LIB_EXPORT RzDemangleFilter *libdemangle_filter_load(const char *path) {
+	RzDemangleFilter *filter = NULL;
+	FilterHeader hdr = { 0 };
+	char lib_version[FILTER_LIB_VERSION_SIZE];
+	filter_lib_version(lib_version);
+	struct stat st;
+	FILE *fp = path ? fopen(path, "rb") : NULL;
+	if (!fp) {
+		return NULL;
+	} else if (fstat(fileno(fp), &st) || fread(&hdr, sizeof(hdr), 1, fp) != 1 ||
+		memcmp(hdr.magic, FILTER_MAGIC, sizeof(hdr.magic)) || hdr.version != FILTER_VERSION ||
+		memcmp(hdr.lib_version, lib_version, sizeof(lib_version)) || hdr.lib_features != DEM_LIB_FEATURES ||
+		!hdr.n_hashes || hdr.n_hashes > FILTER_MAX_HASHES || !hdr.n_bits || hdr.n_bits % 64 ||
+		hdr.n_bits > FILTER_MAX_BITS || !hdr.capacity) {
+		goto end;
+	} else if ((ut64)st.st_size != sizeof(hdr) + hdr.n_bits / 8) {
+		// the bit array is only allocated when the file actually holds it
+		goto end;
+	}
+	filter = filter_alloc(hdr.n_bits, hdr.n_hashes, hdr.capacity);
+	if (!filter) {
+		goto end;
+	} else if (fread(filter->bits, sizeof(ut64), hdr.n_bits / 64, fp) != hdr.n_bits / 64) {
+		libdemangle_filter_free(filter);
+		filter = NULL;
+		goto end;
+	}
+	filter->n_entries = hdr.n_entries;
+
+end:
+	fclose(fp);
+	return filter;
+}
+
+/**
+ * \brief Atomically replaces the file at \p path with the filter.
+ */
+DEM_LIB_EXPORT int libdemangle_filter_save(RzDemangleFilter *filter, const char *path) {
+	if (!filter || !path) {
+		return false;
+	}
+	char *tmp = dem_str_newf("%s.XXXXXX", path);
+	if (!tmp) {
+		return false;
+	}
+	bool ret = false;
+	FILE *fp = NULL;
+	int fd = mkstemp(tmp);
+	if (fd < 0) {
+		goto end;
+	} else if (fchmod(fd, 0644) || !(fp = fdopen(fd, "wb"))) {
+		close(fd);
+		remove(tmp);
+		goto end;
+	}
+	FilterHeader hdr = { 0 };
+	memcpy(hdr.magic, FILTER_MAGIC, sizeof(hdr.magic));
+	hdr.version = FILTER_VERSION;
+	filter_lib_version(hdr.lib_version);
+	hdr.lib_features = DEM_LIB_FEATURES;
+	hdr.n_hashes = filter->n_hashes;
+	hdr.n_bits = filter->n_bits;
+	hdr.capacity = filter->capacity;
+	hdr.n_entries = atomic_load(&filter->n_entries);
+	bool written = fwrite(&hdr, sizeof(hdr), 1, fp) == 1 &&
+		fwrite(filter->bits, sizeof(ut64), filter->n_bits / 64, fp) == filter->n_bits / 64;
+	if (fclose(fp) || !written || rename(tmp, path)) {
+		remove(tmp);
+		goto end;
+	}
+	ret = true;
+
+end:
+	free(tmp);
+	return ret;
+}
+
+static void filter_key_hash(RzDemangleLang lang, const char *symbol, ut64 *h1, ut64 *h2) {
+	ut64 hash = dem_hash(symbol, strlen(symbol)) ^ ((ut64)lang << 56);
+	hash *= 0x9e3779b97f4a7c15ull;
+	*h1 = hash;
+	// the step must be odd, so it never degenerates to a single position
+	*h2 = ((hash >> 29) ^ (hash << 35) ^ 0xbf58476d1ce4e5b9ull) | 1;
+}
+
+/**
+ * \brief Returns true when the symbol is (probably) known not to demangle
+ * for the given language.
+ */
+DEM_LIB_EXPORT int libdemangle_filter_contains(RzDemangleFilter *filter, RzDemangleLang lang, const char *symbol) {
+	if (!filter || !symbol) {
+		return false;
+	}
+	ut64 h1, h2;
+	filter_key_hash(lang, symbol, &h1, &h2);
+	for (ut32 i = 0; i < filter->n_hashes; ++i) {
+		ut64 bit = (h1 + i * h2) % filter->n_bits;
+		if (!(atomic_load(&filter->bits[bit / 64]) & (1ull << (bit % 64)))) {
+			return false;
+		}
+	}
+	return true;
+}
+
+/**
+ * \brief Records the symbol as not demanglable for the given language;
+ * returns false when the filter is full and the symbol cannot be added.
+ */
+DEM_LIB_EXPORT int libdemangle_filter_add(RzDemangleFilter *filter, RzDemangleLang lang, const char *symbol) {
+	if (!filter || !symbol) {
+		return false;
+	} else if (atomic_load(&filter->n_entries) >= filter->capacity) {
+		return libdemangle_filter_contains(filter, lang, symbol);
+	}
+	ut64 h1, h2;
+	bool added = false;
+	filter_key_hash(lang, symbol, &h1, &h2);
+	for (ut32 i = 0; i < filter->n_hashes; ++i) {
+		ut64 bit = (h1 + i * h2) % filter->n_bits;
+		ut64 mask = 1ull << (bit % 64);
+		if (!(filter_set_bits(&filter->bits[bit / 64], mask) & mask)) {
+			added = true;
+		}
+	}
+	if (added) {
+		atomic_inc(&filter->n_entries);
+	}
+	return true;
+}
+
+/**
+ * \brief Demangles the symbol unless the filter knows it fails, recording
+ * the new failures; options are not part of the key, since they only change
+ * how a demangled symbol is printed.
+ */
+DEM_LIB_EXPORT char *libdemangle_filter_demangle(RzDemangleFilter *filter, RzDemangleLang lang, const char *symbol, RzDemangleOpts opts) {
+	if (libdemangle_filter_contains(filter, lang, symbol)) {
+		return NULL;
+	}
+	char *output = libdemangle_handler(lang, symbol, opts);
+	if (!output) {
+		libdemangle_filter_add(filter, lang, symbol);
+	}
+	return output;
+}
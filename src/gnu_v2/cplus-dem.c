@@ -1916,11 +1916,12 @@ gnu_special(struct work_stuff *work, const char **mangled, string *declp)
 	int success = 1;
 	const char *p;
 
-	if ((*mangled)[0] == '_' && strchr(cplus_markers, (*mangled)[1]) != NULL && (*mangled)[2] == '_') {
+	/* strchr() finds the terminator too, which must not be taken for a marker */
+	if ((*mangled)[0] == '_' && (*mangled)[1] && strchr(cplus_markers, (*mangled)[1]) != NULL && (*mangled)[2] == '_') {
 		/* Found a GNU style destructor, get past "_<CPLUS_MARKER>_" */
 		(*mangled) += 3;
 		work->destructor += 1;
-	} else if ((*mangled)[0] == '_' && (((*mangled)[1] == '_' && (*mangled)[2] == 'v' && (*mangled)[3] == 't' && (*mangled)[4] == '_') || ((*mangled)[1] == 'v' && (*mangled)[2] == 't' && strchr(cplus_markers, (*mangled)[3]) != NULL))) {
+	} else if ((*mangled)[0] == '_' && (((*mangled)[1] == '_' && (*mangled)[2] == 'v' && (*mangled)[3] == 't' && (*mangled)[4] == '_') || ((*mangled)[1] == 'v' && (*mangled)[2] == 't' && (*mangled)[3] && strchr(cplus_markers, (*mangled)[3]) != NULL))) {
 		/* Found a GNU style virtual table, get past "_vt<CPLUS_MARKER>"
 		   and create the decl.  Note that we consume the entire mangled
 		   input string, which means that demangle_signature has no work
@@ -2,6 +2,7 @@
 // SPDX-License-Identifier: LGPL-3.0-only
 #include "demangler_util.h"
 #include <rz_libdemangle.h>
+#include "probes.h"
 
 typedef struct {
 	const char *search;
@@ -354,7 +355,7 @@ static char *java_replace_base_classes(char *name) {
  * - myField.I                          myField:int
  * - Lsome/class/Object;.myMethod([F)I  int some.class.Object.myMethod(float[])
  */
-DEM_LIB_EXPORT char *libdemangle_handler_java(const char *mangled, RzDemangleOpts opts) {
+static char *java_handler(const char *mangled, RzDemangleOpts opts) {
 	if (!mangled) {
 		return NULL;
 	}
@@ -381,3 +382,7 @@ DEM_LIB_EXPORT char *libdemangle_handler_java(const char *mangled, RzDemangleOpt
 	}
 	return demangle_any(name);
 }
+
+DEM_LIB_EXPORT char *libdemangle_handler_java(const char *symbol, RzDemangleOpts opts) {
+	return dem_probe_handler(RZ_DEMANGLE_LANG_JAVA, java_handler, symbol, opts);
+}
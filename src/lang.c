@@ -0,0 +1,61 @@
+// SPDX-FileCopyrightText: 2026 RizinOrg <info@rizin.re>
+// SPDX-License-Identifier: LGPL-3.0-only
+
+#include "demangler_util.h"
+#include <rz_libdemangle.h>
+
+typedef char *(*DemHandler)(const char *symbol, RzDemangleOpts opts);
+
+typedef struct {
+	const char *name;
+	DemHandler demangle;
+} DemLanguage;
+
+// !!! sequence in this array need to be same as in RzDemangleLang enum !!!
+static const DemLanguage languages[RZ_DEMANGLE_LANG_MAX] = {
+	{ "c++", libdemangle_handler_cxx },
+	{ "rust", libdemangle_handler_rust },
+#if WITH_SWIFT_DEMANGLER
+	{ "swift", libdemangle_handler_swift },
+#else
+	{ "swift", NULL },
+#endif
+	{ "java", libdemangle_handler_java },
+	{ "msvc", libdemangle_handler_msvc },
+	{ "objc", libdemangle_handler_objc },
+	{ "pascal", libdemangle_handler_pascal },
+};
+
+/**
+ * \brief Returns the language matching the given name or RZ_DEMANGLE_LANG_MAX when unknown/unsupported.
+ */
+DEM_LIB_EXPORT RzDemangleLang libdemangle_lang_from_name(const char *name) {
+	if (!name) {
+		return RZ_DEMANGLE_LANG_MAX;
+	}
+	for (size_t i = 0; i < RZ_ARRAY_SIZE(languages); ++i) {
+		if (languages[i].demangle && !strcmp(languages[i].name, name)) {
+			return (RzDemangleLang)i;
+		}
+	}
+	return RZ_DEMANGLE_LANG_MAX;
+}
+
+DEM_LIB_EXPORT const char *libdemangle_lang_name(RzDemangleLang lang) {
+	if (lang >= RZ_DEMANGLE_LANG_MAX) {
+		return NULL;
+	}
+	return languages[lang].name;
+}
+
+/**
+ * \brief Demangles the symbol with the handler of the given language.
+ *
+ * \return On success a valid pointer is returned, otherwise NULL.
+ */
+DEM_LIB_EXPORT char *libdemangle_handler(RzDemangleLang lang, const char *symbol, RzDemangleOpts opts) {
+	if (lang >= RZ_DEMANGLE_LANG_MAX || !languages[lang].demangle || !symbol) {
+		return NULL;
+	}
+	return languages[lang].demangle(symbol, opts);
+}
@@ -0,0 +1,991 @@
+// SPDX-FileCopyrightText: 2026 RizinOrg <info@rizin.re>
+// SPDX-License-Identifier: LGPL-3.0-only
+
+/**
+ * \file mangle.c
+ *
+ * Mangling of C++ declarations, for looking up a function by hashing its
+ * candidate mangled names instead of demangling every symbol.
+ *
+ * The declaration is parsed here into a small tree, either as written in
+ * the sources or as printed by the demanglers (so access specifiers, calling
+ * conventions and __ptr64 are accepted); the schemes then walk the tree.
+ * A declaration does not tell everything the mangled name encodes (complete
+ * or base constructor, struct or class, member or namespace function, ...),
+ * so each ambiguity is a choice point and every combination is generated.
+ */
+
+#include "mangle.h"
+
+#define MANGLE_MAX_LIST  64
+#define MANGLE_MAX_DEPTH 64
+#define MANGLE_BLOCK     4096
+
+typedef struct mangle_block_t {
+	struct mangle_block_t *next;
+	size_t used;
+	size_t size;
+	void *data[];
+} MangleBlock;
+
+typedef struct {
+	const char *p;
+	MangleBlock *blocks;
+	MangleDecl *decl;
+	int depth;
+} MangleParser;
+
+/**
+ * \brief Typedefs of the builtin types, with the alternatives they stand for
+ * depending on the platform.
+ */
+static const struct {
+	const char *name;
+	const char *builtins[3];
+} mangle_typedefs[] = {
+	{ "int8_t", { "signed char" } },
+	{ "uint8_t", { "unsigned char" } },
+	{ "int16_t", { "short" } },
+	{ "uint16_t", { "unsigned short" } },
+	{ "int32_t", { "int" } },
+	{ "uint32_t", { "unsigned int" } },
+	{ "int64_t", { "long long", "long" } },
+	{ "uint64_t", { "unsigned long long", "unsigned long" } },
+	{ "int128_t", { "__int128" } },
+	{ "uint128_t", { "unsigned __int128" } },
+	{ "size_t", { "unsigned long", "unsigned int", "unsigned long long" } },
+	{ "ssize_t", { "long", "int", "long long" } },
+	{ "ptrdiff_t", { "long", "int", "long long" } },
+	{ "intptr_t", { "long", "int", "long long" } },
+	{ "uintptr_t", { "unsigned long", "unsigned int", "unsigned long long" } },
+};
+
+size_t mangle_choose(MangleChoices *choices, size_t n_options) {
+	if (n_options < 2 || choices->radix * n_options > MANGLE_MAX_VARIANTS) {
+		return 0;
+	}
+	size_t choice = (choices->variant / choices->radix) % n_options;
+	choices->radix *= n_options;
+	return choice;
+}
+
+/**
+ * \brief Like mangle_choose, but the same \p key gets the same choice in the
+ * whole variant (e.g. a class is either a struct or a class everywhere).
+ */
+size_t mangle_choose_keyed(MangleChoices *choices, const char *key, size_t n_options) {
+	for (size_t i = 0; i < choices->n_keyed; ++i) {
+		if (!strcmp(choices->keyed[i].key, key)) {
+			return choices->keyed[i].choice;
+		}
+	}
+	size_t choice = mangle_choose(choices, n_options);
+	if (choices->n_keyed < MANGLE_MAX_KEYED) {
+		char *copy = strdup(key);
+		if (copy) {
+			choices->keyed[choices->n_keyed].key = copy;
+			choices->keyed[choices->n_keyed++].choice = choice;
+		}
+	}
+	return choice;
+}
+
+/**
+ * \brief Returns the builtin type named by the typedef, or NULL when the type
+ * is not one of the well known typedefs.
+ */
+const char *mangle_typedef(MangleChoices *choices, const MangleType *type) {
+	if (type->kind != MANGLE_TYPE_NAMED || type->key || type->name.n_components != 1) {
+		return NULL;
+	}
+	const MangleComponent *c = &type->name.components[0];
+	if (c->kind != MANGLE_COMPONENT_NAME || c->has_args || c->abi_tags) {
+		return NULL;
+	}
+	for (size_t i = 0; i < RZ_ARRAY_SIZE(mangle_typedefs); ++i) {
+		const char *name = mangle_typedefs[i].name;
+		if (strlen(name) != c->length || memcmp(name, c->name, c->length)) {
+			continue;
+		}
+		size_t n = 1;
+		while (n < RZ_ARRAY_SIZE(mangle_typedefs[i].builtins) && mangle_typedefs[i].builtins[n]) {
+			n++;
+		}
+		return mangle_typedefs[i].builtins[mangle_choose_keyed(choices, name, n)];
+	}
+	return NULL;
+}
+
+bool mangle_is_template(const MangleDecl *decl) {
+	const MangleComponent *last = &decl->name.components[decl->name.n_components - 1];
+	return last->has_args && last->kind != MANGLE_COMPONENT_CTOR && last->kind != MANGLE_COMPONENT_DTOR &&
+		last->kind != MANGLE_COMPONENT_CONVERSION;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Canonical printing, used as key of the substitutions and back references
+///////////////////////////////////////////////////////////////////////////////
+
+static bool print_component(DemString *out, const MangleComponent *c, bool args) {
+	switch (c->kind) {
+	case MANGLE_COMPONENT_OPERATOR:
+		dem_string_append(out, "operator");
+		break;
+	case MANGLE_COMPONENT_CONVERSION:
+		dem_string_append(out, "operator ");
+		if (!mangle_print_type(out, c->conversion)) {
+			return false;
+		}
+		break;
+	case MANGLE_COMPONENT_DTOR:
+		dem_string_append_char(out, '~');
+		break;
+	case MANGLE_COMPONENT_ANONYMOUS:
+		dem_string_append(out, "(anonymous namespace)");
+		break;
+	default:
+		break;
+	}
+	dem_string_append_n(out, c->name, c->length);
+	if (c->abi_tags) {
+		dem_string_append_n(out, c->abi_tags, c->abi_tags_length);
+	}
+	if (!args || !c->has_args) {
+		return true;
+	}
+	dem_string_append_char(out, '<');
+	for (size_t i = 0; i < c->n_args; ++i) {
+		const MangleTemplateArg *arg = &c->args[i];
+		if (i) {
+			dem_string_append_char(out, ',');
+		}
+		if (arg->type) {
+			if (!mangle_print_type(out, arg->type)) {
+				return false;
+			}
+		} else {
+			dem_string_appendf(out, "(%s)", arg->literal_type);
+			dem_string_append_n(out, arg->literal, arg->literal_length);
+		}
+	}
+	return dem_string_append_char(out, '>');
+}
+
+/**
+ * \brief Prints the first \p n_components of the name, the template arguments
+ * of the last one only when \p last_args.
+ */
+bool mangle_print_name(DemString *out, const MangleName *name, size_t n_components, bool last_args) {
+	for (size_t i = 0; i < n_components; ++i) {
+		if (i) {
+			dem_string_append(out, "::");
+		}
+		if (!print_component(out, &name->components[i], i + 1 < n_components || last_args)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+/**
+ * \brief Prints the type in a canonical and unambiguous form (qualifiers and
+ * declarators are postfix), which is not meant to be valid C++.
+ */
+bool mangle_print_type(DemString *out, const MangleType *type) {
+	if (type->template_param) {
+		dem_string_appendf(out, "$T%d", type->template_param - 1);
+	} else {
+		switch (type->kind) {
+		case MANGLE_TYPE_BUILTIN:
+			dem_string_append(out, type->builtin);
+			break;
+		case MANGLE_TYPE_NAMED:
+			if (!mangle_print_name(out, &type->name, type->name.n_components, true)) {
+				return false;
+			}
+			break;
+		case MANGLE_TYPE_POINTER:
+		case MANGLE_TYPE_LVALUE_REF:
+		case MANGLE_TYPE_RVALUE_REF:
+			if (!mangle_print_type(out, type->pointee)) {
+				return false;
+			}
+			dem_string_append(out, type->kind == MANGLE_TYPE_POINTER ? "*" : type->kind == MANGLE_TYPE_LVALUE_REF ? "&" : "&&");
+			break;
+		case MANGLE_TYPE_FUNCTION:
+			if (!mangle_print_type(out, type->function.ret)) {
+				return false;
+			}
+			dem_string_append_char(out, '(');
+			for (size_t i = 0; i < type->function.n_params; ++i) {
+				if (i) {
+					dem_string_append_char(out, ',');
+				}
+				if (!mangle_print_type(out, type->function.params[i])) {
+					return false;
+				}
+			}
+			dem_string_append(out, type->function.varargs ? ",...)" : ")");
+			break;
+		}
+	}
+	if (type->cv & MANGLE_CV_CONST) {
+		dem_string_append(out, " const");
+	}
+	if (type->cv & MANGLE_CV_VOLATILE) {
+		dem_string_append(out, " volatile");
+	}
+	return true;
+}
+
+static bool name_equal(const MangleName *a, const MangleName *b);
+
+static bool component_equal(const MangleComponent *a, const MangleComponent *b) {
+	if (a->kind != b->kind || a->length != b->length || memcmp(a->name, b->name, a->length) ||
+		a->has_args != b->has_args || a->n_args != b->n_args) {
+		return false;
+	}
+	if (a->kind == MANGLE_COMPONENT_CONVERSION && !mangle_type_equal(a->conversion, b->conversion, false)) {
+		return false;
+	}
+	for (size_t i = 0; i < a->n_args; ++i) {
+		const MangleTemplateArg *x = &a->args[i], *y = &b->args[i];
+		if (!x->type != !y->type) {
+			return false;
+		} else if (x->type ? !mangle_type_equal(x->type, y->type, false) : x->literal_length != y->literal_length || memcmp(x->literal, y->literal, x->literal_length) || strcmp(x->literal_type, y->literal_type)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+static bool name_equal(const MangleName *a, const MangleName *b) {
+	if (a->n_components != b->n_components) {
+		return false;
+	}
+	for (size_t i = 0; i < a->n_components; ++i) {
+		if (!component_equal(&a->components[i], &b->components[i])) {
+			return false;
+		}
+	}
+	return true;
+}
+
+/**
+ * \brief Compares the types as written, ignoring the qualifiers of the
+ * outermost one when \p ignore_cv.
+ */
+bool mangle_type_equal(const MangleType *a, const MangleType *b, bool ignore_cv) {
+	if (a->kind != b->kind || (!ignore_cv && a->cv != b->cv)) {
+		return false;
+	}
+	switch (a->kind) {
+	case MANGLE_TYPE_BUILTIN:
+		return !strcmp(a->builtin, b->builtin);
+	case MANGLE_TYPE_NAMED:
+		return name_equal(&a->name, &b->name);
+	case MANGLE_TYPE_POINTER:
+	case MANGLE_TYPE_LVALUE_REF:
+	case MANGLE_TYPE_RVALUE_REF:
+		return mangle_type_equal(a->pointee, b->pointee, false);
+	case MANGLE_TYPE_FUNCTION:
+		if (a->function.n_params != b->function.n_params || a->function.varargs != b->function.varargs ||
+			!mangle_type_equal(a->function.ret, b->function.ret, false)) {
+			return false;
+		}
+		for (size_t i = 0; i < a->function.n_params; ++i) {
+			if (!mangle_type_equal(a->function.params[i], b->function.params[i], false)) {
+				return false;
+			}
+		}
+		return true;
+	}
+	return false;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Declaration parser
+///////////////////////////////////////////////////////////////////////////////
+
+static void *parser_alloc(MangleParser *p, size_t size) {
+	size = (size + sizeof(void *) - 1) / sizeof(void *) * sizeof(void *);
+	MangleBlock *block = p->blocks;
+	if (!block || block->size - block->used < size) {
+		size_t block_size = size > MANGLE_BLOCK ? size : MANGLE_BLOCK;
+		block = malloc(sizeof(MangleBlock) + block_size);
+		if (!block) {
+			return NULL;
+		}
+		block->next = p->blocks;
+		block->used = 0;
+		block->size = block_size;
+		p->blocks = block;
+	}
+	void *ptr = (char *)block->data + block->used;
+	block->used += size;
+	memset(ptr, 0, size);
+	return ptr;
+}
+
+static void *parser_dup(MangleParser *p, const void *data, size_t size) {
+	void *copy = parser_alloc(p, size ? size : 1);
+	if (copy) {
+		memcpy(copy, data, size);
+	}
+	return copy;
+}
+
+static bool is_ident_start(char c) {
+	return IS_ALPHA(c) || c == '_' || c == '$';
+}
+
+static bool is_ident(char c) {
+	return is_ident_start(c) || IS_DIGIT(c);
+}
+
+static void skip_spaces(MangleParser *p) {
+	while (*p->p == ' ' || *p->p == '\t') {
+		p->p++;
+	}
+}
+
+static bool accept(MangleParser *p, const char *token) {
+	skip_spaces(p);
+	size_t length = strlen(token);
+	if (strncmp(p->p, token, length)) {
+		return false;
+	}
+	p->p += length;
+	return true;
+}
+
+static bool peek_word(MangleParser *p, const char *word) {
+	skip_spaces(p);
+	size_t length = strlen(word);
+	return !strncmp(p->p, word, length) && !is_ident(p->p[length]);
+}
+
+static bool accept_word(MangleParser *p, const char *word) {
+	if (!peek_word(p, word)) {
+		return false;
+	}
+	p->p += strlen(word);
+	return true;
+}
+
+static size_t parse_identifier(MangleParser *p, const char **ident) {
+	skip_spaces(p);
+	const char *start = p->p;
+	if (!is_ident_start(*start)) {
+		return 0;
+	}
+	while (is_ident(*p->p)) {
+		p->p++;
+	}
+	*ident = start;
+	return p->p - start;
+}
+
+static MangleCallConv parse_cc(MangleParser *p) {
+	static const struct {
+		const char *word;
+		MangleCallConv cc;
+	} ccs[] = {
+		{ "__cdecl", MANGLE_CC_CDECL },
+		{ "__stdcall", MANGLE_CC_STDCALL },
+		{ "__fastcall", MANGLE_CC_FASTCALL },
+		{ "__thiscall", MANGLE_CC_THISCALL },
+		{ "__vectorcall", MANGLE_CC_VECTORCALL },
+	};
+	for (size_t i = 0; i < RZ_ARRAY_SIZE(ccs); ++i) {
+		if (accept_word(p, ccs[i].word)) {
+			return ccs[i].cc;
+		}
+	}
+	return MANGLE_CC_UNKNOWN;
+}
+
+/**
+ * \brief Parses const, volatile and __ptr64 (which only marks the declaration
+ * as coming from a 64 bit binary).
+ */
+static int parse_cv(MangleParser *p) {
+	int cv = 0;
+	for (;;) {
+		if (accept_word(p, "const")) {
+			cv |= MANGLE_CV_CONST;
+		} else if (accept_word(p, "volatile")) {
+			cv |= MANGLE_CV_VOLATILE;
+		} else if (accept_word(p, "__ptr64")) {
+			p->decl->ptr64 = true;
+		} else if (!accept_word(p, "__restrict") && !accept_word(p, "__ptr32")) {
+			return cv;
+		}
+	}
+}
+
+/**
+ * \brief Parses the keywords of a builtin type and returns its canonical name.
+ */
+static const char *parse_builtin(MangleParser *p) {
+	static const char *const bases[] = {
+		"void", "bool", "float", "double", "wchar_t", "char8_t", "char16_t", "char32_t",
+		"__int8", "__int16", "__int32", "__int64", "__int128"
+	};
+	static const char *const unsigned_ints[] = {
+		"unsigned __int8", "unsigned __int16", "unsigned __int32", "unsigned __int64", "unsigned __int128"
+	};
+	int n_signed = 0, n_unsigned = 0, n_short = 0, n_long = 0, n_int = 0, n_char = 0;
+	const char *base = NULL;
+	size_t base_index = 0;
+	for (;;) {
+		if (accept_word(p, "signed")) {
+			n_signed++;
+		} else if (accept_word(p, "unsigned")) {
+			n_unsigned++;
+		} else if (accept_word(p, "short")) {
+			n_short++;
+		} else if (accept_word(p, "long")) {
+			n_long++;
+		} else if (accept_word(p, "int")) {
+			n_int++;
+		} else if (accept_word(p, "char")) {
+			n_char++;
+		} else {
+			size_t i = 0;
+			while (!base && i < RZ_ARRAY_SIZE(bases) && !accept_word(p, bases[i])) {
+				i++;
+			}
+			if (base || i == RZ_ARRAY_SIZE(bases)) {
+				break;
+			}
+			base = bases[i];
+			base_index = i;
+		}
+	}
+	if (base) {
+		if (!strcmp(base, "double")) {
+			return n_long ? "long double" : base;
+		} else if (!strncmp(base, "__int", 5)) {
+			return n_unsigned ? unsigned_ints[base_index - 8] : base;
+		}
+		return base;
+	} else if (n_char) {
+		return n_unsigned ? "unsigned char" : n_signed ? "signed char" : "char";
+	} else if (n_short) {
+		return n_unsigned ? "unsigned short" : "short";
+	} else if (n_long == 1) {
+		return n_unsigned ? "unsigned long" : "long";
+	} else if (n_long > 1) {
+		return n_unsigned ? "unsigned long long" : "long long";
+	} else if (n_int || n_signed || n_unsigned) {
+		return n_unsigned ? "unsigned int" : "int";
+	}
+	return NULL;
+}
+
+static MangleType *parse_type(MangleParser *p);
+static bool parse_name(MangleParser *p, MangleName *name, bool declaration);
+
+static bool parse_template_args(MangleParser *p, MangleComponent *c) {
+	MangleTemplateArg args[MANGLE_MAX_LIST];
+	size_t n = 0;
+	c->has_args = true;
+	if (accept(p, ">")) {
+		return true;
+	}
+	for (;;) {
+		if (n == MANGLE_MAX_LIST) {
+			return false;
+		}
+		MangleTemplateArg *arg = &args[n++];
+		memset(arg, 0, sizeof(*arg));
+		skip_spaces(p);
+		if (*p->p == '(') {
+			// (type)value, as printed by the demangler
+			const char *start = p->p++;
+			const char *builtin = parse_builtin(p);
+			if (!builtin || !accept(p, ")")) {
+				p->p = start;
+			} else {
+				arg->literal_type = builtin;
+				skip_spaces(p);
+			}
+		}
+		if (peek_word(p, "true") || peek_word(p, "false")) {
+			arg->literal = p->p;
+			arg->literal_length = *p->p == 't' ? 4 : 5;
+			arg->literal_type = "bool";
+			p->p += arg->literal_length;
+		} else if (IS_DIGIT(*p->p) || (*p->p == '-' && IS_DIGIT(p->p[1]))) {
+			const char *start = p->p++;
+			while (IS_DIGIT(*p->p)) {
+				p->p++;
+			}
+			arg->literal = start;
+			arg->literal_length = p->p - start;
+			int n_unsigned = 0, n_long = 0;
+			for (; *p->p == 'u' || *p->p == 'U' || *p->p == 'l' || *p->p == 'L'; p->p++) {
+				if (*p->p == 'u' || *p->p == 'U') {
+					n_unsigned++;
+				} else {
+					n_long++;
+				}
+			}
+			if (!arg->literal_type) {
+				arg->literal_type = n_long > 1 ? (n_unsigned ? "unsigned long long" : "long long") : n_long ? (n_unsigned ? "unsigned long" : "long")
+															: (n_unsigned ? "unsigned int" : "int");
+			}
+		} else if (arg->literal_type || !(arg->type = parse_type(p))) {
+			return false;
+		}
+		if (accept(p, ">")) {
+			break;
+		} else if (!accept(p, ",")) {
+			return false;
+		}
+	}
+	c->args = parser_dup(p, args, n * sizeof(MangleTemplateArg));
+	c->n_args = n;
+	return c->args != NULL;
+}
+
+/**
+ * \brief Parses the symbol following the operator keyword; anything else is
+ * the type of a conversion operator.
+ */
+static bool parse_operator(MangleParser *p, MangleComponent *c) {
+	static const char *const symbols[] = {
+		"->*", "<<=", ">>=", "<=>", "()", "[]", "->", "<<", ">>", "<=", ">=", "==", "!=",
+		"&&", "||", "++", "--", "+=", "-=", "*=", "/=", "%=", "^=", "&=", "|=",
+		"+", "-", "*", "/", "%", "^", "&", "|", "~", "!", "=", "<", ">", ","
+	};
+	c->kind = MANGLE_COMPONENT_OPERATOR;
+	skip_spaces(p);
+	const char *start = p->p;
+	if (accept_word(p, "new") || accept_word(p, "delete")) {
+		bool array = accept(p, "[]");
+		c->name = *start == 'n' ? (array ? "new[]" : "new") : (array ? "delete[]" : "delete");
+		c->length = strlen(c->name);
+		return true;
+	} else if (accept_word(p, "co_await")) {
+		c->name = start;
+		c->length = 8;
+		return true;
+	}
+	for (size_t i = 0; i < RZ_ARRAY_SIZE(symbols); ++i) {
+		size_t length = strlen(symbols[i]);
+		if (!strncmp(p->p, symbols[i], length)) {
+			c->name = p->p;
+			c->length = length;
+			p->p += length;
+			return true;
+		}
+	}
+	c->kind = MANGLE_COMPONENT_CONVERSION;
+	c->name = "";
+	c->length = 0;
+	c->conversion = parse_type(p);
+	return c->conversion != NULL;
+}
+
+/**
+ * \brief Parses a qualified name; operators and destructors are accepted only
+ * when parsing the name of the \p declaration.
+ */
+static bool parse_name(MangleParser *p, MangleName *name, bool declaration) {
+	MangleComponent components[MANGLE_MAX_LIST];
+	size_t n = 0;
+	accept(p, "::");
+	do {
+		if (n == MANGLE_MAX_LIST) {
+			return false;
+		}
+		MangleComponent *c = &components[n++];
+		memset(c, 0, sizeof(*c));
+		if (accept(p, "(anonymous namespace)") || accept(p, "`anonymous namespace'")) {
+			c->kind = MANGLE_COMPONENT_ANONYMOUS;
+			c->name = "";
+			continue;
+		}
+		if (accept(p, "~")) {
+			if (!declaration) {
+				return false;
+			}
+			c->kind = MANGLE_COMPONENT_DTOR;
+		}
+		if (!(c->length = parse_identifier(p, &c->name))) {
+			return false;
+		}
+		if (c->length == 8 && !memcmp(c->name, "operator", 8)) {
+			if (!declaration || c->kind == MANGLE_COMPONENT_DTOR || !parse_operator(p, c)) {
+				return false;
+			}
+		} else if (c->length == 11 && !memcmp(c->name, "constructor", 11)) {
+			// as printed by the microsoft demangler
+			c->kind = MANGLE_COMPONENT_CTOR;
+		}
+		if (!strncmp(p->p, "[abi:", 5)) {
+			const char *start = p->p;
+			while (!strncmp(p->p, "[abi:", 5)) {
+				const char *end = strchr(p->p, ']');
+				if (!end) {
+					return false;
+				}
+				p->p = end + 1;
+			}
+			c->abi_tags = start;
+			c->abi_tags_length = p->p - start;
+		}
+		skip_spaces(p);
+		if (*p->p == '<' && c->kind != MANGLE_COMPONENT_CONVERSION) {
+			p->p++;
+			if (++p->depth > MANGLE_MAX_DEPTH || !parse_template_args(p, c)) {
+				return false;
+			}
+			p->depth--;
+		}
+	} while (accept(p, "::"));
+	name->components = parser_dup(p, components, n * sizeof(MangleComponent));
+	name->n_components = n;
+	return name->components != NULL;
+}
+
+static bool parse_params(MangleParser *p, MangleFunction *function) {
+	MangleType *params[MANGLE_MAX_LIST];
+	size_t n = 0;
+	const char *start = p->p;
+	if (accept_word(p, "void") && accept(p, ")")) {
+		return true;
+	}
+	p->p = start;
+	if (accept(p, ")")) {
+		return true;
+	}
+	for (;;) {
+		if (accept(p, "...")) {
+			function->varargs = true;
+			if (!accept(p, ")")) {
+				return false;
+			}
+			break;
+		}
+		if (n == MANGLE_MAX_LIST || !(params[n++] = parse_type(p))) {
+			return false;
+		}
+		const char *ident;
+		parse_identifier(p, &ident); // the name of the parameter
+		if (accept(p, ")")) {
+			break;
+		} else if (!accept(p, ",")) {
+			return false;
+		}
+	}
+	function->params = parser_dup(p, params, n * sizeof(MangleType *));
+	function->n_params = n;
+	return function->params != NULL;
+}
+
+static MangleType *new_type(MangleParser *p, MangleTypeKind kind, MangleType *pointee) {
+	MangleType *type = parser_alloc(p, sizeof(MangleType));
+	if (type) {
+		type->kind = kind;
+		type->pointee = pointee;
+	}
+	return type;
+}
+
+/**
+ * \brief Parses a pointer to function declarator following the return type,
+ * e.g. "(__cdecl *)(int)".
+ */
+static MangleType *parse_function_pointer(MangleParser *p, MangleType *ret) {
+	const char *start = p->p;
+	if (!accept(p, "(")) {
+		return NULL;
+	}
+	MangleCallConv cc = parse_cc(p);
+	MangleTypeKind kind = accept(p, "*") ? MANGLE_TYPE_POINTER : accept(p, "&") ? MANGLE_TYPE_LVALUE_REF
+										    : MANGLE_TYPE_BUILTIN;
+	if (kind == MANGLE_TYPE_BUILTIN) {
+		p->p = start;
+		return NULL;
+	}
+	int cv = parse_cv(p);
+	MangleType *function = new_type(p, MANGLE_TYPE_FUNCTION, NULL);
+	MangleType *pointer = new_type(p, kind, function);
+	if (!function || !pointer || !accept(p, ")") || !accept(p, "(") || !parse_params(p, &function->function)) {
+		return NULL;
+	}
+	function->function.ret = ret;
+	function->function.cc = cc;
+	pointer->cv = cv;
+	return pointer;
+}
+
+static MangleType *parse_type(MangleParser *p) {
+	if (++p->depth > MANGLE_MAX_DEPTH) {
+		return NULL;
+	}
+	MangleType *type = new_type(p, MANGLE_TYPE_BUILTIN, NULL);
+	if (!type) {
+		return NULL;
+	}
+	type->cv = parse_cv(p);
+	if (accept_word(p, "class")) {
+		type->key = MANGLE_KEY_CLASS;
+	} else if (accept_word(p, "struct")) {
+		type->key = MANGLE_KEY_STRUCT;
+	} else if (accept_word(p, "union")) {
+		type->key = MANGLE_KEY_UNION;
+	} else if (accept_word(p, "enum")) {
+		type->key = MANGLE_KEY_ENUM;
+	} else if (accept_word(p, "typename")) {
+		// nothing to do
+	}
+	if (!type->key && (type->builtin = parse_builtin(p))) {
+		type->kind = MANGLE_TYPE_BUILTIN;
+	} else if (peek_word(p, "operator") || !parse_name(p, &type->name, false)) {
+		return NULL;
+	} else {
+		type->kind = MANGLE_TYPE_NAMED;
+	}
+	type->cv |= parse_cv(p);
+	for (;;) {
+		MangleType *outer;
+		if (accept(p, "*")) {
+			outer = new_type(p, MANGLE_TYPE_POINTER, type);
+		} else if (accept(p, "&&")) {
+			outer = new_type(p, MANGLE_TYPE_RVALUE_REF, type);
+		} else if (accept(p, "&")) {
+			outer = new_type(p, MANGLE_TYPE_LVALUE_REF, type);
+		} else if (*p->p == '(' && (outer = parse_function_pointer(p, type))) {
+			type = outer;
+			continue;
+		} else {
+			break;
+		}
+		if (!outer) {
+			return NULL;
+		}
+		type = outer;
+		type->cv = parse_cv(p);
+	}
+	p->depth--;
+	return type;
+}
+
+static void parse_prefix(MangleParser *p, MangleDecl *decl) {
+	for (;;) {
+		if (accept_word(p, "public")) {
+			decl->access = MANGLE_ACCESS_PUBLIC;
+		} else if (accept_word(p, "protected")) {
+			decl->access = MANGLE_ACCESS_PROTECTED;
+		} else if (accept_word(p, "private")) {
+			decl->access = MANGLE_ACCESS_PRIVATE;
+		} else if (accept_word(p, "virtual")) {
+			decl->storage = MANGLE_STORAGE_VIRTUAL;
+		} else if (accept_word(p, "static")) {
+			decl->storage = MANGLE_STORAGE_STATIC;
+		} else if (!accept(p, ":") && !accept_word(p, "inline") && !accept_word(p, "extern") && !accept_word(p, "explicit")) {
+			break;
+		}
+	}
+	if (decl->access && !decl->storage) {
+		decl->storage = MANGLE_STORAGE_NONE;
+	}
+}
+
+static bool parse_special(MangleParser *p, MangleDecl *decl) {
+	static const struct {
+		const char *prefix;
+		MangleDeclKind kind;
+	} specials[] = {
+		{ "vtable for ", MANGLE_DECL_VTABLE },
+		{ "VTT for ", MANGLE_DECL_VTT },
+		{ "typeinfo name for ", MANGLE_DECL_TYPEINFO_NAME },
+		{ "typeinfo for ", MANGLE_DECL_TYPEINFO },
+	};
+	for (size_t i = 0; i < RZ_ARRAY_SIZE(specials); ++i) {
+		if (accept(p, specials[i].prefix)) {
+			decl->kind = specials[i].kind;
+			decl->type = parse_type(p);
+			return decl->type != NULL;
+		}
+	}
+	if (accept(p, "guard variable for ")) {
+		decl->kind = MANGLE_DECL_GUARD;
+		return parse_name(p, &decl->name, false);
+	}
+	// "const ns::Widget::vftable", as printed by the microsoft demangler
+	MangleType *type = parse_type(p);
+	skip_spaces(p);
+	if (!type || *p->p || type->kind != MANGLE_TYPE_NAMED || type->name.n_components < 2) {
+		return false;
+	}
+	const MangleComponent *last = &type->name.components[type->name.n_components - 1];
+	if (last->has_args || last->length != 7 || memcmp(last->name, "vftable", 7)) {
+		return false;
+	}
+	type->name.n_components--;
+	type->cv = 0;
+	decl->kind = MANGLE_DECL_VTABLE;
+	decl->type = type;
+	return true;
+}
+
+static bool parse_declaration(MangleParser *p, MangleDecl *decl) {
+	parse_prefix(p, decl);
+	const char *start = p->p;
+	if (parse_special(p, decl)) {
+		skip_spaces(p);
+		return !*p->p;
+	}
+	p->p = start;
+	p->depth = 0;
+	decl->type = parse_type(p);
+	decl->function.cc = parse_cc(p);
+	skip_spaces(p);
+	if (!decl->type || !*p->p || *p->p == '(') {
+		// there was no type, it was the name
+		p->p = start;
+		p->depth = 0;
+		decl->type = NULL;
+	}
+	if (!parse_name(p, &decl->name, true)) {
+		return false;
+	}
+	if (accept(p, "(")) {
+		decl->kind = MANGLE_DECL_FUNCTION;
+		if (!parse_params(p, &decl->function)) {
+			return false;
+		}
+		for (;;) {
+			int cv = parse_cv(p);
+			decl->method_cv |= cv;
+			if (accept(p, "&&")) {
+				decl->ref_qualifier = 2;
+			} else if (accept(p, "&")) {
+				decl->ref_qualifier = 1;
+			} else if (!cv && !accept_word(p, "noexcept") && !accept_word(p, "override")) {
+				break;
+			}
+		}
+		MangleComponent *last = &decl->name.components[decl->name.n_components - 1];
+		if (last->kind == MANGLE_COMPONENT_NAME && decl->name.n_components > 1) {
+			const MangleComponent *scope = &decl->name.components[decl->name.n_components - 2];
+			if (scope->kind == MANGLE_COMPONENT_NAME && scope->length == last->length && !memcmp(scope->name, last->name, last->length)) {
+				last->kind = MANGLE_COMPONENT_CTOR;
+			}
+		}
+	} else {
+		decl->kind = MANGLE_DECL_VARIABLE;
+	}
+	skip_spaces(p);
+	return !*p->p;
+}
+
+static void parser_fini(MangleParser *p) {
+	while (p->blocks) {
+		MangleBlock *next = p->blocks->next;
+		free(p->blocks);
+		p->blocks = next;
+	}
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Public API
+///////////////////////////////////////////////////////////////////////////////
+
+typedef char *(*MangleScheme)(MangleDecl *decl, MangleChoices *choices);
+
+static void choices_fini(MangleChoices *choices) {
+	for (size_t i = 0; i < choices->n_keyed; ++i) {
+		free(choices->keyed[i].key);
+	}
+}
+
+static bool names_add(char ***names, size_t *n_names, char *name) {
+	for (size_t i = 0; i < *n_names; ++i) {
+		if (!strcmp((*names)[i], name)) {
+			free(name);
+			return true;
+		}
+	}
+	if (!(*n_names & (*n_names + 1))) {
+		// the capacity is the next power of two, leaving room for the NULL
+		size_t capacity = (*n_names + 1) * 2;
+		char **tmp = realloc(*names, capacity * sizeof(char *));
+		if (!tmp) {
+			free(name);
+			return false;
+		}
+		*names = tmp;
+	}
+	(*names)[(*n_names)++] = name;
+	(*names)[*n_names] = NULL;
+	return true;
+}
+
+/**
+ * \brief Mangles the C++ declaration, returning the names it can have in the
+ * symbol table of a binary: a lookup becomes a hash probe per candidate
+ * instead of demangling every symbol.
+ *
+ * The declaration is written as in the sources or as printed by the demangler,
+ * e.g. "ns::Widget::resize(int, int)"; the return type is required for MSVC
+ * and for the function templates. The candidates cover what the declaration
+ * does not tell, like the kind of constructor or the calling convention.
+ *
+ * \param lang RZ_DEMANGLE_LANG_CXX (Itanium ABI) or RZ_DEMANGLE_LANG_MSVC
+ * \param declaration The C++ declaration
+ * \return The NULL terminated list of the candidates, the most likely first,
+ * to be freed with libdemangle_mangle_free; NULL when the declaration cannot
+ * be parsed or mangled.
+ */
+DEM_LIB_EXPORT char **libdemangle_mangle(RzDemangleLang lang, const char *declaration) {
+	MangleScheme scheme = NULL;
+	if (lang == RZ_DEMANGLE_LANG_MSVC) {
+		scheme = microsoft_mangle;
+#if WITH_GPL
+	} else if (lang == RZ_DEMANGLE_LANG_CXX) {
+		scheme = cplus_mangle;
+#endif
+	}
+	if (!scheme || !declaration) {
+		return NULL;
+	}
+
+	MangleDecl decl = { 0 };
+	MangleParser parser = { .p = declaration, .decl = &decl };
+	char **names = NULL;
+	size_t n_names = 0;
+	if (!parse_declaration(&parser, &decl)) {
+		goto end;
+	}
+	for (size_t variant = 0, n_variants = 1; variant < n_variants; ++variant) {
+		MangleChoices choices = { .variant = variant, .radix = 1 };
+		char *name = scheme(&decl, &choices);
+		choices_fini(&choices);
+		n_variants = choices.radix > n_variants ? choices.radix : n_variants;
+		if (name && !names_add(&names, &n_names, name)) {
+			libdemangle_mangle_free(names);
+			names = NULL;
+			goto end;
+		}
+	}
+
+end:
+	parser_fini(&parser);
+	return names;
+}
+
+DEM_LIB_EXPORT void libdemangle_mangle_free(char **names) {
+	if (!names) {
+		return;
+	}
+	for (char **name = names; *name; ++name) {
+		free(*name);
+	}
+	free(names);
+}
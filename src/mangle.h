@@ -0,0 +1,163 @@
+// SPDX-FileCopyrightText: 2026 RizinOrg <info@rizin.re>
+// SPDX-License-Identifier: LGPL-3.0-only
+
+#ifndef MANGLE_H
+#define MANGLE_H
+
+#include "demangler_util.h"
+#include <rz_libdemangle.h>
+
+#define MANGLE_MAX_VARIANTS 4096
+#define MANGLE_MAX_KEYED    32
+
+typedef enum {
+	MANGLE_CV_CONST = (1 << 0),
+	MANGLE_CV_VOLATILE = (1 << 1),
+} MangleCv;
+
+typedef enum {
+	MANGLE_TYPE_BUILTIN = 0,
+	MANGLE_TYPE_NAMED,
+	MANGLE_TYPE_POINTER,
+	MANGLE_TYPE_LVALUE_REF,
+	MANGLE_TYPE_RVALUE_REF,
+	MANGLE_TYPE_FUNCTION,
+} MangleTypeKind;
+
+typedef enum {
+	MANGLE_KEY_UNKNOWN = 0,
+	MANGLE_KEY_CLASS,
+	MANGLE_KEY_STRUCT,
+	MANGLE_KEY_UNION,
+	MANGLE_KEY_ENUM,
+} MangleClassKey;
+
+typedef enum {
+	MANGLE_CC_UNKNOWN = 0,
+	MANGLE_CC_CDECL,
+	MANGLE_CC_STDCALL,
+	MANGLE_CC_FASTCALL,
+	MANGLE_CC_THISCALL,
+	MANGLE_CC_VECTORCALL,
+} MangleCallConv;
+
+typedef enum {
+	MANGLE_COMPONENT_NAME = 0,
+	MANGLE_COMPONENT_OPERATOR, ///< name holds the symbol, e.g. "<<" or "new[]"
+	MANGLE_COMPONENT_CONVERSION,
+	MANGLE_COMPONENT_CTOR,
+	MANGLE_COMPONENT_DTOR,
+	MANGLE_COMPONENT_ANONYMOUS, ///< anonymous namespace
+} MangleComponentKind;
+
+typedef enum {
+	MANGLE_DECL_FUNCTION = 0,
+	MANGLE_DECL_VARIABLE,
+	MANGLE_DECL_VTABLE,
+	MANGLE_DECL_VTT,
+	MANGLE_DECL_TYPEINFO,
+	MANGLE_DECL_TYPEINFO_NAME,
+	MANGLE_DECL_GUARD,
+} MangleDeclKind;
+
+typedef enum {
+	MANGLE_ACCESS_UNKNOWN = 0,
+	MANGLE_ACCESS_PUBLIC,
+	MANGLE_ACCESS_PROTECTED,
+	MANGLE_ACCESS_PRIVATE,
+} MangleAccess;
+
+typedef enum {
+	MANGLE_STORAGE_UNKNOWN = 0,
+	MANGLE_STORAGE_NONE, ///< member which is neither static nor virtual
+	MANGLE_STORAGE_STATIC,
+	MANGLE_STORAGE_VIRTUAL,
+} MangleStorage;
+
+typedef struct mangle_type_t MangleType;
+
+typedef struct {
+	MangleType *type; ///< NULL for a literal
+	const char *literal; ///< value of a literal, e.g. "-5" or "true"
+	size_t literal_length;
+	const char *literal_type; ///< builtin type of the literal
+} MangleTemplateArg;
+
+typedef struct {
+	MangleComponentKind kind;
+	const char *name; ///< identifier or operator symbol, not NUL terminated
+	size_t length;
+	MangleType *conversion;
+	MangleTemplateArg *args;
+	size_t n_args;
+	bool has_args;
+	const char *abi_tags; ///< "[abi:a][abi:b]" as written, or NULL
+	size_t abi_tags_length;
+} MangleComponent;
+
+typedef struct {
+	MangleComponent *components;
+	size_t n_components;
+} MangleName;
+
+typedef struct {
+	MangleType *ret;
+	MangleType **params;
+	size_t n_params;
+	bool varargs;
+	MangleCallConv cc;
+} MangleFunction;
+
+struct mangle_type_t {
+	MangleTypeKind kind;
+	int cv;
+	const char *builtin; ///< canonical builtin name, e.g. "unsigned long"
+	MangleName name;
+	MangleClassKey key;
+	MangleType *pointee; ///< pointed or referenced type
+	MangleFunction function;
+	int template_param; ///< 1 + index of the template parameter standing for the type, 0 for none
+};
+
+typedef struct {
+	MangleDeclKind kind;
+	MangleName name;
+	MangleType *type; ///< return type, type of the variable, or subject of the special names
+	MangleFunction function; ///< parameters of a function (the return type is in type)
+	int method_cv;
+	int ref_qualifier; ///< 0, 1 for & and 2 for &&
+	MangleAccess access;
+	MangleStorage storage;
+	bool ptr64; ///< the declaration uses __ptr64, i.e. it comes from a 64 bit binary
+} MangleDecl;
+
+/**
+ * \brief Ambiguities (e.g. complete or base constructor) are resolved by
+ * generating every combination: each choice point reads its digit from the
+ * variant number, in a mixed radix built while mangling.
+ */
+typedef struct {
+	size_t variant;
+	size_t radix;
+	struct {
+		char *key;
+		size_t choice;
+	} keyed[MANGLE_MAX_KEYED];
+	size_t n_keyed;
+} MangleChoices;
+
+size_t mangle_choose(MangleChoices *choices, size_t n_options);
+size_t mangle_choose_keyed(MangleChoices *choices, const char *key, size_t n_options);
+
+bool mangle_print_type(DemString *out, const MangleType *type);
+bool mangle_print_name(DemString *out, const MangleName *name, size_t n_components, bool last_args);
+bool mangle_type_equal(const MangleType *a, const MangleType *b, bool ignore_cv);
+const char *mangle_typedef(MangleChoices *choices, const MangleType *type);
+bool mangle_is_template(const MangleDecl *decl);
+
+#if WITH_GPL
+char *cplus_mangle(MangleDecl *decl, MangleChoices *choices);
+#endif
+char *microsoft_mangle(MangleDecl *decl, MangleChoices *choices);
+
+#endif /* MANGLE_H */
@@ -0,0 +1,202 @@
+// SPDX-FileCopyrightText: 2026 RizinOrg <info@rizin.re>
+// SPDX-License-Identifier: LGPL-3.0-only
+
+/**
+ * \file memo.c
+ *
+ * Bounded in-memory cache shared by all the threads using a demangle
+ * context. The table is split in shards, each one with its own lock;
+ * when a shard is full it is simply purged, which keeps the memory
+ * bounded without any bookkeeping on hits.
+ * Failures are stored too (NULL result), since they cost as much as
+ * successes to be recomputed.
+ */
+
+#include "memo.h"
+#if WITH_THREADS
+#include <pthread.h>
+#endif
+
+#define MEMO_SHARDS      64
+#define MEMO_MIN_BUCKETS 64
+
+typedef struct dem_memo_entry_t {
+	ut64 hash;
+	ut32 lang;
+	ut32 opts;
+	char *symbol;
+	char *result;
+	struct dem_memo_entry_t *next;
+} DemMemoEntry;
+
+typedef struct {
+#if WITH_THREADS
+	pthread_mutex_t lock;
+#endif
+	DemMemoEntry **buckets;
+	size_t n_buckets;
+	size_t n_entries;
+} DemMemoShard;
+
+struct dem_memo_t {
+	size_t max_shard_entries;
+	DemMemoShard shards[MEMO_SHARDS];
+};
+
+static ut64 memo_hash(RzDemangleLang lang, RzDemangleOpts opts, const char *symbol) {
+	ut64 hash = dem_hash(symbol, strlen(symbol));
+	return (hash ^ ((ut64)lang << 56) ^ ((ut64)opts << 32)) * 0x9e3779b97f4a7c15ull;
+}
+
+static void memo_shard_purge(DemMemoShard *shard) {
+	for (size_t i = 0; i < shard->n_buckets; ++i) {
+		DemMemoEntry *e = shard->buckets[i];
+		while (e) {
+			DemMemoEntry *next = e->next;
+			free(e->symbol);
+			free(e->result);
+			free(e);
+			e = next;
+		}
+		shard->buckets[i] = NULL;
+	}
+	shard->n_entries = 0;
+}
+
+static void memo_shard_grow(DemMemoShard *shard) {
+	size_t n_buckets = shard->n_buckets * 2;
+	DemMemoEntry **buckets = calloc(n_buckets, sizeof(DemMemoEntry *));
+	if (!buckets) {
+		// keeps the old table, it just gets slower.
+		return;
+	}
+	for (size_t i = 0; i < shard->n_buckets; ++i) {
+		DemMemoEntry *e = shard->buckets[i];
+		while (e) {
+			DemMemoEntry *next = e->next;
+			size_t idx = (e->hash >> 8) & (n_buckets - 1);
+			e->next = buckets[idx];
+			buckets[idx] = e;
+			e = next;
+		}
+	}
+	free(shard->buckets);
+	shard->buckets = buckets;
+	shard->n_buckets = n_buckets;
+}
+
+static DemMemoEntry *memo_shard_find(DemMemoShard *shard, ut64 hash, RzDemangleLang lang, RzDemangleOpts opts, const char *symbol) {
+	DemMemoEntry *e = shard->buckets[(hash >> 8) & (shard->n_buckets - 1)];
+	for (; e; e = e->next) {
+		if (e->hash == hash && e->lang == (ut32)lang && e->opts == (ut32)opts && !strcmp(e->symbol, symbol)) {
+			return e;
+		}
+	}
+	return NULL;
+}
+
+/**
+ * \brief Creates a new memo which holds at most (about) \p max_entries.
+ */
+DemMemo *dem_memo_new(size_t max_entries) {
+	DemMemo *memo = RZ_NEW0(DemMemo);
+	if (!memo) {
+		return NULL;
+	}
+	memo->max_shard_entries = max_entries / MEMO_SHARDS + 1;
+	for (size_t i = 0; i < MEMO_SHARDS; ++i) {
+		DemMemoShard *shard = &memo->shards[i];
+		shard->n_buckets = MEMO_MIN_BUCKETS;
+		shard->buckets = calloc(shard->n_buckets, sizeof(DemMemoEntry *));
+		if (!shard->buckets) {
+			dem_memo_free(memo);
+			return NULL;
+		}
+#if WITH_THREADS
+		pthread_mutex_init(&shard->lock, NULL);
+#endif
+	}
+	return memo;
+}
+
+void dem_memo_free(DemMemo *memo) {
+	if (!memo) {
+		return;
+	}
+	for (size_t i = 0; i < MEMO_SHARDS; ++i) {
+		DemMemoShard *shard = &memo->shards[i];
+		if (!shard->buckets) {
+			continue;
+		}
+		memo_shard_purge(shard);
+		free(shard->buckets);
+#if WITH_THREADS
+		pthread_mutex_destroy(&shard->lock);
+#endif
+	}
+	free(memo);
+}
+
+/**
+ * \brief Looks up the symbol; on hit returns true and sets \p result to a
+ * copy of the stored result (NULL when the symbol is known to fail).
+ */
+bool dem_memo_get(DemMemo *memo, RzDemangleLang lang, RzDemangleOpts opts, const char *symbol, char **result) {
+	ut64 hash = memo_hash(lang, opts, symbol);
+	DemMemoShard *shard = &memo->shards[hash % MEMO_SHARDS];
+	bool found = false;
+#if WITH_THREADS
+	pthread_mutex_lock(&shard->lock);
+#endif
+	DemMemoEntry *e = memo_shard_find(shard, hash, lang, opts, symbol);
+	if (e) {
+		*result = e->result ? strdup(e->result) : NULL;
+		found = true;
+	}
+#if WITH_THREADS
+	pthread_mutex_unlock(&shard->lock);
+#endif
+	return found;
+}
+
+void dem_memo_set(DemMemo *memo, RzDemangleLang lang, RzDemangleOpts opts, const char *symbol, const char *result) {
+	ut64 hash = memo_hash(lang, opts, symbol);
+	DemMemoShard *shard = &memo->shards[hash % MEMO_SHARDS];
+	DemMemoEntry *e = RZ_NEW0(DemMemoEntry);
+	if (!e || !(e->symbol = strdup(symbol)) || (result && !(e->result = strdup(result)))) {
+		if (e) {
+			free(e->symbol);
+		}
+		free(e);
+		return;
+	}
+	e->hash = hash;
+	e->lang = lang;
+	e->opts = opts;
+
+#if WITH_THREADS
+	pthread_mutex_lock(&shard->lock);
+#endif
+	if (memo_shard_find(shard, hash, lang, opts, symbol)) {
+		// another thread was faster.
+		free(e->symbol);
+		free(e->result);
+		free(e);
+		goto end;
+	}
+	if (shard->n_entries >= memo->max_shard_entries) {
+		memo_shard_purge(shard);
+	} else if (shard->n_entries >= shard->n_buckets) {
+		memo_shard_grow(shard);
+	}
+	size_t idx = (hash >> 8) & (shard->n_buckets - 1);
+	e->next = shard->buckets[idx];
+	shard->buckets[idx] = e;
+	shard->n_entries++;
+
+end:
+#if WITH_THREADS
+	pthread_mutex_unlock(&shard->lock);
+#endif
+	return;
+}
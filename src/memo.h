@@ -0,0 +1,17 @@
+// SPDX-FileCopyrightText: 2026 RizinOrg <info@rizin.re>
+// SPDX-License-Identifier: LGPL-3.0-only
+
+#ifndef MEMO_H
+#define MEMO_H
+
+#include "demangler_util.h"
+#include <rz_libdemangle.h>
+
+typedef struct dem_memo_t DemMemo;
+
+DemMemo *dem_memo_new(size_t max_entries);
+void dem_memo_free(DemMemo *memo);
+bool dem_memo_get(DemMemo *memo, RzDemangleLang lang, RzDemangleOpts opts, const char *symbol, char **result);
+void dem_memo_set(DemMemo *memo, RzDemangleLang lang, RzDemangleOpts opts, const char *symbol, const char *result);
+
+#endif /* MEMO_H */
@@ -489,6 +489,80 @@ static EDemanglerErr utf16be_to_utf8(const char *utf16be, size_t utf16be_len, ch
 	return eDemanglerErrOK;
 }
 
+/// names of the operators and special functions with a fixed name, by the code following '?'
+const char *const microsoft_operators[128] = {
+	['0'] = "constructor",
+	['1'] = "~destructor",
+	['2'] = "operator new",
+	['3'] = "operator delete",
+	['4'] = "operator=",
+	['5'] = "operator>>",
+	['6'] = "operator<<",
+	['7'] = "operator!",
+	['8'] = "operator==",
+	['9'] = "operator!=",
+	['A'] = "operator[]",
+	['B'] = "operator #{return_type}",
+	['C'] = "operator->",
+	['D'] = "operator*",
+	['E'] = "operator++",
+	['F'] = "operator--",
+	['G'] = "operator-",
+	['H'] = "operator+",
+	['I'] = "operator&",
+	['J'] = "operator->*",
+	['K'] = "operator/",
+	['L'] = "operator%",
+	['M'] = "operator<",
+	['N'] = "operator<=",
+	['O'] = "operator>",
+	['P'] = "operator>=",
+	['Q'] = "operator,",
+	['R'] = "operator()",
+	['S'] = "operator~",
+	['T'] = "operator^",
+	['U'] = "operator|",
+	['V'] = "operator&&",
+	['W'] = "operator||",
+	['X'] = "operator*=",
+	['Y'] = "operator+=",
+	['Z'] = "operator-=",
+};
+
+/// same as microsoft_operators, by the code following "?_"
+const char *const microsoft_operators_ex[128] = {
+	['0'] = "operator/=",
+	['1'] = "operator%=",
+	['2'] = "operator>>=",
+	['3'] = "operator<<=",
+	['4'] = "operator&=",
+	['5'] = "operator|=",
+	['6'] = "operator^=",
+	['7'] = "vftable",
+	['8'] = "vbtable",
+	['9'] = "vcall",
+	['A'] = "typeof",
+	['B'] = "local_static_guard",
+	['D'] = "vbase_dtor",
+	['E'] = "vector_dtor",
+	['F'] = "default_ctor_closure",
+	['G'] = "scalar_dtor",
+	['H'] = "vector_ctor_iter",
+	['I'] = "vector_dtor_iter",
+	['J'] = "vector_vbase_ctor_iter",
+	['K'] = "virtual_displacement_map",
+	['L'] = "eh_vector_ctor_iter",
+	['M'] = "eh_vector_dtor_iter",
+	['N'] = "eh_vector_vbase_ctor_iter",
+	['O'] = "copy_ctor_closure",
+	['S'] = "local_vftable",
+	['T'] = "local_vftable_ctor_closure",
+	['U'] = "operator new[]",
+	['V'] = "operator delete[]",
+	['X'] = "placement_new_closure",
+	['Y'] = "placement_delete_closure",
+};
+
 static size_t get_operator_code(SAbbrState *abbr, const char *buf, DemList *names_l, bool memorize) {
 	// C++ operator code (one character, or two if the first is '_')
 #define SET_OPERATOR_CODE(str) \
@@ -503,42 +577,6 @@ static size_t get_operator_code(SAbbrState *abbr, const char *buf, DemList *name
 	SStrInfo *str_info;
 	size_t read_len = 1;
 	switch (*++buf) {
-	case '0': SET_OPERATOR_CODE("constructor"); break;
-	case '1': SET_OPERATOR_CODE("~destructor"); break;
-	case '2': SET_OPERATOR_CODE("operator new"); break;
-	case '3': SET_OPERATOR_CODE("operator delete"); break;
-	case '4': SET_OPERATOR_CODE("operator="); break;
-	case '5': SET_OPERATOR_CODE("operator>>"); break;
-	case '6': SET_OPERATOR_CODE("operator<<"); break;
-	case '7': SET_OPERATOR_CODE("operator!"); break;
-	case '8': SET_OPERATOR_CODE("operator=="); break;
-	case '9': SET_OPERATOR_CODE("operator!="); break;
-	case 'A': SET_OPERATOR_CODE("operator[]"); break;
-	case 'B': SET_OPERATOR_CODE("operator #{return_type}"); break;
-	case 'C': SET_OPERATOR_CODE("operator->"); break;
-	case 'D': SET_OPERATOR_CODE("operator*"); break;
-	case 'E': SET_OPERATOR_CODE("operator++"); break;
-	case 'F': SET_OPERATOR_CODE("operator--"); break;
-	case 'G': SET_OPERATOR_CODE("operator-"); break;
-	case 'H': SET_OPERATOR_CODE("operator+"); break;
-	case 'I': SET_OPERATOR_CODE("operator&"); break;
-	case 'J': SET_OPERATOR_CODE("operator->*"); break;
-	case 'K': SET_OPERATOR_CODE("operator/"); break;
-	case 'L': SET_OPERATOR_CODE("operator%"); break;
-	case 'M': SET_OPERATOR_CODE("operator<"); break;
-	case 'N': SET_OPERATOR_CODE("operator<="); break;
-	case 'O': SET_OPERATOR_CODE("operator>"); break;
-	case 'P': SET_OPERATOR_CODE("operator>="); break;
-	case 'Q': SET_OPERATOR_CODE("operator,"); break;
-	case 'R': SET_OPERATOR_CODE("operator()"); break;
-	case 'S': SET_OPERATOR_CODE("operator~"); break;
-	case 'T': SET_OPERATOR_CODE("operator^"); break;
-	case 'U': SET_OPERATOR_CODE("operator|"); break;
-	case 'V': SET_OPERATOR_CODE("operator&"); break;
-	case 'W': SET_OPERATOR_CODE("operator||"); break;
-	case 'X': SET_OPERATOR_CODE("operator*="); break;
-	case 'Y': SET_OPERATOR_CODE("operator+="); break;
-	case 'Z': SET_OPERATOR_CODE("operator-="); break;
 	case '$': {
 		str_info = malloc(sizeof(SStrInfo));
 		if (!str_info) {
@@ -555,18 +593,6 @@ static size_t get_operator_code(SAbbrState *abbr, const char *buf, DemList *name
 	}
 	case '_':
 		switch (*++buf) {
-		case '0': SET_OPERATOR_CODE("operator/="); break;
-		case '1': SET_OPERATOR_CODE("operator%="); break;
-		case '2': SET_OPERATOR_CODE("operator>>="); break;
-		case '3': SET_OPERATOR_CODE("operator<<="); break;
-		case '4': SET_OPERATOR_CODE("operator&="); break;
-		case '5': SET_OPERATOR_CODE("operator|="); break;
-		case '6': SET_OPERATOR_CODE("operator^="); break;
-		case '7': SET_OPERATOR_CODE("vftable"); break;
-		case '8': SET_OPERATOR_CODE("vbtable"); break;
-		case '9': SET_OPERATOR_CODE("vcall"); break;
-		case 'A': SET_OPERATOR_CODE("typeof"); break;
-		case 'B': SET_OPERATOR_CODE("local_static_guard"); break;
 		case 'C':
 			if (*++buf != '@') {
 				goto fail;
@@ -708,18 +734,6 @@ static size_t get_operator_code(SAbbrState *abbr, const char *buf, DemList *name
 			free(str);
 			read_len += buf - str_buf_start;
 			break;
-		case 'D': SET_OPERATOR_CODE("vbase_dtor"); break;
-		case 'E': SET_OPERATOR_CODE("vector_dtor"); break;
-		case 'F': SET_OPERATOR_CODE("default_ctor_closure"); break;
-		case 'G': SET_OPERATOR_CODE("scalar_dtor"); break;
-		case 'H': SET_OPERATOR_CODE("vector_ctor_iter"); break;
-		case 'I': SET_OPERATOR_CODE("vector_dtor_iter"); break;
-		case 'J': SET_OPERATOR_CODE("vector_vbase_ctor_iter"); break;
-		case 'K': SET_OPERATOR_CODE("virtual_displacement_map"); break;
-		case 'L': SET_OPERATOR_CODE("eh_vector_ctor_iter"); break;
-		case 'M': SET_OPERATOR_CODE("eh_vector_dtor_iter"); break;
-		case 'N': SET_OPERATOR_CODE("eh_vector_vbase_ctor_iter"); break;
-		case 'O': SET_OPERATOR_CODE("copy_ctor_closure"); break;
 		case 'R':
 			buf++;
 			read_len++;
@@ -769,12 +783,6 @@ static size_t get_operator_code(SAbbrState *abbr, const char *buf, DemList *name
 			default: goto fail;
 			}
 			break;
-		case 'S': SET_OPERATOR_CODE("local_vftable"); break;
-		case 'T': SET_OPERATOR_CODE("local_vftable_ctor_closure"); break;
-		case 'U': SET_OPERATOR_CODE("operator new[]"); break;
-		case 'V': SET_OPERATOR_CODE("operator delete[]"); break;
-		case 'X': SET_OPERATOR_CODE("placement_new_closure"); break;
-		case 'Y': SET_OPERATOR_CODE("placement_delete_closure"); break;
 		case '_':
 			buf++;
 			read_len++;
@@ -818,11 +826,21 @@ static size_t get_operator_code(SAbbrState *abbr, const char *buf, DemList *name
 			default: goto fail;
 			}
 			break;
-		default: goto fail;
+		default:
+			if ((ut8)*buf >= RZ_ARRAY_SIZE(microsoft_operators_ex) || !microsoft_operators_ex[(ut8)*buf]) {
+				goto fail;
+			}
+			SET_OPERATOR_CODE(microsoft_operators_ex[(ut8)*buf]);
+			break;
 		}
 		read_len++;
 		break;
-	default: goto fail;
+	default:
+		if ((ut8)*buf >= RZ_ARRAY_SIZE(microsoft_operators) || !microsoft_operators[(ut8)*buf]) {
+			goto fail;
+		}
+		SET_OPERATOR_CODE(microsoft_operators[(ut8)*buf]);
+		break;
 	}
 	if (*buf) {
 		read_len++;
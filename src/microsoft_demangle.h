@@ -17,4 +17,7 @@
 ///////////////////////////////////////////////////////////////////////////////
 EDemanglerErr microsoft_demangle(SDemangler *demangler, char **demangled_name);
 
+extern const char *const microsoft_operators[128];
+extern const char *const microsoft_operators_ex[128];
+
 #endif // MICROSOFT_DEMANGLE_H
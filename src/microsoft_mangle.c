@@ -0,0 +1,503 @@
+// SPDX-FileCopyrightText: 2026 RizinOrg <info@rizin.re>
+// SPDX-License-Identifier: LGPL-3.0-only
+
+/**
+ * \file microsoft_mangle.c
+ *
+ * Mangling of a parsed declaration with the Microsoft Visual C++ scheme,
+ * the reverse of microsoft_demangle.c whose operator table is shared.
+ *
+ * The names repeated in a symbol are back referenced by their index among the
+ * first 10 ones, and so are the parameter types longer than one character;
+ * template arguments start a new set of back references.
+ */
+
+#include "mangle.h"
+#include "microsoft_demangle.h"
+
+#define MS_MAX_BACKREFS 10
+
+typedef enum {
+	MS_TYPE_OTHER = 0,
+	MS_TYPE_RETURN,
+	MS_TYPE_VARIABLE,
+} MsTypeContext;
+
+typedef struct {
+	char *names[MS_MAX_BACKREFS];
+	size_t n_names;
+	char *types[MS_MAX_BACKREFS];
+	size_t n_types;
+} MsBackrefs;
+
+typedef struct {
+	MangleChoices *choices;
+	MsBackrefs *refs;
+	bool x64;
+} MsMangler;
+
+static const struct {
+	const char *builtin;
+	const char *code;
+} ms_builtins[] = {
+	{ "void", "X" },
+	{ "char", "D" },
+	{ "signed char", "C" },
+	{ "unsigned char", "E" },
+	{ "short", "F" },
+	{ "unsigned short", "G" },
+	{ "int", "H" },
+	{ "unsigned int", "I" },
+	{ "long", "J" },
+	{ "unsigned long", "K" },
+	{ "float", "M" },
+	{ "double", "N" },
+	{ "long double", "O" },
+	{ "bool", "_N" },
+	{ "long long", "_J" },
+	{ "unsigned long long", "_K" },
+	{ "__int8", "_D" },
+	{ "unsigned __int8", "_E" },
+	{ "__int16", "_F" },
+	{ "unsigned __int16", "_G" },
+	{ "__int32", "_H" },
+	{ "unsigned __int32", "_I" },
+	{ "__int64", "_J" },
+	{ "unsigned __int64", "_K" },
+	{ "__int128", "_L" },
+	{ "unsigned __int128", "_M" },
+	{ "char8_t", "_Q" },
+	{ "char16_t", "_S" },
+	{ "char32_t", "_U" },
+	{ "wchar_t", "_W" },
+};
+
+static const char ms_cc_codes[] = {
+	[MANGLE_CC_CDECL] = 'A',
+	[MANGLE_CC_STDCALL] = 'G',
+	[MANGLE_CC_FASTCALL] = 'I',
+	[MANGLE_CC_THISCALL] = 'E',
+	[MANGLE_CC_VECTORCALL] = 'Q',
+};
+
+static bool ms_type(MsMangler *m, DemString *out, MangleType *type, MsTypeContext context);
+static bool ms_function_type(MsMangler *m, DemString *out, MangleFunction *function, MangleCallConv cc);
+
+static void ms_backrefs_fini(MsBackrefs *refs) {
+	for (size_t i = 0; i < refs->n_names; ++i) {
+		free(refs->names[i]);
+	}
+	for (size_t i = 0; i < refs->n_types; ++i) {
+		free(refs->types[i]);
+	}
+}
+
+/**
+ * \brief Appends the back reference to \p key when already in the list,
+ * otherwise appends \p code and records \p key in the list when not full.
+ */
+static bool ms_backref(DemString *out, char **list, size_t *n, const char *key, const char *code, size_t code_length) {
+	for (size_t i = 0; i < *n; ++i) {
+		if (!strcmp(list[i], key)) {
+			return dem_string_append_char(out, '0' + i);
+		}
+	}
+	if (*n < MS_MAX_BACKREFS && !(list[*n] = strdup(key))) {
+		return false;
+	}
+	*n += *n < MS_MAX_BACKREFS;
+	return dem_string_append_n(out, code, code_length);
+}
+
+static bool ms_number(DemString *out, long long value) {
+	unsigned long long v = value < 0 ? -(unsigned long long)value : (unsigned long long)value;
+	if (value < 0) {
+		dem_string_append_char(out, '?');
+	}
+	if (!v) {
+		return dem_string_append(out, "A@");
+	} else if (v <= 10) {
+		return dem_string_append_char(out, '0' + (char)(v - 1));
+	}
+	char digits[17];
+	size_t n = sizeof(digits) - 1;
+	digits[n] = 0;
+	for (; v; v >>= 4) {
+		digits[--n] = 'A' + (v & 0xf);
+	}
+	dem_string_append(out, digits + n);
+	return dem_string_append_char(out, '@');
+}
+
+static const char *ms_operator_code(const MangleComponent *c, char *code) {
+	char name[32];
+	if (c->length + 9 > sizeof(name)) {
+		return NULL;
+	}
+	snprintf(name, sizeof(name), "operator%s%.*s", c->name[0] == 'n' || c->name[0] == 'd' ? " " : "", (int)c->length, c->name);
+	for (size_t i = 0; i < RZ_ARRAY_SIZE(microsoft_operators); ++i) {
+		if (microsoft_operators[i] && !strcmp(microsoft_operators[i], name)) {
+			code[0] = (char)i;
+			code[1] = 0;
+			return code;
+		}
+	}
+	for (size_t i = 0; i < RZ_ARRAY_SIZE(microsoft_operators_ex); ++i) {
+		if (microsoft_operators_ex[i] && !strcmp(microsoft_operators_ex[i], name)) {
+			code[0] = '_';
+			code[1] = (char)i;
+			code[2] = 0;
+			return code;
+		}
+	}
+	return NULL;
+}
+
+/**
+ * \brief Appends the name of the component as found in a qualified name:
+ * an identifier followed by '@' or an operator code.
+ */
+static bool ms_unqualified(MsMangler *m, DemString *out, const MangleComponent *c) {
+	char code[3];
+	switch (c->kind) {
+	case MANGLE_COMPONENT_NAME: {
+		char *name = dem_str_ndup(c->name, c->length);
+		if (!name) {
+			return false;
+		}
+		char *fragment = dem_str_newf("%s@", name);
+		bool ok = fragment && ms_backref(out, m->refs->names, &m->refs->n_names, name, fragment, c->length + 1);
+		free(fragment);
+		free(name);
+		return ok;
+	}
+	case MANGLE_COMPONENT_OPERATOR:
+		if (!ms_operator_code(c, code)) {
+			return false;
+		}
+		dem_string_append_char(out, '?');
+		return dem_string_append(out, code);
+	case MANGLE_COMPONENT_CONVERSION:
+		return dem_string_append(out, "?B");
+	case MANGLE_COMPONENT_CTOR:
+		return dem_string_append(out, "?0");
+	case MANGLE_COMPONENT_DTOR:
+		return dem_string_append(out, "?1");
+	default:
+		// the anonymous namespaces are named after a hash of the file
+		return false;
+	}
+}
+
+/**
+ * \brief Appends the template instance "?$name@args@", which has its own
+ * back references.
+ */
+static bool ms_template_name(MsMangler *m, DemString *out, const MangleComponent *c) {
+	MsBackrefs refs = { 0 };
+	MsBackrefs *saved = m->refs;
+	bool ok = false;
+	m->refs = &refs;
+	dem_string_append(out, "?$");
+	if (!ms_unqualified(m, out, c)) {
+		goto end;
+	}
+	for (size_t i = 0; i < c->n_args; ++i) {
+		const MangleTemplateArg *arg = &c->args[i];
+		if (arg->type) {
+			if (!ms_type(m, out, arg->type, MS_TYPE_OTHER)) {
+				goto end;
+			}
+			continue;
+		}
+		char literal[32];
+		snprintf(literal, sizeof(literal), "%.*s", (int)RZ_MIN(arg->literal_length, sizeof(literal) - 1), arg->literal);
+		long long value = !strcmp(literal, "true") ? 1 : !strcmp(literal, "false") ? 0
+											   : strtoll(literal, NULL, 10);
+		dem_string_append(out, "$0");
+		ms_number(out, value);
+	}
+	ok = dem_string_append_char(out, '@');
+
+end:
+	ms_backrefs_fini(&refs);
+	m->refs = saved;
+	return ok;
+}
+
+static bool ms_fragment(MsMangler *m, DemString *out, const MangleComponent *c) {
+	if (!c->has_args) {
+		return ms_unqualified(m, out, c);
+	}
+	DemString *instance = dem_string_new();
+	if (!instance) {
+		return false;
+	}
+	bool ok = ms_template_name(m, instance, c) &&
+		ms_backref(out, m->refs->names, &m->refs->n_names, dem_string_buffer(instance), dem_string_buffer(instance), dem_string_length(instance));
+	dem_string_free(instance);
+	return ok;
+}
+
+/**
+ * \brief Appends the components of the name from the innermost, skipping the
+ * last \p skip ones, and the final '@'.
+ */
+static bool ms_qualified(MsMangler *m, DemString *out, const MangleName *name, size_t skip) {
+	for (size_t i = name->n_components - skip; i-- > 0;) {
+		if (!ms_fragment(m, out, &name->components[i])) {
+			return false;
+		}
+	}
+	return dem_string_append_char(out, '@');
+}
+
+static char ms_cv_code(int cv) {
+	return "ABCD"[cv & (MANGLE_CV_CONST | MANGLE_CV_VOLATILE)];
+}
+
+static bool ms_builtin(DemString *out, const char *builtin) {
+	for (size_t i = 0; i < RZ_ARRAY_SIZE(ms_builtins); ++i) {
+		if (!strcmp(ms_builtins[i].builtin, builtin)) {
+			return dem_string_append(out, ms_builtins[i].code);
+		}
+	}
+	return false;
+}
+
+static bool ms_type(MsMangler *m, DemString *out, MangleType *type, MsTypeContext context) {
+	const char *builtin = type->kind == MANGLE_TYPE_BUILTIN ? type->builtin : mangle_typedef(m->choices, type);
+	if (builtin) {
+		return ms_builtin(out, builtin);
+	}
+	switch (type->kind) {
+	case MANGLE_TYPE_NAMED: {
+		if (context == MS_TYPE_RETURN) {
+			dem_string_append_char(out, '?');
+			dem_string_append_char(out, ms_cv_code(type->cv));
+		}
+		MangleClassKey key = type->key;
+		if (!key) {
+			DemString *name = dem_string_new();
+			if (!name || !dem_string_append(name, "class-key:") || !mangle_print_name(name, &type->name, type->name.n_components, true)) {
+				dem_string_free(name);
+				return false;
+			}
+			key = mangle_choose_keyed(m->choices, dem_string_buffer(name), 2) ? MANGLE_KEY_STRUCT : MANGLE_KEY_CLASS;
+			dem_string_free(name);
+		}
+		dem_string_append(out, key == MANGLE_KEY_CLASS ? "V" : key == MANGLE_KEY_STRUCT ? "U" : key == MANGLE_KEY_UNION ? "T" : "W4");
+		return ms_qualified(m, out, &type->name, 0);
+	}
+	case MANGLE_TYPE_POINTER:
+	case MANGLE_TYPE_LVALUE_REF:
+	case MANGLE_TYPE_RVALUE_REF:
+		if (type->kind == MANGLE_TYPE_POINTER) {
+			dem_string_append_char(out, "PQRS"[type->cv & (MANGLE_CV_CONST | MANGLE_CV_VOLATILE)]);
+		} else {
+			dem_string_append(out, type->kind == MANGLE_TYPE_LVALUE_REF ? "A" : "$$Q");
+		}
+		if (type->pointee->kind == MANGLE_TYPE_FUNCTION) {
+			dem_string_append_char(out, '6');
+			return ms_function_type(m, out, &type->pointee->function, type->pointee->function.cc);
+		}
+		if (m->x64) {
+			dem_string_append_char(out, 'E');
+		}
+		dem_string_append_char(out, ms_cv_code(type->pointee->cv));
+		return ms_type(m, out, type->pointee, MS_TYPE_OTHER);
+	default:
+		return false;
+	}
+}
+
+/**
+ * \brief Appends the parameters, each one longer than a character being back
+ * referenced when repeated.
+ */
+static bool ms_params(MsMangler *m, DemString *out, MangleFunction *function) {
+	if (!function->n_params && !function->varargs) {
+		return dem_string_append_char(out, 'X');
+	}
+	DemString *key = dem_string_new();
+	DemString *code = dem_string_new();
+	bool ok = key && code;
+	for (size_t i = 0; ok && i < function->n_params; ++i) {
+		MangleType *param = function->params[i];
+		dem_string_reset(key);
+		dem_string_reset(code);
+		ok = mangle_print_type(key, param);
+		for (size_t j = 0; ok && j < m->refs->n_types; ++j) {
+			if (!strcmp(m->refs->types[j], dem_string_buffer(key))) {
+				dem_string_append_char(code, '0' + j);
+				break;
+			}
+		}
+		if (ok && !dem_string_length(code)) {
+			ok = ms_type(m, code, param, MS_TYPE_OTHER);
+			if (ok && dem_string_length(code) > 1 && m->refs->n_types < MS_MAX_BACKREFS) {
+				ok = (m->refs->types[m->refs->n_types++] = strdup(dem_string_buffer(key))) != NULL;
+			}
+		}
+		ok = ok && dem_string_append_n(out, dem_string_buffer(code), dem_string_length(code));
+	}
+	dem_string_free(key);
+	dem_string_free(code);
+	return ok && dem_string_append_char(out, function->varargs ? 'Z' : '@');
+}
+
+static bool ms_cc(MsMangler *m, DemString *out, MangleCallConv cc, MangleCallConv fallback) {
+	return dem_string_append_char(out, ms_cc_codes[cc ? cc : m->x64 ? MANGLE_CC_CDECL : fallback]);
+}
+
+static bool ms_function_type(MsMangler *m, DemString *out, MangleFunction *function, MangleCallConv cc) {
+	return ms_cc(m, out, cc, MANGLE_CC_CDECL) &&
+		ms_type(m, out, function->ret, MS_TYPE_RETURN) &&
+		ms_params(m, out, function) &&
+		dem_string_append_char(out, 'Z');
+}
+
+static MangleAccess ms_access(MsMangler *m, const MangleDecl *decl) {
+	if (decl->access) {
+		return decl->access;
+	}
+	return MANGLE_ACCESS_PUBLIC + mangle_choose(m->choices, 3);
+}
+
+static bool ms_is_member(MsMangler *m, const MangleDecl *decl) {
+	const MangleComponent *last = &decl->name.components[decl->name.n_components - 1];
+	if (decl->access || decl->storage == MANGLE_STORAGE_STATIC || decl->storage == MANGLE_STORAGE_VIRTUAL) {
+		return true;
+	} else if (decl->name.n_components < 2) {
+		return false;
+	} else if (decl->kind == MANGLE_DECL_FUNCTION && last->kind != MANGLE_COMPONENT_NAME && last->kind != MANGLE_COMPONENT_OPERATOR) {
+		return true;
+	}
+	// namespace members first for the variables, class members for the functions
+	return mangle_choose(m->choices, 2) == (decl->kind == MANGLE_DECL_FUNCTION ? 0 : 1);
+}
+
+static bool ms_function(MsMangler *m, DemString *out, MangleDecl *decl) {
+	const MangleComponent *last = &decl->name.components[decl->name.n_components - 1];
+	bool structor = last->kind == MANGLE_COMPONENT_CTOR || last->kind == MANGLE_COMPONENT_DTOR;
+	MangleType *ret = last->kind == MANGLE_COMPONENT_CONVERSION ? last->conversion : decl->type;
+	if (!structor && !ret) {
+		return false;
+	}
+	if (ms_is_member(m, decl)) {
+		static const char codes[][3] = {
+			[MANGLE_ACCESS_PUBLIC] = "QSU",
+			[MANGLE_ACCESS_PROTECTED] = "IKM",
+			[MANGLE_ACCESS_PRIVATE] = "ACE",
+		};
+		MangleAccess access = ms_access(m, decl);
+		MangleStorage storage = decl->storage;
+		if (!storage) {
+			size_t n = last->kind == MANGLE_COMPONENT_CTOR ? 1 : last->kind == MANGLE_COMPONENT_DTOR ? 2
+														 : 3;
+			storage = MANGLE_STORAGE_NONE + mangle_choose(m->choices, n);
+		}
+		dem_string_append_char(out, codes[access][storage - MANGLE_STORAGE_NONE]);
+		if (storage != MANGLE_STORAGE_STATIC) {
+			if (m->x64) {
+				dem_string_append_char(out, 'E');
+			}
+			if (decl->ref_qualifier) {
+				dem_string_append_char(out, decl->ref_qualifier == 1 ? 'G' : 'H');
+			}
+			dem_string_append_char(out, ms_cv_code(decl->method_cv));
+		}
+		bool thiscall = storage != MANGLE_STORAGE_STATIC && !decl->function.varargs;
+		ms_cc(m, out, decl->function.cc, thiscall ? MANGLE_CC_THISCALL : MANGLE_CC_CDECL);
+	} else {
+		static const MangleCallConv ccs[] = { MANGLE_CC_CDECL, MANGLE_CC_STDCALL, MANGLE_CC_FASTCALL };
+		MangleCallConv cc = decl->function.cc;
+		if (!cc && !m->x64) {
+			cc = ccs[mangle_choose(m->choices, RZ_ARRAY_SIZE(ccs))];
+		}
+		dem_string_append_char(out, 'Y');
+		ms_cc(m, out, cc, MANGLE_CC_CDECL);
+	}
+	if (structor) {
+		dem_string_append_char(out, '@');
+	} else if (!ms_type(m, out, ret, MS_TYPE_RETURN)) {
+		return false;
+	}
+	return ms_params(m, out, &decl->function) && dem_string_append_char(out, 'Z');
+}
+
+static bool ms_variable(MsMangler *m, DemString *out, MangleDecl *decl) {
+	MangleType *type = decl->type;
+	if (!type) {
+		return false;
+	}
+	if (ms_is_member(m, decl)) {
+		static const char codes[] = {
+			[MANGLE_ACCESS_PUBLIC] = '2',
+			[MANGLE_ACCESS_PROTECTED] = '1',
+			[MANGLE_ACCESS_PRIVATE] = '0',
+		};
+		dem_string_append_char(out, codes[ms_access(m, decl)]);
+	} else {
+		dem_string_append_char(out, '3');
+	}
+	// the qualifiers of the variable itself come last
+	int cv = type->cv;
+	type->cv = 0;
+	bool ok = ms_type(m, out, type, MS_TYPE_VARIABLE);
+	type->cv = cv;
+	if (ok && m->x64 && type->kind == MANGLE_TYPE_POINTER) {
+		dem_string_append_char(out, 'E');
+	}
+	return ok && dem_string_append_char(out, ms_cv_code(cv));
+}
+
+/**
+ * \brief Mangles the variant of the declaration selected by \p choices.
+ */
+char *microsoft_mangle(MangleDecl *decl, MangleChoices *choices) {
+	MsBackrefs refs = { 0 };
+	MsMangler m = { .choices = choices, .refs = &refs };
+	DemString *out = dem_string_new();
+	bool ok = false;
+	if (!out || (decl->kind != MANGLE_DECL_FUNCTION && decl->kind != MANGLE_DECL_VARIABLE && decl->kind != MANGLE_DECL_VTABLE)) {
+		goto end;
+	}
+	if (decl->kind == MANGLE_DECL_VTABLE) {
+		if (decl->type->kind != MANGLE_TYPE_NAMED) {
+			goto end;
+		}
+		dem_string_append(out, "??_7");
+		ok = ms_qualified(&m, out, &decl->type->name, 0) && dem_string_append(out, "6B@");
+		goto end;
+	}
+	MangleCallConv cc = decl->function.cc;
+	if (decl->ptr64) {
+		m.x64 = true;
+	} else if (cc != MANGLE_CC_STDCALL && cc != MANGLE_CC_FASTCALL && cc != MANGLE_CC_THISCALL) {
+		m.x64 = mangle_choose(choices, 2) == 0;
+	}
+
+	const MangleComponent *last = &decl->name.components[decl->name.n_components - 1];
+	dem_string_append_char(out, '?');
+	if (last->has_args) {
+		// the name of a template instance is not back referenced
+		if (!ms_template_name(&m, out, last)) {
+			goto end;
+		}
+	} else if (!ms_unqualified(&m, out, last)) {
+		goto end;
+	}
+	if (!ms_qualified(&m, out, &decl->name, 1)) {
+		goto end;
+	}
+	ok = decl->kind == MANGLE_DECL_FUNCTION ? ms_function(&m, out, decl) : ms_variable(&m, out, decl);
+
+end:
+	ms_backrefs_fini(&refs);
+	if (!ok) {
+		dem_string_free(out);
+		return NULL;
+	}
+	return dem_string_drain(out);
+}
@@ -2,18 +2,28 @@
 // SPDX-License-Identifier: LGPL-3.0-only
 #include "demangler.h"
 #include <rz_libdemangle.h>
+#include "precomputed.h"
+#include "probes.h"
 
-DEM_LIB_EXPORT char *libdemangle_handler_msvc(const char *str, RzDemangleOpts opts) {
+static char *msvc_handler(const char *str, RzDemangleOpts opts) {
 	char *out = NULL;
 	SDemangler *mangler = 0;
 
+	dem_precomputed_return(RZ_DEMANGLE_LANG_MSVC, str, opts);
+
 	create_demangler(&mangler);
 	if (!mangler) {
 		return NULL;
 	}
+	DEM_PROBE1(msvc_parse_entry, str);
 	if (init_demangler(mangler, (char *)str) == eDemanglerErrOK) {
 		mangler->demangle(mangler, &out /*demangled_name*/);
 	}
+	DEM_PROBE1(msvc_parse_return, out != NULL);
 	free_demangler(mangler);
 	return out;
 }
+
+DEM_LIB_EXPORT char *libdemangle_handler_msvc(const char *symbol, RzDemangleOpts opts) {
+	return dem_probe_handler(RZ_DEMANGLE_LANG_MSVC, msvc_handler, symbol, opts);
+}
@@ -3,6 +3,7 @@
 #include "demangler_util.h"
 #include "cxx.h"
 #include <rz_libdemangle.h>
+#include "probes.h"
 
 static char *demangle_objc(const char *symbol) {
 	char *ret = NULL;
@@ -150,10 +151,14 @@ static char *demangle_objc(const char *symbol) {
 	return ret;
 }
 
-DEM_LIB_EXPORT char *libdemangle_handler_objc(const char *symbol, RzDemangleOpts opts) {
+static char *objc_handler(const char *symbol, RzDemangleOpts opts) {
 	char *res = demangle_objc(symbol);
 	if (res) {
 		return res;
 	}
 	return demangle_gpl_cxx(symbol, opts & RZ_DEMANGLE_OPT_SIMPLIFY);
 }
+
+DEM_LIB_EXPORT char *libdemangle_handler_objc(const char *symbol, RzDemangleOpts opts) {
+	return dem_probe_handler(RZ_DEMANGLE_LANG_OBJC, objc_handler, symbol, opts);
+}
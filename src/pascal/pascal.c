@@ -3,6 +3,7 @@
 
 #include "demangler_util.h"
 #include <rz_libdemangle.h>
+#include "probes.h"
 #include <ctype.h>
 
 #define IS_NAME(x) (IS_LOWER(x) || IS_DIGIT(x) || (x) == '_')
@@ -166,7 +167,7 @@ demangle_fail:
  *
  * Demangles pascal symbols
  */
-DEM_LIB_EXPORT char *libdemangle_handler_pascal(const char *mangled, RzDemangleOpts opts) {
+static char *pascal_handler(const char *mangled, RzDemangleOpts opts) {
 	if (!mangled || !strchr(mangled, '$')) {
 		return NULL;
 	}
@@ -183,3 +184,7 @@ DEM_LIB_EXPORT char *libdemangle_handler_pascal(const char *mangled, RzDemangleO
 
 	return demangle_free_pascal(copy, length);
 }
+
+DEM_LIB_EXPORT char *libdemangle_handler_pascal(const char *symbol, RzDemangleOpts opts) {
+	return dem_probe_handler(RZ_DEMANGLE_LANG_PASCAL, pascal_handler, symbol, opts);
+}
@@ -0,0 +1,51 @@
+// SPDX-FileCopyrightText: 2026 RizinOrg <info@rizin.re>
+// SPDX-License-Identifier: LGPL-3.0-only
+
+#include "precomputed.h"
+
+#if !WITH_PRECOMPUTED
+// the generator itself and builds without the table use an empty one.
+const DemPrecomputedTable dem_precomputed_table = { 0 };
+#endif
+
+ut64 dem_precomputed_hash(RzDemangleLang lang, const char *symbol) {
+	return dem_hash(symbol, strlen(symbol)) ^ ((ut64)(lang + 1) * 0x9e3779b97f4a7c15ull);
+}
+
+ut32 dem_precomputed_slot(ut64 hash, ut32 displacement, ut32 n_entries) {
+	// murmur3 finalizer
+	ut64 h = hash ^ ((ut64)displacement * 0xc2b2ae3d27d4eb4full);
+	h ^= h >> 33;
+	h *= 0xff51afd7ed558ccdull;
+	h ^= h >> 33;
+	h *= 0xc4ceb9fe1a85ec53ull;
+	h ^= h >> 33;
+	return (ut32)(h % n_entries);
+}
+
+/**
+ * \brief Looks up the symbol in the built-in table of the most common
+ * runtime-library symbols.
+ *
+ * \return The static demangled string (must not be freed) or NULL.
+ */
+const char *dem_precomputed_lookup(RzDemangleLang lang, const char *symbol, RzDemangleOpts opts) {
+	const DemPrecomputedTable *table = &dem_precomputed_table;
+	if (!table->n_entries || !symbol) {
+		return NULL;
+	}
+	ut64 hash = dem_precomputed_hash(lang, symbol);
+	ut32 displacement = table->displacements[(hash >> 32) % table->n_displacements];
+	const DemPrecomputedEntry *entry = &table->entries[dem_precomputed_slot(hash, displacement, table->n_entries)];
+	if (!entry->symbol || entry->lang != lang || strcmp(entry->symbol, symbol)) {
+		return NULL;
+	}
+	if ((opts & RZ_DEMANGLE_OPT_SIMPLIFY) && entry->simplified) {
+		return entry->simplified;
+	}
+	return entry->demangled;
+}
+
+DEM_LIB_EXPORT const char *libdemangle_precomputed(RzDemangleLang lang, const char *symbol, RzDemangleOpts opts) {
+	return dem_precomputed_lookup(lang, symbol, opts);
+}
@@ -0,0 +1,42 @@
+// SPDX-FileCopyrightText: 2026 RizinOrg <info@rizin.re>
+// SPDX-License-Identifier: LGPL-3.0-only
+
+#ifndef PRECOMPUTED_H
+#define PRECOMPUTED_H
+
+#include "demangler_util.h"
+#include <rz_libdemangle.h>
+
+typedef struct {
+	const char *symbol; ///< NULL on empty slots
+	const char *demangled;
+	const char *simplified; ///< result with RZ_DEMANGLE_OPT_SIMPLIFY
+	ut8 lang;
+} DemPrecomputedEntry;
+
+/**
+ * Read-only perfect hash table (hash and displace) generated at build time
+ * by src/precomputed/generate.c from the curated lists of symbols.
+ */
+typedef struct {
+	const DemPrecomputedEntry *entries;
+	ut32 n_entries;
+	const ut32 *displacements;
+	ut32 n_displacements;
+} DemPrecomputedTable;
+
+extern const DemPrecomputedTable dem_precomputed_table;
+
+ut64 dem_precomputed_hash(RzDemangleLang lang, const char *symbol);
+ut32 dem_precomputed_slot(ut64 hash, ut32 displacement, ut32 n_entries);
+const char *dem_precomputed_lookup(RzDemangleLang lang, const char *symbol, RzDemangleOpts opts);
+
+#define dem_precomputed_return(lang, symbol, opts) \
+	do { \
+		const char *precomputed = dem_precomputed_lookup(lang, symbol, opts); \
+		if (precomputed) { \
+			return strdup(precomputed); \
+		} \
+	} while (0)
+
+#endif /* PRECOMPUTED_H */
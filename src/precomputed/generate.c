@@ -0,0 +1,292 @@
+// SPDX-FileCopyrightText: 2026 RizinOrg <info@rizin.re>
+// SPDX-License-Identifier: LGPL-3.0-only
+
+/**
+ * \file generate.c
+ *
+ * Build step which demangles the curated lists of symbols with the library
+ * own engines and writes the results as a C perfect hash table (hash and
+ * displace), which is then compiled into libdemangle.
+ *
+ * usage: generate <output.c> <lang>:<list.txt> [<lang>:<list.txt> ...]
+ */
+
+#include "precomputed.h"
+
+#define LINE_SIZE          8192
+#define MAX_DISPLACEMENT   (1u << 24)
+#define ENTRIES_PER_GROUP  4
+
+typedef struct {
+	RzDemangleLang lang;
+	ut64 hash;
+	char *symbol;
+	char *demangled;
+	char *simplified;
+} GenEntry;
+
+typedef struct {
+	GenEntry *entries;
+	ut32 length;
+	ut32 capacity;
+} GenEntries;
+
+typedef struct {
+	ut32 *items;
+	ut32 length;
+} GenGroup;
+
+static bool gen_entries_has(const GenEntries *list, RzDemangleLang lang, ut64 hash, const char *symbol) {
+	for (ut32 i = 0; i < list->length; ++i) {
+		const GenEntry *e = &list->entries[i];
+		if (e->hash == hash && e->lang == lang && !strcmp(e->symbol, symbol)) {
+			return true;
+		}
+	}
+	return false;
+}
+
+static bool gen_entries_add(GenEntries *list, RzDemangleLang lang, const char *symbol) {
+	ut64 hash = dem_precomputed_hash(lang, symbol);
+	if (gen_entries_has(list, lang, hash, symbol)) {
+		return true;
+	}
+	char *demangled = libdemangle_handler(lang, symbol, RZ_DEMANGLE_OPT_BASE);
+	if (!demangled) {
+		// the symbol is not supported by this build configuration.
+		return true;
+	}
+	char *simplified = libdemangle_handler(lang, symbol, RZ_DEMANGLE_OPT_SIMPLIFY);
+	if (simplified && !strcmp(simplified, demangled)) {
+		RZ_FREE(simplified);
+	}
+	if (list->length >= list->capacity) {
+		ut32 capacity = list->capacity ? list->capacity * 2 : 1024;
+		GenEntry *tmp = realloc(list->entries, capacity * sizeof(GenEntry));
+		if (!tmp) {
+			free(demangled);
+			free(simplified);
+			return false;
+		}
+		list->entries = tmp;
+		list->capacity = capacity;
+	}
+	GenEntry *e = &list->entries[list->length++];
+	e->lang = lang;
+	e->hash = hash;
+	e->symbol = strdup(symbol);
+	e->demangled = demangled;
+	e->simplified = simplified;
+	return e->symbol != NULL;
+}
+
+static bool gen_load_list(GenEntries *list, const char *arg) {
+	const char *sep = strchr(arg, ':');
+	if (!sep) {
+		fprintf(stderr, "error: invalid argument '%s', expected <lang>:<list>\n", arg);
+		return false;
+	}
+	char *name = dem_str_ndup(arg, (int)(sep - arg));
+	RzDemangleLang lang = libdemangle_lang_from_name(name);
+	free(name);
+	if (lang == RZ_DEMANGLE_LANG_MAX) {
+		// language disabled in this build configuration
+		return true;
+	}
+
+	FILE *fp = fopen(sep + 1, "r");
+	if (!fp) {
+		fprintf(stderr, "error: cannot open '%s'\n", sep + 1);
+		return false;
+	}
+	char line[LINE_SIZE];
+	bool res = true;
+	while (res && fgets(line, sizeof(line), fp)) {
+		size_t len = strcspn(line, "\r\n");
+		line[len] = 0;
+		if (len > 0 && line[0] != '#') {
+			res = gen_entries_add(list, lang, line);
+		}
+	}
+	fclose(fp);
+	return res;
+}
+
+static int gen_group_cmp(const void *a, const void *b) {
+	const GenGroup *ga = a, *gb = b;
+	if (ga->length != gb->length) {
+		return ga->length < gb->length ? 1 : -1;
+	} else if (!ga->length) {
+		return 0;
+	}
+	// keeps the output stable across qsort implementations
+	return ga->items[0] < gb->items[0] ? -1 : 1;
+}
+
+/**
+ * \brief Hash and displace: every group of keys sharing the same first level
+ * hash searches for the displacement which maps all of its keys to free slots.
+ */
+static bool gen_perfect_hash(const GenEntries *list, ut32 n_slots, ut32 *slots, ut32 n_groups, ut32 *displacements) {
+	GenGroup *groups = calloc(n_groups, sizeof(GenGroup));
+	ut32 *items = calloc(list->length, sizeof(ut32));
+	ut32 *tmp = calloc(list->length, sizeof(ut32));
+	bool res = false;
+	if (!groups || !items || !tmp) {
+		goto end;
+	}
+
+	for (ut32 i = 0; i < list->length; ++i) {
+		groups[(list->entries[i].hash >> 32) % n_groups].length++;
+	}
+	for (ut32 i = 0, offset = 0; i < n_groups; ++i) {
+		groups[i].items = items + offset;
+		offset += groups[i].length;
+		groups[i].length = 0;
+	}
+	for (ut32 i = 0; i < list->length; ++i) {
+		GenGroup *g = &groups[(list->entries[i].hash >> 32) % n_groups];
+		g->items[g->length++] = i;
+	}
+	// biggest groups first, they are the hardest to place.
+	qsort(groups, n_groups, sizeof(GenGroup), gen_group_cmp);
+	for (ut32 i = 0; i < n_slots; ++i) {
+		slots[i] = UT32_MAX;
+	}
+
+	for (ut32 i = 0; i < n_groups && groups[i].length; ++i) {
+		const GenGroup *g = &groups[i];
+		ut32 id = (ut32)((list->entries[g->items[0]].hash >> 32) % n_groups);
+		ut32 d;
+		for (d = 0; d < MAX_DISPLACEMENT; ++d) {
+			ut32 k;
+			for (k = 0; k < g->length; ++k) {
+				ut32 s = dem_precomputed_slot(list->entries[g->items[k]].hash, d, n_slots);
+				if (slots[s] != UT32_MAX) {
+					break;
+				}
+				slots[s] = g->items[k];
+				tmp[k] = s;
+			}
+			if (k == g->length) {
+				break;
+			}
+			// rollback the partial assignment
+			while (k-- > 0) {
+				slots[tmp[k]] = UT32_MAX;
+			}
+		}
+		if (d >= MAX_DISPLACEMENT) {
+			fprintf(stderr, "error: cannot find a displacement for group %u\n", id);
+			goto end;
+		}
+		displacements[id] = d;
+	}
+	res = true;
+
+end:
+	free(groups);
+	free(items);
+	free(tmp);
+	return res;
+}
+
+static void gen_write_string(FILE *fp, const char *str) {
+	if (!str) {
+		fputs("NULL", fp);
+		return;
+	}
+	fputc('"', fp);
+	for (const ut8 *p = (const ut8 *)str; *p; ++p) {
+		if (*p == '"' || *p == '\\') {
+			fprintf(fp, "\\%c", *p);
+		} else if (IS_PRINTABLE(*p) && *p != '?') {
+			// '?' is escaped to avoid trigraphs on msvc strings
+			fputc(*p, fp);
+		} else {
+			fprintf(fp, "\\%03o", *p);
+		}
+	}
+	fputc('"', fp);
+}
+
+static bool gen_write_table(const char *path, const GenEntries *list, ut32 n_slots, const ut32 *slots, ut32 n_groups, const ut32 *displacements) {
+	FILE *fp = fopen(path, "w");
+	if (!fp) {
+		fprintf(stderr, "error: cannot open '%s' for writing\n", path);
+		return false;
+	}
+	fprintf(fp, "// SPDX-FileCopyrightText: 2026 RizinOrg <info@rizin.re>\n");
+	fprintf(fp, "// SPDX-License-Identifier: LGPL-3.0-only\n");
+	fprintf(fp, "// generated by src/precomputed/generate.c, do not edit.\n\n");
+	fprintf(fp, "#include \"precomputed.h\"\n\n");
+	if (!list->length) {
+		fprintf(fp, "const DemPrecomputedTable dem_precomputed_table = { 0 };\n");
+		return !fclose(fp);
+	}
+
+	fprintf(fp, "static const DemPrecomputedEntry entries[%u] = {\n", n_slots);
+	for (ut32 i = 0; i < n_slots; ++i) {
+		if (slots[i] == UT32_MAX) {
+			fprintf(fp, "\t{ NULL, NULL, NULL, 0 },\n");
+			continue;
+		}
+		const GenEntry *e = &list->entries[slots[i]];
+		fprintf(fp, "\t{ ");
+		gen_write_string(fp, e->symbol);
+		fprintf(fp, ", ");
+		gen_write_string(fp, e->demangled);
+		fprintf(fp, ", ");
+		gen_write_string(fp, e->simplified);
+		fprintf(fp, ", %u },\n", (ut32)e->lang);
+	}
+	fprintf(fp, "};\n\n");
+
+	fprintf(fp, "static const ut32 displacements[%u] = {", n_groups);
+	for (ut32 i = 0; i < n_groups; ++i) {
+		fprintf(fp, "%s%u,", (i % 16) ? " " : "\n\t", displacements[i]);
+	}
+	fprintf(fp, "\n};\n\n");
+
+	fprintf(fp, "const DemPrecomputedTable dem_precomputed_table = { entries, %u, displacements, %u };\n", n_slots, n_groups);
+	return !fclose(fp);
+}
+
+int main(int argc, char const *argv[]) {
+	if (argc < 3) {
+		fprintf(stderr, "usage: %s <output.c> <lang>:<list.txt> [<lang>:<list.txt> ...]\n", argv[0]);
+		return 1;
+	}
+
+	GenEntries list = { 0 };
+	int ret = 1;
+	ut32 *slots = NULL, *displacements = NULL;
+	for (int i = 2; i < argc; ++i) {
+		if (!gen_load_list(&list, argv[i])) {
+			goto end;
+		}
+	}
+
+	// ~90% load factor keeps the displacement search short.
+	ut32 n_slots = list.length + list.length / 8 + 1;
+	ut32 n_groups = list.length / ENTRIES_PER_GROUP + 1;
+	slots = calloc(n_slots, sizeof(ut32));
+	displacements = calloc(n_groups, sizeof(ut32));
+	if (!slots || !displacements ||
+		!gen_perfect_hash(&list, n_slots, slots, n_groups, displacements) ||
+		!gen_write_table(argv[1], &list, n_slots, slots, n_groups, displacements)) {
+		goto end;
+	}
+	ret = 0;
+
+end:
+	for (ut32 i = 0; i < list.length; ++i) {
+		free(list.entries[i].symbol);
+		free(list.entries[i].demangled);
+		free(list.entries[i].simplified);
+	}
+	free(list.entries);
+	free(slots);
+	free(displacements);
+	return ret;
+}
@@ -0,0 +1,9 @@
+// SPDX-FileCopyrightText: 2026 RizinOrg <info@rizin.re>
+// SPDX-License-Identifier: LGPL-3.0-only
+
+#include "probes.h"
+
+// the tracers look up the semaphores in the .probes section
+#define DEM_PROBE_DEFINE(name) \
+	__attribute__((section(".probes"))) volatile unsigned short DEM_PROBE_SEMAPHORE(name) = 0;
+DEM_PROBES(DEM_PROBE_DEFINE)
@@ -0,0 +1,77 @@
+// SPDX-FileCopyrightText: 2026 RizinOrg <info@rizin.re>
+// SPDX-License-Identifier: LGPL-3.0-only
+
+/**
+ * \file probes.h
+ *
+ * USDT probes (provider "libdemangle") for tracing the library via eBPF or
+ * systemtap, built with the use_probes meson option:
+ *
+ * - handler_entry(lang, symbol, length)
+ * - handler_return(lang, symbol, result_length, demangled)
+ * - <phase>_entry(symbol) and <phase>_return(demangled) around the engine
+ *   phases: cxx_v2, cxx_v3_parse, cxx_v3_print, cxx_simplify, msvc_parse.
+ *
+ * A probe site is a single nop until a tracer attaches. Every probe has a
+ * semaphore which the tracer increments while attached, the arguments which
+ * cost more than a load (the string lengths) are computed only then.
+ * Without the option all the macros expand to nothing.
+ */
+
+#ifndef RZ_LIBDEMANGLE_PROBES_H
+#define RZ_LIBDEMANGLE_PROBES_H
+
+#include <rz_libdemangle.h>
+#include <string.h>
+
+#define DEM_PROBES(X) \
+	X(handler_entry) \
+	X(handler_return) \
+	X(cxx_v2_entry) \
+	X(cxx_v2_return) \
+	X(cxx_v3_parse_entry) \
+	X(cxx_v3_parse_return) \
+	X(cxx_v3_print_entry) \
+	X(cxx_v3_print_return) \
+	X(cxx_simplify_entry) \
+	X(cxx_simplify_return) \
+	X(msvc_parse_entry) \
+	X(msvc_parse_return)
+
+#if WITH_PROBES
+#define _SDT_HAS_SEMAPHORES 1
+#include <sys/sdt.h>
+
+#define DEM_PROBE_SEMAPHORE(name) libdemangle_##name##_semaphore
+#define DEM_PROBE_DECLARE(name)   extern volatile unsigned short DEM_PROBE_SEMAPHORE(name);
+DEM_PROBES(DEM_PROBE_DECLARE)
+
+#define DEM_PROBE_ENABLED(name)         __builtin_expect(DEM_PROBE_SEMAPHORE(name) != 0, 0)
+#define DEM_PROBE1(name, a)             DTRACE_PROBE1(libdemangle, name, a)
+#define DEM_PROBE3(name, a, b, c)       DTRACE_PROBE3(libdemangle, name, a, b, c)
+#define DEM_PROBE4(name, a, b, c, d)    DTRACE_PROBE4(libdemangle, name, a, b, c, d)
+#else
+#define DEM_PROBE_ENABLED(name)         0
+#define DEM_PROBE1(name, a)             ((void)0)
+#define DEM_PROBE3(name, a, b, c)       ((void)0)
+#define DEM_PROBE4(name, a, b, c, d)    ((void)0)
+#endif
+
+typedef char *(*DemProbedHandler)(const char *symbol, RzDemangleOpts opts);
+
+/**
+ * \brief Calls the handler of \p lang between the handler probes; without
+ * probes it is inlined to the plain call.
+ */
+static inline char *dem_probe_handler(RzDemangleLang lang, DemProbedHandler handler, const char *symbol, RzDemangleOpts opts) {
+	if (DEM_PROBE_ENABLED(handler_entry)) {
+		DEM_PROBE3(handler_entry, (int)lang, symbol, symbol ? strlen(symbol) : 0);
+	}
+	char *result = handler(symbol, opts);
+	if (DEM_PROBE_ENABLED(handler_return)) {
+		DEM_PROBE4(handler_return, (int)lang, symbol, result ? strlen(result) : 0, result != NULL);
+	}
+	return result;
+}
+
+#endif /* RZ_LIBDEMANGLE_PROBES_H */
@@ -3,8 +3,9 @@
 
 #include <rz_libdemangle.h>
 #include "rust.h"
+#include "probes.h"
 
-DEM_LIB_EXPORT char *libdemangle_handler_rust(const char *symbol, RzDemangleOpts opts) {
+static char *rust_handler(const char *symbol, RzDemangleOpts opts) {
 	char *result = rust_demangle_legacy(symbol);
 	if (result) {
 		return result;
@@ -12,3 +13,7 @@ DEM_LIB_EXPORT char *libdemangle_handler_rust(const char *symbol, RzDemangleOpts
 
 	return rust_demangle_v0(symbol, opts & RZ_DEMANGLE_OPT_SIMPLIFY);
 }
+
+DEM_LIB_EXPORT char *libdemangle_handler_rust(const char *symbol, RzDemangleOpts opts) {
+	return dem_probe_handler(RZ_DEMANGLE_LANG_RUST, rust_handler, symbol, opts);
+}
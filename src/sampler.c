@@ -0,0 +1,253 @@
+// SPDX-FileCopyrightText: 2026 RizinOrg <info@rizin.re>
+// SPDX-License-Identifier: LGPL-3.0-only
+
+/**
+ * \file sampler.c
+ *
+ * Sampler of the slowest symbols demangled via a context.
+ *
+ * Every call is timed with the TSC (the monotonic clock on other machines)
+ * and compared against the fastest of the slowest symbols kept by the
+ * calling thread, thus the common case costs two timestamps and a compare.
+ *
+ * Each thread keeps its own top-K samples in a min-heap, claimed on its first
+ * call and only written by that thread. The heap is guarded by a sequence
+ * counter, odd while the owner updates it, so a query copies the heaps of all
+ * the threads without stopping them: a copy is retried when the counter
+ * changed meanwhile. The copies are merged and the ticks converted to ns
+ * by the rate measured since the sampler was created.
+ */
+
+#include "sampler.h"
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+#if defined(_MSC_VER)
+#define SAMPLER_THREAD_LOCAL __declspec(thread)
+#else
+#define SAMPLER_THREAD_LOCAL __thread
+#endif
+
+#define SAMPLER_MAX_THREADS 256
+
+typedef struct {
+	ut64 ticks;
+	RzDemangleLang lang;
+	size_t symbol_length;
+	size_t output_length;
+	char symbol[RZ_DEMANGLE_SAMPLE_SYMBOL]; ///< truncated
+} DemSample;
+
+typedef struct {
+	const void *owner; ///< thread local address of the owner thread
+	ut64 seq; ///< (atomic) odd while the owner updates the heap
+	size_t n_samples;
+	DemSample samples[]; ///< min-heap on the ticks
+} DemSamplerHeap;
+
+struct rz_demangle_sampler_t {
+	ut64 id; ///< never reused, unlike the address
+	size_t top_k;
+	ut64 start_ticks;
+	ut64 start_ns;
+	size_t n_heaps; ///< (atomic) claimed slots, can exceed SAMPLER_MAX_THREADS
+	DemSamplerHeap *heaps[SAMPLER_MAX_THREADS]; ///< (atomic) NULL until published
+};
+
+/* heap of the calling thread for the last sampler it used */
+static SAMPLER_THREAD_LOCAL struct {
+	ut64 sampler_id;
+	DemSamplerHeap *heap;
+} sampler_thread;
+
+static ut64 sampler_ids;
+
+/**
+ * \brief Returns the monotonic clock in ns.
+ */
+ut64 dem_sampler_now_ns(void) {
+#if defined(_WIN32)
+	LARGE_INTEGER counter, frequency;
+	QueryPerformanceCounter(&counter);
+	QueryPerformanceFrequency(&frequency);
+	return (ut64)((double)counter.QuadPart * 1e9 / (double)frequency.QuadPart);
+#else
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (ut64)ts.tv_sec * 1000000000ull + (ut64)ts.tv_nsec;
+#endif
+}
+
+/**
+ * \brief Creates a sampler keeping the \p top_k slowest symbols, to attach
+ * via libdemangle_ctx_set_sampler().
+ */
+DEM_LIB_EXPORT RzDemangleSampler *libdemangle_sampler_new(size_t top_k) {
+	if (!top_k) {
+		return NULL;
+	}
+	RzDemangleSampler *sampler = RZ_NEW0(RzDemangleSampler);
+	if (!sampler) {
+		return NULL;
+	}
+	sampler->id = __atomic_add_fetch(&sampler_ids, 1, __ATOMIC_RELAXED);
+	sampler->top_k = top_k;
+	sampler->start_ns = dem_sampler_now_ns();
+	sampler->start_ticks = dem_sampler_ticks();
+	return sampler;
+}
+
+/**
+ * \brief Frees the sampler, which must not be attached to a context anymore.
+ */
+DEM_LIB_EXPORT void libdemangle_sampler_free(RzDemangleSampler *sampler) {
+	if (!sampler) {
+		return;
+	}
+	for (size_t i = 0; i < SAMPLER_MAX_THREADS; ++i) {
+		free(sampler->heaps[i]);
+	}
+	free(sampler);
+}
+
+/**
+ * \brief Returns the heap of the calling thread, claiming one on its first
+ * call, or NULL when there are too many threads.
+ */
+static DemSamplerHeap *sampler_heap(RzDemangleSampler *sampler) {
+	if (sampler_thread.sampler_id == sampler->id) {
+		return sampler_thread.heap;
+	}
+	// the thread may have switched between samplers
+	DemSamplerHeap *heap = NULL;
+	size_t n_heaps = RZ_MIN(__atomic_load_n(&sampler->n_heaps, __ATOMIC_ACQUIRE), SAMPLER_MAX_THREADS);
+	for (size_t i = 0; i < n_heaps; ++i) {
+		DemSamplerHeap *claimed = __atomic_load_n(&sampler->heaps[i], __ATOMIC_ACQUIRE);
+		if (claimed && claimed->owner == &sampler_thread) {
+			heap = claimed;
+			goto end;
+		}
+	}
+	size_t slot = __atomic_fetch_add(&sampler->n_heaps, 1, __ATOMIC_ACQ_REL);
+	if (slot < SAMPLER_MAX_THREADS && (heap = calloc(1, sizeof(DemSamplerHeap) + sampler->top_k * sizeof(DemSample)))) {
+		heap->owner = &sampler_thread;
+		__atomic_store_n(&sampler->heaps[slot], heap, __ATOMIC_RELEASE);
+	}
+
+end:
+	sampler_thread.sampler_id = sampler->id;
+	sampler_thread.heap = heap;
+	return heap;
+}
+
+/**
+ * \brief Keeps the symbol when among the slowest ones of the thread.
+ */
+void dem_sampler_add(RzDemangleSampler *sampler, RzDemangleLang lang, const char *symbol, const char *result, ut64 ticks) {
+	DemSamplerHeap *heap = sampler_heap(sampler);
+	if (!heap || (heap->n_samples == sampler->top_k && ticks <= heap->samples[0].ticks)) {
+		return;
+	}
+	__atomic_store_n(&heap->seq, heap->seq + 1, __ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+
+	DemSample *samples = heap->samples;
+	size_t n = heap->n_samples;
+	size_t i = 0;
+	if (n < sampler->top_k) {
+		i = heap->n_samples++;
+		// sift up
+		while (i && samples[(i - 1) / 2].ticks > ticks) {
+			samples[i] = samples[(i - 1) / 2];
+			i = (i - 1) / 2;
+		}
+	} else {
+		// sift down from the root, replacing the fastest
+		for (;;) {
+			size_t child = 2 * i + 1;
+			if (child >= n) {
+				break;
+			} else if (child + 1 < n && samples[child + 1].ticks < samples[child].ticks) {
+				child++;
+			}
+			if (samples[child].ticks >= ticks) {
+				break;
+			}
+			samples[i] = samples[child];
+			i = child;
+		}
+	}
+	DemSample *sample = &samples[i];
+	sample->ticks = ticks;
+	sample->lang = lang;
+	sample->symbol_length = strlen(symbol);
+	sample->output_length = result ? strlen(result) : 0;
+	size_t copied = RZ_MIN(sample->symbol_length, sizeof(sample->symbol) - 1);
+	memcpy(sample->symbol, symbol, copied);
+	sample->symbol[copied] = 0;
+
+	__atomic_store_n(&heap->seq, heap->seq + 1, __ATOMIC_RELEASE);
+}
+
+static int sampler_compare(const void *a, const void *b) {
+	const DemSample *x = a, *y = b;
+	return x->ticks < y->ticks ? 1 : x->ticks > y->ticks ? -1 : 0;
+}
+
+/**
+ * \brief Copies the slowest symbols of all the threads, slowest first, while
+ * the sampler keeps recording.
+ *
+ * \return the number of samples copied, at most \p max_samples and the
+ * top_k of the sampler.
+ */
+DEM_LIB_EXPORT size_t libdemangle_sampler_query(RzDemangleSampler *sampler, RzDemangleSample *samples, size_t max_samples) {
+	if (!sampler || !samples || !max_samples) {
+		return 0;
+	}
+	size_t n_heaps = RZ_MIN(__atomic_load_n(&sampler->n_heaps, __ATOMIC_ACQUIRE), SAMPLER_MAX_THREADS);
+	DemSample *merged = n_heaps ? malloc(n_heaps * sampler->top_k * sizeof(DemSample)) : NULL;
+	if (!merged) {
+		return 0;
+	}
+	size_t n_merged = 0;
+	for (size_t i = 0; i < n_heaps; ++i) {
+		DemSamplerHeap *heap = __atomic_load_n(&sampler->heaps[i], __ATOMIC_ACQUIRE);
+		for (; heap;) {
+			ut64 seq = __atomic_load_n(&heap->seq, __ATOMIC_ACQUIRE);
+			if (seq & 1) {
+				continue;
+			}
+			size_t n = RZ_MIN(heap->n_samples, sampler->top_k);
+			memcpy(merged + n_merged, heap->samples, n * sizeof(DemSample));
+			__atomic_thread_fence(__ATOMIC_ACQUIRE);
+			if (__atomic_load_n(&heap->seq, __ATOMIC_RELAXED) == seq) {
+				n_merged += n;
+				break;
+			}
+		}
+	}
+	qsort(merged, n_merged, sizeof(DemSample), sampler_compare);
+
+#if DEM_SAMPLER_TSC
+	ut64 elapsed_ticks = dem_sampler_ticks() - sampler->start_ticks;
+	ut64 elapsed_ns = dem_sampler_now_ns() - sampler->start_ns;
+	double ns_per_tick = elapsed_ticks ? (double)elapsed_ns / (double)elapsed_ticks : 0.0;
+#else
+	double ns_per_tick = 1.0;
+#endif
+	size_t n_samples = RZ_MIN(n_merged, RZ_MIN(max_samples, sampler->top_k));
+	for (size_t i = 0; i < n_samples; ++i) {
+		RzDemangleSample *sample = &samples[i];
+		sample->lang = merged[i].lang;
+		sample->ns = (unsigned long long)((double)merged[i].ticks * ns_per_tick);
+		sample->symbol_length = merged[i].symbol_length;
+		sample->output_length = merged[i].output_length;
+		memcpy(sample->symbol, merged[i].symbol, sizeof(sample->symbol));
+	}
+	free(merged);
+	return n_samples;
+}
@@ -0,0 +1,37 @@
+// SPDX-FileCopyrightText: 2026 RizinOrg <info@rizin.re>
+// SPDX-License-Identifier: LGPL-3.0-only
+
+#ifndef SAMPLER_H
+#define SAMPLER_H
+
+#include "demangler_util.h"
+#include <rz_libdemangle.h>
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define DEM_SAMPLER_TSC 1
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#else
+#include <time.h>
+#endif
+
+/**
+ * \brief Returns a timestamp for the sampler: the TSC on x86, otherwise the
+ * monotonic clock in ns; the ticks are converted to ns on query.
+ */
+static inline ut64 dem_sampler_ticks(void) {
+#if DEM_SAMPLER_TSC && defined(_MSC_VER)
+	return __rdtsc();
+#elif DEM_SAMPLER_TSC
+	return __builtin_ia32_rdtsc();
+#else
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (ut64)ts.tv_sec * 1000000000ull + (ut64)ts.tv_nsec;
+#endif
+}
+
+ut64 dem_sampler_now_ns(void);
+void dem_sampler_add(RzDemangleSampler *sampler, RzDemangleLang lang, const char *symbol, const char *result, ut64 ticks);
+
+#endif /* SAMPLER_H */
@@ -0,0 +1,319 @@
+// SPDX-FileCopyrightText: 2026 RizinOrg <info@rizin.re>
+// SPDX-License-Identifier: LGPL-3.0-only
+
+/**
+ * \file set.c
+ *
+ * Sorted set of the unique demangled names of a corpus.
+ *
+ * The symbols are demangled in parallel on the context worker pool and each
+ * worker inserts its results right away into a hash set split in shards,
+ * each one with its own lock, thus duplicates are dropped while demangling
+ * and the memory only grows with the unique names.
+ *
+ * The names are sorted by a parallel merge sort: the set is split in a few
+ * runs per thread which are sorted concurrently, then adjacent runs are
+ * merged pairwise, in parallel, until one is left. The comparisons are keyed
+ * on the first 8 bytes of each name, loaded as a big endian integer, which
+ * decides most of them without touching the strings.
+ */
+
+#include "batch.h"
+#if WITH_THREADS
+#include <pthread.h>
+#endif
+
+#define SET_SHARDS          64
+#define SET_MIN_SLOTS       64
+#define SET_RUNS_PER_THREAD 4
+
+typedef struct {
+	ut64 hash;
+	char *name; ///< NULL when free
+} DemSetSlot;
+
+typedef struct {
+#if WITH_THREADS
+	pthread_mutex_t lock;
+#endif
+	DemSetSlot *slots;
+	size_t mask;
+	size_t n_names;
+} DemSetShard;
+
+typedef struct {
+	ut64 prefix; ///< first 8 bytes of the name, big endian, zero padded
+	const char *name;
+} DemSetEntry;
+
+struct rz_demangle_set_t {
+	RzDemangleCtx *ctx;
+	bool keep_failures;
+	DemSetShard shards[SET_SHARDS];
+	const char **sorted; ///< last result of libdemangle_set_sorted()
+};
+
+typedef struct {
+	RzDemangleSet *set;
+	RzDemangleLang lang;
+	RzDemangleOpts opts;
+	const char **symbols;
+	bool failed; ///< (atomic)
+} DemSetAddJob;
+
+typedef struct {
+	DemSetEntry *src;
+	DemSetEntry *dst;
+	size_t *bounds; ///< runs[i] is [bounds[i], bounds[i + 1])
+	size_t n_runs;
+} DemSetSortJob;
+
+static ut64 set_hash(const char *name, size_t length) {
+	return dem_hash(name, length) * 0x9e3779b97f4a7c15ull;
+}
+
+static bool set_shard_grow(DemSetShard *shard) {
+	size_t n_slots = shard->slots ? (shard->mask + 1) * 2 : SET_MIN_SLOTS;
+	DemSetSlot *slots = calloc(n_slots, sizeof(DemSetSlot));
+	if (!slots) {
+		return false;
+	}
+	for (size_t i = 0; shard->slots && i <= shard->mask; ++i) {
+		if (!shard->slots[i].name) {
+			continue;
+		}
+		size_t k = shard->slots[i].hash & (n_slots - 1);
+		while (slots[k].name) {
+			k = (k + 1) & (n_slots - 1);
+		}
+		slots[k] = shard->slots[i];
+	}
+	free(shard->slots);
+	shard->slots = slots;
+	shard->mask = n_slots - 1;
+	return true;
+}
+
+/**
+ * \brief Adds the name to the set, which takes its ownership (the name is
+ * freed when already present); returns false on allocation failure.
+ */
+static bool set_insert(RzDemangleSet *set, char *name) {
+	size_t length = strlen(name);
+	ut64 hash = set_hash(name, length);
+	// the shard is picked by the bits which are not used for the slots
+	DemSetShard *shard = &set->shards[hash >> 58];
+	bool res = true;
+#if WITH_THREADS
+	pthread_mutex_lock(&shard->lock);
+#endif
+	// the load factor is kept at most 1/2
+	if (shard->n_names >= (shard->slots ? (shard->mask + 1) / 2 : 0) && !set_shard_grow(shard)) {
+		free(name);
+		res = false;
+		goto end;
+	}
+	size_t k = hash & shard->mask;
+	for (; shard->slots[k].name; k = (k + 1) & shard->mask) {
+		if (shard->slots[k].hash == hash && !strcmp(shard->slots[k].name, name)) {
+			free(name);
+			goto end;
+		}
+	}
+	shard->slots[k].hash = hash;
+	shard->slots[k].name = name;
+	shard->n_names++;
+
+end:
+#if WITH_THREADS
+	pthread_mutex_unlock(&shard->lock);
+#endif
+	return res;
+}
+
+/**
+ * \brief Creates an empty set filled via \p ctx, which must outlive it; with
+ * \p keep_failures the symbols which cannot be demangled are added as they
+ * are, as the text output of the cli prints them.
+ */
+DEM_LIB_EXPORT RzDemangleSet *libdemangle_set_new(RzDemangleCtx *ctx, int keep_failures) {
+	if (!ctx) {
+		return NULL;
+	}
+	RzDemangleSet *set = RZ_NEW0(RzDemangleSet);
+	if (!set) {
+		return NULL;
+	}
+	set->ctx = ctx;
+	set->keep_failures = keep_failures;
+#if WITH_THREADS
+	for (size_t i = 0; i < SET_SHARDS; ++i) {
+		pthread_mutex_init(&set->shards[i].lock, NULL);
+	}
+#endif
+	return set;
+}
+
+DEM_LIB_EXPORT void libdemangle_set_free(RzDemangleSet *set) {
+	if (!set) {
+		return;
+	}
+	for (size_t i = 0; i < SET_SHARDS; ++i) {
+		DemSetShard *shard = &set->shards[i];
+		for (size_t k = 0; shard->slots && k <= shard->mask; ++k) {
+			free(shard->slots[k].name);
+		}
+		free(shard->slots);
+#if WITH_THREADS
+		pthread_mutex_destroy(&shard->lock);
+#endif
+	}
+	free(set->sorted);
+	free(set);
+}
+
+static void set_add_run(void *user, size_t start, size_t end) {
+	DemSetAddJob *job = user;
+	RzDemangleSet *set = job->set;
+	for (size_t i = start; i < end; ++i) {
+		char *name = libdemangle_ctx_demangle(set->ctx, job->lang, job->symbols[i], job->opts);
+		if (!name && set->keep_failures && !(name = strdup(job->symbols[i]))) {
+			__atomic_store_n(&job->failed, true, __ATOMIC_RELAXED);
+		} else if (name && !set_insert(set, name)) {
+			__atomic_store_n(&job->failed, true, __ATOMIC_RELAXED);
+		}
+	}
+}
+
+/**
+ * \brief Demangles the symbols in parallel and adds their unique names to
+ * the set; returns false on allocation failure.
+ */
+DEM_LIB_EXPORT int libdemangle_set_add(RzDemangleSet *set, RzDemangleLang lang, RzDemangleOpts opts, const char **symbols, size_t n_symbols) {
+	if (!set || (n_symbols && !symbols)) {
+		return false;
+	}
+	DemSetAddJob job = { 0 };
+	job.set = set;
+	job.lang = lang;
+	job.opts = opts;
+	job.symbols = symbols;
+	dem_ctx_parallel(set->ctx, n_symbols, 0, set_add_run, &job);
+	return !job.failed;
+}
+
+/**
+ * \brief Returns the number of unique names in the set.
+ */
+DEM_LIB_EXPORT size_t libdemangle_set_size(RzDemangleSet *set) {
+	size_t n_names = 0;
+	for (size_t i = 0; set && i < SET_SHARDS; ++i) {
+		n_names += set->shards[i].n_names;
+	}
+	return n_names;
+}
+
+static int set_entry_cmp(const void *a, const void *b) {
+	const DemSetEntry *x = a;
+	const DemSetEntry *y = b;
+	if (x->prefix != y->prefix) {
+		return x->prefix < y->prefix ? -1 : 1;
+	}
+	// equal prefixes with a NUL byte mean equal names
+	return (x->prefix & 0xff) ? strcmp(x->name + 8, y->name + 8) : 0;
+}
+
+static void set_sort_run(void *user, size_t start, size_t end) {
+	DemSetSortJob *job = user;
+	for (size_t i = start; i < end; ++i) {
+		qsort(job->src + job->bounds[i], job->bounds[i + 1] - job->bounds[i], sizeof(DemSetEntry), set_entry_cmp);
+	}
+}
+
+/**
+ * \brief Merges the runs 2i and 2i + 1 from src into dst.
+ */
+static void set_merge_run(void *user, size_t start, size_t end) {
+	DemSetSortJob *job = user;
+	for (size_t i = start; i < end; ++i) {
+		size_t a = job->bounds[2 * i];
+		size_t mid = job->bounds[RZ_MIN(2 * i + 1, job->n_runs)];
+		size_t b_end = job->bounds[RZ_MIN(2 * i + 2, job->n_runs)];
+		size_t b = mid;
+		size_t out = a;
+		while (a < mid && b < b_end) {
+			job->dst[out++] = set_entry_cmp(&job->src[b], &job->src[a]) < 0 ? job->src[b++] : job->src[a++];
+		}
+		memcpy(job->dst + out, job->src + a, (mid - a) * sizeof(DemSetEntry));
+		out += mid - a;
+		memcpy(job->dst + out, job->src + b, (b_end - b) * sizeof(DemSetEntry));
+	}
+}
+
+/**
+ * \brief Sorts the names of the set in parallel.
+ *
+ * \return the sorted names, owned by the set and valid until it changes,
+ * or NULL on allocation failure.
+ */
+DEM_LIB_EXPORT const char **libdemangle_set_sorted(RzDemangleSet *set, size_t *n_names) {
+	if (!set || !n_names) {
+		return NULL;
+	}
+	size_t n = libdemangle_set_size(set);
+	size_t n_runs = RZ_MIN(n, dem_ctx_n_threads(set->ctx) * SET_RUNS_PER_THREAD);
+	const char **sorted = malloc((n + 1) * sizeof(char *));
+	DemSetEntry *entries = malloc((n + 1) * sizeof(DemSetEntry));
+	DemSetEntry *tmp = malloc((n + 1) * sizeof(DemSetEntry));
+	size_t *bounds = malloc((n_runs + 1) * sizeof(size_t));
+	if (!sorted || !entries || !tmp || !bounds) {
+		free(sorted);
+		sorted = NULL;
+		goto end;
+	}
+	size_t count = 0;
+	for (size_t i = 0; i < SET_SHARDS; ++i) {
+		DemSetShard *shard = &set->shards[i];
+		for (size_t k = 0; shard->slots && k <= shard->mask; ++k) {
+			const char *name = shard->slots[k].name;
+			if (!name) {
+				continue;
+			}
+			ut64 prefix = 0;
+			for (size_t j = 0; j < 8 && name[j]; ++j) {
+				prefix |= (ut64)(ut8)name[j] << (56 - 8 * j);
+			}
+			entries[count].prefix = prefix;
+			entries[count++].name = name;
+		}
+	}
+	for (size_t i = 0; i <= n_runs; ++i) {
+		bounds[i] = n_runs ? n * i / n_runs : 0;
+	}
+
+	DemSetSortJob job = { entries, tmp, bounds, n_runs };
+	dem_ctx_parallel(set->ctx, n_runs, 1, set_sort_run, &job);
+	while (job.n_runs > 1) {
+		size_t n_merged = (job.n_runs + 1) / 2;
+		dem_ctx_parallel(set->ctx, n_merged, 1, set_merge_run, &job);
+		for (size_t i = 0; i <= n_merged; ++i) {
+			bounds[i] = bounds[RZ_MIN(2 * i, job.n_runs)];
+		}
+		job.n_runs = n_merged;
+		DemSetEntry *swap = job.src;
+		job.src = job.dst;
+		job.dst = swap;
+	}
+	for (size_t i = 0; i < n; ++i) {
+		sorted[i] = job.src[i].name;
+	}
+	free(set->sorted);
+	set->sorted = sorted;
+	*n_names = n;
+
+end:
+	free(entries);
+	free(tmp);
+	free(bounds);
+	return sorted;
+}
@@ -3,6 +3,7 @@
 /* work-in-progress reverse engineered swift-demangler in C */
 #include "demangler_util.h"
 #include <rz_libdemangle.h>
+#include "probes.h"
 
 struct Type {
 	const char *code;
@@ -104,7 +105,7 @@ static const char *resolve(struct Type *t, const char *foo, const char **bar) {
 	return NULL;
 }
 
-DEM_LIB_EXPORT char *libdemangle_handler_swift(const char *s, RzDemangleOpts opts) {
+static char *swift_handler(const char *s, RzDemangleOpts opts) {
 #define STRCAT_BOUNDS(x) \
 	if (((x) + 2 + strlen(out)) > sizeof(out)) \
 		break;
@@ -489,3 +490,7 @@ DEM_LIB_EXPORT char *libdemangle_handler_swift(const char *s, RzDemangleOpts opt
 	}
 	return NULL;
 }
+
+DEM_LIB_EXPORT char *libdemangle_handler_swift(const char *symbol, RzDemangleOpts opts) {
+	return dem_probe_handler(RZ_DEMANGLE_LANG_SWIFT, swift_handler, symbol, opts);
+}
@@ -12,6 +12,12 @@ fi
 
 HAS_SWIFT=$("$CLI" | grep "swift")
 HAS_GPL=$("$CLI" | grep "gnu v3")
+HAS_SERVER=$("$CLI" | grep -- "--listen")
+HAS_THREADS=$("$CLI" | grep -- "-j <threads>")
+HAS_FILES=$("$CLI" | grep -- "-f <file>")
+HAS_FILTER=$("$CLI" | grep -- "--filter <file>")
+HAS_CORPUS=$("$CLI" | grep -- "--replay <file>")
+FILES="$(dirname "$0")/files"
 
 # terminate on fail (!= 0)
 set -e
@@ -48,3 +54,187 @@ if [ ! -z "$HAS_GPL" ]]; then
     "$CLI" -s 'c++' '_ZTTNSt7__cxx1118basic_stringstreamIcSt11char_traitsIcESaIcEEE_ptr'
 fi
 
+## without a symbol, one symbol per line is read from stdin
+INPUT='Ljava/lang/String;\nnot a symbol\nLsome/class/Object;.myMethod([F)I\n'
+EXPECTED=$(printf 'java.lang.String\nnot a symbol\nint some.class.Object.myMethod(float[])\n')
+OUTPUT=$(printf "$INPUT" | "$CLI" 'java')
+[ "$OUTPUT" = "$EXPECTED" ]
+
+## NDJSON records, with the escaped input
+OUTPUT=$(printf 'Ljava/lang/String;\nnot "a" symbol\n' | "$CLI" --json 'java')
+JSON_EXPECTED='{"input":"Ljava/lang/String;","lang":"java","result":"java.lang.String","length":16}
+{"input":"not \"a\" symbol","lang":"java","result":null,"length":0}'
+[ "$OUTPUT" = "$JSON_EXPECTED" ]
+"$CLI" --json-ns 'java' 'Ljava/lang/String;' | grep -Eq '"length":16,"ns":[0-9]+(,"bytes":[0-9]+)?}$'
+
+## the statistics are printed on stderr, the output is unchanged
+OUTPUT=$(printf "$INPUT" | "$CLI" --stats 'java' 2> /dev/null)
+[ "$OUTPUT" = "$EXPECTED" ]
+STATS=$(printf "$INPUT" | "$CLI" --stats 'java' 2>&1 > /dev/null)
+echo "$STATS" | grep -qxF 'symbols: 3 (2 demangled, 1 failed)'
+echo "$STATS" | grep -q '^latency: p50 .*, p99 .*, p99.9 .*, max '
+echo "$STATS" | grep -q '  java  Ljava/lang/String;  (16 chars)$'
+## the statistics and the times keep the parallel, deduplicated batches
+## (each symbol is repeated in the batch of lines holding it)
+MANY=$(seq 1 5000 | sed 's|.*|Lpkg/Klass&;|p')
+PLAIN=$(echo "$MANY" | "$CLI" 'java')
+OUTPUT=$(echo "$MANY" | "$CLI" --stats 'java' 2> /dev/null)
+[ "$OUTPUT" = "$PLAIN" ]
+STATS=$(echo "$MANY" | "$CLI" --stats 'java' 2>&1 > /dev/null)
+echo "$STATS" | grep -qxF 'symbols: 10000 (10000 demangled, 0 failed, 5000 deduplicated)'
+## unless each symbol is demangled on its own to count its allocations
+TIMES=$(echo "$MANY" | "$CLI" --json-ns 'java')
+[ $(echo "$TIMES" | grep -c '"ns":[0-9]*') -ge 5000 ]
+[ $(($(echo "$TIMES" | grep -c '"ns":[0-9]*') + $(echo "$TIMES" | grep -c '"deduplicated":true'))) = 10000 ]
+
+## the sorted unique names, the failures are kept as they are
+OUTPUT=$(printf "$INPUT$INPUT" | "$CLI" -u 'java')
+[ "$OUTPUT" = "$(printf "$EXPECTED" | LC_ALL=C sort -u)" ]
+
+## the columnar output holds the results (or the failed inputs) as NUL terminated strings
+COLUMNS_FILE=$(mktemp -u /tmp/demangle-cli.XXXXXX)
+printf "$INPUT" | "$CLI" --columns "$COLUMNS_FILE" --columns-hash 'java'
+[ "$(head -c 8 "$COLUMNS_FILE")" = "RZDMCOLS" ]
+[ "$(tr '\000' '\n' < "$COLUMNS_FILE" | grep -c -xF -e 'java.lang.String' -e 'not a symbol')" = 2 ]
+rm -f "$COLUMNS_FILE"
+
+## the names found in any text are demangled in place
+TEXT='at ?func@@YAXH@Z+0x10 (_RNvC6_123foo3bar)\nnot_RNvC6_123foo3bar ?bad @Bar@foo9$wxqv.\n'
+TEXT_EXPECTED=$(printf 'at void __cdecl func(int)+0x10 (123foo::bar)\nnot_RNvC6_123foo3bar ?bad Bar::foo9(void) volatile const.\n')
+OUTPUT=$(printf "$TEXT" | "$CLI" -t)
+[ "$OUTPUT" = "$TEXT_EXPECTED" ]
+
+## the candidate mangled names of a declaration, one per line
+"$CLI" -m 'msvc' 'public: void __thiscall Widget::resize(int, int)' | grep -qxF '?resize@Widget@@QAEXHH@Z'
+if "$CLI" -m 'msvc' 'f(int)' 2> /dev/null; then
+    exit 1
+fi
+if [ ! -z "$HAS_GPL" ]; then
+    [ "$("$CLI" -m 'c++' 'Foo::~Foo()')" = "$(printf '_ZN3FooD1Ev\n_ZN3FooD2Ev\n_ZN3FooD0Ev')" ]
+fi
+
+## the symbols which failed once are recorded in the filter file
+if [ ! -z "$HAS_FILTER" ]; then
+    FILTER_FILE=$(mktemp -u /tmp/demangle-cli.XXXXXX)
+    OUTPUT=$(printf "$INPUT" | "$CLI" --filter "$FILTER_FILE" --filter-fp 0.01 'java')
+    [ "$OUTPUT" = "$EXPECTED" ]
+    [ -s "$FILTER_FILE" ]
+    OUTPUT=$(printf "$INPUT" | "$CLI" --filter "$FILTER_FILE" 'java')
+    [ "$OUTPUT" = "$EXPECTED" ]
+    "$CLI" --filter "$FILTER_FILE" 'java' 'Ljava/lang/String;' | grep -qxF 'java.lang.String'
+    rm -f "$FILTER_FILE"
+fi
+
+## the captured symbols are replayed as a benchmark
+if [ ! -z "$HAS_CORPUS" ]; then
+    CORPUS_FILE=$(mktemp -u /tmp/demangle-cli.XXXXXX)
+    OUTPUT=$(printf "$INPUT" | "$CLI" --capture "$CORPUS_FILE" 'java')
+    [ "$OUTPUT" = "$EXPECTED" ]
+    echo '_ZN3foo3barE' | RZ_DEMANGLE_CAPTURE="$CORPUS_FILE" "$CLI" -s 'rust' > /dev/null
+    "$CLI" --capture "$CORPUS_FILE" 'msvc' '?x@@3HA' > /dev/null
+    OUTPUT=$("$CLI" --replay "$CORPUS_FILE")
+    echo "$OUTPUT" | grep -q "^symbols: $(($(printf "$INPUT" | wc -l) + 2)) "
+    echo "$OUTPUT" | grep -q '^java  *[0-9]* *[0-9]* *[0-9]* *[0-9]* *[0-9]*$'
+    echo "$OUTPUT" | grep -q '^msvc '
+    "$CLI" -j 2 --replay "$CORPUS_FILE" | grep -q '^threads: 2,'
+    rm -f "$CORPUS_FILE"
+fi
+
+if [ ! -z "$HAS_THREADS" ]; then
+    OUTPUT=$(printf "$TEXT$TEXT" | "$CLI" -j 2 -t)
+    [ "$OUTPUT" = "$(printf '%s\n%s' "$TEXT_EXPECTED" "$TEXT_EXPECTED")" ]
+    OUTPUT=$(printf "$INPUT" | "$CLI" -j 2 'java')
+    [ "$OUTPUT" = "$EXPECTED" ]
+    ## a regular file is mapped in memory
+    INPUT_FILE=$(mktemp)
+    printf "$INPUT" > "$INPUT_FILE"
+    OUTPUT=$("$CLI" -j 3 'java' < "$INPUT_FILE")
+    rm -f "$INPUT_FILE"
+    [ "$OUTPUT" = "$EXPECTED" ]
+fi
+
+if [ ! -z "$HAS_SERVER" ]; then
+    SOCKET=$(mktemp -u /tmp/demangle-cli.XXXXXX)
+    "$CLI" --listen "$SOCKET" &
+    SERVER_PID=$!
+    for i in $(seq 50); do
+        [ -S "$SOCKET" ] && break
+        sleep 0.1
+    done
+    OUTPUT=$(printf "$INPUT" | "$CLI" --connect "$SOCKET" 'java')
+    OUTPUT_SECOND=$(printf "$INPUT" | "$CLI" --connect "$SOCKET" 'java')
+    kill "$SERVER_PID"
+    wait "$SERVER_PID"
+    [ "$OUTPUT" = "$EXPECTED" ]
+    [ "$OUTPUT_SECOND" = "$EXPECTED" ]
+    [ ! -e "$SOCKET" ]
+fi
+
+if [ ! -z "$HAS_FILES" ]; then
+    "$CLI" -f "$FILES/pe/lib.dll" | grep -qxF 'void __cdecl foo(int)'
+    "$CLI" -f "$FILES/pe/lib.dll" | grep -qxF '__declspec(dllimport) void __cdecl qux(void)'
+    "$CLI" -f "$FILES/pe/lib.dll" | grep -qxF 'Borland::func(void)'
+    "$CLI" -f "$FILES/pe/lib.obj" | grep -qxF 'int ns::counter'
+    if "$CLI" -f "$FILES/pe/lib.obj" | grep -q 'plain_c_function'; then
+        exit 1
+    fi
+    if [ ! -z "$HAS_GPL" ]; then
+        "$CLI" -f "$FILES/pe/lib.dll" | grep -qxF 'mingw::test()'
+    fi
+
+    "$CLI" -f "$FILES/macho/thin.o" | grep -qxF 'class Foo'
+    if "$CLI" -f "$FILES/macho/thin.o" | grep -q 'plain_c'; then
+        exit 1
+    fi
+    ## the fat file holds two slices with the same symbols
+    [ $("$CLI" -f "$FILES/macho/fat.o" | grep -cxF 'class Foo') = 2 ]
+    if [ ! -z "$HAS_GPL" ]; then
+        "$CLI" -f "$FILES/macho/thin.o" | grep -qxF 'foo::bar()'
+    fi
+    if [ ! -z "$HAS_SWIFT" ]; then
+        "$CLI" -f "$FILES/macho/thin.o" | grep -qxF 'main.foo'
+        "$CLI" -f "$FILES/macho/thin.o" | grep -qxF 'main.Bar'
+    else
+        ## the runtime names of the swift classes stay raw without the swift demangler
+        "$CLI" -f "$FILES/macho/thin.o" | grep -qxF '_TtC4main3Bar'
+    fi
+
+    ## the symbol records straddle two blocks which are apart in the file
+    [ $("$CLI" -f "$FILES/pdb/lib.pdb" | grep -c '^void __cdecl space::func[0-9]*(int, int)$') = 130 ]
+    "$CLI" -f "$FILES/pdb/lib.pdb" | grep -qxF 'int ns::counter'
+    ## module procedure without a public symbol
+    "$CLI" -f "$FILES/pdb/lib.pdb" | grep -qxF 'int __cdecl ns::local_only(int)'
+
+    ## inlined functions are found only in the DWARF linkage names
+    "$CLI" -f "$FILES/elf/lib.so" | grep -q 'Point3sum\|Point::sum'
+    if [ ! -z "$HAS_GPL" ]; then
+        "$CLI" -f "$FILES/elf/lib.so" | grep -qxF 'dw::Point::sum() const'
+        "$CLI" -f "$FILES/elf/lib.so" | grep -qxF 'dw::Box<long>::get(long)'
+        ## dynamic and static symbol tables, then once for both DWARF units
+        [ $("$CLI" -f "$FILES/elf/lib.so" | grep -cxF 'dw::scale(int)') = 3 ]
+        "$CLI" -f "$FILES/elf/split.dwo" | grep -qxF 'dw::Box<long>::get(long)'
+    fi
+    ## every supported file of the tree, in path order
+    "$CLI" -r "$FILES" | grep -qxF "$FILES/pdb/lib.pdb:"
+    [ $("$CLI" -r "$FILES" | grep -c ':$') = 7 ]
+    [ "$("$CLI" -r "$FILES" | grep ':$' | sort -c 2>&1)" = "" ]
+    [ $("$CLI" -r "$FILES/macho" | grep -cxF 'class Foo') = 3 ]
+    if "$CLI" -r "$FILES/missing" > /dev/null 2>&1; then
+        exit 1
+    fi
+
+    ## only the names missing on the other side are listed, the changed ones paired
+    OLD_LIST=$(mktemp)
+    NEW_LIST=$(mktemp)
+    printf '?foo@@YAXH@Z\n?bar@@YAHXZ\n?same@@YAXXZ\n' > "$OLD_LIST"
+    printf '?same@@YAXXZ\n?baz@@YAXXZ\n?foo@@YAXN@Z\n' > "$NEW_LIST"
+    DIFF_EXPECTED='- int __cdecl bar(void)
++ void __cdecl baz(void)
+< void __cdecl foo(int)
+> void __cdecl foo(double)'
+    OUTPUT=$("$CLI" --diff "$OLD_LIST" "$NEW_LIST")
+    rm -f "$OLD_LIST" "$NEW_LIST"
+    [ "$OUTPUT" = "$DIFF_EXPECTED" ]
+    [ "$("$CLI" --diff "$FILES/elf/lib.so" "$FILES/elf/lib.so")" = "" ]
+    "$CLI" --diff "$FILES/pe/lib.dll" "$FILES/pdb/lib.pdb" | grep -qxF '+ int __cdecl ns::local_only(int)'
+fi
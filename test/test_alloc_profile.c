@@ -0,0 +1,46 @@
+// SPDX-FileCopyrightText: 2026 RizinOrg <info@rizin.re>
+// SPDX-License-Identifier: LGPL-3.0-only
+
+#include "minunit.h"
+
+#define ALLOC_SYMBOLS 100
+
+static bool test_alloc_sites(void) {
+	RzDemangleAllocSite sites[4];
+	libdemangle_alloc_reset();
+	mu_assert(__LINE__, "sites after reset", !libdemangle_alloc_sites(NULL, 0));
+
+	unsigned long long before = libdemangle_alloc_thread_bytes();
+	for (size_t i = 0; i < ALLOC_SYMBOLS; ++i) {
+		free(libdemangle_handler(RZ_DEMANGLE_LANG_JAVA, "Lsome/class/Object;.myMethod([F)I", RZ_DEMANGLE_OPT_BASE));
+	}
+	unsigned long long bytes = libdemangle_alloc_thread_bytes() - before;
+	mu_assert(__LINE__, "no bytes counted", bytes >= ALLOC_SYMBOLS * strlen("int some.class.Object.myMethod(float[])"));
+
+	size_t n_sites = libdemangle_alloc_sites(sites, 4);
+	unsigned long long total = 0;
+	mu_assert(__LINE__, "no sites", n_sites > 0);
+	for (size_t i = 0; i < n_sites && i < 4; ++i) {
+		mu_assert(__LINE__, "not a source file", strstr(sites[i].file, ".c") && sites[i].line > 0);
+		mu_assert(__LINE__, "not sorted", !i || sites[i - 1].bytes >= sites[i].bytes);
+		// each site is called once or a few times per symbol
+		mu_assert(__LINE__, "wrong count", sites[i].count >= ALLOC_SYMBOLS && sites[i].count % ALLOC_SYMBOLS == 0);
+		total += sites[i].bytes;
+	}
+	mu_assert(__LINE__, "more bytes in sites than allocated", total <= bytes);
+
+	FILE *out = tmpfile();
+	char line[256] = { 0 };
+	mu_assert(__LINE__, "cannot open the report", out);
+	libdemangle_alloc_report(out, 4, ALLOC_SYMBOLS);
+	rewind(out);
+	mu_assert(__LINE__, "report header", fgets(line, sizeof(line), out) && strstr(line, "bytes/sym"));
+	mu_assert(__LINE__, "report site", fgets(line, sizeof(line), out) && strstr(line, sites[0].file));
+	fclose(out);
+	mu_end(__LINE__, "alloc_profile", "sites");
+}
+
+int main(int argc, char **argv) {
+	mu_run_test_named(test_alloc_sites, "alloc_profile");
+	return tests_passed != tests_run;
+}
@@ -0,0 +1,380 @@
+// SPDX-FileCopyrightText: 2026 RizinOrg <info@rizin.re>
+// SPDX-License-Identifier: LGPL-3.0-only
+
+#include "minunit.h"
+#if WITH_THREADS
+#include <poll.h>
+#include <pthread.h>
+#endif
+
+#define BATCH_SYMBOLS 10000
+#define BATCH_THREADS 4
+
+static RzDemangleCtx *ctx = NULL;
+
+static const char *java_symbols[] = {
+	"Ljava/lang/String;",
+	"F",
+	"Lsome/class/Object;.myField.I",
+	"myField.I",
+	"Lsome/class/Object;.myMethod([F)I",
+	"makeConcatWithConstants(Ljava/lang/String;)Ljava/lang/String;",
+	"", // fails
+	"(", // fails
+};
+
+static char *libdemangle_handler_batch(const char *symbol, RzDemangleOpts opts) {
+	return libdemangle_ctx_demangle(ctx, RZ_DEMANGLE_LANG_JAVA, symbol, opts);
+}
+
+mu_demangle_tests(batch,
+	mu_demangle_test("Ljava/lang/String;", "java.lang.String"),
+	mu_demangle_test("F", "float"),
+	mu_demangle_test("Lsome/class/Object;.myField.I", "some.class.Object.myField:int"),
+	mu_demangle_test("myField.I", "myField:int"),
+	mu_demangle_test("Lsome/class/Object;.myMethod([F)I", "int some.class.Object.myMethod(float[])"),
+	mu_demangle_test("(", NULL),
+	// end
+);
+
+mu_demangle_with(batch, RZ_DEMANGLE_OPT_BASE);
+
+static int batch_check(RzDemangleBatch *batch) {
+	size_t n_symbols = sizeof(java_symbols) / sizeof(java_symbols[0]);
+	for (size_t i = 0; i < BATCH_SYMBOLS; ++i) {
+		batch->symbols[i] = java_symbols[i % n_symbols];
+	}
+	if (!libdemangle_batch(ctx, batch)) {
+		return 0;
+	}
+	int res = 1;
+	for (size_t i = 0; i < BATCH_SYMBOLS; ++i) {
+		char *expected = libdemangle_handler(batch->lang, batch->symbols[i], batch->opts);
+		if (!expected != !batch->results[i] || (expected && strcmp(expected, batch->results[i]))) {
+			printf("symbol %zu (%s) mismatch: '%s' vs '%s'\n", i, batch->symbols[i], batch->results[i], expected);
+			res = 0;
+		}
+		free(expected);
+		free(batch->results[i]);
+		batch->results[i] = NULL;
+	}
+	return res;
+}
+
+static void *batch_thread(void *user) {
+	RzDemangleBatch batch = { 0 };
+	batch.lang = RZ_DEMANGLE_LANG_JAVA;
+	batch.opts = user ? RZ_DEMANGLE_OPT_SIMPLIFY : RZ_DEMANGLE_OPT_BASE;
+	batch.symbols = calloc(BATCH_SYMBOLS, sizeof(char *));
+	batch.results = calloc(BATCH_SYMBOLS, sizeof(char *));
+	batch.n_symbols = BATCH_SYMBOLS;
+	int res = batch.symbols && batch.results && batch_check(&batch);
+	free(batch.symbols);
+	free(batch.results);
+	return res ? ctx : NULL;
+}
+
+static bool test_batch_results_are_in_order(void) {
+	// twice, the second run is served by the memo
+	mu_assert(__LINE__, "batch results mismatch", batch_thread(NULL));
+	mu_assert(__LINE__, "batch results mismatch", batch_thread(NULL));
+	mu_end(__LINE__, "batch", "in order");
+}
+
+#if WITH_THREADS
+static bool test_batch_concurrent_submitters(void) {
+	pthread_t threads[BATCH_THREADS];
+	for (size_t i = 0; i < BATCH_THREADS; ++i) {
+		mu_assert(__LINE__, "cannot create thread", !pthread_create(&threads[i], NULL, batch_thread, (void *)(i & 1)));
+	}
+	bool res = true;
+	for (size_t i = 0; i < BATCH_THREADS; ++i) {
+		void *ret = NULL;
+		pthread_join(threads[i], &ret);
+		res &= ret != NULL;
+	}
+	mu_assert(__LINE__, "concurrent batch results mismatch", res);
+	mu_end(__LINE__, "batch", "concurrent");
+}
+#endif
+
+static bool test_batch_unique(void) {
+	size_t n_java = sizeof(java_symbols) / sizeof(java_symbols[0]);
+	char **copies = calloc(BATCH_SYMBOLS, sizeof(char *));
+	RzDemangleBatch batch = { 0 };
+	batch.lang = RZ_DEMANGLE_LANG_JAVA;
+	batch.symbols = calloc(BATCH_SYMBOLS, sizeof(char *));
+	batch.results = calloc(BATCH_SYMBOLS, sizeof(char *));
+	batch.ns = malloc(BATCH_SYMBOLS * sizeof(unsigned long long));
+	batch.n_symbols = BATCH_SYMBOLS;
+	mu_assert(__LINE__, "cannot allocate", copies && batch.symbols && batch.results && batch.ns);
+	memset(batch.ns, 0xff, BATCH_SYMBOLS * sizeof(unsigned long long));
+	// equal symbols at different addresses, many distinct ones grow the set
+	for (size_t i = 0; i < BATCH_SYMBOLS; ++i) {
+		char field[32];
+		snprintf(field, sizeof(field), "field%zu.I", i % 500);
+		copies[i] = strdup(i & 1 ? java_symbols[i % n_java] : field);
+		batch.symbols[i] = copies[i];
+	}
+	mu_assert(__LINE__, "cannot demangle", libdemangle_batch_unique(ctx, &batch));
+	bool res = true;
+	for (size_t i = 0; i < BATCH_SYMBOLS; ++i) {
+		char *expected = libdemangle_handler(batch.lang, batch.symbols[i], batch.opts);
+		res &= !expected == !batch.results[i] && (!expected || !strcmp(expected, batch.results[i]));
+		// every occurrence owns its result
+		res &= !batch.results[i] || i < n_java * 2 || batch.results[i] != batch.results[i - n_java * 2];
+		free(expected);
+	}
+	// the first occurrence is timed, the repeated ones are not
+	mu_assert(__LINE__, "symbol times", batch.ns[0] > 0 && batch.ns[500] == ~0ull && batch.ns[1 + n_java * 2] == ~0ull);
+	for (size_t i = 0; i < BATCH_SYMBOLS; ++i) {
+		free(batch.results[i]);
+		free(copies[i]);
+	}
+	free(batch.symbols);
+	free(batch.results);
+	free(batch.ns);
+	free(copies);
+	mu_assert(__LINE__, "unique batch results mismatch", res);
+	mu_end(__LINE__, "batch", "unique");
+}
+
+typedef struct {
+	RzDemangleBatch batch;
+	int completed;
+} async_batch_t;
+
+static async_batch_t *async_batch_new(size_t n_symbols) {
+	async_batch_t *async = calloc(1, sizeof(async_batch_t));
+	size_t n_java = sizeof(java_symbols) / sizeof(java_symbols[0]);
+	async->batch.lang = RZ_DEMANGLE_LANG_JAVA;
+	async->batch.symbols = calloc(n_symbols, sizeof(char *));
+	async->batch.results = calloc(n_symbols, sizeof(char *));
+	async->batch.n_symbols = n_symbols;
+	for (size_t i = 0; i < n_symbols; ++i) {
+		async->batch.symbols[i] = java_symbols[i % n_java];
+	}
+	return async;
+}
+
+/* checks the computed results and frees the batch */
+static int async_batch_free(async_batch_t *async) {
+	int res = 1;
+	for (size_t i = 0; i < async->batch.n_symbols; ++i) {
+		char *result = async->batch.results[i];
+		char *expected = result ? libdemangle_handler(async->batch.lang, async->batch.symbols[i], async->batch.opts) : NULL;
+		res &= !result || (expected && !strcmp(result, expected));
+		free(expected);
+		free(result);
+	}
+	free(async->batch.symbols);
+	free(async->batch.results);
+	free(async);
+	return res;
+}
+
+static void async_callback(RzDemangleRequest *request, void *user) {
+	async_batch_t *async = user;
+	if (libdemangle_request_status(request) == RZ_DEMANGLE_REQUEST_DONE) {
+		__atomic_store_n(&async->completed, 1, __ATOMIC_RELEASE);
+	}
+	libdemangle_request_free(request);
+}
+
+static bool test_async_callback(void) {
+	async_batch_t *batches[8];
+	for (size_t i = 0; i < 8; ++i) {
+		batches[i] = async_batch_new(BATCH_SYMBOLS);
+		mu_assert(__LINE__, "cannot submit", libdemangle_submit(ctx, &batches[i]->batch, async_callback, batches[i]));
+	}
+	for (size_t i = 0; i < 8; ++i) {
+		while (!__atomic_load_n(&batches[i]->completed, __ATOMIC_ACQUIRE)) {
+			// runs the deferred callbacks of a context without workers
+			mu_assert(__LINE__, "no request without callback", !libdemangle_complete(ctx));
+		}
+		for (size_t k = 0; k < BATCH_SYMBOLS; ++k) {
+			const char *symbol = batches[i]->batch.symbols[k];
+			bool valid = symbol[0] && symbol[0] != '(';
+			mu_assert(__LINE__, "missing result", !batches[i]->batch.results[k] == !valid);
+		}
+		mu_assert(__LINE__, "async results mismatch", async_batch_free(batches[i]));
+	}
+	mu_end(__LINE__, "submit", "callback");
+}
+
+static bool test_async_inline_callback(void) {
+	async_batch_t *async = async_batch_new(BATCH_SYMBOLS);
+	RzDemangleRequest *request = libdemangle_submit(ctx, &async->batch, async_callback, async);
+	// completed within submit, but the callback freeing it is not run yet
+	mu_assert(__LINE__, "cannot submit", request);
+	mu_assert(__LINE__, "callback run within submit", !async->completed);
+	mu_assert(__LINE__, "wrong status", libdemangle_request_status(request) == RZ_DEMANGLE_REQUEST_DONE);
+	mu_assert(__LINE__, "wrong user data", libdemangle_request_user(request) == async);
+	mu_assert(__LINE__, "no request without callback", !libdemangle_complete(ctx));
+	mu_assert(__LINE__, "callback not run", async->completed);
+	mu_assert(__LINE__, "async results mismatch", async_batch_free(async));
+	mu_end(__LINE__, "submit", "inline");
+}
+
+static bool test_async_completion_queue(void) {
+	async_batch_t *batches[3];
+	RzDemangleRequest *requests[3];
+	libdemangle_ctx_set_max_pending(ctx, 2);
+	for (size_t i = 0; i < 3; ++i) {
+		batches[i] = async_batch_new(BATCH_SYMBOLS);
+	}
+	// the results of a rejected request are left untouched
+	static char marker[] = "untouched";
+	batches[2]->batch.results[0] = marker;
+	for (size_t i = 0; i < 3; ++i) {
+		requests[i] = libdemangle_submit(ctx, &batches[i]->batch, NULL, batches[i]);
+	}
+	// back-pressure: completed but not yet polled requests are still pending
+	mu_assert(__LINE__, "cannot submit", requests[0] && requests[1]);
+	mu_assert(__LINE__, "the pending limit was not honored", !requests[2]);
+	mu_assert(__LINE__, "rejected request touched the results", batches[2]->batch.results[0] == marker);
+	batches[2]->batch.results[0] = NULL;
+
+	int fd = libdemangle_completion_fd(ctx);
+	for (size_t n_completed = 0; n_completed < 2;) {
+#if WITH_THREADS
+		struct pollfd pfd = { fd, POLLIN, 0 };
+		mu_assert(__LINE__, "completion fd is not pollable", fd >= 0 && poll(&pfd, 1, 10000) == 1);
+#endif
+		RzDemangleRequest *request;
+		while ((request = libdemangle_complete(ctx))) {
+			// the requests complete in any order
+			size_t i = request == requests[0] ? 0 : 1;
+			mu_assert(__LINE__, "unknown request", request == requests[i]);
+			mu_assert(__LINE__, "wrong user data", libdemangle_request_user(request) == batches[i]);
+			mu_assert(__LINE__, "wrong status", libdemangle_request_status(request) == RZ_DEMANGLE_REQUEST_DONE);
+			mu_assert(__LINE__, "cannot cancel a completed request", !libdemangle_cancel(request));
+			libdemangle_request_free(request);
+			n_completed++;
+		}
+	}
+	mu_assert(__LINE__, "cannot submit after polling", (requests[2] = libdemangle_submit(ctx, &batches[2]->batch, NULL, NULL)));
+	while (!libdemangle_complete(ctx)) {
+	}
+	libdemangle_request_free(requests[2]);
+	libdemangle_ctx_set_max_pending(ctx, 1024);
+	for (size_t i = 0; i < 3; ++i) {
+		mu_assert(__LINE__, "async results mismatch", async_batch_free(batches[i]));
+	}
+	mu_end(__LINE__, "submit", "queue");
+}
+
+static bool test_async_cancel(void) {
+	async_batch_t *batches[16];
+	RzDemangleRequest *requests[16];
+	for (size_t i = 0; i < 16; ++i) {
+		batches[i] = async_batch_new(BATCH_SYMBOLS);
+		requests[i] = libdemangle_submit(ctx, &batches[i]->batch, NULL, NULL);
+		mu_assert(__LINE__, "cannot submit", requests[i]);
+	}
+	size_t n_cancelled = 0;
+	for (size_t i = 16; i-- > 0;) {
+		n_cancelled += libdemangle_cancel(requests[i]);
+	}
+	for (size_t n_completed = 0; n_completed < 16;) {
+		RzDemangleRequest *request = libdemangle_complete(ctx);
+		if (!request) {
+			continue;
+		}
+		RzDemangleRequestStatus status = libdemangle_request_status(request);
+		mu_assert(__LINE__, "request not completed", status != RZ_DEMANGLE_REQUEST_PENDING);
+		n_cancelled -= status == RZ_DEMANGLE_REQUEST_CANCELLED;
+		libdemangle_request_free(request);
+		n_completed++;
+	}
+	mu_assert(__LINE__, "cancelled requests count mismatch", !n_cancelled);
+	// partial results must still be correct
+	for (size_t i = 0; i < 16; ++i) {
+		mu_assert(__LINE__, "async results mismatch", async_batch_free(batches[i]));
+	}
+	mu_end(__LINE__, "submit", "cancel");
+}
+
+static bool test_async_ctx_free_detaches(size_t n_threads) {
+	RzDemangleCtx *owner = libdemangle_ctx_new(n_threads);
+	async_batch_t *batches[4];
+	RzDemangleRequest *requests[4];
+	for (size_t i = 0; i < 4; ++i) {
+		batches[i] = async_batch_new(BATCH_SYMBOLS);
+		requests[i] = libdemangle_submit(owner, &batches[i]->batch, NULL, NULL);
+		mu_assert(__LINE__, "cannot submit", requests[i]);
+	}
+	// unpolled requests are still owned, and freed, by the caller
+	RzDemangleRequest *polled;
+	while (!(polled = libdemangle_complete(owner))) {
+	}
+	libdemangle_request_free(polled);
+	// a completed request is dropped from the completion queue when freed
+	RzDemangleRequest *last = requests[3] != polled ? requests[3] : requests[2];
+	while (libdemangle_request_status(last) == RZ_DEMANGLE_REQUEST_PENDING) {
+	}
+	libdemangle_request_free(last);
+	libdemangle_ctx_free(owner);
+	for (size_t i = 0; i < 4; ++i) {
+		if (requests[i] == polled || requests[i] == last) {
+			continue;
+		}
+		mu_assert(__LINE__, "request not completed", libdemangle_request_status(requests[i]) != RZ_DEMANGLE_REQUEST_PENDING);
+		mu_assert(__LINE__, "cannot cancel a detached request", !libdemangle_cancel(requests[i]));
+		libdemangle_request_free(requests[i]);
+	}
+	for (size_t i = 0; i < 4; ++i) {
+		mu_assert(__LINE__, "async results mismatch", async_batch_free(batches[i]));
+	}
+	mu_end(__LINE__, "ctx_free", "detach");
+}
+
+int main(int argc, char **argv) {
+	// without memo, with the worker pool
+	ctx = libdemangle_ctx_new(BATCH_THREADS);
+	mu_demangle_loop(batch, batch);
+	mu_run_test_named(test_batch_results_are_in_order, "batch");
+	mu_run_test_named(test_batch_unique, "batch");
+	libdemangle_ctx_free(ctx);
+
+	// with memo, single threaded
+	ctx = libdemangle_ctx_new(1);
+	libdemangle_ctx_set_memo(ctx, 4);
+	mu_demangle_loop(batch, batch);
+	mu_demangle_loop(batch, batch);
+	mu_run_test_named(test_batch_results_are_in_order, "batch");
+	mu_run_test_named(test_batch_unique, "batch");
+	// without workers the requests complete within submit
+	mu_run_test_named(test_async_callback, "async");
+	mu_run_test_named(test_async_inline_callback, "async");
+	mu_run_test_named(test_async_completion_queue, "async");
+	libdemangle_ctx_free(ctx);
+
+	// with memo and worker pool
+	ctx = libdemangle_ctx_new(BATCH_THREADS);
+	libdemangle_ctx_set_memo(ctx, 1024);
+	mu_run_test_named(test_batch_results_are_in_order, "batch");
+#if WITH_THREADS
+	mu_run_test_named(test_batch_concurrent_submitters, "batch");
+#endif
+	mu_run_test_named(test_async_callback, "async");
+	mu_run_test_named(test_async_completion_queue, "async");
+	mu_run_test_named(test_async_cancel, "async");
+	libdemangle_ctx_free(ctx);
+
+	mu_run_test_named(test_async_ctx_free_detaches, "async", 1);
+	mu_run_test_named(test_async_ctx_free_detaches, "async", BATCH_THREADS);
+
+	// requests still queued are cancelled on free
+	ctx = libdemangle_ctx_new(2);
+	async_batch_t *pending[32];
+	for (size_t i = 0; i < 32; ++i) {
+		pending[i] = async_batch_new(BATCH_SYMBOLS);
+		libdemangle_submit(ctx, &pending[i]->batch, async_callback, pending[i]);
+	}
+	libdemangle_ctx_free(ctx);
+	for (size_t i = 0; i < 32; ++i) {
+		async_batch_free(pending[i]);
+	}
+	return tests_passed != tests_run;
+}
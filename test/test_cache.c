@@ -0,0 +1,196 @@
+// SPDX-FileCopyrightText: 2026 RizinOrg <info@rizin.re>
+// SPDX-License-Identifier: LGPL-3.0-only
+
+#include "minunit.h"
+#include <fcntl.h>
+#include <unistd.h>
+
+#define CACHE_HEADER_SIZE 72 ///< the bucket table follows, 16 bytes per bucket
+#define CACHE_HEAP_OFFSET (CACHE_HEADER_SIZE + (1 << 14) * 16) ///< of a new cache
+
+static RzDemangleCache *cache = NULL;
+static int cache_only = 0;
+
+static char *libdemangle_handler_cache(const char *symbol, RzDemangleOpts opts) {
+	if (cache_only) {
+		return libdemangle_cache_get(cache, RZ_DEMANGLE_LANG_JAVA, symbol, opts);
+	}
+	return libdemangle_cache_demangle(cache, RZ_DEMANGLE_LANG_JAVA, symbol, opts);
+}
+
+mu_demangle_tests(cache,
+	mu_demangle_test("Ljava/lang/String;", "java.lang.String"),
+	mu_demangle_test("F", "float"),
+	mu_demangle_test("Lsome/class/Object;.myField.I", "some.class.Object.myField:int"),
+	mu_demangle_test("myField.I", "myField:int"),
+	mu_demangle_test("Lsome/class/Object;.myMethod([F)I", "int some.class.Object.myMethod(float[])"),
+	// end
+);
+
+mu_demangle_with(cache, RZ_DEMANGLE_OPT_BASE);
+
+static bool test_cache_hit_is_not_recomputed(const char *path) {
+	RzDemangleCache *rw = libdemangle_cache_open(path, RZ_DEMANGLE_CACHE_READ_WRITE);
+	mu_assert(__LINE__, "cannot open cache", rw);
+	mu_assert(__LINE__, "cannot store entry", libdemangle_cache_set(rw, RZ_DEMANGLE_LANG_CXX, "_Z3foov", RZ_DEMANGLE_OPT_SIMPLIFY, "cached foo()"));
+	libdemangle_cache_close(rw);
+
+	RzDemangleCache *ro = libdemangle_cache_open(path, RZ_DEMANGLE_CACHE_READ_ONLY);
+	mu_assert(__LINE__, "cannot open read-only cache", ro);
+	char *result = libdemangle_cache_demangle(ro, RZ_DEMANGLE_LANG_CXX, "_Z3foov", RZ_DEMANGLE_OPT_SIMPLIFY);
+	mu_assert_streq_free("_Z3foov", result, "cached foo()", __LINE__);
+	// the key includes language and options
+	mu_assert_null(libdemangle_cache_get(ro, RZ_DEMANGLE_LANG_CXX, "_Z3foov", RZ_DEMANGLE_OPT_BASE), "_Z3foov", __LINE__);
+	mu_assert_null(libdemangle_cache_get(ro, RZ_DEMANGLE_LANG_RUST, "_Z3foov", RZ_DEMANGLE_OPT_SIMPLIFY), "_Z3foov", __LINE__);
+	mu_assert(__LINE__, "read-only cache must not be writable", !libdemangle_cache_set(ro, RZ_DEMANGLE_LANG_CXX, "_Z3barv", 0, "bar()"));
+	libdemangle_cache_close(ro);
+	mu_end(__LINE__, "_Z3foov", "cached foo()");
+}
+
+static bool test_cache_grows_and_readers_follow(const char *path) {
+	char symbol[64], output[64];
+	RzDemangleCache *ro = libdemangle_cache_open(path, RZ_DEMANGLE_CACHE_READ_ONLY);
+	RzDemangleCache *rw = libdemangle_cache_open(path, RZ_DEMANGLE_CACHE_READ_WRITE);
+	mu_assert(__LINE__, "cannot open cache", ro && rw);
+
+	// more entries than the default table can hold, forces compactions.
+	for (int i = 0; i < 40000; ++i) {
+		snprintf(symbol, sizeof(symbol), "sym_%d", i);
+		snprintf(output, sizeof(output), "out_%d", i);
+		mu_assert(__LINE__, "cannot store entry", libdemangle_cache_set(rw, RZ_DEMANGLE_LANG_PASCAL, symbol, 0, output));
+	}
+	mu_assert(__LINE__, "cannot compact", libdemangle_cache_compact(rw));
+
+	// the reader opened before the compactions must see the new file
+	for (int i = 0; i < 40000; i += 997) {
+		snprintf(symbol, sizeof(symbol), "sym_%d", i);
+		snprintf(output, sizeof(output), "out_%d", i);
+		char *result = libdemangle_cache_get(ro, RZ_DEMANGLE_LANG_PASCAL, symbol, 0);
+		mu_assert_streq_free(symbol, result, output, __LINE__);
+	}
+	char *result = libdemangle_cache_get(ro, RZ_DEMANGLE_LANG_CXX, "_Z3foov", RZ_DEMANGLE_OPT_SIMPLIFY);
+	mu_assert_streq_free("_Z3foov", result, "cached foo()", __LINE__);
+	libdemangle_cache_close(rw);
+	libdemangle_cache_close(ro);
+	mu_end(__LINE__, "sym_*", "out_*");
+}
+
+static bool cache_patch(const char *path, off_t offset, uint64_t value) {
+	int fd = open(path, O_WRONLY);
+	bool res = fd >= 0 && pwrite(fd, &value, sizeof(value), offset) == sizeof(value);
+	if (fd >= 0) {
+		close(fd);
+	}
+	return res;
+}
+
+static bool test_cache_rejects_corrupt_files(const char *path) {
+	// heap_offset (out of the file or misaligned), heap_capacity, heap_size and n_entries within the header
+	const off_t fields[] = { 16, 16, 24, 32, 40 };
+	const uint64_t values[] = { UINT64_MAX - 8, CACHE_HEAP_OFFSET + 4, UINT64_MAX - 8, UINT64_MAX / 2, 0x7fffffff };
+	char copy[256];
+	snprintf(copy, sizeof(copy), "%s.copy", path);
+	for (size_t i = 0; i < sizeof(fields) / sizeof(fields[0]); ++i) {
+		unlink(copy);
+		RzDemangleCache *rw = libdemangle_cache_open(copy, RZ_DEMANGLE_CACHE_READ_WRITE);
+		mu_assert(__LINE__, "cannot create cache", rw && libdemangle_cache_set(rw, RZ_DEMANGLE_LANG_CXX, "_Z3foov", 0, "foo()"));
+		libdemangle_cache_close(rw);
+		mu_assert(__LINE__, "cannot corrupt", cache_patch(copy, fields[i], values[i]));
+		mu_assert(__LINE__, "corrupt header accepted", !libdemangle_cache_open(copy, RZ_DEMANGLE_CACHE_READ_ONLY));
+		// nor replaced by a new cache
+		mu_assert(__LINE__, "corrupt header accepted", !libdemangle_cache_open(copy, RZ_DEMANGLE_CACHE_READ_WRITE));
+	}
+
+	// a truncated file
+	unlink(copy);
+	RzDemangleCache *rw = libdemangle_cache_open(copy, RZ_DEMANGLE_CACHE_READ_WRITE);
+	mu_assert(__LINE__, "cannot create cache", rw);
+	libdemangle_cache_close(rw);
+	mu_assert(__LINE__, "cannot truncate", !truncate(copy, 4096));
+	mu_assert(__LINE__, "truncated file accepted", !libdemangle_cache_open(copy, RZ_DEMANGLE_CACHE_READ_ONLY));
+
+	// a record offset past the heap is never read
+	unlink(copy);
+	rw = libdemangle_cache_open(copy, RZ_DEMANGLE_CACHE_READ_WRITE);
+	mu_assert(__LINE__, "cannot create cache", rw && libdemangle_cache_set(rw, RZ_DEMANGLE_LANG_CXX, "_Z3foov", 0, "foo()"));
+	libdemangle_cache_close(rw);
+	int fd = open(copy, O_RDONLY);
+	uint64_t header[5] = { 0 };
+	mu_assert(__LINE__, "cannot read", fd >= 0 && pread(fd, header, sizeof(header), 0) == sizeof(header));
+	close(fd);
+	uint32_t n_buckets = (uint32_t)(header[1] >> 32);
+	for (uint32_t b = 0; b < n_buckets; ++b) {
+		uint64_t hash = 0;
+		fd = open(copy, O_RDONLY);
+		pread(fd, &hash, sizeof(hash), CACHE_HEADER_SIZE + (off_t)b * 16);
+		close(fd);
+		if (hash) {
+			mu_assert(__LINE__, "cannot corrupt", cache_patch(copy, CACHE_HEADER_SIZE + (off_t)b * 16 + 8, UINT64_MAX - 4));
+		}
+	}
+	RzDemangleCache *ro = libdemangle_cache_open(copy, RZ_DEMANGLE_CACHE_READ_ONLY);
+	mu_assert(__LINE__, "cannot open cache", ro);
+	mu_assert_null(libdemangle_cache_get(ro, RZ_DEMANGLE_LANG_CXX, "_Z3foov", 0), "_Z3foov", __LINE__);
+	libdemangle_cache_close(ro);
+	unlink(copy);
+	mu_end(__LINE__, "cache", "corrupt");
+}
+
+static bool test_cache_resets_stale_files(const char *path) {
+	// lib_version and lib_features of another version or build of the library
+	const off_t fields[] = { 48, 64 };
+	char copy[256];
+	snprintf(copy, sizeof(copy), "%s.stale", path);
+	for (size_t i = 0; i < sizeof(fields) / sizeof(fields[0]); ++i) {
+		unlink(copy);
+		RzDemangleCache *rw = libdemangle_cache_open(copy, RZ_DEMANGLE_CACHE_READ_WRITE);
+		mu_assert(__LINE__, "cannot create cache", rw && libdemangle_cache_set(rw, RZ_DEMANGLE_LANG_CXX, "_Z3foov", 0, "foo()"));
+		libdemangle_cache_close(rw);
+		mu_assert(__LINE__, "cannot patch", cache_patch(copy, fields[i], 0x7fffffff));
+		mu_assert(__LINE__, "stale cache accepted", !libdemangle_cache_open(copy, RZ_DEMANGLE_CACHE_READ_ONLY));
+		// a writer starts over with an empty cache
+		rw = libdemangle_cache_open(copy, RZ_DEMANGLE_CACHE_READ_WRITE);
+		mu_assert(__LINE__, "stale cache not reset", rw);
+		mu_assert_null(libdemangle_cache_get(rw, RZ_DEMANGLE_LANG_CXX, "_Z3foov", 0), "_Z3foov", __LINE__);
+		libdemangle_cache_close(rw);
+		RzDemangleCache *ro = libdemangle_cache_open(copy, RZ_DEMANGLE_CACHE_READ_ONLY);
+		mu_assert(__LINE__, "reset cache rejected", ro);
+		libdemangle_cache_close(ro);
+	}
+	unlink(copy);
+	mu_end(__LINE__, "cache", "stale");
+}
+
+int main(int argc, char **argv) {
+	char dir[] = "/tmp/test_cache.XXXXXX";
+	if (!mkdtemp(dir)) {
+		return 1;
+	}
+	char path[sizeof(dir) + 16];
+	snprintf(path, sizeof(path), "%s/cache", dir);
+
+	// cold run, fills the cache
+	cache = libdemangle_cache_open(path, RZ_DEMANGLE_CACHE_READ_WRITE);
+	mu_demangle_loop(cache, cache);
+	libdemangle_cache_close(cache);
+
+	// warm run, every entry must come from the file
+	cache_only = 1;
+	cache = libdemangle_cache_open(path, RZ_DEMANGLE_CACHE_READ_ONLY);
+	mu_demangle_loop(cache, cache);
+	libdemangle_cache_close(cache);
+
+	mu_run_test_named(test_cache_hit_is_not_recomputed, "cache", path);
+	mu_run_test_named(test_cache_grows_and_readers_follow, "cache", path);
+	mu_run_test_named(test_cache_rejects_corrupt_files, "cache", path);
+	mu_run_test_named(test_cache_resets_stale_files, "cache", path);
+
+	// the compacted cache keeps every entry
+	cache = libdemangle_cache_open(path, RZ_DEMANGLE_CACHE_READ_ONLY);
+	mu_demangle_loop(cache, cache);
+	libdemangle_cache_close(cache);
+
+	unlink(path);
+	rmdir(dir);
+	return tests_passed != tests_run;
+}
@@ -0,0 +1,105 @@
+// SPDX-FileCopyrightText: 2026 RizinOrg <info@rizin.re>
+// SPDX-License-Identifier: LGPL-3.0-only
+
+#include "minunit.h"
+#include <unistd.h>
+
+#define CORPUS_SYMBOLS 3000
+#define CORPUS_THREADS 4
+
+static bool test_corpus_capture_and_replay(const char *path) {
+	RzDemangleCapture *capture = libdemangle_capture_open(path);
+	mu_assert(__LINE__, "cannot open capture", capture);
+	mu_assert(__LINE__, "unknown lang", !libdemangle_capture_add(capture, RZ_DEMANGLE_LANG_MAX, "x", RZ_DEMANGLE_OPT_BASE));
+	mu_assert(__LINE__, "cannot capture", libdemangle_capture_add(capture, RZ_DEMANGLE_LANG_CXX, "_Z3foov", RZ_DEMANGLE_OPT_SIMPLIFY));
+	mu_assert(__LINE__, "cannot capture", libdemangle_capture_add(capture, RZ_DEMANGLE_LANG_RUST, "", RZ_DEMANGLE_OPT_ENABLE_ALL));
+	// bigger than the buffer of the capture
+	size_t long_length = 200000;
+	char *long_symbol = malloc(long_length + 1);
+	mu_assert(__LINE__, "cannot allocate", long_symbol);
+	memset(long_symbol, 'L', long_length);
+	long_symbol[long_length] = 0;
+	mu_assert(__LINE__, "cannot capture", libdemangle_capture_add(capture, RZ_DEMANGLE_LANG_JAVA, long_symbol, RZ_DEMANGLE_OPT_BASE));
+	mu_assert(__LINE__, "cannot close capture", libdemangle_capture_close(capture));
+
+	// appends to the existing file, via the batches of a context
+	RzDemangleCtx *ctx = libdemangle_ctx_new(CORPUS_THREADS);
+	capture = libdemangle_capture_open(path);
+	mu_assert(__LINE__, "cannot open", ctx && capture);
+	libdemangle_ctx_set_capture(ctx, capture);
+	char **symbols = calloc(CORPUS_SYMBOLS, sizeof(char *));
+	char **results = calloc(CORPUS_SYMBOLS, sizeof(char *));
+	mu_assert(__LINE__, "cannot allocate", symbols && results);
+	for (size_t i = 0; i < CORPUS_SYMBOLS; ++i) {
+		char symbol[64];
+		snprintf(symbol, sizeof(symbol), "Lcorpus/Klass%zu;", i);
+		symbols[i] = strdup(symbol);
+	}
+	RzDemangleBatch batch = { RZ_DEMANGLE_LANG_JAVA, RZ_DEMANGLE_OPT_BASE, (const char **)symbols, results, CORPUS_SYMBOLS };
+	mu_assert(__LINE__, "cannot demangle", libdemangle_batch(ctx, &batch));
+	libdemangle_ctx_free(ctx);
+	mu_assert(__LINE__, "cannot close capture", libdemangle_capture_close(capture));
+
+	RzDemangleCorpus *corpus = libdemangle_corpus_open(path);
+	mu_assert(__LINE__, "cannot open corpus", corpus);
+	size_t n_entries = 0;
+	const RzDemangleCorpusEntry *entries = libdemangle_corpus_entries(corpus, &n_entries);
+	mu_assert(__LINE__, "number of entries", entries && n_entries == 3 + CORPUS_SYMBOLS);
+	mu_assert(__LINE__, "first entry", entries[0].lang == RZ_DEMANGLE_LANG_CXX && entries[0].opts == RZ_DEMANGLE_OPT_SIMPLIFY && entries[0].length == 7 && !strcmp(entries[0].symbol, "_Z3foov"));
+	mu_assert(__LINE__, "empty entry", entries[1].lang == RZ_DEMANGLE_LANG_RUST && entries[1].opts == RZ_DEMANGLE_OPT_ENABLE_ALL && !entries[1].length && !*entries[1].symbol);
+	mu_assert(__LINE__, "long entry", entries[2].length == long_length && !strcmp(entries[2].symbol, long_symbol));
+	// the workers capture in any order, each symbol once
+	char *seen = calloc(CORPUS_SYMBOLS, 1);
+	mu_assert(__LINE__, "cannot allocate", seen);
+	for (size_t i = 3; i < n_entries; ++i) {
+		size_t k = 0;
+		mu_assert(__LINE__, "batch entry", entries[i].lang == RZ_DEMANGLE_LANG_JAVA && sscanf(entries[i].symbol, "Lcorpus/Klass%zu;", &k) == 1 && k < CORPUS_SYMBOLS && !seen[k]);
+		mu_assert(__LINE__, "entry length", entries[i].length == strlen(symbols[k]));
+		seen[k] = 1;
+	}
+	libdemangle_corpus_close(corpus);
+
+	// a record truncated by a crashed capture is ignored
+	FILE *fp = fopen(path, "ab");
+	mu_assert(__LINE__, "cannot append", fp && fwrite("\x03\x00\x10Ljava", 1, 8, fp) == 8 && !fclose(fp));
+	corpus = libdemangle_corpus_open(path);
+	mu_assert(__LINE__, "cannot open truncated corpus", corpus);
+	libdemangle_corpus_entries(corpus, &n_entries);
+	mu_assert(__LINE__, "truncated entry", n_entries == 3 + CORPUS_SYMBOLS);
+	libdemangle_corpus_close(corpus);
+
+	for (size_t i = 0; i < CORPUS_SYMBOLS; ++i) {
+		free(symbols[i]);
+		free(results[i]);
+	}
+	free(symbols);
+	free(results);
+	free(seen);
+	free(long_symbol);
+	mu_end(__LINE__, "corpus", "capture");
+}
+
+static bool test_corpus_rejects_other_files(const char *path) {
+	FILE *fp = fopen(path, "wb");
+	mu_assert(__LINE__, "cannot create", fp && fwrite("RZDMCACH\x01\x00\x00\x00", 1, 12, fp) == 12 && !fclose(fp));
+	mu_assert(__LINE__, "capture of another file", !libdemangle_capture_open(path));
+	mu_assert(__LINE__, "corpus of another file", !libdemangle_corpus_open(path));
+	unlink(path);
+	mu_assert(__LINE__, "missing corpus", !libdemangle_corpus_open(path));
+	mu_end(__LINE__, "corpus", "rejected");
+}
+
+int main(int argc, char **argv) {
+	char dir[] = "/tmp/test_corpus.XXXXXX";
+	if (!mkdtemp(dir)) {
+		return 1;
+	}
+	char path[sizeof(dir) + 16];
+	snprintf(path, sizeof(path), "%s/corpus", dir);
+
+	mu_run_test_named(test_corpus_capture_and_replay, "corpus", path);
+	unlink(path);
+	mu_run_test_named(test_corpus_rejects_other_files, "corpus", path);
+	rmdir(dir);
+	return tests_passed != tests_run;
+}
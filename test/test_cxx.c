@@ -26947,6 +26947,9 @@ mu_demangle_tests(gpl,
 	mu_demangle_test("_Z3ft7IiEN11__enable_ifIXsr16__is_scalar_typeIT_EE7__valueEvE6__typeEv", 		"__enable_if<__is_scalar_type<int>::__value, void>::__type ft7<int>()" ),
 	mu_demangle_test("_Z3ft7IPvEN11__enable_ifIXsr16__is_scalar_typeIT_EE7__valueEvE6__typeEv", 		"__enable_if<__is_scalar_type<void*>::__value, void>::__type ft7<void*>()" ),
 	mu_demangle_test("_ZN6PR57968__fill_aIiEENS_11__enable_ifIXntsrNS_11__is_scalarIT_EE7__valueEvE6__typeEv", 		"PR5796::__enable_if<!PR5796::__is_scalar<int>::__value, void>::__type PR5796::__fill_a<int>()" ),
+	// old unresolved-name grammar, parsed again reusing the template arguments
+	mu_demangle_test("_Z1fIiEv5int_cIXsr1A1xEE", "void f<int>(int_c<A::x>)"),
+	mu_demangle_test("_ZN2ns3fooIiNS_3barIcEEEEvNS_5int_cIXsr1A1xEEE", "void ns::foo<int, ns::bar<char> >(ns::int_c<A::x>)"),
 	mu_demangle_test("_ZN3OpsplERKS_", "Ops::operator+(Ops const&)"),
 	mu_demangle_test("_ZN5test01fIdEEvT_RAszcl3ovlcvS1__EE_c", "void test0::f<double>(double, char (&) [sizeof (ovl((double)()))])"),
 	mu_demangle_test("_ZN5test01fIiEEvT_RAszcl3ovlcvS1__EE_c", "void test0::f<int>(int, char (&) [sizeof (ovl((int)()))])"),
@@ -27125,5 +27128,10 @@ mu_demangle_tests(gpl,
 	mu_demangle_test("_ZNSbIiED1Ev", "std::basic_string<int>::~basic_string()"),
 	mu_demangle_test("_ZN1SB8ctor_tagC2Ev", "S[abi:ctor_tag]::S()"),
 	mu_demangle_test("_ZN1SB8ctor_tagD2Ev", "S[abi:ctor_tag]::~S()"),
+	// the leading underscores and the markers are never read past the end
+	mu_demangle_test("", NULL),
+	mu_demangle_test("_", NULL),
+	mu_demangle_test("__", NULL),
+	mu_demangle_test("_vt", NULL),
 );
 mu_main(gpl, cxx, RZ_DEMANGLE_OPT_ENABLE_ALL);
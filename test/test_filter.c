@@ -0,0 +1,154 @@
+// SPDX-FileCopyrightText: 2026 RizinOrg <info@rizin.re>
+// SPDX-License-Identifier: LGPL-3.0-only
+
+#include "minunit.h"
+#include <dirent.h>
+#include <unistd.h>
+
+#define FILTER_SYMBOLS 10000
+
+static RzDemangleFilter *filter = NULL;
+
+static char *libdemangle_handler_filter(const char *symbol, RzDemangleOpts opts) {
+	return libdemangle_filter_demangle(filter, RZ_DEMANGLE_LANG_RUST, symbol, opts);
+}
+
+mu_demangle_tests(filter,
+	mu_demangle_test("_ZN4core3fmt5write17h5f7e4d4e4a0b4c2aE", "core::fmt::write::h5f7e4d4e4a0b4c2a"),
+	mu_demangle_test("_RNvCs1234_7mycrate3foo", "mycrate[3c1c0]::foo"),
+	mu_demangle_test("main", NULL),
+	mu_demangle_test("__libc_start_main", NULL),
+	mu_demangle_test(".L.str.12", NULL),
+	// end
+);
+
+mu_demangle_with(filter, RZ_DEMANGLE_OPT_BASE);
+
+static bool test_filter_records_failures(void) {
+	mu_assert(__LINE__, "failure not recorded", libdemangle_filter_contains(filter, RZ_DEMANGLE_LANG_RUST, "main"));
+	mu_assert(__LINE__, "failure not recorded", libdemangle_filter_contains(filter, RZ_DEMANGLE_LANG_RUST, ".L.str.12"));
+	// the key includes the language, and successes are never recorded
+	mu_assert(__LINE__, "wrong language matched", !libdemangle_filter_contains(filter, RZ_DEMANGLE_LANG_CXX, "main"));
+	mu_assert(__LINE__, "success recorded", !libdemangle_filter_contains(filter, RZ_DEMANGLE_LANG_RUST, "_RNvCs1234_7mycrate3foo"));
+	mu_end(__LINE__, "main", "(filtered)");
+}
+
+static bool test_filter_false_positive_rate(void) {
+	char symbol[64];
+	RzDemangleFilter *f = libdemangle_filter_new(FILTER_SYMBOLS, 0.01);
+	mu_assert(__LINE__, "cannot allocate filter", f);
+	for (int i = 0; i < FILTER_SYMBOLS; ++i) {
+		snprintf(symbol, sizeof(symbol), "label_%d", i);
+		mu_assert(__LINE__, "cannot add symbol", libdemangle_filter_add(f, RZ_DEMANGLE_LANG_CXX, symbol));
+	}
+	int false_positives = 0;
+	for (int i = 0; i < FILTER_SYMBOLS; ++i) {
+		snprintf(symbol, sizeof(symbol), "label_%d", i);
+		mu_assert(__LINE__, "false negative", libdemangle_filter_contains(f, RZ_DEMANGLE_LANG_CXX, symbol));
+		snprintf(symbol, sizeof(symbol), "other_%d", i);
+		false_positives += libdemangle_filter_contains(f, RZ_DEMANGLE_LANG_CXX, symbol);
+	}
+	// twice the configured rate leaves room for the hash variance
+	mu_assert(__LINE__, "false-positive rate too high", false_positives < FILTER_SYMBOLS / 50);
+
+	// a full filter stops growing, so the rate is never exceeded
+	for (int i = 0; i < FILTER_SYMBOLS; ++i) {
+		snprintf(symbol, sizeof(symbol), "more_%d", i);
+		libdemangle_filter_add(f, RZ_DEMANGLE_LANG_CXX, symbol);
+	}
+	false_positives = 0;
+	for (int i = 0; i < FILTER_SYMBOLS; ++i) {
+		snprintf(symbol, sizeof(symbol), "other_%d", i);
+		false_positives += libdemangle_filter_contains(f, RZ_DEMANGLE_LANG_CXX, symbol);
+	}
+	mu_assert(__LINE__, "full filter kept growing", false_positives < FILTER_SYMBOLS / 50);
+	libdemangle_filter_free(f);
+	mu_end(__LINE__, "label_*", "(filtered)");
+}
+
+static bool test_filter_save_and_load(const char *path) {
+	mu_assert(__LINE__, "cannot save filter", libdemangle_filter_save(filter, path));
+	RzDemangleFilter *loaded = libdemangle_filter_load(path);
+	mu_assert(__LINE__, "cannot load filter", loaded);
+	mu_assert(__LINE__, "entry lost", libdemangle_filter_contains(loaded, RZ_DEMANGLE_LANG_RUST, "__libc_start_main"));
+	mu_assert(__LINE__, "wrong entry", !libdemangle_filter_contains(loaded, RZ_DEMANGLE_LANG_RUST, "_RNvCs1234_7mycrate3foo"));
+	libdemangle_filter_free(loaded);
+	// the temporary file is renamed, nothing is left next to the filter
+	char dir[256];
+	snprintf(dir, sizeof(dir), "%s", path);
+	*strrchr(dir, '/') = 0;
+	DIR *d = opendir(dir);
+	mu_assert(__LINE__, "cannot open directory", d);
+	size_t n_files = 0;
+	for (struct dirent *e; (e = readdir(d));) {
+		n_files += e->d_name[0] != '.';
+	}
+	closedir(d);
+	mu_assert(__LINE__, "temporary file left", n_files == 1);
+
+	// a filter of another version of the library is discarded
+	FILE *fp = fopen(path, "r+b");
+	mu_assert(__LINE__, "cannot patch file", fp && !fseek(fp, 40, SEEK_SET) && fputc('9', fp) == '9' && !fclose(fp));
+	mu_assert(__LINE__, "filter of another version loaded", !libdemangle_filter_load(path));
+	// or of another build
+	mu_assert(__LINE__, "cannot save filter", libdemangle_filter_save(filter, path));
+	uint32_t features = 0x7fffffff;
+	fp = fopen(path, "r+b");
+	mu_assert(__LINE__, "cannot patch file", fp && !fseek(fp, 56, SEEK_SET) && fwrite(&features, sizeof(features), 1, fp) == 1 && !fclose(fp));
+	mu_assert(__LINE__, "filter of another build loaded", !libdemangle_filter_load(path));
+
+	// n_bits is bounded by the size of the file, not only by the format
+	mu_assert(__LINE__, "cannot save filter", libdemangle_filter_save(filter, path));
+	uint64_t n_bits = 1ull << 36;
+	fp = fopen(path, "r+b");
+	mu_assert(__LINE__, "cannot patch file", fp && !fseek(fp, 16, SEEK_SET) && fwrite(&n_bits, sizeof(n_bits), 1, fp) == 1 && !fclose(fp));
+	mu_assert(__LINE__, "oversized filter loaded", !libdemangle_filter_load(path));
+
+	fp = fopen(path, "wb");
+	mu_assert(__LINE__, "cannot write file", fp);
+	fputs("not a filter", fp);
+	fclose(fp);
+	mu_assert(__LINE__, "invalid file loaded", !libdemangle_filter_load(path));
+	mu_end(__LINE__, path, "(loaded)");
+}
+
+static bool test_filter_ctx(void) {
+	RzDemangleCtx *ctx = libdemangle_ctx_new(1);
+	RzDemangleFilter *f = libdemangle_filter_new(1024, 0.001);
+	mu_assert(__LINE__, "cannot allocate context", ctx && f);
+	libdemangle_ctx_set_filter(ctx, f);
+	mu_assert_null(libdemangle_ctx_demangle(ctx, RZ_DEMANGLE_LANG_JAVA, "(", RZ_DEMANGLE_OPT_BASE), "(", __LINE__);
+	mu_assert(__LINE__, "failure not recorded", libdemangle_filter_contains(f, RZ_DEMANGLE_LANG_JAVA, "("));
+
+	// a symbol in the filter is never handed to the demangler
+	libdemangle_filter_add(f, RZ_DEMANGLE_LANG_JAVA, "F");
+	mu_assert_null(libdemangle_ctx_demangle(ctx, RZ_DEMANGLE_LANG_JAVA, "F", RZ_DEMANGLE_OPT_BASE), "F", __LINE__);
+	char *result = libdemangle_ctx_demangle(ctx, RZ_DEMANGLE_LANG_JAVA, "I", RZ_DEMANGLE_OPT_BASE);
+	mu_assert_streq_free("I", result, "int", __LINE__);
+	libdemangle_ctx_free(ctx);
+	libdemangle_filter_free(f);
+	mu_end(__LINE__, "F", "(filtered)");
+}
+
+int main(int argc, char **argv) {
+	char dir[] = "/tmp/test_filter.XXXXXX";
+	if (!mkdtemp(dir)) {
+		return 1;
+	}
+	char path[sizeof(dir) + 16];
+	snprintf(path, sizeof(path), "%s/filter", dir);
+
+	filter = libdemangle_filter_new(1024, 0.001);
+	// the failures are recorded by the first run and skipped by the second
+	mu_demangle_loop(filter, filter);
+	mu_demangle_loop(filter, filter);
+	mu_run_test_named(test_filter_records_failures, "filter");
+	mu_run_test_named(test_filter_false_positive_rate, "filter");
+	mu_run_test_named(test_filter_save_and_load, "filter", path);
+	mu_run_test_named(test_filter_ctx, "filter");
+	libdemangle_filter_free(filter);
+
+	unlink(path);
+	rmdir(dir);
+	return tests_passed != tests_run;
+}
@@ -0,0 +1,104 @@
+// SPDX-FileCopyrightText: 2026 RizinOrg <info@rizin.re>
+// SPDX-License-Identifier: LGPL-3.0-only
+
+// minunit.h is C only, the checks of the C++ wrapper print the same way.
+
+#include <rz_libdemangle.hpp>
+#include <array>
+#include <cstdio>
+#include <list>
+
+namespace dem = rz::demangle;
+
+static int tests_run = 0;
+static int tests_passed = 0;
+
+static std::string_view as_view(std::string_view string) {
+	return string;
+}
+
+static std::string_view as_view(const char *string) {
+	return string ? string : "(null)";
+}
+
+#define hpp_assert_streq(actual, expected) \
+	do { \
+		std::string_view act__ = as_view(actual); \
+		std::string exp__(expected); \
+		tests_run++; \
+		if (act__ == exp__) { \
+			tests_passed++; \
+			std::printf("\x1b[32mOK\x1b[0m line %d: '%.*s'\n", __LINE__, (int)exp__.size(), exp__.data()); \
+		} else { \
+			std::printf("\x1b[1m\x1b[31mERR\n[XX] line %d:\x1b[0m\nexpected: %.*s\ngot:      %.*s\n\n", __LINE__, \
+				(int)exp__.size(), exp__.data(), (int)act__.size(), act__.data()); \
+		} \
+	} while (0)
+
+#define hpp_assert(test) hpp_assert_streq((test) ? "true" : "false", "true")
+
+static void test_string_view_inputs() {
+	// a view which is not NUL terminated
+	std::string_view line = "Ljava/lang/String;Ljunk;";
+	dem::Result result = dem::demangle(RZ_DEMANGLE_LANG_JAVA, line.substr(0, 18));
+	hpp_assert_streq(result.view(), "java.lang.String");
+	hpp_assert(!dem::demangle(RZ_DEMANGLE_LANG_JAVA, std::string_view("(")));
+	// longer than the stack buffer
+	std::string name(300, 'a');
+	std::string symbol = "_ZN" + std::to_string(name.size()) + name + "3fooE";
+	result = dem::demangle(RZ_DEMANGLE_LANG_RUST, std::string_view(symbol));
+	hpp_assert_streq(result.view(), name + "::foo");
+	hpp_assert(dem::lang_from_name("java") == RZ_DEMANGLE_LANG_JAVA && !dem::lang_from_name("cobol"));
+}
+
+static void test_buffer_outputs() {
+	std::string buffer;
+	buffer.reserve(64);
+	const char *data = buffer.data();
+	hpp_assert(dem::demangle_into(buffer, RZ_DEMANGLE_LANG_JAVA, "F"));
+	hpp_assert_streq(buffer, "float");
+	hpp_assert(dem::demangle_into(buffer, RZ_DEMANGLE_LANG_JAVA, "I"));
+	hpp_assert_streq(buffer, "int");
+	hpp_assert(buffer.data() == data);
+	hpp_assert(!dem::demangle_into(buffer, RZ_DEMANGLE_LANG_JAVA, "(") && buffer.empty());
+
+	std::array<std::byte, 1024> arena;
+	std::pmr::monotonic_buffer_resource resource(arena.data(), arena.size(), std::pmr::null_memory_resource());
+	auto result = dem::demangle(RZ_DEMANGLE_LANG_JAVA, "Lsome/class/Object;.myMethod([F)I", RZ_DEMANGLE_OPT_BASE, &resource);
+	hpp_assert(result && result->get_allocator().resource() == &resource);
+	hpp_assert_streq(*result, "int some.class.Object.myMethod(float[])");
+}
+
+static void test_context_batch() {
+	dem::Context ctx(2);
+	hpp_assert(ctx.set_memo(1024));
+	dem::Result result = ctx.demangle(RZ_DEMANGLE_LANG_JAVA, std::string("F"));
+	hpp_assert_streq(result.view(), "float");
+
+	std::list<std::string_view> views = { "F", "(", "Ljava/lang/String;" };
+	dem::BatchResults results = ctx.batch(RZ_DEMANGLE_LANG_JAVA, views);
+	hpp_assert(results.size() == 3 && !results[1]);
+	hpp_assert_streq(results[0], "float");
+	hpp_assert_streq(results[2], "java.lang.String");
+
+	std::vector<std::string> strings(1000, "I");
+	size_t n_results = 0;
+	for (const char *result : ctx.batch(RZ_DEMANGLE_LANG_JAVA, strings, RZ_DEMANGLE_OPT_BASE, true)) {
+		n_results += result && !std::strcmp(result, "int");
+	}
+	hpp_assert(n_results == strings.size());
+
+	const char *symbols[] = { "Z", "B" };
+	results = ctx.batch(RZ_DEMANGLE_LANG_JAVA, symbols);
+	dem::Result first = results.take(0);
+	hpp_assert_streq(first.view(), "boolean");
+	hpp_assert(!results[0]);
+	hpp_assert_streq(results[1], "byte");
+}
+
+int main() {
+	test_string_view_inputs();
+	test_buffer_outputs();
+	test_context_batch();
+	return tests_passed != tests_run;
+}
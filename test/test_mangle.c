@@ -0,0 +1,92 @@
+// SPDX-FileCopyrightText: 2026 RizinOrg <info@rizin.re>
+// SPDX-License-Identifier: LGPL-3.0-only
+
+#include "minunit.h"
+
+/**
+ * The candidates are returned space separated, in the order of the list.
+ */
+static char *mangle_joined(RzDemangleLang lang, const char *declaration) {
+	char **names = libdemangle_mangle(lang, declaration);
+	if (!names) {
+		return NULL;
+	}
+	size_t size = 1;
+	for (char **name = names; *name; ++name) {
+		size += strlen(*name) + 1;
+	}
+	char *joined = calloc(size, 1);
+	for (char **name = names; joined && *name; ++name) {
+		if (name != names) {
+			strcat(joined, " ");
+		}
+		strcat(joined, *name);
+	}
+	libdemangle_mangle_free(names);
+	return joined;
+}
+
+static char *libdemangle_handler_mangle_cxx(const char *declaration, RzDemangleOpts opts) {
+	return mangle_joined(RZ_DEMANGLE_LANG_CXX, declaration);
+}
+
+static char *libdemangle_handler_mangle_msvc(const char *declaration, RzDemangleOpts opts) {
+	return mangle_joined(RZ_DEMANGLE_LANG_MSVC, declaration);
+}
+
+#if WITH_GPL
+mu_demangle_tests(mangle_cxx,
+	mu_demangle_test("ns::Widget::resize(int, int)", "_ZN2ns6Widget6resizeEii"),
+	mu_demangle_test("ns::Widget::size() const", "_ZNK2ns6Widget4sizeEv"),
+	mu_demangle_test("Foo::Foo(Foo const&)", "_ZN3FooC1ERKS_ _ZN3FooC2ERKS_"),
+	mu_demangle_test("Foo::~Foo()", "_ZN3FooD1Ev _ZN3FooD2Ev _ZN3FooD0Ev"),
+	mu_demangle_test("foo(char const*, char const*)", "_Z3fooPKcS0_ foo"),
+	mu_demangle_test("hash(uint64_t)", "_Z4hashy hash _Z4hashm"),
+	mu_demangle_test("Vec::operator-(Vec const&) const", "_ZNK3VecmiERKS_ _ZNK3VecngERKS_"),
+	mu_demangle_test("operator new[](unsigned long)", "_Znam"),
+	mu_demangle_test("Widget::operator bool() const", "_ZNK6WidgetcvbEv"),
+	mu_demangle_test("std::vector<int, std::allocator<int> >::push_back(int const&)", "_ZNSt6vectorIiSaIiEE9push_backERKi"),
+	mu_demangle_test("void std::swap<int>(int&, int&)", "_ZSt4swapIiEvRT_S1_ _ZSt4swapIiEvRiS0_"),
+	mu_demangle_test("std::basic_ostream<char, std::char_traits<char> >& std::endl<char, std::char_traits<char> >(std::basic_ostream<char, std::char_traits<char> >&)", "_ZSt4endlIcSt11char_traitsIcEERSt13basic_ostreamIT_T0_ES6_ _ZSt4endlIcSt11char_traitsIcEERSt13basic_ostreamIcT0_ES5_ _ZSt4endlIcSt11char_traitsIcEERSt13basic_ostreamIT_S0_IS3_EES6_ _ZSt4endlIcSt11char_traitsIcEERSoS2_"),
+	mu_demangle_test("std::array<int, 4ul>::fill(int const&)", "_ZNSt5arrayIiLm4EE4fillERKi"),
+	mu_demangle_test("(anonymous namespace)::helper(void (*)(int))", "_ZN12_GLOBAL__N_16helperEPFviE"),
+	mu_demangle_test("std::__cxx11::basic_string<char, std::char_traits<char>, std::allocator<char> >::data[abi:cxx11]() const", "_ZNKSt7__cxx1112basic_stringIcSt11char_traitsIcESaIcEE4dataB5cxx11Ev"),
+	mu_demangle_test("ns::counter", "_ZN2ns7counterE"),
+	mu_demangle_test("counter", "counter"),
+	mu_demangle_test("vtable for ns::Widget", "_ZTVN2ns6WidgetE"),
+	mu_demangle_test("typeinfo for int", "_ZTIi"),
+	mu_demangle_test("guard variable for ns::instance", "_ZGVN2ns8instanceE"),
+	// the return type is part of the signature of the function templates
+	mu_demangle_test("std::swap<int>(int&, int&)", NULL),
+	mu_demangle_test("ns::Widget::resize(int,", NULL),
+	// end
+);
+#endif
+
+mu_demangle_tests(mangle_msvc,
+	mu_demangle_test("int __cdecl f(int)", "?f@@YAHH@Z"),
+	mu_demangle_test("void * __ptr64 __cdecl operator new(unsigned __int64)", "??2@YAPEAX_K@Z"),
+	mu_demangle_test("public: void __thiscall Widget::resize(int, int)", "?resize@Widget@@QAEXHH@Z"),
+	mu_demangle_test("public: virtual __cdecl Widget::~Widget(void) __ptr64", "??1Widget@@UEAA@XZ"),
+	mu_demangle_test("private: static int ns::Widget::count", "?count@Widget@ns@@0HA"),
+	mu_demangle_test("public: class std::basic_ostream<char, struct std::char_traits<char>> & __ptr64 __cdecl std::basic_ostream<char, struct std::char_traits<char>>::put(char) __ptr64", "?put@?$basic_ostream@DU?$char_traits@D@std@@@std@@QEAAAEAV12@D@Z"),
+	mu_demangle_test("const std::exception::vftable", "??_7exception@std@@6B@"),
+	// the return type is required
+	mu_demangle_test("f(int)", NULL),
+	// the anonymous namespaces are named after a hash of the file
+	mu_demangle_test("void __cdecl `anonymous namespace'::helper(void)", NULL),
+	// end
+);
+
+#if WITH_GPL
+mu_demangle_with(mangle_cxx, RZ_DEMANGLE_OPT_BASE);
+#endif
+mu_demangle_with(mangle_msvc, RZ_DEMANGLE_OPT_BASE);
+
+int main(int argc, char **argv) {
+#if WITH_GPL
+	mu_demangle_loop(mangle_cxx, mangle_cxx);
+#endif
+	mu_demangle_loop(mangle_msvc, mangle_msvc);
+	return tests_passed != tests_run;
+}
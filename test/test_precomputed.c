@@ -0,0 +1,77 @@
+// SPDX-FileCopyrightText: 2026 RizinOrg <info@rizin.re>
+// SPDX-License-Identifier: LGPL-3.0-only
+
+#include "minunit.h"
+
+typedef struct {
+	RzDemangleLang lang;
+	const char *symbol;
+} precomputed_symbol_t;
+
+static precomputed_symbol_t lookups[] = {
+	{ RZ_DEMANGLE_LANG_CXX, "_Znwm" },
+	{ RZ_DEMANGLE_LANG_CXX, "_ZNSt7__cxx1112basic_stringIcSt11char_traitsIcESaIcEE9_M_createERmm" },
+	{ RZ_DEMANGLE_LANG_CXX, "_ZSt16__ostream_insertIcSt11char_traitsIcEERSt13basic_ostreamIT_T0_ES6_PKS3_l" },
+	{ RZ_DEMANGLE_LANG_CXX, "_ZNSt3__112basic_stringIcNS_11char_traitsIcEENS_9allocatorIcEEE6appendEPKcm" },
+	{ RZ_DEMANGLE_LANG_MSVC, "??2@YAPAXI@Z" },
+	{ RZ_DEMANGLE_LANG_MSVC, "?cout@std@@3V?$basic_ostream@DU?$char_traits@D@std@@@1@A" },
+	{ RZ_DEMANGLE_LANG_CXX, "_Z3foov" },
+	{ RZ_DEMANGLE_LANG_RUST, "_ZN3std12backtrace_rs5print17BacktraceFrameFmt21print_raw_with_column17h7414c38d976a3a25E" },
+	{ RZ_DEMANGLE_LANG_RUST, "_Znwm" },
+	{ RZ_DEMANGLE_LANG_MSVC, "_Znwm" },
+};
+
+static size_t lookup_index = 0;
+
+static char *libdemangle_handler_precomputed(const char *symbol, RzDemangleOpts opts) {
+	const char *result = libdemangle_precomputed(lookups[lookup_index++].lang, symbol, opts);
+	return result ? strdup(result) : NULL;
+}
+
+mu_demangle_tests(precomputed,
+#if WITH_GPL
+	mu_demangle_test("_Znwm", "operator new(unsigned long)"),
+	mu_demangle_test("_ZNSt7__cxx1112basic_stringIcSt11char_traitsIcESaIcEE9_M_createERmm", "std::string::_M_create(unsigned long&, unsigned long)"),
+	mu_demangle_test("_ZSt16__ostream_insertIcSt11char_traitsIcEERSt13basic_ostreamIT_T0_ES6_PKS3_l", "std::ostream& std::__ostream_insert<char, std::char_traits<char> >(std::ostream&, char const*, long)"),
+	mu_demangle_test("_ZNSt3__112basic_stringIcNS_11char_traitsIcEENS_9allocatorIcEEE6appendEPKcm", "std::string::append(char const*, unsigned long)"),
+#else
+	mu_demangle_test("_Znwm", NULL),
+	mu_demangle_test("_ZNSt7__cxx1112basic_stringIcSt11char_traitsIcESaIcEE9_M_createERmm", NULL),
+	mu_demangle_test("_ZSt16__ostream_insertIcSt11char_traitsIcEERSt13basic_ostreamIT_T0_ES6_PKS3_l", NULL),
+	mu_demangle_test("_ZNSt3__112basic_stringIcNS_11char_traitsIcEENS_9allocatorIcEEE6appendEPKcm", NULL),
+#endif
+	mu_demangle_test("??2@YAPAXI@Z", "void * __cdecl operator new(unsigned int)"),
+	mu_demangle_test("?cout@std@@3V?$basic_ostream@DU?$char_traits@D@std@@@1@A", "class std::basic_ostream<char, struct std::char_traits<char>> std::cout"),
+	// not in the table, the Rust symbols carry the hash of their build
+	mu_demangle_test("_Z3foov", NULL),
+	mu_demangle_test("_ZN3std12backtrace_rs5print17BacktraceFrameFmt21print_raw_with_column17h7414c38d976a3a25E", NULL),
+	// the language is part of the key
+	mu_demangle_test("_Znwm", NULL),
+	mu_demangle_test("_Znwm", NULL),
+	// end
+);
+
+static bool test_precomputed_handlers_return_copies(void) {
+	// handlers return the table content as a newly allocated string.
+	for (size_t i = 0; i < sizeof(lookups) / sizeof(lookups[0]); ++i) {
+		for (int simplify = 0; simplify < 2; ++simplify) {
+			RzDemangleOpts opts = simplify ? RZ_DEMANGLE_OPT_SIMPLIFY : RZ_DEMANGLE_OPT_BASE;
+			const char *expected = libdemangle_precomputed(lookups[i].lang, lookups[i].symbol, opts);
+			if (!expected) {
+				continue;
+			}
+			char *actual = libdemangle_handler(lookups[i].lang, lookups[i].symbol, opts);
+			mu_assert(__LINE__, "handler returned the static string", actual != expected);
+			mu_assert_streq_free(lookups[i].symbol, actual, expected, __LINE__);
+		}
+	}
+	mu_end(__LINE__, "precomputed", "handlers");
+}
+
+mu_demangle_with(precomputed, RZ_DEMANGLE_OPT_ENABLE_ALL);
+
+int main(int argc, char **argv) {
+	mu_demangle_loop(precomputed, precomputed);
+	mu_run_test_named(test_precomputed_handlers_return_copies, "precomputed");
+	return tests_passed != tests_run;
+}
@@ -0,0 +1,66 @@
+// SPDX-FileCopyrightText: 2026 RizinOrg <info@rizin.re>
+// SPDX-License-Identifier: LGPL-3.0-only
+
+#include "minunit.h"
+
+#define SAMPLER_SYMBOLS 4000
+#define SAMPLER_THREADS 4
+#define SAMPLER_TOP     8
+
+static bool test_sampler_slowest(size_t n_threads) {
+	char **copies = calloc(SAMPLER_SYMBOLS, sizeof(char *));
+	char **results = calloc(SAMPLER_SYMBOLS, sizeof(char *));
+	RzDemangleCtx *ctx = libdemangle_ctx_new(n_threads);
+	RzDemangleSampler *sampler = libdemangle_sampler_new(SAMPLER_TOP);
+	RzDemangleSample samples[SAMPLER_TOP + 1];
+	mu_assert(__LINE__, "cannot allocate", copies && results && ctx && sampler);
+	mu_assert(__LINE__, "empty sampler", !libdemangle_sampler_query(sampler, samples, SAMPLER_TOP));
+	libdemangle_ctx_set_sampler(ctx, sampler);
+
+	// a long class name, truncated in the samples, and failures
+	for (size_t i = 0; i < SAMPLER_SYMBOLS; ++i) {
+		char symbol[512];
+		if (i % 3 == 2) {
+			snprintf(symbol, sizeof(symbol), "(%zu", i);
+		} else {
+			int length = snprintf(symbol, sizeof(symbol), "L%zu/", i);
+			memset(symbol + length, 'a', 300);
+			snprintf(symbol + length + 300, sizeof(symbol) - length - 300, "/Klass;");
+		}
+		copies[i] = strdup(symbol);
+	}
+	RzDemangleBatch batch = { RZ_DEMANGLE_LANG_JAVA, RZ_DEMANGLE_OPT_BASE, (const char **)copies, results, SAMPLER_SYMBOLS };
+	mu_assert(__LINE__, "cannot demangle", libdemangle_batch(ctx, &batch));
+
+	size_t n_samples = libdemangle_sampler_query(sampler, samples, SAMPLER_TOP + 1);
+	mu_assert(__LINE__, "top k samples", n_samples == SAMPLER_TOP);
+	for (size_t i = 0; i < n_samples; ++i) {
+		RzDemangleSample *sample = &samples[i];
+		size_t k = 0;
+		for (; k < SAMPLER_SYMBOLS && strncmp(copies[k], sample->symbol, RZ_DEMANGLE_SAMPLE_SYMBOL - 1); ++k) {
+		}
+		mu_assert(__LINE__, "unknown symbol", k < SAMPLER_SYMBOLS && sample->lang == RZ_DEMANGLE_LANG_JAVA);
+		size_t length = strlen(copies[k]);
+		mu_assert(__LINE__, "truncated symbol", strlen(sample->symbol) == (length < RZ_DEMANGLE_SAMPLE_SYMBOL ? length : RZ_DEMANGLE_SAMPLE_SYMBOL - 1));
+		mu_assert(__LINE__, "symbol length", sample->symbol_length == length);
+		mu_assert(__LINE__, "output length", sample->output_length == (results[k] ? strlen(results[k]) : 0));
+		mu_assert(__LINE__, "not sorted", !i || samples[i - 1].ns >= sample->ns);
+	}
+	mu_assert(__LINE__, "max samples", libdemangle_sampler_query(sampler, samples, 2) == 2);
+
+	libdemangle_ctx_free(ctx);
+	libdemangle_sampler_free(sampler);
+	for (size_t i = 0; i < SAMPLER_SYMBOLS; ++i) {
+		free(copies[i]);
+		free(results[i]);
+	}
+	free(copies);
+	free(results);
+	mu_end(__LINE__, "sampler", "slowest");
+}
+
+int main(int argc, char **argv) {
+	mu_run_test_named(test_sampler_slowest, "sampler", 1);
+	mu_run_test_named(test_sampler_slowest, "sampler", SAMPLER_THREADS);
+	return tests_passed != tests_run;
+}
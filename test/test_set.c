@@ -0,0 +1,97 @@
+// SPDX-FileCopyrightText: 2026 RizinOrg <info@rizin.re>
+// SPDX-License-Identifier: LGPL-3.0-only
+
+#include "minunit.h"
+
+#define SET_SYMBOLS 20000
+#define SET_THREADS 4
+
+static int name_cmp(const void *a, const void *b) {
+	return strcmp(*(const char **)a, *(const char **)b);
+}
+
+/**
+ * \brief Checks the set against the unique names computed one by one.
+ */
+static int set_check(RzDemangleSet *set, const char **symbols, size_t n_symbols, int keep_failures) {
+	char **expected = calloc(n_symbols + 1, sizeof(char *));
+	size_t n_expected = 0, n_names = 0;
+	int res = 1;
+	for (size_t i = 0; i < n_symbols; ++i) {
+		char *name = libdemangle_handler(RZ_DEMANGLE_LANG_JAVA, symbols[i], RZ_DEMANGLE_OPT_BASE);
+		if (!name && keep_failures) {
+			name = strdup(symbols[i]);
+		}
+		if (name) {
+			expected[n_expected++] = name;
+		}
+	}
+	qsort(expected, n_expected, sizeof(char *), name_cmp);
+	const char **names = libdemangle_set_sorted(set, &n_names);
+	size_t k = 0;
+	for (size_t i = 0; names && i < n_expected; ++i) {
+		if (i && !strcmp(expected[i], expected[i - 1])) {
+			continue;
+		} else if (k >= n_names || strcmp(names[k], expected[i])) {
+			printf("name %zu mismatch: '%s' vs '%s'\n", k, k < n_names ? names[k] : "(end)", expected[i]);
+			res = 0;
+			break;
+		}
+		k++;
+	}
+	res &= names && k == n_names && n_names == libdemangle_set_size(set);
+	for (size_t i = 0; i < n_expected; ++i) {
+		free(expected[i]);
+	}
+	free(expected);
+	return res;
+}
+
+static bool test_set_sorted_unique(size_t n_threads, int keep_failures) {
+	char **copies = calloc(SET_SYMBOLS, sizeof(char *));
+	RzDemangleCtx *ctx = libdemangle_ctx_new(n_threads);
+	RzDemangleSet *set = libdemangle_set_new(ctx, keep_failures);
+	mu_assert(__LINE__, "cannot allocate", copies && ctx && set);
+	// repeated names, long common prefixes, short names and failures
+	for (size_t i = 0; i < SET_SYMBOLS; ++i) {
+		char symbol[64];
+		switch (i % 4) {
+		case 0: snprintf(symbol, sizeof(symbol), "Lsome/long/package/name/Klass%zu;", i % 3001); break;
+		case 1: snprintf(symbol, sizeof(symbol), "f%zu.I", i % 97); break;
+		case 2: snprintf(symbol, sizeof(symbol), "(%zu", i % 13); break;
+		default: snprintf(symbol, sizeof(symbol), "%s", i & 4 ? "F" : "Z"); break;
+		}
+		copies[i] = strdup(symbol);
+	}
+	// in two halves, the second one extends the sorted set
+	mu_assert(__LINE__, "cannot add", libdemangle_set_add(set, RZ_DEMANGLE_LANG_JAVA, RZ_DEMANGLE_OPT_BASE, (const char **)copies, SET_SYMBOLS / 2));
+	mu_assert(__LINE__, "set mismatch", set_check(set, (const char **)copies, SET_SYMBOLS / 2, keep_failures));
+	mu_assert(__LINE__, "cannot add", libdemangle_set_add(set, RZ_DEMANGLE_LANG_JAVA, RZ_DEMANGLE_OPT_BASE, (const char **)copies + SET_SYMBOLS / 2, SET_SYMBOLS / 2));
+	mu_assert(__LINE__, "set mismatch", set_check(set, (const char **)copies, SET_SYMBOLS, keep_failures));
+	libdemangle_set_free(set);
+	libdemangle_ctx_free(ctx);
+	for (size_t i = 0; i < SET_SYMBOLS; ++i) {
+		free(copies[i]);
+	}
+	free(copies);
+	mu_end(__LINE__, "set", "sorted unique");
+}
+
+static bool test_set_empty(void) {
+	size_t n_names = 1;
+	RzDemangleCtx *ctx = libdemangle_ctx_new(SET_THREADS);
+	RzDemangleSet *set = libdemangle_set_new(ctx, 0);
+	mu_assert(__LINE__, "cannot allocate", ctx && set);
+	mu_assert(__LINE__, "cannot sort", libdemangle_set_sorted(set, &n_names) && !n_names);
+	libdemangle_set_free(set);
+	libdemangle_ctx_free(ctx);
+	mu_end(__LINE__, "set", "empty");
+}
+
+int main(int argc, char **argv) {
+	mu_run_test_named(test_set_sorted_unique, "set", 1, 0);
+	mu_run_test_named(test_set_sorted_unique, "set", SET_THREADS, 0);
+	mu_run_test_named(test_set_sorted_unique, "set", SET_THREADS, 1);
+	mu_run_test_named(test_set_empty, "set");
+	return tests_passed != tests_run;
+}